@@ -0,0 +1,82 @@
+#ifndef ART_CACHE_H
+#define ART_CACHE_H
+
+#include "npcbase.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 内存中的自适应基数树（ART），作为B+树索引的点查镜像（见IndexManager::setIndexCache）
+//   键为定长的保序编码键，逐字节作为基数树的一层；内部节点按孩子数在4/16/48/256四种容量间升降，
+//   只有一个孩子的路径压缩进节点前缀（前缀只存前ART_MAX_PREFIX字节，其余在叶子处比较完整键确认）
+//   叶子存放完整键与该键的各项尾（RID(8字节) + 负载，与B+树叶子项尾相同），按RID序排列
+// 键定长，任何键都不是另一个键的前缀，叶子只出现在路径末端
+// 本身不加锁，由调用方串行化写操作
+#define ART_MAX_PREFIX 10
+
+class ArtCache {
+public:
+    ArtCache(int keyLen, int tailLen);
+    ~ArtCache();
+    ArtCache(const ArtCache&) = delete;
+    ArtCache& operator=(const ArtCache&) = delete;
+
+    /**
+     * 插入一项
+     * @param key 完整键（keyLen字节）
+     * @param tail 项尾（tailLen字节，前8字节为RID）
+     * @return 该键已有相同RID的项时返回false（不变）
+     */
+    bool insert(const char* key, const char* tail);
+
+    /**
+     * 删除键为key、RID为rid的项，键的最后一项删除后叶子随之删除
+     * @return 不存在时返回false
+     */
+    bool remove(const char* key, const RID& rid);
+
+    /**
+     * 取出键等于key的各项（键 + 项尾，按RID序）追加到out
+     * @param first 只要第一项
+     * @return 键不存在时返回false
+     */
+    bool lookup(const char* key, std::vector<char>& out, bool first = false) const;
+
+    size_t keyCount() const { return keys_; }
+    size_t entryCount() const { return entries_; }
+    size_t memoryBytes() const { return bytes_; }   // 节点与叶子占用的字节数（估计）
+
+private:
+    struct Node;
+    struct Node4;
+    struct Node16;
+    struct Node48;
+    struct Node256;
+    struct Leaf;
+    // 孩子指针：最低位为1时指向叶子
+    typedef uintptr_t Child;
+
+    Leaf* newLeaf(const char* key, const char* tail);
+    void freeLeaf(Leaf* leaf);
+    Node* newNode(uint8_t kind);
+    void freeNode(Node* node);
+    void freeTree(Child child);
+
+    const char* leafKey(const Leaf* leaf) const;
+    const Leaf* minimumLeaf(Child child) const;
+    int prefixMismatch(const Node* node, const char* key, int depth) const;
+    Child* findChild(Node* node, uint8_t byte) const;
+    void addChild(Child* ref, Node* node, uint8_t byte, Child child);
+    void removeChild(Child* ref, Node* node, uint8_t byte);
+    bool addTail(Leaf* leaf, const char* tail);
+    bool removeTail(Leaf* leaf, const RID& rid);
+
+    int keyLen_;
+    int tailLen_;
+    Child root_ = 0;
+    size_t keys_ = 0;
+    size_t entries_ = 0;
+    size_t bytes_ = 0;
+};
+
+#endif // ART_CACHE_H
@@ -61,6 +61,18 @@ private:
      */
     void handleCreateTable(const std::vector<std::string>& args);
 
+    /**
+     * 处理删除表命令
+     * @param args 命令参数
+     */
+    void handleDropTable(const std::vector<std::string>& args);
+
+    /**
+     * 处理截断表命令
+     * @param args 命令参数
+     */
+    void handleTruncate(const std::vector<std::string>& args);
+
     /**
      * 处理插入记录命令
      * @param args 命令参数
@@ -91,6 +103,23 @@ private:
      */
     void handleVacuum(const std::vector<std::string>& args);
 
+    /**
+     * 处理统计收集命令
+     * @param args 命令参数
+     */
+    void handleAnalyze(const std::vector<std::string>& args);
+
+    /**
+     * 显示表的列统计信息
+     * @param args 命令参数
+     */
+    void handleShowStats(const std::vector<std::string>& args);
+
+    /**
+     * 处理检查点命令（写回表统计并刷出脏页）
+     */
+    void handleCheckpoint();
+
     /**
      * 创建索引
      * @param args 命令参数
@@ -102,6 +131,18 @@ private:
      * @param args 命令参数
      */
     void handleShowIndex(const std::vector<std::string>& args);
+
+    /**
+     * 开启/关闭索引的内存ART镜像
+     * @param args 命令参数
+     */
+    void handleCacheIndex(const std::vector<std::string>& args);
+
+    /**
+     * 开启/关闭表上某列的Bloom过滤器
+     * @param args 命令参数
+     */
+    void handleBloom(const std::vector<std::string>& args);
 };
 
 #endif  // CLI_H
@@ -3,8 +3,16 @@
 
 #include "npcbase.h"
 #include "log_manager.h"
+#include "row_codec.h"
+#include "page_layout.h"
+#include "statistics.h"
 #include <vector>
 #include <string>
+#include <memory>
+#include <atomic>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
 
 // 表信息结构体
 struct TableInfo {
@@ -16,6 +24,26 @@ struct TableInfo {
     PageNum lastPage;                    // 最后一个数据页
     int deletedCount;                    // 被删除的记录数
     int recordCount;                     // 记录总数
+    PageFormat pageFormat;               // 页面格式
+    uint32_t bloomColumns;               // 维护Bloom过滤器的列（第i位对应第i列）
+};
+
+#define MAX_INDEX_COLUMNS 4                 // 复合索引最多键列数
+#define MAX_INDEX_INCLUDE 4                 // 覆盖索引最多INCLUDE列数
+#define MAX_INDEX_PREDICATES 4              // 部分索引最多谓词项数
+#define INDEX_PREDICATE_KEY_LEN 64          // 部分索引谓词字面量的最大编码长度
+
+// 索引访问方法
+enum class IndexMethod : uint8_t {
+    BTREE = 0,   // B+树：等值与范围查找、有序扫描
+    HASH = 1     // 可扩展哈希：仅等值查找（给出全部键列），一次探测一个桶
+};
+
+// 部分索引的谓词项：列 op 字面量，字面量存为该列的保序键编码，与行中列值的编码按memcmp比较
+struct IndexPredicate {
+    int16_t column;                          // 列序号
+    char op[3];                              // = != < <= > >=
+    char key[INDEX_PREDICATE_KEY_LEN];       // 字面量的保序编码（indexKeyLength(列类型, 列长)字节）
 };
 
 // 索引信息结构体（sys_indexes）
@@ -24,16 +52,47 @@ struct IndexInfo {
     char indexName[MAX_TABLE_NAME_LEN];     // 索引名
     TableId tableId;                        // 所属表ID
     char tableName[MAX_TABLE_NAME_LEN];     // 所属表名（便于展示）
-    char columnName[MAX_ATTR_NAME_LEN];     // 索引列名（单列）
-    AttrType keyType;                       // 键类型
-    int keyLen;                             // 键长度
+    char columnName[MAX_ATTR_NAME_LEN];     // 首个键列名
+    AttrType keyType;                       // 首个键列类型
+    int keyLen;                             // 键长度（各键列编码长度之和）
     PageNum rootPage;                       // 根页号
     bool unique;                            // 是否唯一
     int height;                             // 树高
     int totalPages;                         // 页面总数
     int totalKeys;                          // 键总数
+    int keyColumnCount;                     // 键列数
+    int16_t keyColumns[MAX_INDEX_COLUMNS];  // 键列在表中的序号（按键序）
+    int includeCount;                       // INCLUDE列数
+    int16_t includeColumns[MAX_INDEX_INCLUDE]; // INCLUDE列在表中的序号（仅存于叶子项）
+    int payloadLen;                         // 叶子项中键与RID之后的负载长度（空值位图 + INCLUDE列）
+    IndexMethod method;                     // 访问方法（哈希索引的rootPage为其元页）
+    bool cached;                            // 是否在内存中维护ART镜像供点查（仅B+树，见IndexManager::setIndexCache）
+    uint8_t keyExprs[MAX_INDEX_COLUMNS];    // 各键列上的表达式（ColumnExpr，NONE为列值本身）
+    int16_t keyExprArgs[MAX_INDEX_COLUMNS]; // 表达式参数（PREFIX为前缀长度）
+    int predicateCount;                     // 部分索引的谓词项数（0为全表索引）
+    IndexPredicate predicates[MAX_INDEX_PREDICATES]; // 各项AND，只有满足全部谓词的行入索引
 };
 
+// 目录项：由DataDict独占修改，外部通过只读句柄（TableRef/IndexRef）访问；目录由catalogMutex_保护，可并发查找。
+// 表与索引信息都写时复制：页范围、记录数等统计变化或DDL时换上新的目录项，旧句柄的内容不再改变，
+// 持有者在一次操作内读到一致的信息；并发下降所需的当前根页与树高由IndexManager的根锁维护，不取自句柄。
+// 被换下的目录项version递增；截断、建/删索引等DDL递增version；删除时置dropped并从目录摘除，已持有的句柄仍可安全访问。
+// 调用方缓存句柄时记下version，使用前比较version与dropped即可判断缓存是否过期。
+struct TableEntry {
+    TableInfo info;                        // 表信息
+    std::atomic<uint64_t> version{0};      // DDL版本号
+    std::atomic<bool> dropped{false};      // 是否已删除
+};
+
+struct IndexEntry {
+    IndexInfo info;                        // 索引信息
+    std::atomic<uint64_t> version{0};      // DDL版本号
+    std::atomic<bool> dropped{false};      // 是否已删除
+};
+
+typedef std::shared_ptr<const TableEntry> TableRef;   // 表句柄（引用计数，零拷贝）
+typedef std::shared_ptr<const IndexEntry> IndexRef;   // 索引句柄（引用计数，零拷贝）
+
 struct DictPageHeader {
     int tableCount;  // 该页实际存储的表元数据数量
 };
@@ -46,6 +105,7 @@ public:
 
     /**
      * 初始化数据字典
+     * @return 字典或索引元数据文件的格式版本与程序不符时返回RC_FORMAT_MISMATCH
      */
     RC init();
 
@@ -55,15 +115,24 @@ public:
      * @param attrCount 属性数量
      * @param attrs 属性信息数组
      * @param tableId 输出参数，返回表ID
+     * @param pageFormat 页面格式
      */
-    RC createTable(TransactionId txId, const char *tableName, int attrCount, const AttrInfo *attrs, TableId &tableId);
+    RC createTable(TransactionId txId, const char *tableName, int attrCount, const AttrInfo *attrs, TableId &tableId,
+                   PageFormat pageFormat = PAGE_FORMAT_SLOTTED);
 
     /**
-     * 删除表
+     * 删除表（同时删除其索引元数据，原地清除字典记录并写一条删除表日志）
      * @param tableName 表名
      */
     RC dropTable(TransactionId txId, const char *tableName);
 
+    /**
+     * 截断表：清空页面信息与记录统计，原地改写字典记录并写一条截断表日志
+     * @param txId 事务ID
+     * @param tableId 表ID
+     */
+    RC truncateTable(TransactionId txId, TableId tableId);
+
     /**
      * 查找表信息
      * @param tableName 表名
@@ -79,12 +148,37 @@ public:
     RC findTableById(TableId tableId, TableInfo& tableInfo);
 
     /**
-     * 更新表的页面信息
+     * 获取表句柄（不拷贝TableInfo，可跨操作持有，内容为取得时的快照）
+     * @param tableName 表名
+     * @param table 输出参数，返回表句柄
+     */
+    RC getTable(const char* tableName, TableRef& table);
+
+    /**
+     * 获取表句柄（通过表ID）
+     * @param tableId 表ID
+     * @param table 输出参数，返回表句柄
+     */
+    RC getTableById(TableId tableId, TableRef& table);
+
+    /**
+     * 更新表的页面信息：换上新的目录项（仅修改内存并记为脏，检查点时写回字典页）
      * @param tableId 表ID
      * @param lastPage 最后一个数据页
-     * @param recordCount 记录总数
      */
-    RC updateTableInfo(TableId tableId, PageNum lastPage, int recordCount);
+    RC updateTableInfo(TableId tableId, PageNum lastPage);
+
+    /**
+     * 调整表的记录数（插入、删除记录时使用，同样换上新的目录项并在检查点时写回）
+     * @param tableId 表ID
+     * @param delta 增量
+     */
+    RC adjustRecordCount(TableId tableId, int delta);
+
+    /**
+     * 检查点：将统计有变化的表信息原地写回其字典页，并刷出所有脏页
+     */
+    RC checkpoint();
 
     /**
      * 获取所有表名
@@ -92,17 +186,96 @@ public:
      */
     RC listTables(std::vector<std::string>& tables);
 
+    /**
+     * 获取表的行布局（每个表结构只计算一次）
+     * @param tableId 表ID
+     * @param layout 输出参数，返回行布局
+     */
+    RC getRowLayout(TableId tableId, const RowLayout*& layout);
+
+    /**
+     * 获取表的PAX页布局（仅PAX格式的表有效）
+     * @param tableId 表ID
+     * @param layout 输出参数，返回PAX页布局
+     */
+    RC getPaxLayout(TableId tableId, const PaxLayout*& layout);
+
+    /**
+     * 获取表的定长页布局（仅定长格式的表有效）
+     * @param tableId 表ID
+     * @param layout 输出参数，返回定长页布局
+     */
+    RC getFixedLayout(TableId tableId, const FixedLayout*& layout);
+
+    // ========= 统计信息 =========
+    /**
+     * 保存表的统计信息（由ANALYZE生成，替换旧统计）
+     * @param tableId 表ID
+     * @param stats 表统计
+     */
+    RC setTableStats(TableId tableId, TableStats&& stats);
+
+    /**
+     * 获取表的统计信息
+     * @param tableId 表ID
+     * @param stats 输出参数，返回表统计；表未ANALYZE时返回RC_TABLE_NOT_FOUND
+     */
+    RC getTableStats(TableId tableId, const TableStats*& stats);
+
+    /**
+     * 统计与Bloom过滤器增量维护：插入一行（表未ANALYZE、过滤器未构建时忽略）
+     * @param tableId 表ID
+     * @param page 行所在页号
+     * @param data 编码行
+     * @param len 编码行长度
+     */
+    void onRowInserted(TableId tableId, PageNum page, const char* data, int len);
+
+    /**
+     * 统计增量维护：删除一行（表未ANALYZE时忽略）
+     * @param tableId 表ID
+     * @param data 编码行
+     * @param len 编码行长度
+     */
+    void onRowDeleted(TableId tableId, const char* data, int len);
+
+    // ========= Bloom过滤器 =========
+    /**
+     * 设置表维护Bloom过滤器的列（写回字典记录），已构建的过滤器随之丢弃
+     * @param tableId 表ID
+     * @param columns 列位掩码（第i位对应第i列，0表示不维护）
+     */
+    RC setBloomColumns(TableId tableId, uint32_t columns);
+
+    /**
+     * 保存表的Bloom过滤器（由TableManager扫描全表构建，替换旧过滤器）
+     * @param tableId 表ID
+     * @param blooms 过滤器
+     */
+    RC setTableBlooms(TableId tableId, TableBlooms&& blooms);
+
+    /**
+     * 获取表的Bloom过滤器
+     * @param tableId 表ID
+     * @param blooms 输出参数，返回过滤器；尚未构建（重启后、截断后）时返回RC_TABLE_NOT_FOUND
+     */
+    RC getTableBlooms(TableId tableId, const TableBlooms*& blooms);
+
     // ========= 索引元数据（sys_indexes）=========
     /**
      * 创建索引元数据并创建对应文件（不构建数据）
      * @param indexName 索引名
      * @param tableName 表名
-     * @param columnName 列名
+     * @param keyColumns 键列（按键序，最多MAX_INDEX_COLUMNS个；列名或列上的表达式，见parseColumnRef）
+     * @param includeColumns INCLUDE列名（最多MAX_INDEX_INCLUDE个）
      * @param unique 是否唯一
+     * @param method 访问方法
+     * @param predicates 部分索引的谓词（最多MAX_INDEX_PREDICATES项，空为全表索引）
      * @param outIndex 输出参数，返回创建的索引信息
      */
     RC createIndexMetadata(TransactionId txId, const char* indexName, const char* tableName,
-                           const char* columnName, bool unique, IndexInfo& outIndex);
+                           const std::vector<std::string>& keyColumns, const std::vector<std::string>& includeColumns,
+                           bool unique, IndexMethod method, const std::vector<IndexPredicate>& predicates, IndexInfo& outIndex);
 
     /**
      * 查找索引
@@ -126,14 +299,35 @@ public:
     RC listIndexesForTable(TableId tableId, std::vector<IndexInfo>& outIndexes);
 
     /**
-     * 更新索引信息（根页、树高、统计等）
+     * 获取索引句柄
+     * @param indexName 索引名
+     * @param index 输出参数，返回索引句柄
+     */
+    RC getIndex(const char* indexName, IndexRef& index);
+
+    /**
+     * 列出表的所有索引句柄（按创建顺序，不拷贝IndexInfo）
+     * @param tableId 表ID
+     * @param outIndexes 输出参数，返回索引句柄列表
+     */
+    RC listIndexRefsForTable(TableId tableId, std::vector<IndexRef>& outIndexes);
+
+    /**
+     * 更新索引信息（根页、树高、统计等）：换上新的目录项，旧目录项的version递增
      * @param info 索引信息
      */
     RC updateIndexInfo(const IndexInfo& info);
 
 private:
-    std::vector<TableInfo> tables_;  // 存储所有表信息
-    std::vector<IndexInfo> indexes_; // 存储所有索引信息
+    // 保护表与索引目录（以下至tableIndexIds_）、dirtyTables_与各布局缓存：查找取读锁，登记、换上新目录项与DDL取写锁
+    std::shared_mutex catalogMutex_;
+    std::unordered_map<TableId, std::shared_ptr<TableEntry>> tables_;  // 表ID到表目录项
+    std::unordered_map<std::string, TableId> tableIdByName_;      // 表名到表ID
+    std::unordered_map<TableId, std::shared_ptr<IndexEntry>> indexes_; // 索引ID到索引目录项
+    // 被updateIndexInfo换下、可能仍有句柄持有的旧目录项：删除索引时一并标记dropped
+    std::unordered_map<TableId, std::vector<std::weak_ptr<IndexEntry>>> supersededIndexes_;
+    std::unordered_map<std::string, TableId> indexIdByName_;      // 索引名到索引ID
+    std::unordered_map<TableId, std::vector<TableId>> tableIndexIds_; // 表ID到其索引ID列表（按创建顺序）
     TableId nextTableId_ = 1;        // 下一个可用的表ID
     TableId nextIndexId_ = 10000;    // 下一个可用的索引ID（与表ID空间分离）
     DiskManager& diskManager_;       // 磁盘管理器引用
@@ -142,17 +336,45 @@ private:
     std::unordered_map<BlockNum, int> blockOffsets_;  // 数据字典块偏移
     BlockNum currentLogBlock_;       // 当前数据字典块号（表元数据）
 
-    // sys_indexes 持久化管理
-    std::unordered_map<BlockNum, int> indexMetaBlockOffsets_; // 索引元数据块偏移
-    BlockNum indexMetaCurrentBlock_ = -1;                     // 当前索引元数据块号
+    // sys_indexes 持久化管理：每个索引固定占一个槽，统计变化时原地改写
+    std::unordered_map<TableId, std::pair<BlockNum, int>> indexMetaSlots_; // 索引ID到(块号, 块内偏移)
+    std::vector<std::pair<BlockNum, int>> indexMetaFreeSlots_;            // 空闲槽（删除索引后复用）
 
     std::unordered_map<TableId, PageNum> tableIdToDictPage_;  // 表ID到数据字典页面的映射
+    std::unordered_set<TableId> dirtyTables_;                 // 统计已变化、待检查点写回的表
+    std::unordered_map<TableId, TableStats> tableStats_;      // 列统计信息（ANALYZE生成，仅内存）
+    std::unordered_map<TableId, TableBlooms> tableBlooms_;    // Bloom过滤器（按需构建，仅内存）
+    std::unordered_map<TableId, RowLayout> rowLayouts_;       // 行布局缓存
+    std::unordered_map<TableId, PaxLayout> paxLayouts_;       // PAX页布局缓存
+    std::unordered_map<TableId, FixedLayout> fixedLayouts_;   // 定长页布局缓存
+
+    // 内部：登记/移除内存中的表与索引（同时维护名称索引与表的索引列表；调用方持有catalogMutex_的写锁）
+    void addTableEntry(const TableInfo &table);
+    void addIndexEntry(const IndexInfo &info);
+    void removeIndexEntry(TableId indexId);
+    // 内部：写时复制地改写表信息，ddl为真时新目录项的version递增
+    void replaceTableEntry(std::shared_ptr<TableEntry> &slot, const TableInfo &info, bool ddl);
+
+    // 内部：检查字典类文件的魔数与格式版本（旧版本文件的布局不同，不能按当前结构读取）
+    RC checkFormatVersion(TableId fileId);
 
     // 内部：将表信息写入数据字典缓存
     RC writeToDictCache(const TableInfo &table);
 
-    // 内部：追加写入索引元数据记录
+    // 内部：为新索引分配元数据槽并写入（优先复用空闲槽）
     RC appendIndexMeta(const IndexInfo& info);
+
+    // 内部：改写索引元数据槽（info为nullptr时清零）
+    RC writeIndexMetaSlot(BlockNum block, int offset, const IndexInfo* info);
+
+    // 内部：重建索引元数据文件，只保留各索引的当前版本
+    RC compactIndexMeta(const std::vector<IndexInfo>& live);
+
+    // 内部：原地改写表在字典页中的记录（table为nullptr时清除该记录）
+    RC rewriteDictEntry(TableId tableId, const TableInfo* table);
+
+    // 内部：清除索引的元数据槽并归还空闲槽
+    RC eraseIndexMeta(TableId indexId);
 };
 
 #endif  // DATA_DICT_H
@@ -5,12 +5,17 @@
 #include <string>
 #include <fstream>
 #include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 
 
 // 表文件头（每个表文件的第一个块）
 struct TableFileHeader {
-    int totalBlocks;  // 该表文件总块数
-    int usedBlocks;   // 已使用块数
+    int totalBlocks;    // 该表文件总块数
+    int usedBlocks;     // 已使用块数
+    int magic;          // 文件魔数（DB_FILE_MAGIC）
+    int formatVersion;  // 创建文件时的磁盘格式版本（DB_FORMAT_VERSION）
 };
 
 // 磁盘管理器类（一个表一个文件）
@@ -49,6 +54,18 @@ public:
      */
     RC closeTableFile(TableId tableId);
 
+    /**
+     * 删除表文件（文件不存在时视为成功）
+     * @param tableId 表ID
+     */
+    RC removeTableFile(TableId tableId);
+
+    /**
+     * 将表文件重置为新建状态（删除后重新创建）
+     * @param tableId 表ID
+     */
+    RC truncateTableFile(TableId tableId);
+
     /**
      * 为表分配新块
      * @param tableId 表ID
@@ -79,6 +96,13 @@ public:
      */
     RC writeBlock(TableId tableId, BlockNum blockNum, const char* data);
 
+    /**
+     * 提示操作系统预读表的块（异步，不等待读完成；不支持的平台上为空操作）
+     * @param tableId 表ID
+     * @param blockNum 块号
+     */
+    RC prefetchBlock(TableId tableId, BlockNum blockNum);
+
     /**
      * 为新日志创建文件
      */
@@ -95,13 +119,15 @@ public:
             return "";
         } else if (tableId == INDEX_META_TABLE_ID) {
             return dbName_ + "_indexes.db"; // 独立的索引元数据文件
+        } else if (tableId <= TOAST_TABLE_ID_BASE) {
+            return dbName_ + std::to_string(TOAST_TABLE_ID_BASE - tableId) + "_toast.db"; // 表的溢出文件
         } else {
             return dbName_ + std::to_string(tableId) + ".db";
         }
     }
 
     /**
-     * 读取表文件头
+     * 读取表文件头（返回打开文件时缓存的文件头）
      * @param tableId 表ID
      * @param header 输出参数，文件头
      */
@@ -115,11 +141,55 @@ public:
     RC writeTableFileHeader(TableId tableId, const TableFileHeader& header);
 
 private:
+    // 已打开的表文件：文件流不是线程安全的，同一文件上的读写与文件头的读改写由该文件的互斥锁串行化，
+    // 不同文件之间的读写可以并行
+    struct OpenFile {
+        std::fstream stream;
+        TableFileHeader header{};  // 文件头缓存（打开时读入，写文件头时同步更新），读写块不必再读盘
+        int prefetchFd = -1;       // 预读提示用的只读描述符（仅Linux，打开文件时一并打开）
+        std::mutex mutex;
+    };
+
+    /**
+     * 取已打开的文件，未打开时先打开
+     * @param tableId 表ID
+     * @param lock 调用方持有的filesMutex_共享锁（打开文件时临时换成独占锁，返回时仍持有共享锁）
+     * @param file 输出参数，打开的文件（持有共享锁期间有效）
+     */
+    RC acquireFile(TableId tableId, std::shared_lock<std::shared_mutex> &lock, OpenFile *&file);
+
+    /**
+     * 打开文件并读入文件头（调用方持有filesMutex_独占锁）
+     * @param tableId 表ID
+     */
+    RC openFileLocked(TableId tableId);
+
+    /**
+     * 关闭文件（调用方持有filesMutex_独占锁）
+     * @param tableId 表ID
+     */
+    RC closeFileLocked(TableId tableId);
+
+    /**
+     * 新建文件并写入初始文件头（调用方持有filesMutex_独占锁）
+     * @param filePath 文件路径
+     */
+    RC createFileLocked(const std::string &filePath);
+
+    /**
+     * 写入文件头并更新缓存（调用方持有该文件的互斥锁）
+     * @param file 打开的文件
+     * @param header 文件头
+     */
+    RC writeHeaderLocked(OpenFile &file, const TableFileHeader &header);
+
     size_t diskSize_;          // 磁盘大小
     std::string dbName_;       // 数据库名称
     int totalBlocks_;          // 总块数
-    // 表ID到文件流的映射（仅打开的文件）
-    std::unordered_map<TableId, std::fstream> tableFiles_;
+    // 表ID到打开文件的映射（仅打开的文件）
+    std::unordered_map<TableId, std::unique_ptr<OpenFile>> tableFiles_;
+    // 保护映射本身：读写块持共享锁（期间文件不会被关闭），打开/关闭/创建/删除文件持独占锁
+    std::shared_mutex filesMutex_;
 };
 
 #endif  // DISK_MANAGER_H
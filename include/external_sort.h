@@ -0,0 +1,94 @@
+#ifndef NPCBASE_EXTERNAL_SORT_H
+#define NPCBASE_EXTERNAL_SORT_H
+
+#include "npcbase.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+#define SORT_MERGE_MIN_CHUNK (64 * 1024)   // 归并时每个有序段的最小读缓冲
+
+// 定长记录外部归并排序：记录按整条memcmp排序。
+// 内存缓冲区写满时在内存中排序，作为一个有序段（run）追加到临时文件；
+// finish后若产生过有序段则多路归并输出，否则直接输出内存中的有序结果。
+class ExternalSorter {
+public:
+    /**
+     * @param recordLen 记录长度
+     * @param memBudget 排序缓冲区字节数
+     * @param tempPath 临时文件路径（仅在数据超出缓冲区时创建，析构时删除）
+     */
+    ExternalSorter(int recordLen, size_t memBudget, const std::string &tempPath);
+    ~ExternalSorter();
+
+    ExternalSorter(const ExternalSorter &) = delete;
+    ExternalSorter &operator=(const ExternalSorter &) = delete;
+
+    /**
+     * 加入一条记录
+     * @param record 记录（recordLen字节）
+     */
+    RC add(const char *record);
+
+    /**
+     * 结束输入，准备按序输出
+     */
+    RC finish();
+
+    /**
+     * 按序取下一条记录
+     * @param record 输出参数，记录指针（在下一次调用前有效）
+     * @return 已无记录时返回false
+     */
+    bool next(const char *&record);
+
+    /**
+     * 已加入的记录数
+     */
+    int64_t count() const { return count_; }
+
+    /**
+     * 写出的有序段数（0表示完全在内存中排序）
+     */
+    int runCount() const { return (int)runs_.size(); }
+
+    /**
+     * 归并过程中的读错误（next提前返回false时由调用方检查）
+     */
+    RC status() const { return status_; }
+
+private:
+    // 有序段读取状态
+    struct RunCursor {
+        int64_t offset;            // 下一块在临时文件中的偏移
+        int64_t remaining;         // 段内尚未读入缓冲的记录数
+        std::vector<char> buffer;  // 读缓冲
+        int bufferCount = 0;       // 缓冲中的记录数
+        int pos = 0;               // 缓冲中的当前记录
+    };
+
+    RC sortBuffer();
+    RC spillRun();
+    RC fillCursor(RunCursor &cursor);
+    const char *cursorRecord(const RunCursor &cursor) const { return cursor.buffer.data() + (size_t)cursor.pos * recordLen_; }
+
+    int recordLen_;
+    size_t capacity_;                      // 缓冲区可容纳的记录数
+    std::string tempPath_;
+    std::fstream file_;
+    int64_t count_ = 0;
+
+    std::vector<char> buffer_;             // 内存缓冲
+    std::vector<uint32_t> order_;          // 缓冲内记录的排序结果（记录序号）
+    size_t buffered_ = 0;                  // 缓冲中的记录数
+    size_t emitPos_ = 0;                   // 内存输出位置
+
+    std::vector<std::pair<int64_t, int64_t>> runs_;  // 各有序段 (文件偏移, 记录数)
+    std::vector<RunCursor> cursors_;
+    std::vector<int> heap_;                // 归并堆（按当前记录的最小堆，元素为段号）
+    int lastRun_ = -1;                     // 上一次输出记录所在的段（下次取记录前再前进）
+    bool merging_ = false;
+    RC status_ = RC_OK;
+};
+
+#endif // NPCBASE_EXTERNAL_SORT_H
@@ -0,0 +1,70 @@
+#ifndef HASH_INDEX_H
+#define HASH_INDEX_H
+
+#include "npcbase.h"
+#include "index_node.h"
+#include <cstdint>
+
+// 哈希索引（可扩展哈希）的页格式，与B+树索引一样存放在索引自己的文件中
+//   元页（即IndexInfo.rootPage）：页头 + 各目录页的页号
+//   目录页：桶页号数组，共2^globalDepth项分布在各目录页中，下标为键哈希值的低globalDepth位
+//   桶页：页头 + 定长项（键 + RID(8字节) + 负载，与B+树叶子项相同），相同键必在同一桶中
+// 桶放不下时按哈希值的第localDepth位一分为二（localDepth达到globalDepth时先将目录加倍）；
+// 各项哈希值相同（重复键）或目录已达上限时无法靠分裂腾出空间，改为在桶后挂溢出页
+// 删除只移走项，不合并桶也不收缩目录
+
+struct HashMetaHeader {
+    uint8_t nodeType;     // IndexNodeType::HASH_META
+    int32_t pageNum;      // 页号
+    int32_t globalDepth;  // 全局深度
+    int32_t dirPageCount; // 目录页数
+    int32_t bucketCount;  // 桶数（不含溢出页）
+};
+
+struct HashBucketHeader {
+    uint8_t nodeType;      // IndexNodeType::HASH_BUCKET
+    int32_t pageNum;       // 页号
+    int32_t localDepth;    // 局部深度（溢出页与所属桶相同）
+    uint32_t hashBits;     // 本桶各键哈希值的低localDepth位
+    int32_t count;         // 本页项数
+    int32_t overflowPage;  // 下一个溢出页，-1表示链尾
+};
+
+#define HASH_DIR_PER_PAGE (BLOCK_SIZE / 4)                                          // 每个目录页的桶页号数
+#define HASH_MAX_DIR_PAGES ((BLOCK_SIZE - (int)sizeof(HashMetaHeader)) / 4)           // 元页能记下的目录页数
+#define HASH_MAX_GLOBAL_DEPTH 19                                                     // 目录最多2^19项
+static_assert((1 << HASH_MAX_GLOBAL_DEPTH) / HASH_DIR_PER_PAGE <= HASH_MAX_DIR_PAGES, "hash directory too large");
+
+/**
+ * 键的哈希值（对保序编码后的完整键字节计算）
+ * @param key 键
+ * @param keyLen 键长度
+ */
+uint32_t hashIndexKey(const char* key, int keyLen);
+
+/**
+ * 哈希值的低depth位
+ */
+inline uint32_t hashLowBits(uint32_t hash, int depth) { return depth == 0 ? 0 : hash & ((1u << depth) - 1); }
+
+/**
+ * 元页中第i个目录页的页号字段
+ */
+inline char* hashDirPageSlot(char* meta, int i) { return meta + sizeof(HashMetaHeader) + i * 4; }
+inline const char* hashDirPageSlot(const char* meta, int i) { return meta + sizeof(HashMetaHeader) + i * 4; }
+
+/**
+ * 每个桶页的项数
+ * @param entryLen 项长（键 + RID + 负载）
+ */
+inline int hashBucketCapacity(int entryLen) { return (BLOCK_SIZE - (int)sizeof(HashBucketHeader)) / entryLen; }
+
+/**
+ * 桶页中第pos项的起始地址
+ */
+inline char* hashBucketEntry(char* page, int entryLen, int pos) { return page + sizeof(HashBucketHeader) + pos * entryLen; }
+inline const char* hashBucketEntry(const char* page, int entryLen, int pos) {
+    return page + sizeof(HashBucketHeader) + pos * entryLen;
+}
+
+#endif // HASH_INDEX_H
@@ -6,42 +6,178 @@
 #include "mem_manager.h"
 #include "disk_manager.h"
 #include "log_manager.h"
+#include "index_node.h"
+#include "hash_index.h"
+#include "art_cache.h"
+#include <cstring>
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <memory>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
 
-// 节点类型
-enum class IndexNodeType : uint8_t { LEAF = 1, INTERNAL = 2 };
-
-// 索引页头（固定32字节）
-struct IndexPageHeader {
-    uint8_t nodeType;     // 1字节：叶子/内部
-    int32_t pageNum;      // 4字节：页号
-    int32_t prevPage;     // 4字节：前驱页（叶子链）
-    int32_t nextPage;     // 4字节：后继页（叶子链）
-    int16_t keyCount;     // 2字节：当前键数量
-    int16_t maxKeys;      // 2字节：最大键数量
-    int32_t parentPage;   // 4字节：父节点页号
-    int32_t leftMostChild;// 4字节：内部节点用，最左孩子页号；叶子为-1
-    uint8_t reserved[7];  // 填充到32字节
-};
+// 复合/覆盖索引叶子项的负载：空值位图（第i位为第i个键列，其后依次为各INCLUDE列）+ 各INCLUDE列的保序编码
+// 非首键列为空时键中该列编码为全0，由位图区分；首键列为空的行不入索引
+#define INDEX_NULL_BITMAP_LEN 1
+static_assert(MAX_INDEX_COLUMNS + MAX_INDEX_INCLUDE <= INDEX_NULL_BITMAP_LEN * 8, "null bitmap too small");
+
+#define INDEX_BUILD_FILL_PCT 90                  // 批量建索引时节点的默认填充率（百分比，50~100）
+#define INDEX_BUILD_SORT_MEM (16 * 1024 * 1024)  // 批量建索引的排序缓冲区，超出时外部归并排序
 
-// 将任意键值抽象为定长字节数组
+// 将任意键值抽象为定长字节数组（内联存放，构造与拷贝不分配堆内存）
 struct KeyBytes {
-    std::vector<char> bytes; // 长度等于keyLen
+    int len = 0;                       // 键长度
+    char bytes[MAX_INDEX_KEY_LEN];     // 前len字节有效
 
     KeyBytes() = default;
-    explicit KeyBytes(size_t len) : bytes(len, 0) {}
+    explicit KeyBytes(int keyLen) : len(keyLen) { std::memset(bytes, 0, keyLen); }
+
+    char* data() { return bytes; }
+    const char* data() const { return bytes; }
+    int size() const { return len; }
 
     int compare(const KeyBytes& other) const {
-        size_t n = std::min(bytes.size(), other.bytes.size());
-        int c = std::memcmp(bytes.data(), other.bytes.data(), n);
+        int n = std::min(len, other.len);
+        int c = std::memcmp(bytes, other.bytes, n);
         if (c != 0) return c;
-        if (bytes.size() == other.bytes.size()) return 0;
-        return bytes.size() < other.bytes.size() ? -1 : 1;
+        if (len == other.len) return 0;
+        return len < other.len ? -1 : 1;
     }
 };
 
-// 叶子项：key + RID(8字节：4字节页号 + 4字节槽)
+// 保序键编码：编码后按memcmp比较即与列值顺序一致
+//   INT：符号位取反后按大端序存放
+//   FLOAT：IEEE位模式，非负数翻转符号位、负数按位取反，再按大端序存放（-0规整为+0）
+//   STRING：字符原样存放、不足补0，末尾KEY_STRING_LEN_BYTES字节大端长度（"ab"排在"ab\0"之前）
+#define KEY_STRING_LEN_BYTES 2
+
+/**
+ * 计算列的索引键长度
+ * @param type 列类型
+ * @param attrLength 列最大长度
+ */
+int indexKeyLength(AttrType type, int attrLength);
+
+/**
+ * 将列数据编码为保序键
+ * @param type 列类型
+ * @param data 列数据（INT/FLOAT为row_codec中的4字节值，STRING为字符）
+ * @param len 列数据长度
+ * @param keyLen 键长度
+ * @param out 输出缓冲区（keyLen字节）
+ */
+void encodeIndexKey(AttrType type, const char* data, int len, int keyLen, char* out);
+
+/**
+ * 将列值编码为保序键（用于按字面量查找）
+ * @param value 列值（非空）
+ * @param keyLen 键长度
+ * @param key 输出参数，编码后的键
+ */
+void encodeValueKey(const Value& value, int keyLen, KeyBytes& key);
+
+/**
+ * 将保序键解码为列值（用于展示）
+ * @param type 列类型
+ * @param key 键
+ * @param keyLen 键长度
+ * @param value 输出参数，列值
+ */
+void decodeIndexKey(AttrType type, const char* key, int keyLen, Value& value);
+
+/**
+ * 叶子项长度：键 + RID(8字节) + 负载
+ * @param info 索引信息
+ */
+inline int indexLeafEntryLen(const IndexInfo& info) { return info.keyLen + 8 + info.payloadLen; }
+
+/**
+ * 索引是否以posting列表存放重复键（非唯一且叶子项无负载；覆盖索引每行的INCLUDE值不同，仍逐行存放）
+ * 只有重复较多的键（约占半个叶子以上）才转为posting列表，其余仍逐行存放
+ * @param info 索引信息
+ */
+inline bool indexUsesPostings(const IndexInfo& info) { return !info.unique && info.payloadLen == 0; }
+
+/**
+ * 键中是否有空值列（非首键列为空时编码为全0，可能与INT_MIN、空串等非空值的编码相同）
+ * 唯一索引只约束各键列都非空的项：含空值的项之间、与其他项之间都不冲突
+ * @param info 索引信息
+ * @param payload 叶子项的负载（空值位图在最前）
+ */
+inline bool indexKeyHasNull(const IndexInfo& info, const char* payload) {
+    if (info.payloadLen == 0) return false;
+    return (payload[0] & (char)((1 << info.keyColumnCount) - 1)) != 0;
+}
+
+/**
+ * 第i个键列的列引用（列序号与其上的表达式）
+ * @param info 索引信息
+ * @param i 键列位置
+ */
+inline ColumnRef indexKeyRef(const IndexInfo& info, int i) {
+    ColumnRef ref;
+    ref.column = info.keyColumns[i];
+    ref.expr = (ColumnExpr)info.keyExprs[i];
+    ref.arg = info.keyExprArgs[i];
+    return ref;
+}
+
+/**
+ * 第i个键列在键中的编码长度（表达式为前缀时按前缀长度）
+ * @param table 表信息
+ * @param info 索引信息
+ * @param i 键列位置
+ */
+int indexKeyPartLength(const TableInfo& table, const IndexInfo& info, int i);
+
+/**
+ * 从键中解码第i个键列的值（键列为表达式时得到表达式的值）
+ * @param table 表信息
+ * @param info 索引信息
+ * @param key 键（keyLen字节）
+ * @param payload 叶子负载，用于区分空值；为nullptr时不区分
+ * @param i 键列位置
+ * @param value 输出参数，列值
+ */
+void decodeIndexKeyPart(const TableInfo& table, const IndexInfo& info, const char* key, const char* payload, int i, Value& value);
+
+/**
+ * 索引是否含有某列（键列或INCLUDE列），含有时可直接从索引项取值而无需回表
+ * 以表达式出现的键列不算含有该列
+ * @param info 索引信息
+ * @param col 表列序号
+ */
+bool indexCoversColumn(const IndexInfo& info, int col);
+
+/**
+ * 从索引项解码表列的值
+ * @param table 表信息
+ * @param info 索引信息
+ * @param key 键（keyLen字节）
+ * @param payload 叶子负载；为nullptr时（如内部节点的分隔键）只能解码键列，且不区分空值
+ * @param col 表列序号
+ * @param value 输出参数，列值
+ * @return 列不在索引中时返回false
+ */
+bool decodeIndexColumn(const TableInfo& table, const IndexInfo& info, const char* key, const char* payload, int col, Value& value);
+
+// 部分索引的谓词项（列名 op 字面量，op为 = != < <= > >=），各项AND
+struct IndexCondition {
+    std::string column;
+    std::string op;
+    std::string literal;
+};
+
+// 批量维护索引的一行：行数据与其RID
+struct RowChange {
+    std::string data;
+    RID rid;
+};
+
+// 叶子项：key + RID(8字节：4字节页号 + 4字节槽) + 负载(payloadLen字节)
 struct LeafEntry {
     KeyBytes key;
     int32_t ridPage; // RID.pageNum
@@ -55,64 +191,404 @@ struct InternalEntry {
     int32_t pad;       // 保留
 };
 
+// 索引扫描方向
+enum class ScanDirection { FORWARD, BACKWARD };
+
+class IndexManager;
+
+// 索引扫描迭代器：沿叶子链按键序（或逆序）产出范围内的RID
+// 每次进入叶子时将其拷贝到迭代器内（按页闩版本校验拷贝一致），不持有缓冲帧也不加锁，
+// 扫描期间允许其他线程修改索引（已拷贝的叶子不反映修改）
+// 哈希索引只支持给出完整键的等值扫描：打开时一次取出桶中键相同的各项，按RID序产出；
+// 有ART镜像的B+树索引的完整键等值扫描在镜像命中时同样一次取出
+class IndexScan {
+public:
+    IndexScan() = default;
+    IndexScan(const IndexScan&) = delete;
+    IndexScan& operator=(const IndexScan&) = delete;
+
+    /**
+     * 取下一条索引项
+     * @param rid 输出参数，记录ID
+     * @return 扫描结束或出错时返回false（由status区分）
+     */
+    bool next(RID& rid);
+
+    /**
+     * 最近一次next返回项的键（保序编码，keyLength字节）
+     */
+    const char* key() const { return lastKey_; }
+    int keyLength() const { return keyLen_; }
+
+    /**
+     * 最近一次next返回项的叶子负载（空值位图 + INCLUDE列，配合decodeIndexColumn使用）
+     */
+    const char* payload() const { return lastTail_ ? lastTail_ + 8 : nullptr; }
+
+    /**
+     * 读叶子时的错误
+     */
+    RC status() const { return status_; }
+
+    /**
+     * 结束扫描
+     */
+    void close() { done_ = true; }
+
+private:
+    friend class IndexManager;
+
+    // 沿叶子链从from移到to；from已不是拷贝时的版本时stale为true，须重新定位
+    RC moveToLeaf(PageNum from, PageNum to, bool& stale);
+    // 拷贝已固定的叶子，拷贝后其版本号仍为version时成功
+    bool copyLeaf(const BufferFrame* frame, uint64_t version);
+    // 下降到key所在叶子并定位（upper为true时越过相同键；key为nullptr时定位到扫描方向的起始端）
+    RC seek(const char* key, bool upper);
+    bool beforeStart(const char* key) const;
+    bool pastEnd(const char* key) const;
+
+    IndexManager* mgr_ = nullptr;
+    IndexRef index_;
+    int keyLen_ = 0;
+    int tailLen_ = 0;              // 叶子项尾：RID + 负载
+    NodeFormat fmt_;               // 当前叶子的页内键格式
+    KeyBytes low_, high_;
+    KeyBytes start_;               // 补齐到键长的起始边界
+    bool hasStart_ = false, startUpper_ = false;
+    uint64_t leafVersion_ = 0;     // 拷贝时叶子的版本号
+    KeyBytes runKey_;              // 最后看过的键
+    std::vector<uint64_t> runIds_; // 该键已产出的项（RID编号，posting项为其项尾）
+    bool examined_ = false;        // runKey_是否有效
+    bool resumed_ = false;         // 重新定位后仍在runKey_的相同项中
+    bool hasLow_ = false, hasHigh_ = false;
+    bool lowInclusive_ = true, highInclusive_ = true;
+    ScanDirection direction_ = ScanDirection::FORWARD;
+    bool prefetch_ = false;
+    bool done_ = true;
+    RC status_ = RC_OK;
+    int pos_ = 0;                  // 当前叶子内的下一项
+    const char* lastKey_ = nullptr;
+    const char* lastTail_ = nullptr;
+    std::vector<uint64_t> postings_;   // 当前键的posting列表（RID编号）
+    size_t postingPos_ = 0;            // 已产出的个数
+    char keyBuf_[MAX_INDEX_KEY_LEN];   // 还原的当前项完整键
+    char leaf_[BLOCK_SIZE];        // 当前叶子的拷贝
+    bool point_ = false;           // 一次取出各项的等值扫描（哈希索引或ART镜像命中）
+    std::vector<char> pointEntries_;   // 取出的各项（键 + 项尾）
+    size_t pointPos_ = 0;              // 已产出的项数
+};
+
 // 索引管理器
+// 并发：B+树的读写可由多个线程同时进行（建/删索引等DDL除外），采用乐观锁耦合：
+//   读者（查找、扫描、唯一性探测）不加锁，自根下降时逐页取版本号、读完校验，页被修改则自根重试；
+//   插入/删除只对要修改的叶子加写锁，叶子放得下（不下溢）时就地完成；
+//   需要分裂、合并、借位或转为posting列表时，在该索引的结构修改互斥锁下重新下降，
+//   期间经readPage取到的页一律加写锁直到本次结构修改结束，读者遇到这些页时等待或重试；
+//   根页号的变化由索引的根版本锁保护；posting链由其所在叶子的写锁串行修改，各posting页另有页闩供读者校验
 class IndexManager {
 public:
     IndexManager(DataDict& dataDict, DiskManager& diskManager, MemManager& memManager, LogManager& logManager);
     ~IndexManager() = default;
 
-    // 创建索引：构建B+树并持久化
-    RC createIndex(TransactionId txId, const char* indexName, const char* tableName, const char* columnName, bool unique = false);
+    // 创建索引：扫描表并排序(键, RID)，自底向上批量构建B+树并持久化
+    // fillPct为叶子与内部节点的填充率（百分比），预留的空间供后续插入，减少分裂
+    RC createIndex(TransactionId txId, const char* indexName, const char* tableName, const char* columnName, bool unique = false,
+                   int fillPct = INDEX_BUILD_FILL_PCT);
+
+    // 创建复合/覆盖索引：键为keyColumns各列保序编码的拼接，includeColumns的值只存于叶子项，
+    // 查询所需的列都在索引中时可只读索引、不回表
+    // method为HASH时建可扩展哈希索引（fillPct不适用），只服务于给出全部键列的等值查找
+    // 键列可以是列上的表达式（lower(列)、substr(列, 1, n)），键为表达式的值；
+    // where非空时为部分索引：只有满足全部谓词的行入索引（唯一性也只在这些行之间检查）
+    RC createIndex(TransactionId txId, const char* indexName, const char* tableName, const std::vector<std::string>& keyColumns,
+                   const std::vector<std::string>& includeColumns, bool unique = false, int fillPct = INDEX_BUILD_FILL_PCT,
+                   IndexMethod method = IndexMethod::BTREE, const std::vector<IndexCondition>& where = {});
+
+    // 重置为空索引：在（已截断的）索引文件中分配空的根叶子（哈希索引为元页、目录页与一个空桶）并更新元数据
+    RC resetIndex(IndexInfo& info);
 
     // 显示索引文件内容
     RC showIndex(const char* indexName);
 
-    // 由表管理器回调：插入/删除记录时维护索引
+    /**
+     * 开启/关闭B+树索引的内存ART镜像（记入IndexInfo.cached）：开启时自叶子构建，之后随记录插入/删除同步，
+     * 完整键的等值扫描与唯一性检查先查镜像，命中时不访问缓冲池，未命中时仍查B+树
+     * 重启后在首次点查时重新构建
+     * @param indexName 索引名
+     * @param enabled 是否开启
+     * @return 哈希索引返回RC_INVALID_ARG
+     */
+    RC setIndexCache(const char* indexName, bool enabled);
+
+    /**
+     * 丢弃索引的ART镜像（删表时调用；镜像仍开启时下次点查重新构建）
+     * @param indexId 索引ID
+     */
+    void dropCache(TableId indexId);
+
+    /**
+     * 设置批量建索引的排序缓冲区大小（默认INDEX_BUILD_SORT_MEM），超出时外部归并排序
+     * @param bytes 缓冲区字节数
+     */
+    void setBuildSortMemory(size_t bytes) { buildSortMem_ = bytes; }
+
+    /**
+     * 打开索引范围扫描：下降到范围起点所在叶子，之后沿叶子链逐项产出
+     * 边界可以短于键长，此时按键前缀比较（复合索引只给出前几列时使用）
+     * 哈希索引的上下界须为相同的完整键且均包含，否则返回RC_INVALID_ARG
+     * @param indexName 索引名
+     * @param low 下界（保序编码键），nullptr表示无下界
+     * @param lowInclusive 下界是否包含
+     * @param high 上界（保序编码键），nullptr表示无上界
+     * @param highInclusive 上界是否包含
+     * @param direction 扫描方向（BACKWARD时从上界向下界）
+     * @param scan 输出参数，扫描迭代器
+     * @param prefetch 进入叶子时提示磁盘预读扫描方向上的下一个叶子
+     */
+    RC openScan(const char* indexName, const KeyBytes* low, bool lowInclusive, const KeyBytes* high, bool highInclusive,
+                ScanDirection direction, IndexScan& scan, bool prefetch = false);
+
+    /**
+     * 插入记录前检查表上各唯一索引，键已存在时返回RC_DUPLICATE_KEY
+     * @param table 表信息
+     * @param data 行数据
+     * @param len 行长度
+     */
+    RC checkUnique(const TableInfo& table, const char* data, int len);
+
+    /**
+     * 批量插入前检查表上各唯一索引：键已存在或批内两行键相同时返回RC_DUPLICATE_KEY
+     * @param table 表信息
+     * @param rows 待插入的行（rid不使用）
+     */
+    RC checkUnique(const TableInfo& table, const std::vector<RowChange>& rows);
+
+    // 由表管理器回调：插入/删除记录时维护索引（插入遇到唯一性冲突等错误时返回，由调用方撤销该行）
     RC onRecordInserted(const TableInfo& table, const char* data, int len, const RID& rid);
     RC onRecordDeleted(const TableInfo& table, const char* data, int len, const RID& rid);
 
+    // 多行DML的批量维护：每个B+树索引的键按(键, RID)排序后自左向右一趟写入，
+    // 连续落在同一叶子上的键共用一次下降与叶子写锁（哈希索引逐项处理）；
+    // 某项失败时其余各项与其余索引仍照常维护，返回第一个错误码
+    RC onRecordsInserted(const TableInfo& table, const std::vector<RowChange>& rows);
+    RC onRecordsDeleted(const TableInfo& table, const std::vector<RowChange>& rows);
+
 private:
+    friend class IndexScan;
+
     DataDict& dataDict_;
     DiskManager& diskManager_;
     MemManager& memManager_;
     LogManager& logManager_;
+    std::atomic<size_t> buildSortMem_{INDEX_BUILD_SORT_MEM};  // 批量建索引的排序缓冲区字节数
+
+    // 索引的并发控制状态：根页号的版本锁、当前根页与树高、结构修改互斥锁
+    // 根页与树高以这里为准（换根时在根版本锁下更新），下降与结构修改每次操作读一次，不读句柄中的IndexInfo
+    struct IndexLatch {
+        PageLatch root;
+        std::atomic<PageNum> rootPage{-1};
+        std::atomic<int> height{0};
+        std::mutex smo;
+    };
+    std::mutex latchesMutex_;
+    std::unordered_map<TableId, std::unique_ptr<IndexLatch>> latches_;
+    std::mutex dictMutex_;  // 换根时写数据字典（不同索引的结构修改可能同时换根）
+    // 取索引的并发控制状态，首次使用时从数据字典读入当前根页与树高
+    IndexLatch& latchFor(TableId indexId);
+    // 结构修改换根：在根版本锁下改写数据字典中的根页与树高（其余字段取字典中的当前值）
+    RC updateRoot(TableId indexId, PageNum rootPage, int height);
+    // 建索引/重置索引时写入整份索引信息，同时更新当前根页与树高
+    RC publishIndexInfo(const IndexInfo& info);
+
+    // 在叶子中插入一项的结果：完成、叶子已满需分裂、需在结构修改互斥下处理（跨叶子的重复键或转为posting列表）
+    enum class LeafInsert { DONE, FULL, SLOW };
+
+    // ART镜像：cachesMutex_保护登记表，镜像本身由其读写锁保护（点查共享，构建与同步独占）
+    // 构建者在登记表锁下登记镜像并取得写锁，再自叶子链扫描构建；记录的插入/删除先改B+树，
+    // 再取写锁同步已登记的镜像（按RID幂等）：登记前完成的修改已在扫描中，登记后的修改在构建完成后补上
+    struct IndexCache {
+        std::shared_mutex mutex;
+        ArtCache art;
+        IndexCache(int keyLen, int tailLen) : art(keyLen, tailLen) {}
+    };
+    std::mutex cachesMutex_;
+    std::unordered_map<TableId, std::shared_ptr<IndexCache>> caches_;
+    std::atomic<size_t> cacheCount_{0};  // caches_中的镜像数（同步镜像时无镜像则不取登记表锁）
+    // 取索引已登记的镜像；未登记且build为true时构建（索引须已开启镜像）；
+    // build为false时只查登记表：同步镜像以登记表为准，不依赖调用方句柄中可能已过期的cached
+    std::shared_ptr<IndexCache> cacheFor(const IndexInfo& info, bool build);
+    RC buildCache(const IndexInfo& info, ArtCache& art);
+    // 查镜像：命中时将键等于key的各项（键 + 项尾）追加到out
+    bool cacheLookup(const IndexInfo& info, const KeyBytes& key, std::vector<char>& out, bool first = false);
+    // 记录插入/删除后同步镜像
+    void cacheApply(const IndexInfo& info, const KeyBytes& key, const RID& rid, const char* payload, bool insert);
+
+    // 批量维护中一个索引的一项：键、RID，以及项尾（RID + 负载）在项尾缓冲中的起点
+    struct BatchEntry {
+        KeyBytes key;
+        RID rid;
+        size_t tail;
+    };
+    // 取出各行在该索引上的项（不入索引的行跳过），按(键, RID)排序
+    void collectBatch(const TableInfo& table, const IndexInfo& info, const std::vector<RowChange>& rows,
+                      std::vector<BatchEntry>& entries, std::vector<char>& tails);
+    /**
+     * 有序批量插入：每次下降取得叶子的上界，小于上界的后续项在同一叶子上继续插入，
+     * 叶子放不下或需跨叶子处理的项单独在结构修改中完成，之后重新下降
+     * @param applied 输出参数，各项是否已插入（用于同步ART镜像）
+     */
+    RC insertBatch(TableId indexId, const IndexInfo& info, const std::vector<BatchEntry>& entries, const std::vector<char>& tails,
+                   std::vector<char>& applied);
+    // 有序批量删除：后续项的键不超过叶子末键时在同一叶子上继续删除，下溢的叶子离开后重平衡一次；
+    // 项不在该叶子（相同键跨叶子）或会删空叶子时单独走逐项删除；applied输出各项是否已删除（用于同步ART镜像）
+    RC deleteBatch(TableId indexId, const IndexInfo& info, const std::vector<BatchEntry>& entries, std::vector<char>& applied);
+    /**
+     * 批量删除后叶子下溢：持结构修改互斥锁自根重新定位并重平衡一次
+     * 叶子此间已被其他结构修改改动时不处理（下溢只影响空间利用，不影响正确性）
+     * @param key 叶子中的首键（用于重新定位）
+     */
+    RC rebalanceLeaf(TableId indexId, const IndexInfo& info, PageNum leafPage, const KeyBytes& key);
+    // 唯一性检查的单键探查（ART镜像、哈希桶或B+树叶子）：只找键中没有空值列的相同键项
+    RC keyExists(const IndexInfo& info, const KeyBytes& key, bool& found);
 
     // 辅助：根据表/列提取键配置
     RC getKeyConfig(const char* tableName, const char* columnName, AttrType& type, int& keyLen);
 
-    // 辅助：将记录数据提取为KeyBytes（当前假设键位于记录起始处）
-    KeyBytes extractKey(const char* data, int len, AttrType type, int keyLen);
+    // 辅助：按行布局从记录中提取各键列（或其上的表达式）拼接为KeyBytes，并填写叶子负载（payloadLen字节）；
+    // 首键列为空或行不满足部分索引的谓词时返回false（不入索引）
+    bool extractKey(const TableInfo& table, const IndexInfo& info, const char* data, int len, KeyBytes& key, char* payload);
+    // extractKey读取的列：键列、INCLUDE列与部分索引的谓词列（建索引扫描表时只需读取这些列）
+    static std::vector<int> extractColumns(const IndexInfo& info);
+
+    // 批量构建：外部排序后自左向右写满叶子，再逐层构建内部节点（info须为resetIndex后的空索引）
+    RC bulkBuild(IndexInfo& info, const TableInfo& table, int fillPct);
 
-    // 页面操作
+    // 页面操作：readPage在结构修改期间对取到的页加写锁（见SmoLatches），pinPage只固定不加锁（乐观读与posting页用）
     RC initNewIndexRoot(TableId indexId, PageNum rootPage, int maxKeys, bool leaf);
     RC readPage(TableId indexId, PageNum pageNum, BufferFrame*& frame);
+    RC pinPage(TableId indexId, PageNum pageNum, BufferFrame*& frame);
     void releasePage(TableId indexId, PageNum pageNum);
 
     // B+树操作
-    RC insertKey(TableId indexId, const IndexInfo& info, const KeyBytes& key, const RID& rid);
+    RC insertKey(TableId indexId, const IndexInfo& info, const KeyBytes& key, const RID& rid, const char* payload);
     RC deleteKey(TableId indexId, const IndexInfo& info, const KeyBytes& key, const RID& rid);
-    RC splitLeafAndInsert(TableId indexId, const IndexInfo& info, BufferFrame* leafFrame, const KeyBytes& key, const RID& rid);
-    RC insertIntoParent(TableId indexId, const IndexInfo& info, PageNum left, const KeyBytes& upKey, PageNum right);
-    RC splitInternalAndInsert(TableId indexId, const IndexInfo& info, BufferFrame* internalFrame, const KeyBytes& upKey, PageNum right);
+    // 插入/删除不能只改一个叶子时：持结构修改互斥锁重新定位并完成（分裂、借位/合并）
+    RC insertInSmo(TableId indexId, const IndexInfo& info, const KeyBytes& key, const char* tail, const RID& rid);
+    RC deleteInSmo(TableId indexId, const IndexInfo& info, const KeyBytes& key, const RID& rid);
+    // 分裂只拆分已有项（分隔键取后缀截断的最短键），插入由insertKey在分裂后重新定位并重试
+    // 节点不记父页号，父节点由下降时记下的路径给出：path为自根到父节点的各祖先页号（根节点为空），
+    // 分裂只改写被分裂的节点、新节点与父节点，不回写移动的孩子
+    RC splitLeaf(TableId indexId, const IndexInfo& info, BufferFrame* leafFrame, std::vector<PageNum>& path);
+    /**
+     * 将(upKey, right)插到left之后；父节点放不下时先分裂父节点
+     * @param path 进入时为left的祖先路径，返回时为left（也即right）此时的祖先路径
+     */
+    RC insertIntoParent(TableId indexId, const IndexInfo& info, PageNum left, const KeyBytes& upKey, PageNum right,
+                        std::vector<PageNum>& path);
+    /**
+     * @param path 进入时为被分裂节点的祖先路径，返回时为分裂出的两半此时共同的祖先路径
+     * @param newPage 输出参数，分裂出的右半页号
+     */
+    RC splitInternal(TableId indexId, const IndexInfo& info, BufferFrame* internalFrame, std::vector<PageNum>& path, PageNum& newPage);
 
-    // 搜索定位叶子
-    RC findLeaf(TableId indexId, const IndexInfo& info, const KeyBytes& key, PageNum& leafPage, std::vector<PageNum>* path = nullptr);
+    // 定位key所在的叶子项：相同键可能落在分隔键两侧的叶子中，自可能含key的最左叶子起向右越过小于key的叶子
+    // 键中有空值列的相同键项跳过（见indexKeyHasNull）
+    // found为false时leafPage/pos为第一个大于key的项（仅供判断，乐观读，不加锁）
+    RC findKeyEntry(TableId indexId, const IndexInfo& info, const KeyBytes& key, PageNum& leafPage, int& pos, bool& found);
 
-    // 计算每页最大项数量
+    // 插入一项：先对目标叶子加写锁就地插入，不行时在结构修改互斥下分裂（或转为posting列表）后重试
+    RC insertEntry(TableId indexId, const IndexInfo& info, const KeyBytes& key, const char* tail, const RID& rid);
+    /**
+     * 在已加写锁的叶子中插入一项
+     * 唯一索引遇到相同键时rc为RC_DUPLICATE_KEY；posting索引中相同键已有posting列表时追加到列表，
+     * 行内的重复项达到postingThreshold时，smo为true则整体转为posting列表，否则返回SLOW
+     * @param smo 是否处于结构修改中（可以读写相邻叶子）
+     */
+    LeafInsert insertIntoLeaf(TableId indexId, const IndexInfo& info, BufferFrame* leafFrame, const KeyBytes& key, const char* tail,
+                              const RID& rid, bool smo, RC& rc);
+
+    // posting列表：相同键的行内重复项达到postingThreshold时整体转为posting列表、写入新链、追加/删除RID、读出整条链
+    // 转换在结构修改中进行：run为各叶子中相同键的项（自左向右，页已加写锁），第一项改为指向新链，其余删去
+    struct RunPart { BufferFrame* frame; int from, to; };
+    RC convertToPosting(TableId indexId, const IndexInfo& info, const std::vector<RunPart>& run, const RID& rid);
+    int postingThreshold(const IndexInfo& info) const { return std::max(2, calcLeafMaxKeys(info) / 2); }
+    RC writePostingChain(TableId indexId, const uint64_t* rids, int n, PageNum& head);
+    RC insertPosting(TableId indexId, PageNum head, uint64_t rid);
+    RC removePosting(TableId indexId, PageNum head, uint64_t rid, int& remaining, uint64_t& survivor);
+    RC readPostings(TableId indexId, PageNum head, std::vector<uint64_t>& out);
+    // 从已加写锁的叶子第pos项的posting列表中删除rid，只剩一个RID时改回行内存放
+    RC removeFromPosting(TableId indexId, BufferFrame* leafFrame, const NodeFormat& fmt, int pos, const RID& rid);
+    // 自head起找到应含rid的posting页（首RID不大于rid的最后一页），返回时该页已固定于frame；prev为其前驱页（无则为-1）
+    RC seekPostingPage(TableId indexId, PageNum head, uint64_t rid, PageNum& page, PageNum& prev, BufferFrame*& frame);
+
+    /**
+     * 乐观下降到叶子：逐页取版本号，读出孩子页号后校验父页未变，页被修改时自根重试
+     * 返回时叶子已固定于frame，version为读到的版本号（调用方读完后校验，或据此升级为写锁）
+     * @param key 为nullptr时沿最左（leftmost）或最右孩子下降到边界叶子
+     * @param leftmost 有key时：false定位key应插入的叶子（相同键之后），true定位可能含key的最左叶子
+     * @param fence 非空时输出叶子的上界（leftmost为false时，小于上界的键都定位到该叶子；len为0表示无上界）
+     */
+    RC descend(TableId indexId, const IndexInfo& info, const KeyBytes* key, bool leftmost, PageNum& leafPage, BufferFrame*& frame,
+               uint64_t& version, KeyBytes* fence = nullptr);
+
+    /**
+     * 结构修改中下降到叶子：内部节点只由结构修改改动，持有结构修改互斥锁时不必校验；返回时叶子未固定
+     * @param path 输出参数，叶子的祖先路径（自根起）
+     */
+    RC descendForSmo(TableId indexId, const IndexInfo& info, const KeyBytes& key, bool leftmost, PageNum& leafPage,
+                     std::vector<PageNum>& path);
+
+    /**
+     * 沿叶子链右移一页并相应更新祖先路径
+     * @param path 进入时为page的祖先路径，返回时为右邻叶子的祖先路径
+     * @param page 进入时为当前叶子，返回时为右邻叶子
+     */
+    RC stepRight(TableId indexId, const IndexInfo& info, std::vector<PageNum>& path, PageNum& page);
+
+    // 不压缩时每页的项数（内部节点；叶子项另带负载），记入页头maxKeys作为下溢阈值的基准
+    // 页内键压缩后实际容量按字节计算，可以超过此值
     int calcMaxKeys(int keyLen) const { return (int)((BLOCK_SIZE - sizeof(IndexPageHeader)) / (keyLen + 8)); }
+    int calcLeafMaxKeys(const IndexInfo& info) const { return (int)((BLOCK_SIZE - sizeof(IndexPageHeader)) / indexLeafEntryLen(info)); }
 
     // ===== 删除重平衡（借位/合并）辅助 =====
-    RC rebalanceAfterDelete(TableId indexId, const IndexInfo& info, PageNum leafPage);
-    int minKeysForNode(int maxKeys) const { return (maxKeys + 1) / 2; }
+    // path均为该节点的祖先路径（自根起，根节点为空）
+    RC rebalanceAfterDelete(TableId indexId, const IndexInfo& info, PageNum leafPage, const std::vector<PageNum>& path);
+    // 下溢阈值取下整：内部节点合并后共 2*minKeys 项（含下移的分隔键），不得超过maxKeys
+    int minKeysForNode(int maxKeys) const { return maxKeys / 2; }
     int32_t getChildAt(char* parentPageData, int keyLen, int childIndex) const;
     int findChildIndex(char* parentPageData, int keyLen, PageNum childPage) const;
-    RC updateParentKeyForRightChild(TableId indexId, BufferFrame* parentFrame, int keyLen, int keyPos, BufferFrame* rightChildFrame);
-    RC removeParentEntryAt(TableId indexId, const IndexInfo& info, BufferFrame* parentFrame, int removeKeyPos);
-    RC shrinkRootIfNeeded(TableId indexId, const IndexInfo& info, BufferFrame* rootFrame);
+    RC removeParentEntryAt(TableId indexId, const IndexInfo& info, BufferFrame* parentFrame, int removeKeyPos,
+                           const std::vector<PageNum>& path);
+    RC shrinkRootIfNeeded(TableId indexId, BufferFrame* rootFrame);
 
     // 内部节点删除后的重平衡（递归）
-    RC rebalanceInternalAfterDelete(TableId indexId, const IndexInfo& info, PageNum parentPage);
-    RC setChildrenParent(TableId indexId, const std::vector<PageNum>& children, PageNum newParent);
+    RC rebalanceInternalAfterDelete(TableId indexId, const IndexInfo& info, PageNum pageNum, const std::vector<PageNum>& path);
+
+    // ===== 哈希索引（页格式见hash_index.h）=====
+    // 并发：目录（元页与目录页）只在结构修改互斥锁下、持根版本锁时改写，查目录时乐观读并校验根版本；
+    //   桶页闩保护整条桶链（溢出页随所属桶一起读写），读者读完整条链后校验桶页版本；
+    //   桶页头记下本桶的哈希位，查到的桶已被分裂（哈希位不符）时重新查目录
+    RC resetHashIndex(IndexInfo& info);
+    // 建索引时逐行插入已有数据
+    RC buildHashIndex(IndexInfo& info, const TableInfo& table);
+    /**
+     * 按哈希值查目录得到桶页号
+     * @param bucket 输出参数，桶页号（读出后可能已被分裂，由调用方按桶页头的哈希位校验）
+     */
+    RC hashBucketFor(const IndexInfo& info, uint32_t hash, PageNum& bucket);
+    /**
+     * 取出键等于key的各项（键 + 项尾），追加到out
+     * @param first 只要第一项（唯一性检查）
+     */
+    RC hashProbe(const IndexInfo& info, const KeyBytes& key, std::vector<char>& out, bool first = false);
+    RC hashInsert(const IndexInfo& info, const KeyBytes& key, const RID& rid, const char* payload);
+    RC hashDelete(const IndexInfo& info, const KeyBytes& key, const RID& rid);
+    // 桶链已满：在结构修改互斥锁下分裂该桶（必要时目录加倍），无法分开时挂溢出页
+    RC hashGrow(const IndexInfo& info, uint32_t hash);
+    RC hashDoubleDirectory(const IndexInfo& info, BufferFrame* meta);
+    RC hashNewBucketPage(TableId indexId, int localDepth, uint32_t hashBits, PageNum& page, BufferFrame*& frame);
+    // keyString将项的键与负载格式化为各列值
+    RC showHashIndex(const IndexInfo& info, const std::function<std::string(const char*, const char*)>& keyString);
 };
 
 #endif // INDEX_MANAGER_H
@@ -0,0 +1,266 @@
+#ifndef INDEX_NODE_H
+#define INDEX_NODE_H
+
+#include "npcbase.h"
+#include <cstring>
+#include <vector>
+
+// 索引键最大长度（STRING列键长为列长+KEY_STRING_LEN_BYTES）
+#define MAX_INDEX_KEY_LEN 256
+
+// 节点类型（HASH_META/HASH_BUCKET为哈希索引的页，见hash_index.h）
+enum class IndexNodeType : uint8_t { LEAF = 1, INTERNAL = 2, POSTING = 3, HASH_META = 4, HASH_BUCKET = 5 };
+
+// 索引页头
+struct IndexPageHeader {
+    uint8_t nodeType;     // 1字节：叶子/内部
+    int32_t pageNum;      // 4字节：页号
+    int32_t prevPage;     // 4字节：前驱页（叶子链）
+    int32_t nextPage;     // 4字节：后继页（叶子链）
+    int16_t keyCount;     // 2字节：当前键数量
+    int16_t maxKeys;      // 2字节：不压缩时的最大键数量（下溢阈值按此计算）
+    int32_t leftMostChild;// 4字节：内部节点用，最左孩子页号；叶子为-1
+    int16_t prefixLen;    // 2字节：页内公共前缀长度
+    int16_t gapStart;     // 2字节：页内各键均为0的区段起点
+    int16_t gapLen;       // 2字节：该区段长度（0表示无）
+    uint8_t reserved[1];
+};
+
+// 页内整数按字节拷贝读写（项在页内不保证对齐）
+inline int32_t loadInt32(const char* p) {
+    int32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline void storeInt32(char* p, int32_t v) {
+    std::memcpy(p, &v, sizeof(v));
+}
+
+// 节点页格式（页内键压缩）：页头之后是页内所有键的公共前缀（prefixLen字节），再是定长的键数组与项尾数组
+//   键 = 完整键去掉前缀与 [gapStart, gapStart + gapLen) 后的其余字节
+//   该区段在页内所有键上均为0（字符串键的补0区、截断分隔键的尾部等），不必存放
+//   项尾：叶子为 RID(8字节) + 负载，内部节点为 孩子页号(4字节) + 保留(4字节)
+// 键数组按本格式的容量预留，项尾数组紧随其后：页内查找只读连续存放的键，4/8字节的键可按SIMD成组比较
+// 新键不符合页内格式（前缀不同或区段非0）时整页重新压缩
+#define INTERNAL_TAIL_LEN 8
+
+// 页内键格式
+struct NodeFormat {
+    int keyLen = 0;     // 完整键长
+    int tailLen = 0;    // 项尾长度
+    int prefixLen = 0;
+    int gapStart = 0;
+    int gapLen = 0;
+
+    NodeFormat() = default;
+    NodeFormat(const char* page, int keyLen, int tailLen);
+
+    int storedLen() const { return keyLen - prefixLen - gapLen; }   // 每项存放的键字节数
+    int headLen() const { return gapStart - prefixLen; }            // 区段之前存放的键字节数
+    int stride() const { return storedLen() + tailLen; }            // 每项占用的页内字节数（键 + 项尾）
+    int capacity() const;                                           // 本格式下每页可容纳的项数
+    int tailOffset() const;                                         // 项尾数组在页内的起点
+
+    /**
+     * 键是否符合本格式（前缀相同且区段为0），符合时可不重新压缩直接放入页中
+     * @param page 节点页
+     * @param key 完整键
+     */
+    bool accepts(const char* page, const char* key) const;
+
+    /**
+     * 页头给出的格式与项数是否落在页内：乐观读到正被改写的页时可能不成立，此时不得按其查找
+     * @param page 节点页
+     */
+    bool consistent(const char* page) const;
+};
+
+/**
+ * 第pos项压缩后的键字节
+ */
+inline char* nodeEntry(char* page, const NodeFormat& fmt, int pos) {
+    return page + sizeof(IndexPageHeader) + fmt.prefixLen + pos * fmt.storedLen();
+}
+inline const char* nodeEntry(const char* page, const NodeFormat& fmt, int pos) {
+    return page + sizeof(IndexPageHeader) + fmt.prefixLen + pos * fmt.storedLen();
+}
+
+/**
+ * 项尾地址（叶子：RID + 负载；内部节点：孩子页号）
+ */
+inline char* nodeTail(char* page, const NodeFormat& fmt, int pos) { return page + fmt.tailOffset() + pos * fmt.tailLen; }
+inline const char* nodeTail(const char* page, const NodeFormat& fmt, int pos) { return page + fmt.tailOffset() + pos * fmt.tailLen; }
+
+/**
+ * 还原第pos项的完整键
+ * @param out 输出缓冲（keyLen字节）
+ */
+void nodeGetKey(const char* page, const NodeFormat& fmt, int pos, char* out);
+
+/**
+ * 第pos项的键与key比较（<0：项键较小）
+ */
+int nodeCompareKey(const char* page, const NodeFormat& fmt, int pos, const char* key);
+
+// 节点内查找的实现：页内存放4或8字节的键时，先二分到不超过NODE_SIMD_WINDOW项的区间，
+// 再在区间内成组比较并计数；按CPU特性在运行时选定，不支持时退回标量二分
+enum class NodeSearchKernel { SCALAR, SSE42, AVX2 };
+#define NODE_SIMD_WINDOW 64
+
+/**
+ * 当前使用的节点内查找实现
+ */
+NodeSearchKernel nodeSearchKernel();
+
+/**
+ * 指定节点内查找实现（用于基准测试对比），CPU不支持时不变
+ * @return 是否已切换
+ */
+bool setNodeSearchKernel(NodeSearchKernel kernel);
+
+/**
+ * 第一个键大于key的项位置
+ */
+int nodeUpperBound(const char* page, const NodeFormat& fmt, const char* key);
+
+/**
+ * 第一个键不小于key的项位置
+ */
+int nodeLowerBound(const char* page, const NodeFormat& fmt, const char* key);
+
+/**
+ * 不重新压缩直接在pos处插入一项：键须符合页内格式且页内有空位
+ * @return 不满足条件时返回false，页不变
+ */
+bool nodeInsertInPlace(char* page, const NodeFormat& fmt, int pos, const char* key, const char* tail);
+
+/**
+ * 删除第pos项（删除后页内格式仍然有效）
+ */
+void nodeRemove(char* page, const NodeFormat& fmt, int pos);
+
+/**
+ * 替换第pos项的键（新键须保持页内有序），不符合页内格式时整页重新压缩
+ * @param keyLen 完整键长
+ * @param tailLen 项尾长度
+ * @return 重新压缩后放不下时返回false，页不变
+ */
+bool nodeReplaceKey(char* page, int keyLen, int tailLen, int pos, const char* key);
+
+/**
+ * 分隔键后缀截断：取right的最短前缀（其余补0），使之大于left且不大于right
+ * left与right相同（重复键跨节点）时取right本身
+ * @param out 输出缓冲（keyLen字节）
+ * @return 有效字节数（其后均为0）
+ */
+int makeSeparator(const char* left, const char* right, int keyLen, char* out);
+
+// 展开的节点：页头 + 完整键的项，用于分裂、合并、借位等整页重组，完成后重新压缩写回
+class NodeImage {
+public:
+    NodeImage(int keyLen, int tailLen) : keyLen_(keyLen), tailLen_(tailLen) { std::memset(&hdr_, 0, sizeof(hdr_)); }
+
+    /**
+     * 从节点页展开
+     */
+    void load(const char* page);
+
+    /**
+     * 按最优的前缀与0区段压缩写回节点页
+     * @return 放不下时返回false，页不变
+     */
+    bool store(char* page) const;
+
+    /**
+     * 压缩后的页内字节数
+     */
+    int packedSize() const;
+
+    IndexPageHeader& header() { return hdr_; }
+    int count() const { return (int)(entries_.size() / entryLen()); }
+    int entryLen() const { return keyLen_ + tailLen_; }
+    char* key(int i) { return entries_.data() + (size_t)i * entryLen(); }
+    char* tail(int i) { return key(i) + keyLen_; }
+
+    void insert(int pos, const char* key, const char* tail);
+    void erase(int from, int to);
+    void append(NodeImage& other, int from, int to);
+
+private:
+    NodeFormat bestFormat() const;
+
+    int keyLen_;
+    int tailLen_;
+    IndexPageHeader hdr_;
+    std::vector<char> entries_;
+};
+
+// 逐项追加时估计压缩后的页大小（批量建索引按字节填充节点）；键须按序追加
+class NodeSizer {
+public:
+    NodeSizer(int keyLen, int tailLen) : keyLen_(keyLen), tailLen_(tailLen), orBytes_(keyLen, 0), first_(keyLen, 0) {}
+
+    void reset();
+    void add(const char* key);
+
+    /**
+     * 再追加key后的压缩页大小
+     */
+    int sizeWith(const char* key) const;
+    int count() const { return count_; }
+
+private:
+    int keyLen_;
+    int tailLen_;
+    int count_ = 0;
+    int prefixLen_ = 0;
+    std::vector<uint8_t> orBytes_;  // 各键按位或：为0的位置在所有键上均为0
+    std::vector<char> first_;
+};
+
+// 重复键的RID列表（posting list）：非唯一且无叶子负载的索引中，重复较多的键只占一个叶子项
+//   项尾的页号字段为POSTING_RID_PAGE，槽号字段为posting链首页；重复较少的键仍每行一项，项尾为该行的RID
+//   posting页按RID顺序存放，页内RID差分后按变长整数编码，一页放不下时分裂出后继页
+#define POSTING_RID_PAGE (-2)
+
+// posting页头
+struct PostingPageHeader {
+    uint8_t nodeType;     // IndexNodeType::POSTING
+    int32_t pageNum;      // 页号
+    int32_t nextPage;     // 后继posting页（RID更大），-1表示链尾
+    int32_t count;        // 本页RID数
+    int32_t dataLen;      // 编码区字节数
+    int32_t totalCount;   // 整条链的RID数（仅链首页有效）
+};
+
+#define POSTING_DATA_CAPACITY (BLOCK_SIZE - (int)sizeof(PostingPageHeader))
+
+/**
+ * RID的全序编号（页号在高32位），posting列表按此排序
+ */
+inline uint64_t ridOrdinal(const RID& rid) { return ((uint64_t)(uint32_t)rid.pageNum << 32) | (uint16_t)rid.slotNum; }
+inline RID ridFromOrdinal(uint64_t v) { return RID((PageNum)(v >> 32), (SlotNum)(uint16_t)v); }
+
+/**
+ * 将有序RID编号差分编码（首项为绝对值），编码到容量用完为止
+ * @param rids 有序RID编号
+ * @param n 数量
+ * @param out 输出缓冲
+ * @param capacity 缓冲容量
+ * @param bytes 输出参数，已编码字节数
+ * @return 已编码的RID数
+ */
+int encodePostings(const uint64_t* rids, int n, char* out, int capacity, int& bytes);
+
+/**
+ * 解码posting页内的全部RID编号，追加到out
+ */
+void decodePostings(const char* page, std::vector<uint64_t>& out);
+
+/**
+ * posting页内的首个RID编号（页为空时返回UINT64_MAX）
+ */
+uint64_t firstPosting(const char* page);
+
+#endif // INDEX_NODE_H
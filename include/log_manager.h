@@ -54,6 +54,18 @@ struct UpdateLog {
     char data[0];       // 先存旧数据，再存新数据（旧数据长度oldDataLen）
 };
 
+// 溢出页日志：溢出链上一页的数据（写入时为新内容，删除记录时为其完整的行外部分）
+// 一页数据放不进一个日志块时按偏移拆成多条
+struct OverflowLog {
+    LogHeader header;
+    TableId tableId;    // 溢出文件ID
+    PageNum pageNum;    // 溢出页号
+    PageNum nextPage;   // 链上的下一页，-1表示结束
+    int offset;         // 本条数据在该页数据中的偏移
+    int dataLen;        // 本条数据长度
+    char data[0];       // 页数据片段
+};
+
 // 创建表日志
 struct CreateTableLog {
     LogHeader header;
@@ -63,7 +75,7 @@ struct CreateTableLog {
     AttrInfo attrs[0];      // 柔性数组存储属性信息（数量由attrCount指定）
 };
 
-// 删除表日志
+// 删除表/截断表日志
 struct DropTableLog {
     LogHeader header;
     TableId tableId;        // 表ID
@@ -98,6 +110,10 @@ public:
     lsn_t writeDeleteLog(TransactionId txId, TableId tableId, const RID& rid,
                          const char* data, int dataLen);
 
+    // 写入溢出页日志（数据超过一个日志块时拆成多条），返回最后一条的LSN
+    lsn_t writeOverflowLog(TransactionId txId, TableId tableId, PageNum pageNum, PageNum nextPage,
+                           const char* data, int dataLen);
+
     // 写入更新操作日志，返回当前日志LSN
     lsn_t writeUpdateLog(TransactionId txId, TableId tableId, const RID& rid,
                          const char* oldData, int oldLen, const char* newData, int newLen);
@@ -109,6 +125,9 @@ public:
     // 写入删除表日志，返回当前日志LSN
     lsn_t writeDropTableLog(TransactionId txId, TableId tableId, const char* tableName);
 
+    // 写入截断表日志，返回当前日志LSN
+    lsn_t writeTruncateTableLog(TransactionId txId, TableId tableId, const char* tableName);
+
     // 刷新所有日志到磁盘（无参数版本）
     RC flushLog();
 
@@ -162,6 +181,9 @@ private:
 
     // 获取当前日志块的缓冲帧
     RC getCurrentLogBlock(BufferFrame*& frame);
+
+    // 写入只含表ID与表名的DDL日志（删除表/截断表）
+    lsn_t writeTableDdlLog(LogType type, TransactionId txId, TableId tableId, const char* tableName);
 };
 
 #endif //NPCBASE_LOG_MANAGER_H
\ No newline at end of file
@@ -3,8 +3,58 @@
 
 #include "npcbase.h"
 #include "disk_manager.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
+// 页闩（乐观锁耦合用的版本锁）：版本号为奇数表示正被写
+// 读者不加锁：读页前取版本号（正被写时让出等待），读完后校验版本号未变，变了则重读；
+// 写者以CAS将版本号由偶数加1上锁，解锁时再加1，读者据此发现页已被修改
+// 闩只保护页内容，页的固定与置换仍由MemManager管理，持闩期间须保持页被固定
+class PageLatch {
+public:
+    /**
+     * 等待写者离开后取版本号
+     */
+    uint64_t readLock() const {
+        uint64_t v = version_.load(std::memory_order_acquire);
+        while (v & 1) {
+            std::this_thread::yield();
+            v = version_.load(std::memory_order_acquire);
+        }
+        return v;
+    }
+
+    /**
+     * 读完后校验：版本号未变时读到的内容一致
+     * @param v readLock返回的版本号
+     */
+    bool validate(uint64_t v) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return version_.load(std::memory_order_relaxed) == v;
+    }
+
+    /**
+     * 读到版本v后升级为写锁；页已被修改（版本号已变）时失败，调用方重新读取
+     */
+    bool tryUpgrade(uint64_t v) {
+        return version_.compare_exchange_strong(v, v + 1, std::memory_order_acquire);
+    }
+
+    void lock() {
+        while (!tryUpgrade(readLock())) {
+        }
+    }
+
+    void unlock() { version_.fetch_add(1, std::memory_order_release); }
+
+private:
+    std::atomic<uint64_t> version_{0};
+};
+
 // 缓冲帧结构体
 struct BufferFrame {
     PageNum pageNum;       // 页号
@@ -15,14 +65,17 @@ struct BufferFrame {
     bool refBit;           // 引用位（CLOCK算法）
     MemSpaceType spaceType;// 内存分区类型
     int pinCount;          // 固定计数
-
+    bool ioPending;        // 正在置换（写回旧页/读入新页），此时帧已被固定，其他线程等待读入完成
+    PageLatch latch;       // 页闩（见PageLatch；目前仅索引页使用）
 
     BufferFrame() : pageNum(-1), tableId(-1), data(nullptr), isValid(true),
                     isDirty(false), refBit(false),
-                    spaceType(DATA_SPACE), pinCount(0) {}
+                    spaceType(DATA_SPACE), pinCount(0), ioPending(false) {}
 };
 
 // 内存管理器类
+// 线程安全：页表、固定计数、脏页标记与置换由一把互斥锁保护，页内容的并发访问由调用方以页闩协调
+// 磁盘读写不持有该锁：置换中的帧标记为ioPending，访问同一页的线程在条件变量上等待
 class MemManager {
 public:
     /**
@@ -78,6 +131,21 @@ public:
      */
     RC flushSpace(MemSpaceType spaceType);
 
+    /**
+     * 一次遍历丢弃若干文件的全部缓冲帧（脏页不写回），用于删除/截断表
+     * @param tableIds 文件ID列表（表文件、溢出文件及索引文件）
+     * @return 有帧仍被固定时返回RC_INVALID_OP，此时不丢弃任何帧
+     */
+    RC discardPages(const std::vector<TableId> &tableIds);
+
+    /**
+     * 丢弃单个页的缓冲帧（脏页不写回），用于释放块之前；页不在缓冲池中时直接返回
+     * @param tableId 表ID
+     * @param pageNum 页号
+     * @return 帧仍被固定时返回RC_INVALID_OP
+     */
+    RC discardPage(TableId tableId, PageNum pageNum);
+
     /**
      * 获取空闲缓冲帧（可能需要置换）
      * @param frame 输出参数，返回空闲缓冲帧
@@ -102,6 +170,27 @@ public:
 
 private:
     DiskManager& diskManager_;
+    std::mutex mutex_;                             // 保护帧元数据与页表
+    std::condition_variable ioDone_;               // 帧的置换I/O结束时通知
+    std::unordered_map<uint64_t, int> pageTable_;  // (表ID, 页号) -> 帧下标
+
+    static uint64_t pageKey(TableId tableId, PageNum pageNum) {
+        return ((uint64_t)(uint32_t)tableId << 32) | (uint32_t)pageNum;
+    }
+
+    /**
+     * 将帧写回磁盘并清除脏页标记（调用方持有mutex_）
+     */
+    RC writeBack(BufferFrame &frame);
+
+    /**
+     * 在不持有mutex_的情况下写回一个脏帧：先固定帧并清除脏页标记，
+     * 在页闩下复制页内容（读到一致的版本）后写盘，写失败时恢复脏页标记
+     * @param lock 调用方持有的mutex_（写盘期间释放，返回时重新持有）
+     * @param idx 帧下标
+     * @param tableId 写入的目标文件
+     */
+    RC flushFrame(std::unique_lock<std::mutex> &lock, int idx, TableId tableId);
 
     /**
      * 执行CLOCK置换算法，找到可置换的页
@@ -10,7 +10,10 @@
 #define MAX_TABLE_NAME_LEN 32    // 最大表名长度
 #define MAX_ATTR_NAME_LEN 32     // 最大属性名长度
 #define MAX_ATTRS_PER_TABLE 16   // 每个表最大属性数
-#define MAX_RECORD_LEN (BLOCK_SIZE - 64)  // 最大记录长度
+#define MAX_RECORD_LEN (BLOCK_SIZE - 64)  // 最大行内记录长度
+#define MAX_TUPLE_LEN (1024 * 1024)       // 最大逻辑记录长度（超出行内部分存入溢出页）
+#define TOAST_THRESHOLD (BLOCK_SIZE / 4)  // 记录超过该长度时将尾部移出行外存储
+#define TOAST_INLINE_LEN 512              // 溢出记录在数据页中保留的前缀长度
 #define BUFFER_POOL_PCT 70       // 数据处理缓存占内存比例
 #define PLAN_CACHE_PCT 10        // 访问计划占内存比例
 #define DICT_CACHE_PCT 10        // 数据字典占内存比例
@@ -19,6 +22,9 @@
 #define LOG_TABLE_ID (-1)        // 日志表ID
 #define PLAN_TABLE_ID (-2)       // 访问计划表ID
 #define INDEX_META_TABLE_ID (-3) // 索引元数据表ID（sys_indexes），独立文件
+#define TOAST_TABLE_ID_BASE (-1000) // 溢出文件ID基准：溢出文件ID = TOAST_TABLE_ID_BASE - 表ID
+#define DB_FILE_MAGIC 0x4E504342  // 文件头魔数（"NPCB"）
+#define DB_FORMAT_VERSION 1       // 磁盘格式版本：字典/索引元数据、页面或索引键的编码改变时递增
 
 // 返回码定义
 typedef int RC;
@@ -47,6 +53,8 @@ typedef int RC;
 #define RC_INVALID_LSN 21        // 无效LSN
 #define RC_LOG_NOT_FLUSHED 22    // 日志缓冲中
 #define RC_LOG_READ_ERROR 23     // 日志读取错误
+#define RC_DUPLICATE_KEY 24      // 违反唯一索引
+#define RC_FORMAT_MISMATCH 25    // 磁盘格式版本与程序不符
 
 // 数据类型枚举
 enum AttrType {
@@ -65,7 +73,9 @@ enum LogType {
     LOG_UPDATE,       // 更新记录
     LOG_CREATE_TABLE, // 创建表
     LOG_DROP_TABLE,   // 删除表
-    LOG_ALTER_TABLE   // 修改表结构
+    LOG_ALTER_TABLE,  // 修改表结构
+    LOG_TRUNCATE_TABLE, // 截断表
+    LOG_OVERFLOW      // 溢出页数据（超长记录行外部分）
 };
 
 // 内存分区类型
@@ -76,6 +86,13 @@ enum MemSpaceType {
     LOG_SPACE      // 日志缓存区
 };
 
+// 表的页面格式（建表时选择）
+enum PageFormat {
+    PAGE_FORMAT_SLOTTED,  // 行式变长页（槽目录）
+    PAGE_FORMAT_PAX,      // 列式PAX页（每列一个minipage）
+    PAGE_FORMAT_FIXED     // 定长行页（占用位图，槽号直接定址）
+};
+
 // 页号类型
 typedef int32_t PageNum;
 
@@ -114,6 +131,11 @@ struct RID {
     }
 };
 
+// 表的溢出文件ID（每个表一个独立的溢出文件）
+inline TableId toastFileId(TableId tableId) {
+    return TOAST_TABLE_ID_BASE - tableId;
+}
+
 // 最大LSN值
 #define MAX_LSN INT64_MAX
 
@@ -0,0 +1,226 @@
+#ifndef NPCBASE_PAGE_LAYOUT_H
+#define NPCBASE_PAGE_LAYOUT_H
+
+#include "npcbase.h"
+#include "row_codec.h"
+#include <string>
+#include <vector>
+
+// 位图页头（PAX页与定长页使用）：占用位图紧随页头，RID槽号即行序号
+struct BitmapPageHeader {
+    PageNum pageNum;          // 当前页号
+    int capacity;             // 每页行数上限
+    int liveCount;            // 有效行数
+    int reserved;             // 保留（保持8字节对齐）
+};
+
+// 位图操作（按64位字访问，位图长度均按8字节对齐）
+inline bool bitmapTest(const char *bitmap, int bit) {
+    return (reinterpret_cast<const uint8_t *>(bitmap)[bit >> 3] >> (bit & 7)) & 1;
+}
+
+inline void bitmapSet(char *bitmap, int bit) {
+    reinterpret_cast<uint8_t *>(bitmap)[bit >> 3] |= (uint8_t)(1u << (bit & 7));
+}
+
+inline void bitmapClear(char *bitmap, int bit) {
+    reinterpret_cast<uint8_t *>(bitmap)[bit >> 3] &= (uint8_t)~(1u << (bit & 7));
+}
+
+/**
+ * 查找位图中第一个为0的位
+ * @param bitmap 位图
+ * @param nbits 有效位数
+ * @return 位序号，-1表示全满
+ */
+int bitmapFindZero(const char *bitmap, int nbits);
+
+// 位图字节数（按8字节对齐）
+inline int bitmapBytes(int nbits) {
+    return ((nbits + 63) / 64) * 8;
+}
+
+#define PAX_MIN_ROWS 8     // PAX页至少容纳的行数，否则不适合列式存储
+#define FIXED_MIN_ROWS 8   // 定长页至少容纳的行数
+
+// PAX页布局（每个表结构计算一次）：
+//   [BitmapPageHeader][占用位图][列0 minipage][列1 minipage]...
+// 每个minipage为 [空值位图][值数组]；INT/FLOAT值数组为capacity个4字节值，
+// STRING值数组为capacity个int32长度后接capacity个定长（列最大长度）字符区。
+// 同一列的值在页内连续存放，只访问少数列的扫描不会读入其他列。
+struct PaxLayout {
+    int capacity = 0;                              // 每页行数
+    int bitmapOffset = 0;                          // 占用位图偏移
+    int nullOffset[MAX_ATTRS_PER_TABLE];           // 各列空值位图偏移
+    int valueOffset[MAX_ATTRS_PER_TABLE];          // 各列值数组偏移（STRING为长度数组）
+    int charOffset[MAX_ATTRS_PER_TABLE];           // STRING列字符区偏移；定长列为-1
+
+    /**
+     * 根据行布局计算PAX页布局
+     * @param layout 行布局
+     * @return 行过宽（每页容纳不足PAX_MIN_ROWS行）时返回RC_RECORD_TOO_LONG
+     */
+    RC init(const RowLayout &layout);
+};
+
+// PAX页访问器（不持有页面，调用方负责pin/unpin）
+class PaxPage {
+public:
+    PaxPage(char *data, const PaxLayout &pax, const RowLayout &row) : data_(data), pax_(pax), row_(row) {}
+
+    /**
+     * 初始化空页
+     * @param pageNum 页号
+     */
+    void init(PageNum pageNum);
+
+    BitmapPageHeader *header() const { return reinterpret_cast<BitmapPageHeader *>(data_); }
+
+    /**
+     * 行是否有效
+     * @param slot 行序号
+     */
+    bool isLive(int slot) const { return bitmapTest(data_ + pax_.bitmapOffset, slot); }
+
+    /**
+     * 查找空闲行
+     * @return 行序号，-1表示页已满
+     */
+    int findFreeSlot() const { return bitmapFindZero(data_ + pax_.bitmapOffset, pax_.capacity); }
+
+    /**
+     * 清除行的占用位（删除行）
+     * @param slot 行序号
+     */
+    void clearLive(int slot) { bitmapClear(data_ + pax_.bitmapOffset, slot); }
+
+    /**
+     * 将编码行按列拆分写入各minipage
+     * @param slot 行序号
+     * @param rowData 编码行（row_codec格式）
+     * @param rowLen 编码行长度
+     */
+    void writeRow(int slot, const char *rowData, int rowLen);
+
+    /**
+     * 从各minipage拼装编码行
+     * @param slot 行序号
+     * @param out 输出参数，编码行（row_codec格式）
+     */
+    void readRow(int slot, std::string &out) const;
+
+    /**
+     * 读取单列值
+     * @param slot 行序号
+     * @param col 列序号
+     * @param value 输出参数，列值
+     */
+    void getValue(int slot, int col, Value &value) const;
+
+    /**
+     * 列等值匹配：在连续值数组上逐行比较，结果按64行一组与占用位图、空值位图求与
+     * @param col 列序号
+     * @param value 比较值（非空）
+     * @param slots 输出参数，追加匹配的行序号
+     */
+    void matchEquals(int col, const Value &value, std::vector<int> &slots) const;
+
+    /**
+     * 列的空值位图
+     * @param col 列序号
+     */
+    const char *nullBitmap(int col) const { return data_ + pax_.nullOffset[col]; }
+
+    /**
+     * 占用位图
+     */
+    const char *liveBitmap() const { return data_ + pax_.bitmapOffset; }
+
+    /**
+     * 定长列的连续值数组（INT为int32，FLOAT为float）
+     * @param col 列序号
+     */
+    const char *values(int col) const { return data_ + pax_.valueOffset[col]; }
+
+private:
+    char *data_;
+    const PaxLayout &pax_;
+    const RowLayout &row_;
+};
+
+// 定长页布局（每个表结构计算一次）：
+//   [BitmapPageHeader][占用位图][行0][行1]...
+// 行宽取表结构的最大编码长度，第i行位于 rowOffset + i * width，无槽目录。
+// 行内仍为row_codec格式（短字符串行尾部补0），实际长度由偏移表得出。
+struct FixedLayout {
+    int capacity = 0;          // 每页行数
+    int width = 0;             // 行宽
+    int bitmapOffset = 0;      // 占用位图偏移
+    int rowOffset = 0;         // 行区起始偏移
+
+    /**
+     * 根据行布局计算定长页布局
+     * @param layout 行布局
+     * @return 行过宽（每页容纳不足FIXED_MIN_ROWS行）时返回RC_RECORD_TOO_LONG
+     */
+    RC init(const RowLayout &layout);
+};
+
+// 定长页访问器（不持有页面，调用方负责pin/unpin）
+class FixedPage {
+public:
+    FixedPage(char *data, const FixedLayout &fixed, const RowLayout &row) : data_(data), fixed_(fixed), row_(row) {}
+
+    /**
+     * 初始化空页
+     * @param pageNum 页号
+     */
+    void init(PageNum pageNum);
+
+    BitmapPageHeader *header() const { return reinterpret_cast<BitmapPageHeader *>(data_); }
+
+    /**
+     * 行是否有效
+     * @param slot 行序号
+     */
+    bool isLive(int slot) const { return bitmapTest(data_ + fixed_.bitmapOffset, slot); }
+
+    /**
+     * 查找空闲行
+     * @return 行序号，-1表示页已满
+     */
+    int findFreeSlot() const { return bitmapFindZero(data_ + fixed_.bitmapOffset, fixed_.capacity); }
+
+    /**
+     * 清除行的占用位（删除行）
+     * @param slot 行序号
+     */
+    void clearLive(int slot) { bitmapClear(data_ + fixed_.bitmapOffset, slot); }
+
+    /**
+     * 行数据（页内原地访问）
+     * @param slot 行序号
+     */
+    const char *row(int slot) const { return data_ + fixed_.rowOffset + slot * fixed_.width; }
+
+    /**
+     * 行的编码长度（最后一个字符串列的结束偏移，无字符串列时为定长部分长度）
+     * @param slot 行序号
+     */
+    int rowLength(int slot) const;
+
+    /**
+     * 写入行
+     * @param slot 行序号
+     * @param rowData 编码行（row_codec格式）
+     * @param rowLen 编码行长度（不超过行宽）
+     */
+    void writeRow(int slot, const char *rowData, int rowLen);
+
+private:
+    char *data_;
+    const FixedLayout &fixed_;
+    const RowLayout &row_;
+};
+
+#endif // NPCBASE_PAGE_LAYOUT_H
@@ -0,0 +1,212 @@
+#ifndef NPCBASE_ROW_CODEC_H
+#define NPCBASE_ROW_CODEC_H
+
+#include "npcbase.h"
+#include <string>
+#include <vector>
+
+// 行格式（由表结构驱动）：
+//   [空值位图 ceil(n/8)字节][定长列区：INT/FLOAT各4字节][变长偏移表：每个STRING列一个int32结束偏移][变长数据区]
+// 定长列偏移与偏移表位置在表结构确定后只计算一次，任意列的访问均为O(1)。
+
+// 行布局（每个表结构计算一次）
+struct RowLayout {
+    int attrCount = 0;                          // 列数
+    AttrType types[MAX_ATTRS_PER_TABLE];        // 列类型
+    int lengths[MAX_ATTRS_PER_TABLE];           // 列最大长度（STRING有效）
+    int fixedOffset[MAX_ATTRS_PER_TABLE];       // 定长列在行中的偏移；STRING列为-1
+    int varIndex[MAX_ATTRS_PER_TABLE];          // STRING列在偏移表中的序号；定长列为-1
+    int nullBitmapLen = 0;                      // 空值位图长度
+    int varCount = 0;                           // 变长列数量
+    int varTableOffset = 0;                     // 变长偏移表起始偏移
+    int varDataOffset = 0;                      // 变长数据区起始偏移（即最短行长）
+
+    /**
+     * 根据表结构计算行布局
+     * @param attrCount 属性数量
+     * @param attrs 属性信息数组
+     */
+    RC init(int attrCount, const AttrInfo *attrs);
+
+    /**
+     * 行的最大编码长度（所有字符串取最大长度）
+     */
+    int maxRowLen() const;
+};
+
+// 列值（用于编码行与解析字面量）
+struct Value {
+    AttrType type = INT;   // 值类型
+    bool isNull = false;   // 是否为空
+    int32_t intVal = 0;    // INT值
+    float floatVal = 0.0f; // FLOAT值
+    std::string strVal;    // STRING值
+};
+
+// 列表达式：索引键列与WHERE条件可以是STRING列上的表达式
+//   lower(列)：ASCII字母转为小写；substr(列, 1, n)：前n个字符
+enum class ColumnExpr : uint8_t { NONE = 0, LOWER = 1, PREFIX = 2 };
+
+// 列引用：列序号与其上的表达式
+struct ColumnRef {
+    int column = -1;                       // 列序号
+    ColumnExpr expr = ColumnExpr::NONE;    // 表达式
+    int arg = 0;                           // 表达式参数（PREFIX为前缀长度）
+};
+
+// 行只读视图：在编码后的行上按列直接访问，不做整行解码
+class RowView {
+public:
+    RowView(const RowLayout &layout, const char *data, int len) : layout_(layout), data_(data), len_(len) {}
+
+    /**
+     * 列是否为空
+     * @param col 列序号
+     */
+    bool isNull(int col) const {
+        return (data_[col >> 3] >> (col & 7)) & 1;
+    }
+
+    /**
+     * 读取INT列
+     * @param col 列序号
+     */
+    int32_t getInt(int col) const {
+        int32_t v;
+        std::memcpy(&v, data_ + layout_.fixedOffset[col], sizeof(v));
+        return v;
+    }
+
+    /**
+     * 读取FLOAT列
+     * @param col 列序号
+     */
+    float getFloat(int col) const {
+        float v;
+        std::memcpy(&v, data_ + layout_.fixedOffset[col], sizeof(v));
+        return v;
+    }
+
+    /**
+     * 读取STRING列（不拷贝）
+     * @param col 列序号
+     * @param len 输出参数，字符串长度
+     */
+    const char *getString(int col, int &len) const {
+        int start, end;
+        varBounds(layout_.varIndex[col], start, end);
+        len = end - start;
+        return data_ + start;
+    }
+
+    /**
+     * 列在行中的字节区间
+     * @param col 列序号
+     * @param offset 输出参数，起始偏移
+     * @param len 输出参数，字节长度
+     */
+    void columnRange(int col, int &offset, int &len) const;
+
+    /**
+     * 读取列值
+     * @param col 列序号
+     * @param value 输出参数，列值
+     */
+    void getValue(int col, Value &value) const;
+
+    /**
+     * 校验行结构（长度、偏移表单调性）
+     */
+    bool validate() const;
+
+private:
+    const RowLayout &layout_;
+    const char *data_;
+    int len_;
+
+    void varBounds(int varIdx, int &start, int &end) const {
+        int32_t prevEnd = layout_.varDataOffset;
+        if (varIdx > 0) std::memcpy(&prevEnd, data_ + layout_.varTableOffset + (varIdx - 1) * 4, sizeof(int32_t));
+        int32_t curEnd;
+        std::memcpy(&curEnd, data_ + layout_.varTableOffset + varIdx * 4, sizeof(int32_t));
+        start = prevEnd;
+        end = curEnd;
+    }
+};
+
+/**
+ * 按行布局编码一行
+ * @param layout 行布局
+ * @param values 列值（数量须等于列数）
+ * @param out 输出参数，编码后的行
+ */
+RC encodeRow(const RowLayout &layout, const std::vector<Value> &values, std::string &out);
+
+/**
+ * 将字面量解析为列值（"null"表示空值）
+ * @param attr 列信息
+ * @param literal 字面量（已去除引号）
+ * @param value 输出参数，列值
+ */
+RC parseValue(const AttrInfo &attr, const std::string &literal, Value &value);
+
+/**
+ * 按列名查找列序号
+ * @param attrCount 属性数量
+ * @param attrs 属性信息数组
+ * @param name 列名
+ * @return 列序号，-1表示不存在
+ */
+int findAttrIndex(int attrCount, const AttrInfo *attrs, const char *name);
+
+/**
+ * 解析列引用：列名、lower(列名)或substr(列名, 1, n)（函数名不区分大小写，忽略空白）
+ * @param attrCount 属性数量
+ * @param attrs 属性信息数组
+ * @param text 列引用文本
+ * @param ref 输出参数，列引用
+ * @return 列不存在时返回RC_ATTR_NOT_FOUND；表达式不合法（非STRING列、n不在[1, 列长]内等）时返回RC_INVALID_ARG
+ */
+RC parseColumnRef(int attrCount, const AttrInfo *attrs, const std::string &text, ColumnRef &ref);
+
+/**
+ * 列引用的文本形式（可由parseColumnRef解析回来）
+ * @param attrs 属性信息数组
+ * @param ref 列引用
+ */
+std::string columnRefText(const AttrInfo *attrs, const ColumnRef &ref);
+
+/**
+ * 对列值求表达式（空值不变）
+ * @param expr 表达式
+ * @param arg 表达式参数
+ * @param value 列值，原地改写
+ */
+void applyColumnExpr(ColumnExpr expr, int arg, Value &value);
+
+/**
+ * 对STRING列的原始字符求表达式
+ * @param expr 表达式
+ * @param arg 表达式参数
+ * @param data 字符
+ * @param len 字符数
+ * @param out 输出缓冲（至少len字节）
+ * @return 结果字符数
+ */
+int applyColumnExpr(ColumnExpr expr, int arg, const char *data, int len, char *out);
+
+/**
+ * 将列值格式化为可读文本
+ * @param value 列值
+ */
+std::string valueToString(const Value &value);
+
+/**
+ * 比较两个同类型非空列值
+ * @param a 列值
+ * @param b 列值
+ * @return 负数、0、正数分别表示a小于、等于、大于b
+ */
+int compareValue(const Value &a, const Value &b);
+
+#endif // NPCBASE_ROW_CODEC_H
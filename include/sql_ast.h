@@ -7,16 +7,16 @@
 #include <optional>
 
 struct SqlExpr {
-    // Only support column = literal for WHERE
+    // Only support column <op> literal for WHERE; the column may be wrapped as lower(col) or substr(col, 1, n)
     std::string column;
-    std::string op; // '=' only for now
+    std::string op; // one of = < <= > >=
     std::string literal; // store as string; type resolution later
 };
 
 struct SqlSelect {
     std::vector<std::string> columns; // '*' or specific columns
     std::string table;
-    std::optional<SqlExpr> where;
+    std::vector<SqlExpr> where; // AND-ed conditions; empty when there is no WHERE
 };
 
 // Minimal CREATE TABLE AST
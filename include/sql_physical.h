@@ -5,6 +5,8 @@
 #include "index_manager.h"
 #include "table_manager.h"
 #include "data_dict.h"
+#include <functional>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -13,6 +15,11 @@ enum class PhysOpType { TableScan, IndexScan, Filter, Project };
 struct PhysOp {
     PhysOpType type;
     std::string detail; // human-readable description
+    std::string table{};                // TableScan/IndexScan: table to read
+    std::string index{};                // IndexScan: index to scan
+    std::vector<SqlExpr> predicates{};  // IndexScan: conditions bounding the key range; Filter: remaining conditions
+    bool indexOnly = false;             // IndexScan: every referenced column is in the index, the heap is not read
+    std::vector<std::string> columns{}; // Project: output columns
 };
 
 struct PhysicalPlan { std::vector<PhysOp> steps; };
@@ -23,5 +30,14 @@ PhysicalPlan buildPhysicalPlan(const LogicalPlan& optPlan, DataDict& dict, Index
 // Pretty print physical plan
 std::string printPhysicalPlan(const PhysicalPlan& plan);
 
+// Receives each result row (projected values in output column order); return false to stop
+typedef std::function<bool(const RID&, const std::vector<Value>&)> RowSink;
+
+// Execute a physical plan: IndexScan walks the index range and fetches matching rows by RID
+// (or decodes them from the index entries when indexOnly), TableScan reads every row except on page
+// segments whose Bloom filters rule out an equality condition;
+// all conditions of both steps are checked on each row
+RC executePhysicalPlan(const PhysicalPlan& plan, DataDict& dict, TableManager& tableMgr, IndexManager& idxMgr, const RowSink& sink);
+
 #endif
 
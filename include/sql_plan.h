@@ -14,7 +14,7 @@ struct LogicalNode {
     LogicalOpType type;
     std::string table; // for Scan
     std::vector<std::string> columns; // for Project
-    std::optional<SqlExpr> predicate; // for Select
+    std::vector<SqlExpr> predicates; // for Select (AND-ed)
     std::vector<LogicalNode> children; // unary/linear tree
 };
 
@@ -0,0 +1,236 @@
+#ifndef NPCBASE_STATISTICS_H
+#define NPCBASE_STATISTICS_H
+
+#include "npcbase.h"
+#include "row_codec.h"
+#include <string>
+#include <vector>
+
+#define HLL_PRECISION 10                      // HyperLogLog寄存器位数（2^10个寄存器，标准误差约3%）
+#define HLL_REGISTERS (1 << HLL_PRECISION)    // HyperLogLog寄存器数
+#define STATS_HISTOGRAM_BUCKETS 32            // 等深直方图桶数
+#define ANALYZE_SAMPLE_PAGES 128              // ANALYZE最多抽样的数据页数
+#define DEFAULT_EQ_SELECTIVITY 0.005          // 无统计信息时等值谓词的默认选择率
+#define DEFAULT_RANGE_SELECTIVITY 0.3333      // 无统计信息时范围谓词的默认选择率
+#define BLOOM_SEGMENT_PAGES 16                // 每个Bloom过滤器覆盖的连续数据页数
+#define BLOOM_BITS_PER_ROW 10                 // Bloom过滤器每行分配的位数（7个哈希时误判率约1%）
+#define BLOOM_HASHES 7                        // Bloom过滤器哈希个数
+#define BLOOM_MIN_BITS 1024                   // 每个Bloom过滤器的最少位数
+
+// 代价模型常量（以顺序读一页为单位）
+#define SEQ_PAGE_COST 1.0                     // 顺序读一页
+#define RANDOM_PAGE_COST 4.0                  // 随机读一页
+#define CPU_TUPLE_COST 0.01                   // 处理一行
+
+/**
+ * 计算列值的64位哈希（用于基数估计）
+ * @param value 列值（非空）
+ */
+uint64_t hashValue(const Value &value);
+
+/**
+ * 列值在直方图中的排序键：INT/FLOAT取数值，STRING取前8字节按大端序解释
+ * @param value 列值（非空）
+ */
+double statsSortKey(const Value &value);
+
+// HyperLogLog基数估计（固定1KB寄存器，可增量加入）
+class HyperLogLog {
+public:
+    HyperLogLog() : registers_(HLL_REGISTERS, 0) {}
+
+    /**
+     * 加入一个元素
+     * @param hash 元素的64位哈希
+     */
+    void add(uint64_t hash);
+
+    /**
+     * 估计不同元素个数（小基数时使用线性计数修正）
+     */
+    double estimate() const;
+
+    /**
+     * 清空
+     */
+    void clear();
+
+private:
+    std::vector<uint8_t> registers_;
+};
+
+// Bloom过滤器（位数为2的幂，由元素的64位哈希双重散列出BLOOM_HASHES个位置）
+class BloomFilter {
+public:
+    /**
+     * @param bits 位数（2的幂）
+     */
+    explicit BloomFilter(size_t bits) : words_(bits / 64, 0) {}
+
+    /**
+     * 加入一个元素
+     * @param hash 元素的64位哈希
+     */
+    void add(uint64_t hash);
+
+    /**
+     * 元素是否可能已加入（false时一定未加入）
+     * @param hash 元素的64位哈希
+     */
+    bool mayContain(uint64_t hash) const;
+
+    size_t bits() const { return words_.size() * 64; }
+
+private:
+    std::vector<uint64_t> words_;
+};
+
+// 表的分段Bloom过滤器：对选定的列，每BLOOM_SEGMENT_PAGES个数据页一个过滤器，记录这些页上出现过的非空值，
+// 等值扫描据此跳过不可能含有该值的页段。插入时增量加入；删除与更新留下的旧值只造成误判，由VACUUM重建清除
+class TableBlooms {
+public:
+    /**
+     * @param columns 维护过滤器的列序号
+     * @param rowsPerPage 每页行数估计（决定每个过滤器的位数）
+     */
+    TableBlooms(std::vector<int> columns, int rowsPerPage);
+
+    const std::vector<int> &columns() const { return columns_; }
+
+    /**
+     * 是否为该列维护过滤器
+     */
+    bool covers(int column) const;
+
+    /**
+     * 加入一行
+     * @param layout 行布局
+     * @param page 行所在页号
+     * @param data 编码行
+     * @param len 编码行长度
+     */
+    void addRow(const RowLayout &layout, PageNum page, const char *data, int len);
+
+    /**
+     * 页page所在页段是否可能含有 column = value 的行（未加入过任何行的页段返回false）
+     * @param column 列序号（须为covers的列）
+     * @param page 页号
+     * @param hash 比较值的hashValue
+     */
+    bool mayContain(int column, PageNum page, uint64_t hash) const;
+
+    /**
+     * 过滤器占用的字节数
+     */
+    size_t memoryBytes() const;
+
+private:
+    std::vector<int> columns_;
+    size_t bits_;                                        // 每个过滤器的位数
+    std::vector<std::vector<BloomFilter>> segments_;     // 各列的过滤器，下标为 页号 / BLOOM_SEGMENT_PAGES
+};
+
+// 列统计信息
+struct ColumnStats {
+    AttrType type = INT;            // 列类型
+    int64_t rowCount = 0;           // 行数（含空值）
+    int64_t nullCount = 0;          // 空值数
+    bool hasMinMax = false;         // 是否已有最小/最大值
+    Value minValue;                 // 最小值
+    Value maxValue;                 // 最大值
+    HyperLogLog ndv;                // 不同值计数草图
+    double ndvScale = 1.0;          // 抽样时的不同值放大系数
+    int64_t addedRows = 0;          // ANALYZE后增量加入的行数
+    std::vector<double> bounds;     // 等深直方图桶边界（STATS_HISTOGRAM_BUCKETS + 1个，非空值排序键）
+
+    /**
+     * 空值比例
+     */
+    double nullFraction() const;
+
+    /**
+     * 估计不同值个数（不超过非空行数）
+     */
+    double distinct() const;
+
+    /**
+     * 等值谓词 col = value 的选择率
+     * @param value 比较值
+     */
+    double equalSelectivity(const Value &value) const;
+
+    /**
+     * 范围谓词 col < value（inclusive时为 col <= value）的选择率：按直方图定位所在桶，桶内线性插值
+     * @param value 比较值
+     * @param inclusive 是否包含等于
+     */
+    double lessSelectivity(const Value &value, bool inclusive) const;
+
+    /**
+     * 增量加入一个值
+     * @param value 列值
+     */
+    void addValue(const Value &value);
+
+    /**
+     * 增量移除一个值（HyperLogLog与直方图不支持删除，仅调整行数与空值数）
+     * @param value 列值
+     */
+    void removeValue(const Value &value);
+};
+
+// 表统计信息
+struct TableStats {
+    int64_t sampledRows = 0;              // ANALYZE抽样行数
+    int sampledPages = 0;                 // ANALYZE抽样页数
+    int64_t modifiedRows = 0;             // ANALYZE后增量维护的行数
+    std::vector<ColumnStats> columns;     // 各列统计
+
+    /**
+     * 增量维护：插入一行
+     * @param layout 行布局
+     * @param data 编码行
+     * @param len 编码行长度
+     */
+    void addRow(const RowLayout &layout, const char *data, int len);
+
+    /**
+     * 增量维护：删除一行
+     * @param layout 行布局
+     * @param data 编码行
+     * @param len 编码行长度
+     */
+    void removeRow(const RowLayout &layout, const char *data, int len);
+};
+
+// ANALYZE统计构建器：逐行收集抽样，结束时生成直方图并按抽样比例修正不同值数
+class StatsBuilder {
+public:
+    /**
+     * @param layout 行布局
+     */
+    explicit StatsBuilder(const RowLayout &layout);
+
+    /**
+     * 加入一条抽样行
+     * @param data 编码行
+     * @param len 编码行长度
+     */
+    void addRow(const char *data, int len);
+
+    /**
+     * 生成表统计
+     * @param totalRows 表的总行数
+     * @param sampledPages 抽样页数
+     * @param stats 输出参数，表统计
+     */
+    void finish(int64_t totalRows, int sampledPages, TableStats &stats);
+
+private:
+    const RowLayout &layout_;
+    int64_t rows_ = 0;
+    std::vector<ColumnStats> columns_;
+    std::vector<std::vector<double>> keys_;   // 各列非空值的排序键
+};
+
+#endif // NPCBASE_STATISTICS_H
@@ -5,9 +5,13 @@
 #include "data_dict.h"
 #include "mem_manager.h"
 #include "disk_manager.h"
+#include <functional>
+#include <string>
+#include <vector>
 
 // 前向声明，避免头文件循环依赖
 class IndexManager;
+struct RowChange;
 
 // 变长记录页面头
 struct VarPageHeader {
@@ -22,10 +26,33 @@ struct VarPageHeader {
 // 记录槽信息
 struct RecordSlot {
     int offset;               // 记录在页中的偏移量
-    int length;               // 记录长度
+    int length;               // 记录长度（溢出记录为行内前缀+溢出指针的长度）
     bool isDeleted;           // 删除标记
+    bool isOverflow;          // 溢出标记：尾部数据存放在溢出链中
 };
 
+// 溢出页头（溢出文件中的每个页）
+struct OverflowPageHeader {
+    PageNum pageNum;          // 当前页号
+    PageNum nextPage;         // 链上的下一页，-1表示结束
+    int dataLen;              // 本页存储的数据长度
+};
+
+// 行内溢出指针（紧跟在行内前缀之后）
+struct ToastPointer {
+    PageNum firstPage;        // 溢出链首页
+    int totalLength;          // 记录完整长度
+};
+
+// 记录访问回调：参数为RID与完整记录（row_codec格式），返回false时停止扫描
+typedef std::function<bool(const RID&, const char*, int)> RecordVisitor;
+
+// 页过滤回调：参数为页号，返回false时扫描跳过该页
+typedef std::function<bool(PageNum)> PageFilter;
+
+// 列等值条件（列序号, 比较值），顺序扫描据此查Bloom过滤器跳过页段
+typedef std::vector<std::pair<int, Value>> ColumnEqualities;
+
 // 表管理器类
 class TableManager {
 public:
@@ -45,14 +72,24 @@ public:
      * @param tableName 表名
      * @param attrCount 属性数量
      * @param attrs 属性信息数组
+     * @param pageFormat 页面格式（行式槽目录页、列式PAX页或定长页）
      */
-    RC createTable(TransactionId txId, const char *tableName, int attrCount, const AttrInfo *attrs);
+    RC createTable(TransactionId txId, const char *tableName, int attrCount, const AttrInfo *attrs,
+                   PageFormat pageFormat = PAGE_FORMAT_SLOTTED);
 
     /**
-     * 删除表
+     * 删除表：丢弃表、溢出文件及索引的全部缓冲帧，删除文件与元数据
+     * @param txId 事务ID
      * @param tableName 表名
      */
-    RC dropTable(const char* tableName);
+    RC dropTable(TransactionId txId, const char* tableName);
+
+    /**
+     * 截断表：丢弃全部缓冲帧，重建空的表文件与索引，保留表结构和索引定义
+     * @param txId 事务ID
+     * @param tableName 表名
+     */
+    RC truncateTable(TransactionId txId, const char* tableName);
 
     /**
      * 插入记录
@@ -72,6 +109,28 @@ public:
      */
     RC deleteRecord(TransactionId txId, const char *tableName, const RID &rid);
 
+    /**
+     * 批量插入记录：逐行写数据页，整批写完后按索引排序一次维护（见IndexManager::onRecordsInserted）
+     * 唯一索引先对整批检查（含批内重复），任一行冲突时整批不插入并返回RC_DUPLICATE_KEY；
+     * 中途写行或维护索引失败时删去已写入的行，整批不插入并返回其错误码
+     * @param txId 事务ID
+     * @param tableName 表名
+     * @param rows 各行记录数据
+     * @param rids 输出参数，各行的记录ID（失败时为空）
+     */
+    RC insertRecords(TransactionId txId, const char* tableName, const std::vector<std::string>& rows, std::vector<RID>& rids);
+
+    /**
+     * 批量删除记录：逐行删除后对已删除的各行一次维护索引（见IndexManager::onRecordsDeleted）
+     * 删除前先确认各行都存在，任一行不存在时整批不删除并返回其错误码；
+     * 删除中途的I/O错误不回滚，已删除的各行保持删除
+     * @param txId 事务ID
+     * @param tableName 表名
+     * @param rids 各行记录ID（重复的只删除一次）
+     * @param deleted 输出参数，已删除的行数（出错时为出错前删除的行数）
+     */
+    RC deleteRecords(TransactionId txId, const char* tableName, const std::vector<RID>& rids, int& deleted);
+
     /**
      * 更新记录
      * @param txId 事务ID
@@ -92,11 +151,100 @@ public:
     RC readRecord(const char* tableName, const RID& rid, char*& data, int& length);
 
     /**
-     * 执行垃圾回收（Vacuum）
+     * 读取记录的部分字节（溢出记录仅在区间超出行内前缀时才访问溢出页）
+     * @param tableName 表名
+     * @param rid 记录ID
+     * @param offset 起始偏移
+     * @param len 读取长度
+     * @param out 输出缓冲区（至少len字节）
+     * @param outLen 输出参数，实际读取长度（区间超出记录末尾时截断）
+     */
+    RC readRecordRange(const char* tableName, const RID& rid, int offset, int len, char* out, int& outLen);
+
+    /**
+     * 从溢出链读取数据
+     * @param memManager 内存管理器引用
+     * @param tableId 表ID（溢出文件由表ID推导）
+     * @param firstPage 溢出链首页
+     * @param offset 溢出数据内的起始偏移
+     * @param len 读取长度
+     * @param out 输出缓冲区
+     */
+    static RC readOverflowChain(MemManager& memManager, TableId tableId, PageNum firstPage,
+                                int offset, int len, char* out);
+
+    /**
+     * 读取记录的单个列（只读取该列所在的字节区间，溢出部分按需读取）
+     * @param tableName 表名
+     * @param rid 记录ID
+     * @param column 列序号
+     * @param value 输出参数，返回列值
+     */
+    RC readColumn(const char* tableName, const RID& rid, int column, Value& value);
+
+    /**
+     * 顺序扫描表的所有有效记录（按页面格式解码，溢出记录按需拼接）
+     * 给出columns时，溢出记录只从溢出链读到这些列中最靠后的字节为止，都在行内前缀中时不访问溢出链；
+     * 此时交给visitor的可能只是行的前缀（len为前缀长度），visitor只可读取所列的列
+     * @param memManager 内存管理器引用
+     * @param dataDict 数据字典引用
+     * @param tableInfo 表信息
+     * @param visitor 记录访问回调
+     * @param pageStride 页面步长（每pageStride页访问一页，用于抽样；1为全表扫描）
+     * @param pageFilter 页过滤（为空时不跳过），被跳过的页不读入缓冲池
+     * @param columns visitor读取的列序号（为空指针时读取全部列，溢出记录拼接完整）
+     */
+    static RC scanRecords(MemManager& memManager, DataDict& dataDict, const TableInfo& tableInfo,
+                          const RecordVisitor& visitor, int pageStride = 1, const PageFilter& pageFilter = nullptr,
+                          const std::vector<int>* columns = nullptr);
+
+    /**
+     * 顺序扫描表的所有有效记录
+     * @param tableName 表名
+     * @param visitor 记录访问回调
+     */
+    RC scanTable(const char* tableName, const RecordVisitor& visitor);
+
+    /**
+     * 顺序扫描表，条件列维护了Bloom过滤器时跳过不可能含有比较值的页段
+     * （只是跳过一定不匹配的页，其余页的行仍全部交给visitor，条件由调用方检查）
+     * @param tableName 表名
+     * @param visitor 记录访问回调
+     * @param equalities 等值条件
+     * @param columns visitor读取的列序号（为空指针时读取全部列，见scanRecords）
+     */
+    RC scanTable(const char* tableName, const RecordVisitor& visitor, const ColumnEqualities& equalities,
+                 const std::vector<int>* columns = nullptr);
+
+    /**
+     * 收集表的列统计信息（经缓冲池抽样至多ANALYZE_SAMPLE_PAGES个数据页）
+     * @param tableName 表名
+     */
+    RC analyzeTable(const char* tableName);
+
+    /**
+     * 按列等值过滤（PAX表直接在连续的列数组上比较，不拼装整行）
+     * @param tableName 表名
+     * @param column 列序号
+     * @param value 比较值（空值不匹配任何行）
+     * @param rids 输出参数，返回匹配记录的RID
+     */
+    RC filterEquals(const char* tableName, int column, const Value& value, std::vector<RID>& rids);
+
+    /**
+     * 执行垃圾回收（Vacuum），并重建表的Bloom过滤器（清除已删除行留下的值）
      * @param tableName 表名
      */
     RC vacuum(const char* tableName);
 
+    /**
+     * 开启/关闭某列的Bloom过滤器（开启时扫描全表构建，此后随插入增量维护）
+     * @param tableName 表名
+     * @param column 列名
+     * @param enabled 是否维护
+     */
+    RC setBloomFilter(const char* tableName, const char* column, bool enabled);
+
 private:
     DataDict& dataDict_;      // 数据字典引用
     MemManager& memManager_;  // 内存管理器引用
@@ -128,6 +276,95 @@ private:
      */
     RC findFreeSlot(char* pageData, int length, SlotNum& slotNum);
 
+    /**
+     * 向位图页（PAX/定长）表插入记录
+     * @param txId 事务ID
+     * @param tableInfo 表信息（目录句柄中的实时信息）
+     * @param layout 行布局
+     * @param data 记录数据
+     * @param length 记录长度
+     * @param rid 输出参数，返回记录ID
+     * @param deferred 非空时不维护索引，把行追加到其中留待整批维护
+     */
+    RC insertBitmapRecord(TransactionId txId, const TableInfo& tableInfo, const RowLayout& layout,
+                          const char* data, int length, RID& rid, std::vector<RowChange>* deferred);
+
+    /**
+     * 删除位图页（PAX/定长）表中的记录
+     * @param txId 事务ID
+     * @param tableInfo 表信息
+     * @param rid 记录ID
+     * @param deferred 非空时不维护索引，把行追加到其中留待整批维护
+     */
+    RC deleteBitmapRecord(TransactionId txId, const TableInfo& tableInfo, const RID& rid, std::vector<RowChange>* deferred);
+
+    // 插入/删除一行的实现：deferred非空时（批量DML）索引不逐行维护，行追加到其中，
+    // 插入时也不再逐行检查唯一索引（已对整批检查）
+    RC insertRecord(TransactionId txId, const char* tableName, const char* data, int length, RID& rid,
+                    std::vector<RowChange>* deferred);
+    RC deleteRecord(TransactionId txId, const char* tableName, const RID& rid, std::vector<RowChange>* deferred);
+
+    /**
+     * 撤销刚写入的一行：索引维护失败（如并发插入了相同的唯一键）时删去其索引项与数据行
+     * @param cause 索引维护的错误码，撤销成功时原样返回
+     */
+    RC undoInsert(TransactionId txId, const TableInfo& tableInfo, const char* data, int length, const RID& rid, RC cause);
+
+    /**
+     * 从位图页读取一行
+     * @param tableInfo 表信息
+     * @param rid 记录ID
+     * @param row 输出参数，返回编码行
+     */
+    RC readBitmapRecord(const TableInfo& tableInfo, const RID& rid, std::string& row);
+
+    /**
+     * 固定位图页并读出有效行；成功时页面保持pin住，由调用方释放
+     * @param tableInfo 表信息
+     * @param rid 记录ID
+     * @param frame 输出参数，返回缓冲帧
+     * @param row 输出参数，返回编码行
+     */
+    RC pinBitmapRecord(const TableInfo& tableInfo, const RID& rid, BufferFrame*& frame, std::string& row);
+
+    /**
+     * 扫描全表重建Bloom过滤器（表未选定任何列时不做任何事）
+     * @param tableInfo 表信息
+     */
+    RC buildBlooms(const TableInfo& tableInfo);
+
+    /**
+     * 等值条件对应的页过滤：任一条件列的过滤器表明页所在页段不含比较值时跳过该页；
+     * 过滤器尚未构建时先构建，没有可用的条件时返回空过滤
+     * @param tableInfo 表信息
+     * @param equalities 等值条件
+     */
+    PageFilter bloomPageFilter(const TableInfo& tableInfo, const ColumnEqualities& equalities);
+
+    /**
+     * 将数据写入新的溢出链
+     * @param tableId 表ID
+     * @param data 溢出数据
+     * @param length 溢出数据长度
+     * @param firstPage 输出参数，返回溢出链首页
+     */
+    RC writeOverflowChain(TableId tableId, const char* data, int length, PageNum& firstPage);
+
+    /**
+     * 释放溢出链上的所有页
+     * @param tableId 表ID
+     * @param firstPage 溢出链首页
+     */
+    RC freeOverflowChain(TableId tableId, PageNum firstPage);
+
+    /**
+     * 将溢出链上每一页的内容写入日志（每页一条或多条LOG_OVERFLOW记录）
+     * @param txId 事务ID
+     * @param tableId 表ID
+     * @param firstPage 溢出链首页
+     */
+    RC logOverflowChain(TransactionId txId, TableId tableId, PageNum firstPage);
+
     /**
      * 计算记录所需空间
      * @param length 记录数据长度
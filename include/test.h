@@ -31,6 +31,24 @@ public:
     // 执行任务四测试：SQL解析/逻辑与物理计划
     RC runTask4();
 
+    // 执行任务五测试：节点内查找（SIMD与标量二分）的微基准
+    RC runTask5();
+
+    // 执行任务六测试：多线程并发插入索引与点查，校验最终内容并给出线程扩展性
+    RC runTask6();
+
+    // 执行任务七测试：小排序缓冲区下的外部归并排序与批量建索引，校验索引内容与临时文件清理
+    RC runTask7();
+
+    // 执行任务八测试：行编解码往返（空值与各类型），经RowView、getRowLayout、readRecord与readColumn读回
+    RC runTask8();
+
+    // 执行任务九测试：溢出行删除后插入新槽、清理与槽复用，校验其余行与溢出页不受影响
+    RC runTask9();
+
+    // 执行任务十测试：WHERE中长于列宽的字符串字面量（等值不匹配任何行，范围按截断后的字面量比较，有无索引结果一致）
+    RC runTask10();
+
 private:
     TableManager& tableManager_;
     MemManager& memManager_;
@@ -0,0 +1,531 @@
+#include "../include/art_cache.h"
+#include "../include/index_node.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+enum ArtNodeKind : uint8_t { NODE4, NODE16, NODE48, NODE256 };
+
+struct ArtCache::Node {
+    uint8_t kind;
+    uint16_t count = 0;               // 孩子数
+    uint32_t prefixLen = 0;           // 压缩路径的长度
+    uint8_t prefix[ART_MAX_PREFIX];   // 压缩路径的前ART_MAX_PREFIX字节
+};
+
+// Node4/Node16：键字节有序存放，孩子与之一一对应
+struct ArtCache::Node4 : ArtCache::Node {
+    uint8_t keys[4];
+    Child children[4];
+};
+
+struct ArtCache::Node16 : ArtCache::Node {
+    uint8_t keys[16];
+    Child children[16];
+};
+
+// Node48：按键字节直接取孩子下标（0表示无，否则为下标+1），孩子紧凑存放
+struct ArtCache::Node48 : ArtCache::Node {
+    uint8_t index[256];
+    Child children[48];
+};
+
+struct ArtCache::Node256 : ArtCache::Node {
+    Child children[256];
+};
+
+// 叶子：各项尾之后紧跟完整键（与叶子一次分配）
+struct ArtCache::Leaf {
+    std::vector<char> tails;
+};
+
+static inline bool isLeaf(uintptr_t child) { return (child & 1) != 0; }
+
+template <typename T>
+static inline T* untag(uintptr_t child) { return reinterpret_cast<T*>(child & ~(uintptr_t)1); }
+
+template <typename T>
+static inline uintptr_t tagLeaf(T* leaf) { return reinterpret_cast<uintptr_t>(leaf) | 1; }
+
+template <typename N>
+static inline void copyHeader(N* to, const N* from) {
+    to->count = from->count;
+    to->prefixLen = from->prefixLen;
+    std::memcpy(to->prefix, from->prefix, sizeof(to->prefix));
+}
+
+static inline uint64_t tailOrdinal(const char* tail) { return ridOrdinal(RID(loadInt32(tail), (SlotNum)loadInt32(tail + 4))); }
+
+ArtCache::ArtCache(int keyLen, int tailLen) : keyLen_(keyLen), tailLen_(tailLen) {}
+
+ArtCache::~ArtCache() { freeTree(root_); }
+
+ArtCache::Leaf* ArtCache::newLeaf(const char* key, const char* tail) {
+    void* mem = ::operator new(sizeof(Leaf) + keyLen_);
+    Leaf* leaf = new (mem) Leaf();
+    std::memcpy(reinterpret_cast<char*>(leaf + 1), key, keyLen_);
+    leaf->tails.assign(tail, tail + tailLen_);
+    bytes_ += sizeof(Leaf) + keyLen_ + tailLen_;
+    return leaf;
+}
+
+void ArtCache::freeLeaf(Leaf* leaf) {
+    bytes_ -= sizeof(Leaf) + keyLen_ + leaf->tails.size();
+    leaf->~Leaf();
+    ::operator delete(leaf);
+}
+
+ArtCache::Node* ArtCache::newNode(uint8_t kind) {
+    Node* node;
+    size_t size;
+    switch (kind) {
+        case NODE4: node = new Node4(); size = sizeof(Node4); break;
+        case NODE16: node = new Node16(); size = sizeof(Node16); break;
+        case NODE48: node = new Node48(); size = sizeof(Node48); break;
+        default: node = new Node256(); size = sizeof(Node256); break;
+    }
+    node->kind = kind;
+    bytes_ += size;
+    return node;
+}
+
+void ArtCache::freeNode(Node* node) {
+    switch (node->kind) {
+        case NODE4: bytes_ -= sizeof(Node4); delete static_cast<Node4*>(node); break;
+        case NODE16: bytes_ -= sizeof(Node16); delete static_cast<Node16*>(node); break;
+        case NODE48: bytes_ -= sizeof(Node48); delete static_cast<Node48*>(node); break;
+        default: bytes_ -= sizeof(Node256); delete static_cast<Node256*>(node); break;
+    }
+}
+
+void ArtCache::freeTree(Child child) {
+    if (child == 0) return;
+    if (isLeaf(child)) {
+        freeLeaf(untag<Leaf>(child));
+        return;
+    }
+    Node* node = untag<Node>(child);
+    switch (node->kind) {
+        case NODE4: for (int i = 0; i < node->count; ++i) freeTree(static_cast<Node4*>(node)->children[i]); break;
+        case NODE16: for (int i = 0; i < node->count; ++i) freeTree(static_cast<Node16*>(node)->children[i]); break;
+        case NODE48: for (int i = 0; i < node->count; ++i) freeTree(static_cast<Node48*>(node)->children[i]); break;
+        default: for (Child c : static_cast<Node256*>(node)->children) freeTree(c); break;
+    }
+    freeNode(node);
+}
+
+const char* ArtCache::leafKey(const Leaf* leaf) const {
+    return reinterpret_cast<const char*>(leaf + 1);
+}
+
+const ArtCache::Leaf* ArtCache::minimumLeaf(Child child) const {
+    while (!isLeaf(child)) {
+        Node* node = untag<Node>(child);
+        switch (node->kind) {
+            case NODE4: child = static_cast<Node4*>(node)->children[0]; break;
+            case NODE16: child = static_cast<Node16*>(node)->children[0]; break;
+            case NODE48: {
+                auto* n = static_cast<Node48*>(node);
+                int b = 0;
+                while (n->index[b] == 0) ++b;
+                child = n->children[n->index[b] - 1];
+                break;
+            }
+            default: {
+                auto* n = static_cast<Node256*>(node);
+                int b = 0;
+                while (n->children[b] == 0) ++b;
+                child = n->children[b];
+                break;
+            }
+        }
+    }
+    return untag<Leaf>(child);
+}
+
+// 节点前缀与key[depth...]第一个不同的位置（全部相同时为prefixLen）；超出存放部分的前缀取自子树中任一叶子的完整键
+int ArtCache::prefixMismatch(const Node* node, const char* key, int depth) const {
+    int stored = std::min<int>(node->prefixLen, ART_MAX_PREFIX);
+    for (int i = 0; i < stored; ++i) {
+        if (node->prefix[i] != (uint8_t)key[depth + i]) return i;
+    }
+    if ((int)node->prefixLen > stored) {
+        const char* full = leafKey(minimumLeaf(reinterpret_cast<Child>(node)));
+        for (int i = stored; i < (int)node->prefixLen; ++i) {
+            if (full[depth + i] != key[depth + i]) return i;
+        }
+    }
+    return node->prefixLen;
+}
+
+ArtCache::Child* ArtCache::findChild(Node* node, uint8_t byte) const {
+    switch (node->kind) {
+        case NODE4: {
+            auto* n = static_cast<Node4*>(node);
+            for (int i = 0; i < n->count; ++i) {
+                if (n->keys[i] == byte) return &n->children[i];
+            }
+            return nullptr;
+        }
+        case NODE16: {
+            auto* n = static_cast<Node16*>(node);
+#ifdef __SSE2__
+            // 16个键字节一次比较
+            __m128i eq = _mm_cmpeq_epi8(_mm_set1_epi8((char)byte), _mm_loadu_si128(reinterpret_cast<const __m128i*>(n->keys)));
+            unsigned mask = (unsigned)_mm_movemask_epi8(eq) & ((1u << n->count) - 1);
+            return mask ? &n->children[__builtin_ctz(mask)] : nullptr;
+#else
+            for (int i = 0; i < n->count; ++i) {
+                if (n->keys[i] == byte) return &n->children[i];
+            }
+            return nullptr;
+#endif
+        }
+        case NODE48: {
+            auto* n = static_cast<Node48*>(node);
+            return n->index[byte] ? &n->children[n->index[byte] - 1] : nullptr;
+        }
+        default: {
+            auto* n = static_cast<Node256*>(node);
+            return n->children[byte] ? &n->children[byte] : nullptr;
+        }
+    }
+}
+
+// 在有序的键字节数组中插入：keys/children容量须有空位
+template <typename N>
+static void insertSorted(N* n, uint8_t byte, uintptr_t child) {
+    int pos = 0;
+    while (pos < n->count && n->keys[pos] < byte) ++pos;
+    std::memmove(n->keys + pos + 1, n->keys + pos, n->count - pos);
+    std::memmove(n->children + pos + 1, n->children + pos, (n->count - pos) * sizeof(uintptr_t));
+    n->keys[pos] = byte;
+    n->children[pos] = child;
+    n->count++;
+}
+
+template <typename N>
+static void eraseSorted(N* n, int pos) {
+    std::memmove(n->keys + pos, n->keys + pos + 1, n->count - pos - 1);
+    std::memmove(n->children + pos, n->children + pos + 1, (n->count - pos - 1) * sizeof(uintptr_t));
+    n->count--;
+}
+
+// ref为指向node的孩子槽（或根），节点已满时换成更大的节点
+void ArtCache::addChild(Child* ref, Node* node, uint8_t byte, Child child) {
+    switch (node->kind) {
+        case NODE4: {
+            auto* n = static_cast<Node4*>(node);
+            if (n->count < 4) {
+                insertSorted(n, byte, child);
+                return;
+            }
+            auto* grown = static_cast<Node16*>(newNode(NODE16));
+            copyHeader<Node>(grown, n);
+            std::memcpy(grown->keys, n->keys, 4);
+            std::memcpy(grown->children, n->children, 4 * sizeof(Child));
+            insertSorted(grown, byte, child);
+            *ref = reinterpret_cast<Child>(grown);
+            freeNode(n);
+            return;
+        }
+        case NODE16: {
+            auto* n = static_cast<Node16*>(node);
+            if (n->count < 16) {
+                insertSorted(n, byte, child);
+                return;
+            }
+            auto* grown = static_cast<Node48*>(newNode(NODE48));
+            copyHeader<Node>(grown, n);
+            for (int i = 0; i < 16; ++i) {
+                grown->index[n->keys[i]] = (uint8_t)(i + 1);
+                grown->children[i] = n->children[i];
+            }
+            grown->index[byte] = (uint8_t)(grown->count + 1);
+            grown->children[grown->count++] = child;
+            *ref = reinterpret_cast<Child>(grown);
+            freeNode(n);
+            return;
+        }
+        case NODE48: {
+            auto* n = static_cast<Node48*>(node);
+            if (n->count < 48) {
+                n->index[byte] = (uint8_t)(n->count + 1);
+                n->children[n->count++] = child;
+                return;
+            }
+            auto* grown = static_cast<Node256*>(newNode(NODE256));
+            copyHeader<Node>(grown, n);
+            for (int b = 0; b < 256; ++b) {
+                if (n->index[b]) grown->children[b] = n->children[n->index[b] - 1];
+            }
+            grown->children[byte] = child;
+            grown->count++;
+            *ref = reinterpret_cast<Child>(grown);
+            freeNode(n);
+            return;
+        }
+        default: {
+            auto* n = static_cast<Node256*>(node);
+            n->children[byte] = child;
+            n->count++;
+            return;
+        }
+    }
+}
+
+// 删去byte处的孩子，孩子数降到下一档容量以下时换成更小的节点；Node4只剩一个孩子时与之合并
+void ArtCache::removeChild(Child* ref, Node* node, uint8_t byte) {
+    switch (node->kind) {
+        case NODE4: {
+            auto* n = static_cast<Node4*>(node);
+            int pos = 0;
+            while (n->keys[pos] != byte) ++pos;
+            eraseSorted(n, pos);
+            if (n->count > 1) return;
+            Child only = n->children[0];
+            if (!isLeaf(only)) {
+                // 合并路径：本节点前缀 + 键字节 + 孩子前缀
+                Node* c = untag<Node>(only);
+                uint8_t merged[ART_MAX_PREFIX];
+                int len = std::min<int>(n->prefixLen, ART_MAX_PREFIX);
+                std::memcpy(merged, n->prefix, len);
+                if (len < ART_MAX_PREFIX) merged[len++] = n->keys[0];
+                int take = std::min<int>(c->prefixLen, ART_MAX_PREFIX - len);
+                std::memcpy(merged + len, c->prefix, take);
+                len += take;
+                c->prefixLen += n->prefixLen + 1;
+                std::memcpy(c->prefix, merged, len);
+            }
+            *ref = only;
+            freeNode(n);
+            return;
+        }
+        case NODE16: {
+            auto* n = static_cast<Node16*>(node);
+            int pos = 0;
+            while (n->keys[pos] != byte) ++pos;
+            eraseSorted(n, pos);
+            if (n->count > 3) return;
+            auto* shrunk = static_cast<Node4*>(newNode(NODE4));
+            copyHeader<Node>(shrunk, n);
+            std::memcpy(shrunk->keys, n->keys, n->count);
+            std::memcpy(shrunk->children, n->children, n->count * sizeof(Child));
+            *ref = reinterpret_cast<Child>(shrunk);
+            freeNode(n);
+            return;
+        }
+        case NODE48: {
+            auto* n = static_cast<Node48*>(node);
+            int slot = n->index[byte] - 1;
+            n->index[byte] = 0;
+            int last = n->count - 1;
+            if (slot != last) {
+                // 最后一个孩子移入空出的位置
+                n->children[slot] = n->children[last];
+                for (int b = 0; b < 256; ++b) {
+                    if (n->index[b] == last + 1) { n->index[b] = (uint8_t)(slot + 1); break; }
+                }
+            }
+            n->count--;
+            if (n->count > 12) return;
+            auto* shrunk = static_cast<Node16*>(newNode(NODE16));
+            copyHeader<Node>(shrunk, n);
+            int i = 0;
+            for (int b = 0; b < 256; ++b) {
+                if (!n->index[b]) continue;
+                shrunk->keys[i] = (uint8_t)b;
+                shrunk->children[i++] = n->children[n->index[b] - 1];
+            }
+            *ref = reinterpret_cast<Child>(shrunk);
+            freeNode(n);
+            return;
+        }
+        default: {
+            auto* n = static_cast<Node256*>(node);
+            n->children[byte] = 0;
+            n->count--;
+            if (n->count > 37) return;
+            auto* shrunk = static_cast<Node48*>(newNode(NODE48));
+            copyHeader<Node>(shrunk, n);
+            int i = 0;
+            for (int b = 0; b < 256; ++b) {
+                if (!n->children[b]) continue;
+                shrunk->index[b] = (uint8_t)(i + 1);
+                shrunk->children[i++] = n->children[b];
+            }
+            *ref = reinterpret_cast<Child>(shrunk);
+            freeNode(n);
+            return;
+        }
+    }
+}
+
+bool ArtCache::addTail(Leaf* leaf, const char* tail) {
+    uint64_t id = tailOrdinal(tail);
+    int n = (int)(leaf->tails.size() / tailLen_);
+    int lo = 0, hi = n;
+    while (lo < hi) {
+        int mid = (lo + hi) >> 1;
+        if (tailOrdinal(leaf->tails.data() + (size_t)mid * tailLen_) < id) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo < n && tailOrdinal(leaf->tails.data() + (size_t)lo * tailLen_) == id) return false;
+    leaf->tails.insert(leaf->tails.begin() + (size_t)lo * tailLen_, tail, tail + tailLen_);
+    entries_++;
+    bytes_ += tailLen_;
+    return true;
+}
+
+bool ArtCache::removeTail(Leaf* leaf, const RID& rid) {
+    uint64_t id = ridOrdinal(rid);
+    size_t n = leaf->tails.size() / tailLen_;
+    for (size_t i = 0; i < n; ++i) {
+        if (tailOrdinal(leaf->tails.data() + i * tailLen_) != id) continue;
+        auto at = leaf->tails.begin() + i * tailLen_;
+        leaf->tails.erase(at, at + tailLen_);
+        entries_--;
+        bytes_ -= tailLen_;
+        return true;
+    }
+    return false;
+}
+
+bool ArtCache::insert(const char* key, const char* tail) {
+    Child* ref = &root_;
+    int depth = 0;
+    while (true) {
+        Child child = *ref;
+        if (child == 0) {
+            *ref = tagLeaf(newLeaf(key, tail));
+            keys_++;
+            entries_++;
+            return true;
+        }
+        if (isLeaf(child)) {
+            Leaf* leaf = untag<Leaf>(child);
+            const char* other = leafKey(leaf);
+            if (std::memcmp(other, key, keyLen_) == 0) return addTail(leaf, tail);
+            // 两键自depth起的公共部分成为新节点的前缀，在第一个不同的字节处分开
+            int p = depth;
+            while (other[p] == key[p]) ++p;
+            Node* node = newNode(NODE4);
+            node->prefixLen = p - depth;
+            std::memcpy(node->prefix, key + depth, std::min<int>(node->prefixLen, ART_MAX_PREFIX));
+            *ref = reinterpret_cast<Child>(node);
+            addChild(ref, node, (uint8_t)other[p], child);
+            addChild(ref, node, (uint8_t)key[p], tagLeaf(newLeaf(key, tail)));
+            keys_++;
+            entries_++;
+            return true;
+        }
+        Node* node = untag<Node>(child);
+        if (node->prefixLen > 0) {
+            int m = prefixMismatch(node, key, depth);
+            if (m < (int)node->prefixLen) {
+                // 在前缀中途分开：前m字节留给新的父节点，原节点保留分开处之后的部分
+                Node* parent = newNode(NODE4);
+                parent->prefixLen = m;
+                std::memcpy(parent->prefix, key + depth, std::min(m, ART_MAX_PREFIX));
+                uint8_t edge;
+                if (node->prefixLen <= ART_MAX_PREFIX) {
+                    edge = node->prefix[m];
+                    node->prefixLen -= m + 1;
+                    std::memmove(node->prefix, node->prefix + m + 1, node->prefixLen);
+                } else {
+                    const char* full = leafKey(minimumLeaf(child));
+                    edge = (uint8_t)full[depth + m];
+                    node->prefixLen -= m + 1;
+                    std::memcpy(node->prefix, full + depth + m + 1, std::min<int>(node->prefixLen, ART_MAX_PREFIX));
+                }
+                *ref = reinterpret_cast<Child>(parent);
+                addChild(ref, parent, edge, child);
+                addChild(ref, parent, (uint8_t)key[depth + m], tagLeaf(newLeaf(key, tail)));
+                keys_++;
+                entries_++;
+                return true;
+            }
+            depth += node->prefixLen;
+        }
+        Child* next = findChild(node, (uint8_t)key[depth]);
+        if (!next) {
+            addChild(ref, node, (uint8_t)key[depth], tagLeaf(newLeaf(key, tail)));
+            keys_++;
+            entries_++;
+            return true;
+        }
+        ref = next;
+        depth++;
+    }
+}
+
+bool ArtCache::remove(const char* key, const RID& rid) {
+    if (root_ == 0) return false;
+    if (isLeaf(root_)) {
+        Leaf* leaf = untag<Leaf>(root_);
+        if (std::memcmp(leafKey(leaf), key, keyLen_) != 0 || !removeTail(leaf, rid)) return false;
+        if (leaf->tails.empty()) {
+            freeLeaf(leaf);
+            root_ = 0;
+            keys_--;
+        }
+        return true;
+    }
+    Child* ref = &root_;
+    int depth = 0;
+    while (true) {
+        Node* node = untag<Node>(*ref);
+        int stored = std::min<int>(node->prefixLen, ART_MAX_PREFIX);
+        for (int i = 0; i < stored; ++i) {
+            if (node->prefix[i] != (uint8_t)key[depth + i]) return false;
+        }
+        depth += node->prefixLen;
+        uint8_t byte = (uint8_t)key[depth];
+        Child* next = findChild(node, byte);
+        if (!next) return false;
+        if (isLeaf(*next)) {
+            Leaf* leaf = untag<Leaf>(*next);
+            if (std::memcmp(leafKey(leaf), key, keyLen_) != 0 || !removeTail(leaf, rid)) return false;
+            if (leaf->tails.empty()) {
+                freeLeaf(leaf);
+                keys_--;
+                removeChild(ref, node, byte);
+            }
+            return true;
+        }
+        ref = next;
+        depth++;
+    }
+}
+
+bool ArtCache::lookup(const char* key, std::vector<char>& out, bool first) const {
+    Child child = root_;
+    int depth = 0;
+    while (child != 0) {
+        if (isLeaf(child)) {
+            // 下降时只比较了前缀的存放部分，在叶子处确认完整键
+            const Leaf* leaf = untag<Leaf>(child);
+            if (std::memcmp(leafKey(leaf), key, keyLen_) != 0) return false;
+            size_t n = first ? 1 : leaf->tails.size() / tailLen_;
+            for (size_t i = 0; i < n; ++i) {
+                out.insert(out.end(), key, key + keyLen_);
+                out.insert(out.end(), leaf->tails.begin() + i * tailLen_, leaf->tails.begin() + (i + 1) * tailLen_);
+            }
+            return true;
+        }
+        Node* node = untag<Node>(child);
+        int stored = std::min<int>(node->prefixLen, ART_MAX_PREFIX);
+        for (int i = 0; i < stored; ++i) {
+            if (node->prefix[i] != (uint8_t)key[depth + i]) return false;
+        }
+        depth += node->prefixLen;
+        Child* next = findChild(node, (uint8_t)key[depth]);
+        if (!next) return false;
+        child = *next;
+        depth++;
+    }
+    return false;
+}
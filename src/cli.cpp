@@ -60,10 +60,22 @@ void CLI::executeCommand(const std::string& cmd, const std::vector<std::string>&
         handleTest(args);
     } else if (cmd == "create" && args.size() >= 2 && args[0] == "table") {
         handleCreateTable(args);
+    } else if (cmd == "drop" && args.size() >= 2 && args[0] == "table") {
+        handleDropTable(args);
+    } else if (cmd == "truncate") {
+        handleTruncate(args);
     } else if (cmd == "create" && args.size() >= 2 && args[0] == "index") {
         handleCreateIndex(args);
     } else if (cmd == "show" && args.size() >= 2 && args[0] == "index") {
         handleShowIndex(args);
+    } else if (cmd == "cache" && args.size() >= 1 && args[0] == "index") {
+        handleCacheIndex(args);
+    } else if (cmd == "bloom") {
+        handleBloom(args);
+    } else if (cmd == "show" && args.size() >= 2 && args[0] == "stats") {
+        handleShowStats(args);
+    } else if (cmd == "analyze") {
+        handleAnalyze(args);
     } else if (cmd == "insert") {
         handleInsert(args);
     } else if (cmd == "delete") {
@@ -74,6 +86,8 @@ void CLI::executeCommand(const std::string& cmd, const std::vector<std::string>&
         handleSelect(args);
     } else if (cmd == "vacuum") {
         handleVacuum(args);
+    } else if (cmd == "checkpoint") {
+        handleCheckpoint();
     } else {
         std::cout << "Unknown command. Type 'help' for available commands." << std::endl;
     }
@@ -81,14 +95,21 @@ void CLI::executeCommand(const std::string& cmd, const std::vector<std::string>&
 
 void CLI::printHelp() {
     std::cout << "Available commands:" << std::endl;
-    std::cout << "  create table <table_name> (<attr_name> <type> [<length>], ...) - Create a new table" << std::endl;
-    std::cout << "  create index <index_name> on <table_name>(<column_name>) [unique] - Create a B+tree index" << std::endl;
+    std::cout << "  create table <table_name> (<attr_name> <type> [<length>], ...) [using pax|fixed] - Create a new table" << std::endl;
+    std::cout << "  drop table <table_name> - Drop a table with its indexes and files" << std::endl;
+    std::cout << "  truncate [table] <table_name> - Remove all rows, keeping the schema and indexes" << std::endl;
+    std::cout << "  create index <index_name> on <table_name>(<column_name>[, ...]) [include (<column_name>, ...)] [using btree|hash] [unique] [where <column_name> <op> <literal> [and ...]] - Create an index (B+tree by default; hash serves equality only; key columns may be lower(<column_name>) or substr(<column_name>, 1, <n>); where makes it partial)" << std::endl;
     std::cout << "  show index <index_name> - Show index page contents" << std::endl;
-    std::cout << "  insert into <table_name> values (...) - Insert a new record" << std::endl;
-    std::cout << "  delete from <table_name> where rid=<page>:<slot> - Delete a record" << std::endl;
+    std::cout << "  cache index <index_name> on|off - Mirror a B+tree index in memory (ART) for point lookups" << std::endl;
+    std::cout << "  bloom <table_name> <column_name> on|off - Keep per-segment Bloom filters on a column to skip pages in equality scans" << std::endl;
+    std::cout << "  analyze <table_name> - Collect column statistics for the optimizer" << std::endl;
+    std::cout << "  show stats <table_name> - Show column statistics" << std::endl;
+    std::cout << "  insert into <table_name> values (...)[, (...) ...] - Insert records (several rows maintain indexes as one sorted batch)" << std::endl;
+    std::cout << "  delete from <table_name> where rid=<page>:<slot>[,<page>:<slot> ...] - Delete records (several rows maintain indexes as one sorted batch)" << std::endl;
     std::cout << "  update <table_name> set ... where rid=<page>:<slot> - Update a record" << std::endl;
     std::cout << "  select from <table_name> where rid=<page>:<slot> - Retrieve a record" << std::endl;
     std::cout << "  vacuum <table_name> - Perform garbage collection" << std::endl;
+    std::cout << "  checkpoint - Persist table statistics and flush dirty pages" << std::endl;
     std::cout << "  test <task_idx> - Run a test task" << std::endl;
     std::cout << "  help - Show this help message" << std::endl;
     std::cout << "  exit - Quit the CLI" << std::endl;
@@ -108,6 +129,18 @@ void CLI::handleTest(const std::vector<std::string> &args) {
         test_.runTask3();
     } else if (args[0] == "4") {
         test_.runTask4();
+    } else if (args[0] == "5") {
+        test_.runTask5();
+    } else if (args[0] == "6") {
+        test_.runTask6();
+    } else if (args[0] == "7") {
+        test_.runTask7();
+    } else if (args[0] == "8") {
+        test_.runTask8();
+    } else if (args[0] == "9") {
+        test_.runTask9();
+    } else if (args[0] == "10") {
+        test_.runTask10();
     } else {
         std::cout << "Invalid test number. This task is not available" << std::endl;
         return;
@@ -116,10 +149,26 @@ void CLI::handleTest(const std::vector<std::string> &args) {
 
 void CLI::handleCreateTable(const std::vector<std::string>& args) {
     if (args.size() < 2) {
-        std::cout << "Usage: create table <table_name> (<attr_name> <type> [<length>], ...)" << std::endl;
+        std::cout << "Usage: create table <table_name> (<attr_name> <type> [<length>], ...) [using pax|fixed]" << std::endl;
         return;
     }
 
+    // 可选的页面格式子句：using pax / using fixed
+    std::vector<std::string> attrArgs(args);
+    PageFormat pageFormat = PAGE_FORMAT_SLOTTED;
+    if (attrArgs.size() >= 4 && attrArgs[attrArgs.size() - 2] == "using") {
+        const std::string& format = attrArgs.back();
+        if (format == "pax") {
+            pageFormat = PAGE_FORMAT_PAX;
+        } else if (format == "fixed") {
+            pageFormat = PAGE_FORMAT_FIXED;
+        } else if (format != "slotted") {
+            std::cout << "Unknown page format: " << format << std::endl;
+            return;
+        }
+        attrArgs.resize(attrArgs.size() - 2);
+    }
+
     // 辅助函数：清理字符串中的括号和逗号
     auto cleanSymbol = [](const std::string& s) {
         std::string res;
@@ -131,25 +180,25 @@ void CLI::handleCreateTable(const std::vector<std::string>& args) {
         return res;
     };
 
-    std::string tableName = cleanSymbol(args[1]);
+    std::string tableName = cleanSymbol(attrArgs[1]);
     std::vector<AttrInfo> attrs;
 
     // 解析属性列表（带符号清理）
-    for (size_t i = 2; i < args.size(); ) {
+    for (size_t i = 2; i < attrArgs.size(); ) {
         // 清理属性名中的符号（可能包含'(', ')'等）
-        std::string attrName = cleanSymbol(args[i]);
+        std::string attrName = cleanSymbol(attrArgs[i]);
         if (attrName.empty()) {  // 跳过空字符串（纯符号的情况）
             i++;
             continue;
         }
 
-        if (i + 1 >= args.size()) {
+        if (i + 1 >= attrArgs.size()) {
             std::cout << "Missing type for attribute: " << attrName << std::endl;
             return;
         }
 
         // 清理类型中的符号（可能包含','等）
-        std::string typeStr = cleanSymbol(args[i+1]);
+        std::string typeStr = cleanSymbol(attrArgs[i+1]);
         if (typeStr.empty()) {
             std::cout << "Invalid type for attribute: " << attrName << std::endl;
             return;
@@ -172,8 +221,8 @@ void CLI::handleCreateTable(const std::vector<std::string>& args) {
             attr.type = STRING;
             attr.length = 255;  // 默认长度
             // 检查是否有指定长度
-            if (i + 2 < args.size()) {
-                std::string lenStr = cleanSymbol(args[i+2]);
+            if (i + 2 < attrArgs.size()) {
+                std::string lenStr = cleanSymbol(attrArgs[i+2]);
                 if (!lenStr.empty()) {
                     try {
                         attr.length = std::stoi(lenStr);
@@ -200,34 +249,141 @@ void CLI::handleCreateTable(const std::vector<std::string>& args) {
     }
 
     // TODO: 实际应从事务管理器获取txId
-    RC rc = tableManager_.createTable(1, tableName.c_str(), (int)attrs.size(), attrs.data());
+    RC rc = tableManager_.createTable(1, tableName.c_str(), (int)attrs.size(), attrs.data(), pageFormat);
     if (rc == RC_OK) {
         std::cout << "Table " << tableName << " created successfully" << std::endl;
     } else if (rc == RC_TABLE_EXISTS) {
         std::cout << "Error: Table " << tableName << " already exists" << std::endl;
+    } else if (rc == RC_RECORD_TOO_LONG) {
+        std::cout << "Error: rows of table " << tableName << " are too wide for the requested page format" << std::endl;
     } else {
         std::cout << "Error creating table: " << rc << std::endl;
     }
 }
 
+void CLI::handleDropTable(const std::vector<std::string>& args) {
+    if (args.size() != 2) {
+        std::cout << "Usage: drop table <table_name>" << std::endl;
+        return;
+    }
+
+    // TODO: 实际应从事务管理器获取txId
+    RC rc = tableManager_.dropTable(1, args[1].c_str());
+    if (rc == RC_OK) {
+        std::cout << "Table " << args[1] << " dropped" << std::endl;
+    } else if (rc == RC_TABLE_NOT_FOUND) {
+        std::cout << "Error: Table " << args[1] << " not found" << std::endl;
+    } else {
+        std::cout << "Error dropping table: " << rc << std::endl;
+    }
+}
+
+void CLI::handleTruncate(const std::vector<std::string>& args) {
+    // Syntax: truncate [table] <table_name>
+    size_t nameIdx = (!args.empty() && args[0] == "table") ? 1 : 0;
+    if (args.size() != nameIdx + 1) {
+        std::cout << "Usage: truncate [table] <table_name>" << std::endl;
+        return;
+    }
+
+    const std::string& tableName = args[nameIdx];
+    RC rc = tableManager_.truncateTable(1, tableName.c_str());
+    if (rc == RC_OK) {
+        std::cout << "Table " << tableName << " truncated" << std::endl;
+    } else if (rc == RC_TABLE_NOT_FOUND) {
+        std::cout << "Error: Table " << tableName << " not found" << std::endl;
+    } else {
+        std::cout << "Error truncating table: " << rc << std::endl;
+    }
+}
+
 void CLI::handleInsert(const std::vector<std::string>& args) {
     if (args.size() < 3 || args[0] != "into" || args[2] != "values") {
-        std::cout << "Usage: insert into <table_name> values (...) - Insert a new record" << std::endl;
+        std::cout << "Usage: insert into <table_name> values (...)[, (...) ...] - Insert records" << std::endl;
         return;
     }
     
     std::string tableName = args[1];
-    // 简化实现：假设数据是一个字符串
-    std::string data;
+    std::string valueList;
     for (size_t i = 3; i < args.size(); i++) {
-        if (i > 3) data += " ";
-        data += args[i];
+        if (i > 3) valueList += " ";
+        valueList += args[i];
     }
-    
-    RID rid;
-    RC rc = tableManager_.insertRecord(0, tableName.c_str(), data.c_str(), (int)data.length(), rid);
-    if (rc == RC_OK) {
-        std::cout << "Record inserted with RID: " << rid.pageNum << ":" << rid.slotNum << std::endl;
+
+    // 拆分值列表：每个括号内为一行，按引号外的逗号切分；多行时整批插入
+    std::vector<std::vector<std::string>> tuples;
+    std::vector<std::string> literals;
+    std::string cur;
+    char quote = 0;
+    bool inTuple = false;
+    bool invalid = false;
+    for (char c : valueList) {
+        if (quote) {
+            if (c == quote) quote = 0; else cur += c;
+        } else if (!inTuple) {
+            // 括号之间只允许空格与逗号
+            if (c == '(') inTuple = true;
+            else if (c != ' ' && c != ',') invalid = true;
+        } else if (c == '\'' || c == '"') {
+            quote = c;
+        } else if (c == ',' || c == ')') {
+            while (!cur.empty() && cur.back() == ' ') cur.pop_back();
+            literals.push_back(cur); cur.clear();
+            if (c == ')') { tuples.push_back(literals); literals.clear(); inTuple = false; }
+        } else if (c != ' ' || !cur.empty()) {
+            cur += c;
+        }
+    }
+    if (invalid || tuples.empty() || inTuple || quote) {
+        std::cout << "Invalid VALUES clause. Expect (<v1>, <v2>, ...)[, (...) ...]" << std::endl;
+        return;
+    }
+
+    // 按表结构编码
+    TableInfo ti;
+    if (dataDict_.findTable(tableName.c_str(), ti) != RC_OK) {
+        std::cout << "Table not found: " << tableName << std::endl;
+        return;
+    }
+    const RowLayout* layout = nullptr;
+    dataDict_.getRowLayout(ti.tableId, layout);
+    std::vector<std::string> rows;
+    for (const auto& tuple : tuples) {
+        if ((int)tuple.size() != ti.attrCount) {
+            std::cout << "Expected " << ti.attrCount << " values, got " << tuple.size() << std::endl;
+            return;
+        }
+        std::vector<Value> values(ti.attrCount);
+        for (int i = 0; i < ti.attrCount; ++i) {
+            if (parseValue(ti.attrs[i], tuple[i], values[i]) != RC_OK) {
+                std::cout << "Invalid value for column " << ti.attrs[i].name << ": " << tuple[i] << std::endl;
+                return;
+            }
+        }
+        std::string data;
+        RC rc = encodeRow(*layout, values, data);
+        if (rc != RC_OK) {
+            std::cout << "Error encoding record: " << rc << std::endl;
+            return;
+        }
+        rows.push_back(data);
+    }
+
+    RC rc;
+    std::vector<RID> rids(1);
+    if (rows.size() == 1) {
+        rc = tableManager_.insertRecord(0, tableName.c_str(), rows[0].data(), (int)rows[0].length(), rids[0]);
+    } else {
+        rc = tableManager_.insertRecords(0, tableName.c_str(), rows, rids);
+    }
+    if (rc == RC_OK && rows.size() == 1) {
+        std::cout << "Record inserted with RID: " << rids[0].pageNum << ":" << rids[0].slotNum << std::endl;
+    } else if (rc == RC_OK) {
+        std::cout << rids.size() << " records inserted" << std::endl;
+    } else if (rc == RC_DUPLICATE_KEY) {
+        std::cout << "Error inserting record: duplicate key violates a unique index" << std::endl;
+    } else if (rows.size() > 1) {
+        std::cout << "Error inserting records: " << rc << " (no rows inserted)" << std::endl;
     } else {
         std::cout << "Error inserting record: " << rc << std::endl;
     }
@@ -235,31 +391,48 @@ void CLI::handleInsert(const std::vector<std::string>& args) {
 
 void CLI::handleDelete(const std::vector<std::string>& args) {
     if (args.size() < 4 || args[0] != "from" || args[2] != "where" || args[3].substr(0, 4) != "rid=") {
-        std::cout << "Usage: delete from <table_name> where rid=<page>:<slot>" << std::endl;
+        std::cout << "Usage: delete from <table_name> where rid=<page>:<slot>[,<page>:<slot> ...]" << std::endl;
         return;
     }
     
     std::string tableName = args[1];
-    std::string ridStr = args[3].substr(4);
-    size_t colonPos = ridStr.find(':');
-    if (colonPos == std::string::npos) {
-        std::cout << "Invalid RID format. Use <page>:<slot>" << std::endl;
-        return;
-    }
-    
+    std::string ridList = args[3].substr(4);
+    for (size_t i = 4; i < args.size(); i++) ridList += args[i];
+
+    // 多个RID以逗号分隔，整批删除
+    std::vector<RID> rids;
     try {
-        PageNum pageNum = std::stoi(ridStr.substr(0, colonPos));
-        SlotNum slotNum = std::stoi(ridStr.substr(colonPos + 1));
-        RID rid(pageNum, slotNum);
-        
-        RC rc = tableManager_.deleteRecord(0, tableName.c_str(), rid);
-        if (rc == RC_OK) {
-            std::cout << "Record deleted successfully" << std::endl;
-        } else {
-            std::cout << "Error deleting record: " << rc << std::endl;
+        size_t start = 0;
+        while (start <= ridList.size()) {
+            size_t comma = ridList.find(',', start);
+            if (comma == std::string::npos) comma = ridList.size();
+            std::string ridStr = ridList.substr(start, comma - start);
+            size_t colonPos = ridStr.find(':');
+            if (colonPos == std::string::npos) {
+                std::cout << "Invalid RID format. Use <page>:<slot>" << std::endl;
+                return;
+            }
+            PageNum pageNum = std::stoi(ridStr.substr(0, colonPos));
+            SlotNum slotNum = std::stoi(ridStr.substr(colonPos + 1));
+            rids.push_back(RID(pageNum, slotNum));
+            start = comma + 1;
         }
     } catch (...) {
         std::cout << "Invalid RID format" << std::endl;
+        return;
+    }
+
+    int deleted = 0;
+    RC rc = rids.size() == 1 ? tableManager_.deleteRecord(0, tableName.c_str(), rids[0])
+                             : tableManager_.deleteRecords(0, tableName.c_str(), rids, deleted);
+    if (rc == RC_OK && rids.size() == 1) {
+        std::cout << "Record deleted successfully" << std::endl;
+    } else if (rc == RC_OK) {
+        std::cout << deleted << " records deleted" << std::endl;
+    } else if (deleted > 0) {
+        std::cout << "Error deleting records: " << rc << " (" << deleted << " records deleted before the error)" << std::endl;
+    } else {
+        std::cout << "Error deleting record: " << rc << std::endl;
     }
 }
 
@@ -311,7 +484,14 @@ void CLI::handleSelect(const std::vector<std::string>& args) {
             RID rid(pageNum, slotNum);
             char* data = nullptr; int length = 0;
             RC rc = tableManager_.readRecord(tableName.c_str(), rid, data, length);
-            if (rc == RC_OK) { std::cout << "Record data: " << std::string(data, length) << std::endl; delete[] data; }
+            TableInfo ti; const RowLayout* layout = nullptr;
+            if (rc == RC_OK && dataDict_.findTable(tableName.c_str(), ti) == RC_OK && dataDict_.getRowLayout(ti.tableId, layout) == RC_OK) {
+                RowView row(*layout, data, length); Value v;
+                std::cout << "Record data:";
+                for (int i = 0; i < ti.attrCount; ++i) { row.getValue(i, v); std::cout << " " << ti.attrs[i].name << "=" << valueToString(v); }
+                std::cout << std::endl; delete[] data;
+            }
+            else if (rc == RC_OK) { std::cout << "Record data: " << std::string(data, length) << std::endl; delete[] data; }
             else { std::cout << "Error reading record: " << rc << std::endl; }
         } catch (...) { std::cout << "Invalid RID format" << std::endl; }
         return;
@@ -326,9 +506,9 @@ void CLI::handleSelect(const std::vector<std::string>& args) {
     std::cout << "[Parse Tree] SELECT columns=";
     for (size_t i=0;i<parseRes.select.columns.size();++i){ if(i) std::cout << ", "; std::cout << parseRes.select.columns[i]; }
     std::cout << " FROM " << parseRes.select.table;
-    if (parseRes.select.where.has_value()) {
-        const auto& w = parseRes.select.where.value();
-        std::cout << " WHERE " << w.column << " " << w.op << " '" << w.literal << "'";
+    for (size_t i = 0; i < parseRes.select.where.size(); ++i) {
+        const auto& w = parseRes.select.where[i];
+        std::cout << (i == 0 ? " WHERE " : " AND ") << w.column << " " << w.op << " '" << w.literal << "'";
     }
     std::cout << std::endl;
 
@@ -355,6 +535,19 @@ void CLI::handleSelect(const std::vector<std::string>& args) {
     // Physical plan
     auto phys = buildPhysicalPlan(opt.optimized, dataDict_, indexManager_);
     std::cout << "[Physical Plan Steps]\n" << printPhysicalPlan(phys);
+
+    // 执行计划并输出结果
+    std::cout << "[Result]" << std::endl;
+    int rows = 0;
+    RC rc = executePhysicalPlan(phys, dataDict_, tableManager_, indexManager_, [&](const RID& rid, const std::vector<Value>& values) {
+        std::cout << "RID(" << rid.pageNum << ":" << rid.slotNum << ")";
+        for (const auto& v : values) std::cout << " " << valueToString(v);
+        std::cout << std::endl;
+        rows++;
+        return true;
+    });
+    if (rc != RC_OK) { std::cout << "Error executing plan: " << rc << std::endl; return; }
+    std::cout << rows << " row(s)" << std::endl;
 }
 
 void CLI::handleVacuum(const std::vector<std::string>& args) {
@@ -372,10 +565,67 @@ void CLI::handleVacuum(const std::vector<std::string>& args) {
     }
 }
 
+void CLI::handleAnalyze(const std::vector<std::string>& args) {
+    if (args.size() != 1) {
+        std::cout << "Usage: analyze <table_name>" << std::endl;
+        return;
+    }
+
+    RC rc = tableManager_.analyzeTable(args[0].c_str());
+    if (rc == RC_OK) {
+        std::cout << "Analyze completed" << std::endl;
+    } else {
+        std::cout << "Error during analyze: " << rc << std::endl;
+    }
+}
+
+void CLI::handleShowStats(const std::vector<std::string>& args) {
+    // Syntax: show stats <table>
+    if (args.size() != 2) {
+        std::cout << "Usage: show stats <table_name>" << std::endl;
+        return;
+    }
+
+    TableRef table;
+    const TableStats* stats = nullptr;
+    if (dataDict_.getTable(args[1].c_str(), table) != RC_OK) {
+        std::cout << "Table not found: " << args[1] << std::endl;
+        return;
+    }
+    if (dataDict_.getTableStats(table->info.tableId, stats) != RC_OK) {
+        std::cout << "No statistics for " << args[1] << ", run 'analyze " << args[1] << "' first" << std::endl;
+        return;
+    }
+
+    const TableInfo& ti = table->info;
+    std::cout << "Table: " << ti.tableName << ", Rows: " << ti.recordCount << ", Sampled rows: " << stats->sampledRows
+              << " (" << stats->sampledPages << " pages), Modified since analyze: " << stats->modifiedRows << std::endl;
+    for (int i = 0; i < ti.attrCount && i < (int)stats->columns.size(); ++i) {
+        const ColumnStats& col = stats->columns[i];
+        std::cout << "  " << ti.attrs[i].name << ": ndv=" << (int64_t)col.distinct()
+                  << ", null_frac=" << col.nullFraction();
+        if (col.hasMinMax) {
+            std::cout << ", min=" << valueToString(col.minValue) << ", max=" << valueToString(col.maxValue);
+        }
+        std::cout << ", buckets=" << (col.bounds.empty() ? 0 : (int)col.bounds.size() - 1) << std::endl;
+    }
+}
+
+void CLI::handleCheckpoint() {
+    RC rc = dataDict_.checkpoint();
+    if (rc == RC_OK) {
+        std::cout << "Checkpoint completed" << std::endl;
+    } else {
+        std::cout << "Error during checkpoint: " << rc << std::endl;
+    }
+}
+
 void CLI::handleCreateIndex(const std::vector<std::string> &args) {
-    // Syntax: create index <index_name> on <table>(<column>) [unique]
+    // Syntax: create index <index_name> on <table>(<column>[, <column> ...]) [include (<column>, ...)] [using btree|hash] [unique]
+    //        [where <column> <op> <literal> [and ...]]
+    // 键列可以是 lower(<column>) 或 substr(<column>, 1, <n>)
     if (args.size() < 4 || args[2] != "on") {
-        std::cout << "Usage: create index <index_name> on <table>(<column>) [unique]" << std::endl;
+        std::cout << "Usage: create index <index_name> on <table>(<column>[, ...]) [include (<column>, ...)] [using btree|hash] [unique] [where <column> <op> <literal> [and ...]]" << std::endl;
         return;
     }
     std::string indexName = args[1];
@@ -384,9 +634,13 @@ void CLI::handleCreateIndex(const std::vector<std::string> &args) {
         if (!tableAndCol.empty()) tableAndCol += " ";
         tableAndCol += args[i];
     }
-    // parse table and column
+    // parse table and column（键列可以是表达式，取与左括号配对的右括号）
     auto lpar = tableAndCol.find('(');
-    auto rpar = tableAndCol.find(')');
+    auto rpar = std::string::npos;
+    for (size_t i = lpar, depth = 0; lpar != std::string::npos && i < tableAndCol.size(); ++i) {
+        if (tableAndCol[i] == '(') depth++;
+        if (tableAndCol[i] == ')' && --depth == 0) { rpar = i; break; }
+    }
     if (lpar == std::string::npos || rpar == std::string::npos || rpar <= lpar) {
         std::cout << "Invalid ON clause. Expect <table>(<column>)" << std::endl;
         return;
@@ -400,12 +654,119 @@ void CLI::handleCreateIndex(const std::vector<std::string> &args) {
         if (b == std::string::npos) return std::string();
         return s.substr(b, e - b + 1);
     };
+    // 按括号外的逗号拆分（substr(name, 1, 3)内的逗号不拆）
+    auto splitColumns = [&trim](const std::string& list){
+        std::vector<std::string> cols;
+        size_t start = 0;
+        int depth = 0;
+        for (size_t i = 0; i <= list.size(); ++i) {
+            if (i < list.size() && list[i] == '(') depth++;
+            if (i < list.size() && list[i] == ')') depth--;
+            if (i < list.size() && (list[i] != ',' || depth > 0)) continue;
+            std::string c = trim(list.substr(start, i - start));
+            if (!c.empty()) cols.push_back(c);
+            start = i + 1;
+        }
+        return cols;
+    };
     tableName = trim(tableName);
     columnName = trim(columnName);
+    std::vector<std::string> keyColumns = splitColumns(columnName);
+
+    // 其余子句按词法单元解析：关键字须是括号与引号之外的完整单词（列名或字面量中出现unique、where等不误判）
+    std::string rest = tableAndCol.substr(rpar + 1);
+    size_t pos = 0;
+    // 取下一个词法单元：配对括号括起的整组、引号串，或不含空格与左括号的单词；末尾返回空串
+    auto nextToken = [&rest, &pos]() {
+        while (pos < rest.size() && rest[pos] == ' ') pos++;
+        size_t start = pos;
+        if (pos < rest.size() && rest[pos] == '(') {
+            for (int depth = 0; pos < rest.size(); ++pos) {
+                if (rest[pos] == '(') depth++;
+                if (rest[pos] == ')' && --depth == 0) { ++pos; break; }
+            }
+        } else if (pos < rest.size() && (rest[pos] == '\'' || rest[pos] == '"')) {
+            size_t close = rest.find(rest[pos], pos + 1);
+            pos = close == std::string::npos ? rest.size() : close + 1;
+        } else {
+            while (pos < rest.size() && rest[pos] != ' ' && rest[pos] != '(') pos++;
+        }
+        return rest.substr(start, pos - start);
+    };
 
-    bool unique = tableAndCol.find("unique") != std::string::npos;
+    std::vector<std::string> includeColumns;
+    bool unique = false;
+    IndexMethod method = IndexMethod::BTREE;
+    bool hasWhere = false;
+    std::string whereText;
+    for (std::string token = nextToken(); !token.empty(); token = nextToken()) {
+        if (token == "unique") {
+            unique = true;
+        } else if (token == "include") {
+            // include (...)：仅存放在叶子中的覆盖列
+            std::string group = nextToken();
+            if (group.size() < 2 || group.front() != '(' || group.back() != ')') {
+                std::cout << "Invalid INCLUDE clause. Expect include (<column>, ...)" << std::endl;
+                return;
+            }
+            includeColumns = splitColumns(group.substr(1, group.size() - 2));
+        } else if (token == "using") {
+            // 访问方法：using btree / using hash
+            std::string name = nextToken();
+            if (name == "hash") {
+                method = IndexMethod::HASH;
+            } else if (name != "btree") {
+                std::cout << "Unknown index method: " << name << std::endl;
+                return;
+            }
+        } else if (token == "where") {
+            // where 放在最后，其后都是谓词
+            hasWhere = true;
+            whereText = rest.substr(pos);
+            break;
+        } else {
+            std::cout << "Unexpected token in CREATE INDEX: " << token << std::endl;
+            return;
+        }
+    }
 
-    RC rc = indexManager_.createIndex(1, indexName.c_str(), tableName.c_str(), columnName.c_str(), unique);
+    // 可选的 where <列> <op> <字面量> [and ...]（部分索引）
+    std::vector<IndexCondition> where;
+    if (hasWhere) {
+        std::istringstream whereIn(whereText);
+        std::string token;
+        IndexCondition cond;
+        while (whereIn >> token) {
+            if (token == "and" || token == "AND") continue;
+            // 列与运算符可以连写（status='open'），拆出运算符
+            size_t opPos = token.find_first_of("=!<>");
+            if (cond.column.empty() && opPos != std::string::npos && opPos > 0) {
+                cond.column = token.substr(0, opPos);
+                token = token.substr(opPos);
+            }
+            if (cond.column.empty()) { cond.column = token; continue; }
+            if (cond.op.empty()) {
+                size_t opLen = token.find_first_not_of("=!<>");
+                cond.op = token.substr(0, opLen);
+                if (opLen == std::string::npos) continue;
+                token = token.substr(opLen);
+            }
+            std::string literal = token;
+            if (literal.size() >= 2 && (literal.front() == '\'' || literal.front() == '"') && literal.back() == literal.front()) {
+                literal = literal.substr(1, literal.size() - 2);
+            }
+            cond.literal = literal;
+            where.push_back(cond);
+            cond = IndexCondition();
+        }
+        if (!cond.column.empty() || where.empty()) {
+            std::cout << "Invalid WHERE clause. Expect where <column> <op> <literal> [and ...]" << std::endl;
+            return;
+        }
+    }
+
+    RC rc = indexManager_.createIndex(1, indexName.c_str(), tableName.c_str(), keyColumns, includeColumns, unique,
+                                      INDEX_BUILD_FILL_PCT, method, where);
     if (rc == RC_OK) {
         std::cout << "Index " << indexName << " created on " << tableName << "(" << columnName << ")" << std::endl;
     } else if (rc == RC_TABLE_EXISTS) {
@@ -414,11 +775,47 @@ void CLI::handleCreateIndex(const std::vector<std::string> &args) {
         std::cout << "Table not found: " << tableName << std::endl;
     } else if (rc == RC_ATTR_NOT_FOUND) {
         std::cout << "Column not found: " << columnName << std::endl;
+    } else if (rc == RC_INVALID_ARG) {
+        std::cout << "Invalid index columns or predicate (duplicate, too many, or unsupported expression)" << std::endl;
     } else {
         std::cout << "Failed to create index. RC=" << rc << std::endl;
     }
 }
 
+void CLI::handleCacheIndex(const std::vector<std::string> &args) {
+    if (args.size() != 3 || (args[2] != "on" && args[2] != "off")) {
+        std::cout << "Usage: cache index <index_name> on|off" << std::endl;
+        return;
+    }
+    RC rc = indexManager_.setIndexCache(args[1].c_str(), args[2] == "on");
+    if (rc == RC_OK) {
+        std::cout << "ART cache " << (args[2] == "on" ? "enabled" : "disabled") << " for index " << args[1] << std::endl;
+    } else if (rc == RC_TABLE_NOT_FOUND) {
+        std::cout << "Index not found: " << args[1] << std::endl;
+    } else if (rc == RC_INVALID_ARG) {
+        std::cout << "Only B+tree indexes can be cached" << std::endl;
+    } else {
+        std::cout << "Failed to set index cache. RC=" << rc << std::endl;
+    }
+}
+
+void CLI::handleBloom(const std::vector<std::string> &args) {
+    if (args.size() != 3 || (args[2] != "on" && args[2] != "off")) {
+        std::cout << "Usage: bloom <table_name> <column_name> on|off" << std::endl;
+        return;
+    }
+    RC rc = tableManager_.setBloomFilter(args[0].c_str(), args[1].c_str(), args[2] == "on");
+    if (rc == RC_OK) {
+        std::cout << "Bloom filter " << (args[2] == "on" ? "enabled" : "disabled") << " on " << args[0] << "(" << args[1] << ")" << std::endl;
+    } else if (rc == RC_TABLE_NOT_FOUND) {
+        std::cout << "Table not found: " << args[0] << std::endl;
+    } else if (rc == RC_ATTR_NOT_FOUND) {
+        std::cout << "Column not found: " << args[1] << std::endl;
+    } else {
+        std::cout << "Failed to set bloom filter. RC=" << rc << std::endl;
+    }
+}
+
 void CLI::handleShowIndex(const std::vector<std::string> &args) {
     if (args.size() != 2) {
         std::cout << "Usage: show index <index_name>" << std::endl;
@@ -1,4 +1,5 @@
 #include "../include/data_dict.h"
+#include "../include/index_manager.h"
 #include <cstring>
 #include <algorithm>
 #include <iostream>
@@ -13,14 +14,32 @@ DataDict::DataDict(DiskManager &diskManager, MemManager &memManager, LogManager
 
 RC DataDict::init() {
     // 初始化数据字典（从磁盘的DICT_TABLE_ID顺序读取TableInfo，简化实现）
+    std::unique_lock<std::shared_mutex> guard(catalogMutex_);
     tables_.clear();
+    tableIdByName_.clear();
     indexes_.clear();
+    supersededIndexes_.clear();
+    indexIdByName_.clear();
+    tableIndexIds_.clear();
     tableIdToDictPage_.clear();
+    dirtyTables_.clear();
+    tableStats_.clear();
+    tableBlooms_.clear();
+    rowLayouts_.clear();
+    paxLayouts_.clear();
+    fixedLayouts_.clear();
     blockOffsets_.clear();
-    indexMetaBlockOffsets_.clear();
+    indexMetaSlots_.clear();
+    indexMetaFreeSlots_.clear();
     nextTableId_ = 1;
     nextIndexId_ = 10000;
 
+    // 0) 检查磁盘格式版本：不符时不读取任何元数据
+    for (TableId fileId : {DICT_TABLE_ID, INDEX_META_TABLE_ID}) {
+        RC rc = checkFormatVersion(fileId);
+        if (rc != RC_OK) return rc;
+    }
+
     // 1) 加载表元数据
     BlockNum blockNum = 0;
     char blockData[BLOCK_SIZE];
@@ -37,7 +56,7 @@ RC DataDict::init() {
         while (offset + (int)sizeof(TableInfo) <= BLOCK_SIZE) {
             auto *table = reinterpret_cast<TableInfo *>(blockData + offset);
             if (table->tableId != 0) {
-                tables_.push_back(*table);
+                addTableEntry(*table);
                 tableIdToDictPage_[table->tableId] = blockNum;
                 if (table->tableId >= nextTableId_) nextTableId_ = table->tableId + 1;
             }
@@ -70,66 +89,82 @@ RC DataDict::init() {
     }
 
     // 2) 加载索引元数据（sys_indexes）
+    // 早期版本每次更新都追加一条记录，同一索引可能有多个版本，以最后出现的为准；全零记录为空闲槽
     BlockNum idxBlock = 0;
-    bool anyIndexRead = false;
-    std::unordered_map<std::string, IndexInfo> lastByName;
+    int entryCount = 0;
+    std::unordered_map<std::string, std::pair<IndexInfo, std::pair<BlockNum, int>>> lastByName;
+    std::vector<std::pair<BlockNum, int>> freeSlots;
 
     while (true) {
         RC rc = diskManager_.readBlock(INDEX_META_TABLE_ID, idxBlock, blockData);
         if (rc != RC_OK) break;
-        anyIndexRead = true;
-        int offset = 0;
-        while (offset + (int)sizeof(IndexInfo) <= BLOCK_SIZE) {
+        for (int offset = 0; offset + (int)sizeof(IndexInfo) <= BLOCK_SIZE; offset += sizeof(IndexInfo)) {
             auto* idx = reinterpret_cast<IndexInfo*>(blockData + offset);
             if (idx->indexId != 0 && idx->indexName[0] != '\0') {
-                lastByName[std::string(idx->indexName)] = *idx; // 覆盖为最新
+                lastByName[std::string(idx->indexName)] = {*idx, {idxBlock, offset}}; // 覆盖为最新
                 if (idx->indexId >= nextIndexId_) nextIndexId_ = idx->indexId + 1;
+                entryCount++;
+            } else {
+                freeSlots.push_back({idxBlock, offset});
             }
-            offset += sizeof(IndexInfo);
         }
-        indexMetaBlockOffsets_[idxBlock] = (offset % BLOCK_SIZE);
         idxBlock++;
     }
 
-    indexes_.clear();
-    indexes_.reserve(lastByName.size());
-    for (auto& kv : lastByName) indexes_.push_back(kv.second);
+    // 按索引ID（即创建顺序）登记，保证表的索引列表顺序稳定
+    std::vector<IndexInfo> loaded;
+    loaded.reserve(lastByName.size());
+    for (auto& kv : lastByName) loaded.push_back(kv.second.first);
+    std::sort(loaded.begin(), loaded.end(), [](const IndexInfo& a, const IndexInfo& b) {
+        return a.indexId < b.indexId;
+    });
+    indexes_.reserve(loaded.size());
+    for (const auto& idx : loaded) addIndexEntry(idx);
+
+    // 存在旧版本或文件块数多于所需时重建文件，此后启动开销只与索引数量有关
+    int perBlock = BLOCK_SIZE / (int)sizeof(IndexInfo);
+    int neededBlocks = ((int)loaded.size() + perBlock - 1) / perBlock;
+    if (entryCount > (int)loaded.size() || idxBlock > neededBlocks) {
+        return compactIndexMeta(loaded);
+    }
 
-    if (!anyIndexRead) {
-        // 初始化索引元数据块
-        BlockNum newBlock;
-        RC rc = diskManager_.allocBlock(INDEX_META_TABLE_ID, newBlock);
-        if (rc != RC_OK) return rc;
-        indexMetaCurrentBlock_ = newBlock;
-        indexMetaBlockOffsets_[indexMetaCurrentBlock_] = 0;
-    } else {
-        BlockNum last = (idxBlock == 0) ? 0 : (idxBlock - 1);
-        int lastOffset = indexMetaBlockOffsets_[last];
-        if (lastOffset + (int)sizeof(IndexInfo) > BLOCK_SIZE) {
-            BlockNum newBlock;
-            RC rc = diskManager_.allocBlock(INDEX_META_TABLE_ID, newBlock);
-            if (rc != RC_OK) return rc;
-            indexMetaCurrentBlock_ = newBlock;
-            indexMetaBlockOffsets_[indexMetaCurrentBlock_] = 0;
-        } else {
-            indexMetaCurrentBlock_ = last;
-        }
+    for (auto& kv : lastByName) {
+        indexMetaSlots_[kv.second.first.indexId] = kv.second.second;
     }
+    // 空闲槽按位置逆序存放，分配时从块首开始
+    std::reverse(freeSlots.begin(), freeSlots.end());
+    indexMetaFreeSlots_ = std::move(freeSlots);
 
     return RC_OK;
 }
 
+RC DataDict::checkFormatVersion(TableId fileId) {
+    RC rc = diskManager_.openTableFile(fileId);
+    if (rc != RC_OK) return rc;
+    TableFileHeader header;
+    rc = diskManager_.readTableFileHeader(fileId, header);
+    if (rc != RC_OK) return rc;
+    if (header.magic != DB_FILE_MAGIC || header.formatVersion != DB_FORMAT_VERSION) {
+        std::cerr << "Database file '" << diskManager_.getFilePath(fileId) << "' has on-disk format version "
+                  << (header.magic == DB_FILE_MAGIC ? std::to_string(header.formatVersion) : std::string("unknown"))
+                  << ", this build expects version " << DB_FORMAT_VERSION
+                  << "; recreate the database with this build" << std::endl;
+        return RC_FORMAT_MISMATCH;
+    }
+    return RC_OK;
+}
+
 RC DataDict::createTable(TransactionId txId, const char *tableName, int attrCount, const AttrInfo *attrs,
-                         TableId &tableId) {
+                         TableId &tableId, PageFormat pageFormat) {
     // 1. 参数有效性检查
     if (tableName == nullptr || strlen(tableName) >= MAX_TABLE_NAME_LEN ||
         attrCount <= 0 || attrCount > MAX_ATTRS_PER_TABLE || attrs == nullptr) {
         return RC_INVALID_ARG;
     }
 
-    // 2. 检查表是否已存在
-    TableInfo temp;
-    if (findTable(tableName, temp) == RC_OK) {
+    // 2. 检查表是否已存在（持写锁直到登记完成，同名的并发建表只有一个成功）
+    std::unique_lock<std::shared_mutex> guard(catalogMutex_);
+    if (tableIdByName_.count(tableName)) {
         return RC_TABLE_EXISTS;
     }
 
@@ -144,6 +179,8 @@ RC DataDict::createTable(TransactionId txId, const char *tableName, int attrCoun
     table.lastPage = -1;
     table.deletedCount = 0;
     table.recordCount = 0;
+    table.pageFormat = pageFormat;
+    table.bloomColumns = 0;
 
     // 4. 创建文件并将元数据写入内存管理器的数据字典缓存区
     RC rc = diskManager_.createTableFile(table.tableId);
@@ -159,7 +196,7 @@ RC DataDict::createTable(TransactionId txId, const char *tableName, int attrCoun
     }
 
     // 5. 内存缓存（供快速查询，非必须但推荐）
-    tables_.push_back(table);
+    addTableEntry(table);
 
     // 6. 记录日志（用于故障恢复）
     logManager_.writeCreateTableLog(txId, table.tableId, tableName, attrCount, attrs);
@@ -213,90 +250,417 @@ RC DataDict::dropTable(TransactionId txId, const char *tableName) {
         return RC_INVALID_ARG;
     }
 
-    auto it = std::find_if(tables_.begin(), tables_.end(), [tableName](const TableInfo &table) {
-        return strcmp(table.tableName, tableName) == 0;
-    });
+    std::unique_lock<std::shared_mutex> guard(catalogMutex_);
+    auto nameIt = tableIdByName_.find(tableName);
+    if (nameIt == tableIdByName_.end()) {
+        return RC_TABLE_NOT_FOUND;
+    }
 
+    TableId tableId = nameIt->second;
+    std::shared_ptr<TableEntry> entry = tables_.at(tableId);
+
+    // 删除该表的索引元数据
+    auto listIt = tableIndexIds_.find(tableId);
+    if (listIt != tableIndexIds_.end()) {
+        std::vector<TableId> indexIds = listIt->second;
+        for (TableId indexId : indexIds) {
+            eraseIndexMeta(indexId);
+            removeIndexEntry(indexId);
+        }
+        tableIndexIds_.erase(tableId);
+    }
+
+    // 清除字典页中的表记录（init时跳过tableId为0的记录）
+    RC rc = rewriteDictEntry(tableId, nullptr);
+    if (rc != RC_OK) {
+        return rc;
+    }
+
+    logManager_.writeDropTableLog(txId, tableId, tableName);
+
+    rowLayouts_.erase(tableId);
+    paxLayouts_.erase(tableId);
+    fixedLayouts_.erase(tableId);
+    tableIdToDictPage_.erase(tableId);
+    dirtyTables_.erase(tableId);
+    tableStats_.erase(tableId);
+    tableBlooms_.erase(tableId);
+    tableIdByName_.erase(nameIt);
+    tables_.erase(tableId);
+
+    // 已持有句柄者据此得知表已删除
+    entry->version++;
+    entry->dropped = true;
+    return RC_OK;
+}
+
+RC DataDict::truncateTable(TransactionId txId, TableId tableId) {
+    std::unique_lock<std::shared_mutex> guard(catalogMutex_);
+    auto it = tables_.find(tableId);
     if (it == tables_.end()) {
         return RC_TABLE_NOT_FOUND;
     }
 
-    tables_.erase(it);
+    TableInfo table = it->second->info;
+    table.firstPage = -1;
+    table.lastPage = -1;
+    table.deletedCount = 0;
+    table.recordCount = 0;
+    replaceTableEntry(it->second, table, true);
+    RC rc = rewriteDictEntry(tableId, &table);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    dirtyTables_.erase(tableId);
+    tableStats_.erase(tableId);
+    tableBlooms_.erase(tableId);
+    logManager_.writeTruncateTableLog(txId, tableId, table.tableName);
     return RC_OK;
 }
 
+RC DataDict::rewriteDictEntry(TableId tableId, const TableInfo *table) {
+    auto pageIt = tableIdToDictPage_.find(tableId);
+    if (pageIt == tableIdToDictPage_.end()) {
+        return RC_TABLE_NOT_FOUND;
+    }
+
+    BufferFrame *frame = nullptr;
+    RC rc = memManager_.getPage(DICT_TABLE_ID, pageIt->second, frame, DICT_SPACE);
+    if (rc != RC_OK) {
+        return rc;
+    }
+
+    rc = RC_TABLE_NOT_FOUND;
+    for (int offset = 0; offset + (int)sizeof(TableInfo) <= BLOCK_SIZE; offset += sizeof(TableInfo)) {
+        auto *entry = reinterpret_cast<TableInfo *>(frame->data + offset);
+        if (entry->tableId != tableId) continue;
+        if (table != nullptr) {
+            *entry = *table;
+        } else {
+            memset(entry, 0, sizeof(TableInfo));
+        }
+        memManager_.markDirty(DICT_TABLE_ID, pageIt->second);
+        rc = RC_OK;
+        break;
+    }
+    memManager_.releasePage(DICT_TABLE_ID, pageIt->second);
+    return rc;
+}
+
 RC DataDict::findTable(const char *tableName, TableInfo &tableInfo) {
     if (tableName == nullptr) {
         return RC_INVALID_ARG;
     }
 
     // 仅从内存缓存查找（初始化时已加载）
-    for (const auto &table : tables_) {
-        if (strcmp(table.tableName, tableName) == 0) {
-            tableInfo = table;
-            return RC_OK;
-        }
+    std::shared_lock<std::shared_mutex> guard(catalogMutex_);
+    auto nameIt = tableIdByName_.find(tableName);
+    if (nameIt == tableIdByName_.end()) {
+        return RC_TABLE_NOT_FOUND;
     }
-    return RC_TABLE_NOT_FOUND;
+    tableInfo = tables_.at(nameIt->second)->info;
+    return RC_OK;
 }
 
 RC DataDict::findTableById(TableId tableId, TableInfo &tableInfo) {
-    for (const auto &table: tables_) {
-        if (table.tableId == tableId) {
-            tableInfo = table;
+    std::shared_lock<std::shared_mutex> guard(catalogMutex_);
+    auto it = tables_.find(tableId);
+    if (it == tables_.end()) {
+        return RC_TABLE_NOT_FOUND;
+    }
+    tableInfo = it->second->info;
+    return RC_OK;
+}
+
+RC DataDict::getTable(const char *tableName, TableRef &table) {
+    if (tableName == nullptr) {
+        return RC_INVALID_ARG;
+    }
+
+    std::shared_lock<std::shared_mutex> guard(catalogMutex_);
+    auto nameIt = tableIdByName_.find(tableName);
+    if (nameIt == tableIdByName_.end()) {
+        return RC_TABLE_NOT_FOUND;
+    }
+    table = tables_.at(nameIt->second);
+    return RC_OK;
+}
+
+RC DataDict::getTableById(TableId tableId, TableRef &table) {
+    std::shared_lock<std::shared_mutex> guard(catalogMutex_);
+    auto it = tables_.find(tableId);
+    if (it == tables_.end()) {
+        return RC_TABLE_NOT_FOUND;
+    }
+    table = it->second;
+    return RC_OK;
+}
+
+RC DataDict::updateTableInfo(TableId tableId, PageNum lastPage) {
+    std::unique_lock<std::shared_mutex> guard(catalogMutex_);
+    auto it = tables_.find(tableId);
+    if (it == tables_.end()) {
+        return RC_TABLE_NOT_FOUND;
+    }
+
+    TableInfo table = it->second->info;
+    if (table.firstPage == -1) {
+        table.firstPage = lastPage;
+    }
+    table.lastPage = lastPage;
+    replaceTableEntry(it->second, table, false);
+    dirtyTables_.insert(tableId);
+    return RC_OK;
+}
+
+RC DataDict::adjustRecordCount(TableId tableId, int delta) {
+    std::unique_lock<std::shared_mutex> guard(catalogMutex_);
+    auto it = tables_.find(tableId);
+    if (it == tables_.end()) {
+        return RC_TABLE_NOT_FOUND;
+    }
+
+    TableInfo table = it->second->info;
+    table.recordCount += delta;
+    replaceTableEntry(it->second, table, false);
+    dirtyTables_.insert(tableId);
+    return RC_OK;
+}
+
+RC DataDict::checkpoint() {
+    // 逐行更新只修改内存，此处按表批量原地写回（每个表只改写一次字典记录）
+    {
+        std::unique_lock<std::shared_mutex> guard(catalogMutex_);
+        for (TableId tableId : dirtyTables_) {
+            auto it = tables_.find(tableId);
+            if (it == tables_.end()) {
+                continue;
+            }
+            RC rc = rewriteDictEntry(tableId, &it->second->info);
+            if (rc != RC_OK) {
+                return rc;
+            }
+        }
+        dirtyTables_.clear();
+    }
+    return memManager_.flushAllPages();
+}
+
+RC DataDict::listTables(std::vector<std::string> &tables) {
+    tables.clear();
+    std::shared_lock<std::shared_mutex> guard(catalogMutex_);
+    // 按表ID（即创建顺序）输出
+    std::vector<TableId> ids;
+    ids.reserve(tables_.size());
+    for (const auto &kv: tables_) {
+        ids.push_back(kv.first);
+    }
+    std::sort(ids.begin(), ids.end());
+    tables.reserve(ids.size());
+    for (TableId id: ids) {
+        tables.push_back(std::string(tables_.at(id)->info.tableName));
+    }
+    return RC_OK;
+}
+
+RC DataDict::getRowLayout(TableId tableId, const RowLayout *&layout) {
+    {
+        std::shared_lock<std::shared_mutex> guard(catalogMutex_);
+        auto it = rowLayouts_.find(tableId);
+        if (it != rowLayouts_.end()) {
+            layout = &it->second;
             return RC_OK;
         }
     }
+    TableInfo table;
+    RC rc = findTableById(tableId, table);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    RowLayout computed;
+    rc = computed.init(table.attrCount, table.attrs);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    std::unique_lock<std::shared_mutex> guard(catalogMutex_);
+    layout = &rowLayouts_.emplace(tableId, computed).first->second;   // 已被并发登记时沿用已有的（元素地址不随插入改变）
+    return RC_OK;
+}
 
-    return RC_TABLE_NOT_FOUND;
+RC DataDict::getPaxLayout(TableId tableId, const PaxLayout *&layout) {
+    {
+        std::shared_lock<std::shared_mutex> guard(catalogMutex_);
+        auto it = paxLayouts_.find(tableId);
+        if (it != paxLayouts_.end()) {
+            layout = &it->second;
+            return RC_OK;
+        }
+    }
+    const RowLayout *row = nullptr;
+    RC rc = getRowLayout(tableId, row);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    PaxLayout computed;
+    rc = computed.init(*row);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    std::unique_lock<std::shared_mutex> guard(catalogMutex_);
+    layout = &paxLayouts_.emplace(tableId, computed).first->second;
+    return RC_OK;
 }
 
-RC DataDict::updateTableInfo(TableId tableId, PageNum lastPage, int recordCount) {
-    for (auto &table: tables_) {
-        if (table.tableId == tableId) {
-            if (table.firstPage == -1) {
-                table.firstPage = lastPage;
-            }
-            table.lastPage = lastPage;
-            table.recordCount = recordCount;
+RC DataDict::getFixedLayout(TableId tableId, const FixedLayout *&layout) {
+    {
+        std::shared_lock<std::shared_mutex> guard(catalogMutex_);
+        auto it = fixedLayouts_.find(tableId);
+        if (it != fixedLayouts_.end()) {
+            layout = &it->second;
             return RC_OK;
         }
     }
+    const RowLayout *row = nullptr;
+    RC rc = getRowLayout(tableId, row);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    FixedLayout computed;
+    rc = computed.init(*row);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    std::unique_lock<std::shared_mutex> guard(catalogMutex_);
+    layout = &fixedLayouts_.emplace(tableId, computed).first->second;
+    return RC_OK;
+}
 
-    return RC_TABLE_NOT_FOUND;
+RC DataDict::setTableStats(TableId tableId, TableStats &&stats) {
+    TableRef table;
+    if (getTableById(tableId, table) != RC_OK) {
+        return RC_TABLE_NOT_FOUND;
+    }
+    tableStats_[tableId] = std::move(stats);
+    return RC_OK;
 }
 
-RC DataDict::listTables(std::vector<std::string> &tables) {
-    tables.clear();
-    for (const auto &table: tables_) {
-        tables.push_back(std::string(table.tableName));
+RC DataDict::getTableStats(TableId tableId, const TableStats *&stats) {
+    auto it = tableStats_.find(tableId);
+    if (it == tableStats_.end()) {
+        return RC_TABLE_NOT_FOUND;
     }
+    stats = &it->second;
     return RC_OK;
 }
 
-RC DataDict::createIndexMetadata(TransactionId txId, const char *indexName, const char *tableName,
-                                 const char *columnName, bool unique, IndexInfo &outIndex) {
-    if (!indexName || !tableName || !columnName) return RC_INVALID_ARG;
+void DataDict::onRowInserted(TableId tableId, PageNum page, const char *data, int len) {
+    auto it = tableStats_.find(tableId);
+    auto bloomIt = tableBlooms_.find(tableId);
+    const RowLayout *layout = nullptr;
+    if ((it == tableStats_.end() && bloomIt == tableBlooms_.end()) || getRowLayout(tableId, layout) != RC_OK) {
+        return;
+    }
+    if (it != tableStats_.end()) {
+        it->second.addRow(*layout, data, len);
+    }
+    if (bloomIt != tableBlooms_.end()) {
+        bloomIt->second.addRow(*layout, page, data, len);
+    }
+}
 
-    // 检查同名索引
-    for (const auto& idx : indexes_) {
-        if (strcmp(idx.indexName, indexName) == 0) return RC_TABLE_EXISTS; // 复用错误码表示已存在
+void DataDict::onRowDeleted(TableId tableId, const char *data, int len) {
+    auto it = tableStats_.find(tableId);
+    const RowLayout *layout = nullptr;
+    if (it == tableStats_.end() || getRowLayout(tableId, layout) != RC_OK) {
+        return;
     }
+    it->second.removeRow(*layout, data, len);
+}
 
-    // 表和列合法性
-    TableInfo tableInfo;
-    RC rc = findTable(tableName, tableInfo);
-    if (rc != RC_OK) return rc;
+RC DataDict::setBloomColumns(TableId tableId, uint32_t columns) {
+    std::unique_lock<std::shared_mutex> guard(catalogMutex_);
+    auto it = tables_.find(tableId);
+    if (it == tables_.end()) {
+        return RC_TABLE_NOT_FOUND;
+    }
+
+    TableInfo table = it->second->info;
+    table.bloomColumns = columns;
+    replaceTableEntry(it->second, table, true);
+    tableBlooms_.erase(tableId);
+    return rewriteDictEntry(tableId, &table);
+}
+
+RC DataDict::setTableBlooms(TableId tableId, TableBlooms &&blooms) {
+    TableRef table;
+    if (getTableById(tableId, table) != RC_OK) {
+        return RC_TABLE_NOT_FOUND;
+    }
+    tableBlooms_.erase(tableId);
+    tableBlooms_.emplace(tableId, std::move(blooms));
+    return RC_OK;
+}
+
+RC DataDict::getTableBlooms(TableId tableId, const TableBlooms *&blooms) {
+    auto it = tableBlooms_.find(tableId);
+    if (it == tableBlooms_.end()) {
+        return RC_TABLE_NOT_FOUND;
+    }
+    blooms = &it->second;
+    return RC_OK;
+}
+
+RC DataDict::createIndexMetadata(TransactionId txId, const char *indexName, const char *tableName,
+                                 const std::vector<std::string> &keyColumns, const std::vector<std::string> &includeColumns,
+                                 bool unique, IndexMethod method, const std::vector<IndexPredicate> &predicates,
+                                 IndexInfo &outIndex) {
+    if (!indexName || !tableName || keyColumns.empty()) return RC_INVALID_ARG;
+    if ((int)keyColumns.size() > MAX_INDEX_COLUMNS || (int)includeColumns.size() > MAX_INDEX_INCLUDE ||
+        (int)predicates.size() > MAX_INDEX_PREDICATES) return RC_INVALID_ARG;
 
-    AttrType keyType = INT; int keyLen = 4; bool found = false;
-    for (int i = 0; i < tableInfo.attrCount; ++i) {
-        if (strcmp(tableInfo.attrs[i].name, columnName) == 0) {
-            keyType = tableInfo.attrs[i].type;
-            keyLen = (tableInfo.attrs[i].type == STRING) ? tableInfo.attrs[i].length : 4;
-            found = true; break;
+    // 检查同名索引（持写锁直到登记完成）
+    std::unique_lock<std::shared_mutex> guard(catalogMutex_);
+    if (indexIdByName_.count(indexName)) return RC_TABLE_EXISTS; // 复用错误码表示已存在
+
+    // 表和列合法性
+    auto tableIt = tableIdByName_.find(tableName);
+    if (tableIt == tableIdByName_.end()) return RC_TABLE_NOT_FOUND;
+    const TableInfo tableInfo = tables_.at(tableIt->second)->info;
+    RC rc = RC_OK;
+
+    // 键为各键列保序编码的拼接；INCLUDE列按同样编码放在叶子项的负载中
+    // 键列可以是列上的表达式（同一列可以带不同表达式出现多次），其键宽按表达式结果计算
+    std::vector<int> keyCols, includeCols;
+    std::vector<ColumnRef> keyRefs;
+    int keyLen = 0, payloadLen = 0;
+    for (const auto &text : keyColumns) {
+        ColumnRef ref;
+        rc = parseColumnRef(tableInfo.attrCount, tableInfo.attrs, text, ref);
+        if (rc != RC_OK) return rc;
+        for (const auto &other : keyRefs) {
+            if (other.column == ref.column && other.expr == ref.expr && other.arg == ref.arg) return RC_INVALID_ARG;
         }
+        keyRefs.push_back(ref);
+        keyCols.push_back(ref.column);
+        const AttrInfo &attr = tableInfo.attrs[ref.column];
+        keyLen += indexKeyLength(attr.type, ref.expr == ColumnExpr::PREFIX ? ref.arg : attr.length);
+    }
+    for (const auto &name : includeColumns) {
+        int col = findAttrIndex(tableInfo.attrCount, tableInfo.attrs, name.c_str());
+        if (col < 0) return RC_ATTR_NOT_FOUND;
+        // 只以表达式出现在键中的列仍可作为INCLUDE列（供不回表取原值）
+        bool inKey = std::any_of(keyRefs.begin(), keyRefs.end(),
+                                 [&](const ColumnRef &ref) { return ref.column == col && ref.expr == ColumnExpr::NONE; });
+        if (inKey || std::find(includeCols.begin(), includeCols.end(), col) != includeCols.end()) return RC_INVALID_ARG;
+        includeCols.push_back(col);
+        payloadLen += indexKeyLength(tableInfo.attrs[col].type, tableInfo.attrs[col].length);
+    }
+    // 单列无INCLUDE的索引不需要空值位图（首键列为空的行不入索引）
+    if (keyCols.size() > 1 || !includeCols.empty()) payloadLen += INDEX_NULL_BITMAP_LEN;
+    // 每个节点至少容纳4项
+    if (keyLen > MAX_INDEX_KEY_LEN || keyLen + 8 + payloadLen > (BLOCK_SIZE - (int)sizeof(IndexPageHeader)) / 4) {
+        return RC_RECORD_TOO_LONG;
     }
-    if (!found) return RC_ATTR_NOT_FOUND;
 
     // 分配索引ID并创建索引文件
     TableId indexId = nextIndexId_++;
@@ -311,17 +675,30 @@ RC DataDict::createIndexMetadata(TransactionId txId, const char *indexName, cons
     info.tableId = tableInfo.tableId;
     strncpy(info.tableName, tableInfo.tableName, MAX_TABLE_NAME_LEN - 1);
     info.tableName[MAX_TABLE_NAME_LEN - 1] = '\0';
-    strncpy(info.columnName, columnName, MAX_ATTR_NAME_LEN - 1);
+    strncpy(info.columnName, tableInfo.attrs[keyCols[0]].name, MAX_ATTR_NAME_LEN - 1);
     info.columnName[MAX_ATTR_NAME_LEN - 1] = '\0';
-    info.keyType = keyType;
+    info.keyType = tableInfo.attrs[keyCols[0]].type;
     info.keyLen = keyLen;
     info.rootPage = -1;
     info.unique = unique;
     info.height = 0;
     info.totalPages = 0;
     info.totalKeys = 0;
-
-    indexes_.push_back(info);
+    info.keyColumnCount = (int)keyCols.size();
+    for (size_t i = 0; i < keyCols.size(); ++i) {
+        info.keyColumns[i] = (int16_t)keyCols[i];
+        info.keyExprs[i] = (uint8_t)keyRefs[i].expr;
+        info.keyExprArgs[i] = (int16_t)keyRefs[i].arg;
+    }
+    info.includeCount = (int)includeCols.size();
+    for (size_t i = 0; i < includeCols.size(); ++i) info.includeColumns[i] = (int16_t)includeCols[i];
+    info.payloadLen = payloadLen;
+    info.method = method;
+    info.cached = false;
+    info.predicateCount = (int)predicates.size();
+    for (size_t i = 0; i < predicates.size(); ++i) info.predicates[i] = predicates[i];
+
+    addIndexEntry(info);
     outIndex = info;
 
     // 追加写入到索引元数据文件
@@ -331,49 +708,186 @@ RC DataDict::createIndexMetadata(TransactionId txId, const char *indexName, cons
 
 RC DataDict::findIndex(const char *indexName, IndexInfo &outIndex) {
     if (!indexName) return RC_INVALID_ARG;
-    for (const auto& idx : indexes_) {
-        if (strcmp(idx.indexName, indexName) == 0) { outIndex = idx; return RC_OK; }
-    }
-    return RC_TABLE_NOT_FOUND;
+    std::shared_lock<std::shared_mutex> guard(catalogMutex_);
+    auto nameIt = indexIdByName_.find(indexName);
+    if (nameIt == indexIdByName_.end()) return RC_TABLE_NOT_FOUND;
+    outIndex = std::atomic_load(&indexes_.at(nameIt->second))->info;
+    return RC_OK;
+}
+
+RC DataDict::findIndexById(TableId indexId, IndexInfo &outIndex) {
+    std::shared_lock<std::shared_mutex> guard(catalogMutex_);
+    auto it = indexes_.find(indexId);
+    if (it == indexes_.end()) return RC_TABLE_NOT_FOUND;
+    outIndex = std::atomic_load(&it->second)->info;
+    return RC_OK;
 }
 
 RC DataDict::listIndexesForTable(TableId tableId, std::vector<IndexInfo> &outIndexes) {
     outIndexes.clear();
-    for (const auto& idx : indexes_) if (idx.tableId == tableId) outIndexes.push_back(idx);
+    std::shared_lock<std::shared_mutex> guard(catalogMutex_);
+    auto listIt = tableIndexIds_.find(tableId);
+    if (listIt == tableIndexIds_.end()) return RC_OK;
+    outIndexes.reserve(listIt->second.size());
+    for (TableId indexId : listIt->second) outIndexes.push_back(std::atomic_load(&indexes_.at(indexId))->info);
+    return RC_OK;
+}
+
+RC DataDict::getIndex(const char *indexName, IndexRef &index) {
+    if (!indexName) return RC_INVALID_ARG;
+    std::shared_lock<std::shared_mutex> guard(catalogMutex_);
+    auto nameIt = indexIdByName_.find(indexName);
+    if (nameIt == indexIdByName_.end()) return RC_TABLE_NOT_FOUND;
+    index = std::atomic_load(&indexes_.at(nameIt->second));
+    return RC_OK;
+}
+
+RC DataDict::listIndexRefsForTable(TableId tableId, std::vector<IndexRef> &outIndexes) {
+    outIndexes.clear();
+    std::shared_lock<std::shared_mutex> guard(catalogMutex_);
+    auto listIt = tableIndexIds_.find(tableId);
+    if (listIt == tableIndexIds_.end()) return RC_OK;
+    outIndexes.reserve(listIt->second.size());
+    for (TableId indexId : listIt->second) outIndexes.push_back(std::atomic_load(&indexes_.at(indexId)));
     return RC_OK;
 }
 
 RC DataDict::updateIndexInfo(const IndexInfo &info) {
-    for (auto& idx : indexes_) {
-        if (idx.indexId == info.indexId) { idx = info; appendIndexMeta(info); return RC_OK; }
+    std::unique_lock<std::shared_mutex> guard(catalogMutex_);
+    auto it = indexes_.find(info.indexId);
+    if (it == indexes_.end()) {
+        // 未找到则登记为新索引
+        addIndexEntry(info);
+        return appendIndexMeta(info);
     }
-    // 未找到则追加
-    indexes_.push_back(info);
-    appendIndexMeta(info);
+
+    // 写时复制：持有旧目录项的操作可能正在读其中的信息，不原地改写
+    auto entry = std::make_shared<IndexEntry>();
+    entry->info = info;
+    entry->version = it->second->version.load();
+    std::shared_ptr<IndexEntry> old = std::atomic_exchange(&it->second, entry);
+    old->version++;
+    auto &superseded = supersededIndexes_[info.indexId];
+    superseded.erase(std::remove_if(superseded.begin(), superseded.end(),
+                                    [](const std::weak_ptr<IndexEntry> &e) { return e.expired(); }),
+                     superseded.end());
+    superseded.push_back(old);
+    auto slotIt = indexMetaSlots_.find(info.indexId);
+    if (slotIt == indexMetaSlots_.end()) return appendIndexMeta(info);
+    return writeIndexMetaSlot(slotIt->second.first, slotIt->second.second, &info);
+}
+
+void DataDict::addTableEntry(const TableInfo &table) {
+    auto entry = std::make_shared<TableEntry>();
+    entry->info = table;
+    tables_[table.tableId] = entry;
+    tableIdByName_[table.tableName] = table.tableId;
+}
+
+void DataDict::replaceTableEntry(std::shared_ptr<TableEntry> &slot, const TableInfo &info, bool ddl) {
+    // 持有旧目录项的操作可能正在读其中的信息，不原地改写
+    auto entry = std::make_shared<TableEntry>();
+    entry->info = info;
+    entry->version = slot->version.load() + (ddl ? 1 : 0);
+    slot->version++;
+    slot = entry;
+}
+
+void DataDict::addIndexEntry(const IndexInfo &info) {
+    auto entry = std::make_shared<IndexEntry>();
+    entry->info = info;
+    indexes_[info.indexId] = entry;
+    indexIdByName_[info.indexName] = info.indexId;
+    tableIndexIds_[info.tableId].push_back(info.indexId);
+
+    // 表的索引集合变化
+    auto tableIt = tables_.find(info.tableId);
+    if (tableIt != tables_.end()) tableIt->second->version++;
+}
+
+void DataDict::removeIndexEntry(TableId indexId) {
+    auto it = indexes_.find(indexId);
+    if (it == indexes_.end()) return;
+
+    const IndexInfo &info = it->second->info;
+    indexIdByName_.erase(info.indexName);
+    auto listIt = tableIndexIds_.find(info.tableId);
+    if (listIt != tableIndexIds_.end()) {
+        auto &ids = listIt->second;
+        ids.erase(std::remove(ids.begin(), ids.end(), indexId), ids.end());
+        if (ids.empty()) tableIndexIds_.erase(listIt);
+    }
+    auto tableIt = tables_.find(info.tableId);
+    if (tableIt != tables_.end()) tableIt->second->version++;
+
+    it->second->version++;
+    it->second->dropped = true;
+    indexes_.erase(it);
+    auto oldIt = supersededIndexes_.find(indexId);
+    if (oldIt != supersededIndexes_.end()) {
+        for (const auto &weak : oldIt->second) {
+            if (auto old = weak.lock()) old->dropped = true;
+        }
+        supersededIndexes_.erase(oldIt);
+    }
+}
+
+RC DataDict::eraseIndexMeta(TableId indexId) {
+    auto it = indexMetaSlots_.find(indexId);
+    if (it == indexMetaSlots_.end()) return RC_OK;
+    RC rc = writeIndexMetaSlot(it->second.first, it->second.second, nullptr);
+    if (rc != RC_OK) return rc;
+    indexMetaFreeSlots_.push_back(it->second);
+    indexMetaSlots_.erase(it);
     return RC_OK;
 }
 
 RC DataDict::appendIndexMeta(const IndexInfo &info) {
-    // 确保当前块有效
-    if (indexMetaCurrentBlock_ == -1 || indexMetaBlockOffsets_.find(indexMetaCurrentBlock_) == indexMetaBlockOffsets_.end()) {
+    // 无空闲槽则分配新块，新块的所有槽加入空闲列表
+    if (indexMetaFreeSlots_.empty()) {
         BlockNum newBlock; RC rc = diskManager_.allocBlock(INDEX_META_TABLE_ID, newBlock); if (rc != RC_OK) return rc;
-        indexMetaCurrentBlock_ = newBlock; indexMetaBlockOffsets_[indexMetaCurrentBlock_] = 0;
-    }
-    // 空间不足则分配新块
-    if (indexMetaBlockOffsets_[indexMetaCurrentBlock_] + (int)sizeof(IndexInfo) > BLOCK_SIZE) {
-        BlockNum newBlock; RC rc = diskManager_.allocBlock(INDEX_META_TABLE_ID, newBlock); if (rc != RC_OK) return rc;
-        indexMetaCurrentBlock_ = newBlock; indexMetaBlockOffsets_[indexMetaCurrentBlock_] = 0;
+        int perBlock = BLOCK_SIZE / (int)sizeof(IndexInfo);
+        for (int i = perBlock - 1; i >= 0; --i) {
+            indexMetaFreeSlots_.push_back({newBlock, i * (int)sizeof(IndexInfo)});
+        }
     }
 
+    std::pair<BlockNum, int> slot = indexMetaFreeSlots_.back();
+    RC rc = writeIndexMetaSlot(slot.first, slot.second, &info);
+    if (rc != RC_OK) return rc;
+    indexMetaFreeSlots_.pop_back();
+    indexMetaSlots_[info.indexId] = slot;
+    return RC_OK;
+}
+
+RC DataDict::writeIndexMetaSlot(BlockNum block, int offset, const IndexInfo *info) {
     BufferFrame* frame = nullptr;
-    RC rc = memManager_.getPage(INDEX_META_TABLE_ID, indexMetaCurrentBlock_, frame, DICT_SPACE);
+    RC rc = memManager_.getPage(INDEX_META_TABLE_ID, block, frame, DICT_SPACE);
     if (rc != RC_OK) return rc;
-    int offset = indexMetaBlockOffsets_[indexMetaCurrentBlock_];
     auto* dst = reinterpret_cast<IndexInfo*>(frame->data + offset);
-    *dst = info;
-
-    indexMetaBlockOffsets_[indexMetaCurrentBlock_] += sizeof(IndexInfo);
-    memManager_.markDirty(INDEX_META_TABLE_ID, indexMetaCurrentBlock_);
-    memManager_.releasePage(INDEX_META_TABLE_ID, indexMetaCurrentBlock_);
+    if (info != nullptr) {
+        *dst = *info;
+    } else {
+        memset(dst, 0, sizeof(IndexInfo));
+    }
+    memManager_.markDirty(INDEX_META_TABLE_ID, block);
+    memManager_.releasePage(INDEX_META_TABLE_ID, block);
     return RC_OK;
 }
+
+RC DataDict::compactIndexMeta(const std::vector<IndexInfo> &live) {
+    std::vector<TableId> files = {INDEX_META_TABLE_ID};
+    RC rc = memManager_.discardPages(files);
+    if (rc != RC_OK) return rc;
+    rc = diskManager_.truncateTableFile(INDEX_META_TABLE_ID);
+    if (rc != RC_OK) return rc;
+
+    indexMetaSlots_.clear();
+    indexMetaFreeSlots_.clear();
+    for (const auto& info : live) {
+        rc = appendIndexMeta(info);
+        if (rc != RC_OK) return rc;
+    }
+    // 旧文件已删除，立即落盘
+    return memManager_.flushAllPages();
+}
@@ -2,6 +2,10 @@
 #include <cstring>
 #include <iostream>
 #include <filesystem>
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace fs = std::filesystem;
 
@@ -15,10 +19,15 @@ DiskManager::DiskManager(size_t diskSize, const std::string &dbName)
 
 DiskManager::~DiskManager() {
     // 关闭所有打开的表文件
-    for (auto &[tableId, fs]: tableFiles_) {
-        if (fs.is_open()) {
-            fs.close();
+    for (auto &[tableId, file]: tableFiles_) {
+        if (file->stream.is_open()) {
+            file->stream.close();
         }
+#if defined(__linux__)
+        if (file->prefetchFd >= 0) {
+            ::close(file->prefetchFd);
+        }
+#endif
     }
 }
 
@@ -44,8 +53,7 @@ RC DiskManager::init() {
     return RC_OK;
 }
 
-RC DiskManager::createTableFile(TableId tableId) {
-    std::string filePath = getFilePath(tableId);
+RC DiskManager::createFileLocked(const std::string &filePath) {
     // 检查文件是否已存在
     if (fs::exists(filePath)) {
         return RC_FILE_EXISTS;
@@ -58,86 +66,167 @@ RC DiskManager::createTableFile(TableId tableId) {
     }
 
     // 写入文件头（初始1个块，未使用）
-    TableFileHeader header = {1, 0};
+    TableFileHeader header = {1, 0, DB_FILE_MAGIC, DB_FORMAT_VERSION};
     fs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    if (fs.fail()) {
+        return RC_FILE_NOT_FOUND;
+    }
 
     // 初始化第一个块（空块）
     char emptyBlock[BLOCK_SIZE] = {0};
     fs.write(emptyBlock, BLOCK_SIZE);
+    if (fs.fail()) {
+        return RC_FILE_NOT_FOUND;
+    }
 
     fs.close();
     return RC_OK;
 }
 
-RC DiskManager::openTableFile(TableId tableId) {
+RC DiskManager::createTableFile(TableId tableId) {
+    std::unique_lock<std::shared_mutex> guard(filesMutex_);
+    return createFileLocked(getFilePath(tableId));
+}
+
+RC DiskManager::openFileLocked(TableId tableId) {
     // 若已打开则直接返回
     if (tableFiles_.count(tableId)) {
         return RC_OK;
     }
 
     std::string filePath = getFilePath(tableId);
-    std::fstream fs(filePath, std::ios::in | std::ios::out | std::ios::binary);
-    if (!fs.is_open()) {
+    auto file = std::make_unique<OpenFile>();
+    file->stream.open(filePath, std::ios::in | std::ios::out | std::ios::binary);
+    if (!file->stream.is_open()) {
+        return RC_FILE_NOT_FOUND;
+    }
+    file->stream.seekg(0);
+    file->stream.read(reinterpret_cast<char *>(&file->header), sizeof(TableFileHeader));
+    if (file->stream.fail()) {
         return RC_FILE_NOT_FOUND;
     }
+#if defined(__linux__)
+    // fstream不暴露文件描述符，另开一个只读描述符供预读提示使用，随文件一起关闭
+    file->prefetchFd = ::open(filePath.c_str(), O_RDONLY);
+#endif
 
-    tableFiles_[tableId] = std::move(fs);
+    tableFiles_[tableId] = std::move(file);
     return RC_OK;
 }
 
-RC DiskManager::closeTableFile(TableId tableId) {
+RC DiskManager::closeFileLocked(TableId tableId) {
     auto it = tableFiles_.find(tableId);
     if (it == tableFiles_.end()) {
         return RC_FILE_ERROR;
     }
-    if (it->second.is_open()) {
-        it->second.close();
+    if (it->second->stream.is_open()) {
+        it->second->stream.close();
+    }
+#if defined(__linux__)
+    if (it->second->prefetchFd >= 0) {
+        ::close(it->second->prefetchFd);
     }
+#endif
     tableFiles_.erase(it);
     return RC_OK;
 }
 
+RC DiskManager::acquireFile(TableId tableId, std::shared_lock<std::shared_mutex> &lock, OpenFile *&file) {
+    auto it = tableFiles_.find(tableId);
+    if (it == tableFiles_.end()) {
+        // 未打开：换成独占锁打开，再换回共享锁重新查找（期间可能已被其他线程打开或关闭）
+        lock.unlock();
+        RC rc;
+        {
+            std::unique_lock<std::shared_mutex> exclusive(filesMutex_);
+            rc = openFileLocked(tableId);
+        }
+        lock.lock();
+        if (rc != RC_OK) {
+            return rc;
+        }
+        it = tableFiles_.find(tableId);
+        if (it == tableFiles_.end()) {
+            return RC_FILE_NOT_FOUND;
+        }
+    }
+    file = it->second.get();
+    return RC_OK;
+}
+
+RC DiskManager::openTableFile(TableId tableId) {
+    std::unique_lock<std::shared_mutex> guard(filesMutex_);
+    return openFileLocked(tableId);
+}
+
+RC DiskManager::closeTableFile(TableId tableId) {
+    std::unique_lock<std::shared_mutex> guard(filesMutex_);
+    return closeFileLocked(tableId);
+}
+
+RC DiskManager::removeTableFile(TableId tableId) {
+    std::unique_lock<std::shared_mutex> guard(filesMutex_);
+    closeFileLocked(tableId);
+    std::error_code ec;
+    fs::remove(getFilePath(tableId), ec);
+    return ec ? RC_FILE_ERROR : RC_OK;
+}
+
+RC DiskManager::truncateTableFile(TableId tableId) {
+    std::unique_lock<std::shared_mutex> guard(filesMutex_);
+    closeFileLocked(tableId);
+    std::error_code ec;
+    fs::remove(getFilePath(tableId), ec);
+    if (ec) {
+        return RC_FILE_ERROR;
+    }
+    return createFileLocked(getFilePath(tableId));
+}
+
 RC DiskManager::readTableFileHeader(TableId tableId, TableFileHeader &header) {
+    std::shared_lock<std::shared_mutex> guard(filesMutex_);
     auto it = tableFiles_.find(tableId);
-    if (it == tableFiles_.end() || !it->second.is_open()) {
+    if (it == tableFiles_.end() || !it->second->stream.is_open()) {
         return RC_FILE_ERROR;
     }
 
+    std::lock_guard<std::mutex> fileGuard(it->second->mutex);
+    header = it->second->header;
+    return RC_OK;
+}
+
+RC DiskManager::writeHeaderLocked(OpenFile &file, const TableFileHeader &header) {
     // 定位到文件头（文件起始位置）
-    it->second.seekg(0);
-    it->second.read(reinterpret_cast<char *>(&header), sizeof(header));
-    if (it->second.fail()) {
+    file.stream.seekp(0);
+    file.stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    if (file.stream.fail()) {
         return RC_FILE_NOT_FOUND;
     }
+    file.header = header;
     return RC_OK;
 }
 
 RC DiskManager::writeTableFileHeader(TableId tableId, const TableFileHeader &header) {
+    std::shared_lock<std::shared_mutex> guard(filesMutex_);
     auto it = tableFiles_.find(tableId);
-    if (it == tableFiles_.end() || !it->second.is_open()) {
+    if (it == tableFiles_.end() || !it->second->stream.is_open()) {
         return RC_FILE_ERROR;
     }
 
-    // 定位到文件头
-    it->second.seekp(0);
-    it->second.write(reinterpret_cast<const char *>(&header), sizeof(header));
-    if (it->second.fail()) {
-        return RC_FILE_NOT_FOUND;
-    }
-    return RC_OK;
+    std::lock_guard<std::mutex> fileGuard(it->second->mutex);
+    return writeHeaderLocked(*it->second, header);
 }
 
 RC DiskManager::allocBlock(TableId tableId, BlockNum &blockNum) {
-    RC rc = openTableFile(tableId);
+    std::shared_lock<std::shared_mutex> guard(filesMutex_);
+    OpenFile *file = nullptr;
+    RC rc = acquireFile(tableId, guard, file);
     if (rc != RC_OK) {
         return rc;
     }
 
-    TableFileHeader header;
-    rc = readTableFileHeader(tableId, header);
-    if (rc != RC_OK) {
-        return rc;
-    }
+    std::lock_guard<std::mutex> fileGuard(file->mutex);
+    TableFileHeader header = file->header;
 
     // 分配新块（使用第一个未使用的块号）
     blockNum = header.usedBlocks;
@@ -147,19 +236,17 @@ RC DiskManager::allocBlock(TableId tableId, BlockNum &blockNum) {
     if (header.usedBlocks >= header.totalBlocks) {
         // 扩展1个块
         header.totalBlocks++;
-        std::string filePath = getFilePath(tableId);
-        std::fstream &fs = tableFiles_[tableId];
         // 定位到文件末尾并写入空块
-        fs.seekp(0, std::ios::end);
+        file->stream.seekp(0, std::ios::end);
         char emptyBlock[BLOCK_SIZE] = {0};
-        fs.write(emptyBlock, BLOCK_SIZE);
-        if (fs.fail()) {
+        file->stream.write(emptyBlock, BLOCK_SIZE);
+        if (file->stream.fail()) {
             return RC_FILE_NOT_FOUND;
         }
     }
 
     // 更新文件头
-    return writeTableFileHeader(tableId, header);
+    return writeHeaderLocked(*file, header);
 }
 
 RC DiskManager::freeBlock(TableId tableId, BlockNum blockNum) {
@@ -183,27 +270,24 @@ RC DiskManager::readBlock(TableId tableId, BlockNum blockNum, char *data) {
         return RC_INVALID_ARG;
     }
 
-    RC rc = openTableFile(tableId);
+    std::shared_lock<std::shared_mutex> guard(filesMutex_);
+    OpenFile *file = nullptr;
+    RC rc = acquireFile(tableId, guard, file);
     if (rc != RC_OK) {
         return rc;
     }
 
-    TableFileHeader header;
-    rc = readTableFileHeader(tableId, header);
-    if (rc != RC_OK) {
-        return rc;
-    }
-    if (blockNum >= header.usedBlocks) {
+    std::lock_guard<std::mutex> fileGuard(file->mutex);
+    if (blockNum >= file->header.usedBlocks) {
         return RC_BLOCK_NOT_FOUND;
     }
 
     // 块在文件中的偏移量 = 文件头大小 + 块号 * 块大小
     size_t offset = sizeof(TableFileHeader) + blockNum * BLOCK_SIZE;
-    std::fstream &fs = tableFiles_[tableId];
-    fs.seekg(offset);
-    fs.read(data, BLOCK_SIZE);
+    file->stream.seekg(offset);
+    file->stream.read(data, BLOCK_SIZE);
 
-    if (fs.fail()) {
+    if (file->stream.fail()) {
         return RC_FILE_NOT_FOUND;
     }
     return RC_OK;
@@ -214,62 +298,55 @@ RC DiskManager::writeBlock(TableId tableId, BlockNum blockNum, const char *data)
         return RC_INVALID_ARG;
     }
 
-    RC rc = openTableFile(tableId);
+    std::shared_lock<std::shared_mutex> guard(filesMutex_);
+    OpenFile *file = nullptr;
+    RC rc = acquireFile(tableId, guard, file);
     if (rc != RC_OK) {
         return rc;
     }
 
-    TableFileHeader header;
-    rc = readTableFileHeader(tableId, header);
-    if (rc != RC_OK) {
-        return rc;
-    }
-
-    if (blockNum < 0 || blockNum >= header.usedBlocks) {
+    std::lock_guard<std::mutex> fileGuard(file->mutex);
+    if (blockNum < 0 || blockNum >= file->header.usedBlocks) {
         return RC_INVALID_BLOCK;
     }
 
     size_t offset = sizeof(TableFileHeader) + blockNum * BLOCK_SIZE;
-    std::fstream &fs = tableFiles_[tableId];
-    fs.seekp(offset);
-    fs.write(data, BLOCK_SIZE);
+    file->stream.seekp(offset);
+    file->stream.write(data, BLOCK_SIZE);
 
-    if (fs.fail()) {
+    if (file->stream.fail()) {
         return RC_FILE_NOT_FOUND;
     }
     return RC_OK;
 }
 
-RC DiskManager::createLogFile() {
-    std::string filePath = getFilePath(LOG_TABLE_ID);
-    // 检查文件是否已存在
-    if (fs::exists(filePath)) {
-        return RC_FILE_EXISTS;
-    }
-
-    // 创建并初始化文件
-    std::fstream fs(filePath, std::ios::out | std::ios::binary);
-    if (!fs.is_open()) {
-        return RC_FILE_ERROR;
+RC DiskManager::prefetchBlock(TableId tableId, BlockNum blockNum) {
+    if (blockNum < 0) {
+        return RC_INVALID_BLOCK;
     }
-
-    // 写入文件头（初始1个块，未使用）
-    TableFileHeader header = {1, 0};
-    fs.write(reinterpret_cast<const char *>(&header), sizeof(header));
-    if (fs.fail()) {
-        return RC_FILE_NOT_FOUND;
+#if defined(__linux__)
+    // 复用打开文件时的只读描述符发出预读提示，由内核在后台读入页缓存；不占用文件的读写锁
+    std::shared_lock<std::shared_mutex> guard(filesMutex_);
+    OpenFile *file = nullptr;
+    RC rc = acquireFile(tableId, guard, file);
+    if (rc != RC_OK) {
+        return rc;
     }
-
-    // 初始化第一个块（空块）
-    char emptyBlock[BLOCK_SIZE] = {0};
-    fs.write(emptyBlock, BLOCK_SIZE);
-    if (fs.fail()) {
+    if (file->prefetchFd < 0) {
         return RC_FILE_NOT_FOUND;
     }
-
-    fs.close();
+    off_t offset = (off_t)sizeof(TableFileHeader) + (off_t)blockNum * BLOCK_SIZE;
+    ::posix_fadvise(file->prefetchFd, offset, BLOCK_SIZE, POSIX_FADV_WILLNEED);
+#else
+    (void)tableId;
+#endif
     return RC_OK;
 }
+
+RC DiskManager::createLogFile() {
+    std::unique_lock<std::shared_mutex> guard(filesMutex_);
+    return createFileLocked(getFilePath(LOG_TABLE_ID));
+}
 //
 //RC DiskManager::openLogFile() {
 //    return openTableFile(LOG_TABLE_ID);
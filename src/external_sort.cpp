@@ -0,0 +1,150 @@
+#include "../include/external_sort.h"
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+
+ExternalSorter::ExternalSorter(int recordLen, size_t memBudget, const std::string &tempPath)
+        : recordLen_(recordLen), tempPath_(tempPath) {
+    // 每条记录另占一个4字节排序下标
+    capacity_ = std::max<size_t>(1, memBudget / (size_t)(recordLen + sizeof(uint32_t)));
+}
+
+ExternalSorter::~ExternalSorter() {
+    if (file_.is_open()) {
+        file_.close();
+        std::remove(tempPath_.c_str());
+    }
+}
+
+RC ExternalSorter::add(const char *record) {
+    if (merging_) return RC_INVALID_OP;
+    if (buffered_ == capacity_) {
+        RC rc = spillRun();
+        if (rc != RC_OK) return rc;
+    }
+    buffer_.insert(buffer_.end(), record, record + recordLen_);
+    buffered_++;
+    count_++;
+    return RC_OK;
+}
+
+RC ExternalSorter::sortBuffer() {
+    order_.resize(buffered_);
+    std::iota(order_.begin(), order_.end(), 0u);
+    const char *base = buffer_.data();
+    const size_t len = (size_t)recordLen_;
+    std::sort(order_.begin(), order_.end(), [base, len](uint32_t a, uint32_t b) {
+        return std::memcmp(base + a * len, base + b * len, len) < 0;
+    });
+    emitPos_ = 0;
+    return RC_OK;
+}
+
+RC ExternalSorter::spillRun() {
+    sortBuffer();
+    if (!file_.is_open()) {
+        file_.open(tempPath_, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file_.is_open()) return RC_FILE_ERROR;
+    }
+
+    // 有序段依次追加到临时文件末尾
+    file_.seekp(0, std::ios::end);
+    int64_t offset = (int64_t)file_.tellp();
+    for (uint32_t idx : order_) {
+        file_.write(buffer_.data() + (size_t)idx * recordLen_, recordLen_);
+    }
+    if (file_.fail()) return RC_IO_ERROR;
+
+    runs_.emplace_back(offset, (int64_t)buffered_);
+    buffer_.clear();
+    buffered_ = 0;
+    return RC_OK;
+}
+
+RC ExternalSorter::fillCursor(RunCursor &cursor) {
+    int capacity = (int)(cursor.buffer.size() / recordLen_);
+    int n = (int)std::min<int64_t>(capacity, cursor.remaining);
+    cursor.pos = 0;
+    cursor.bufferCount = n;
+    if (n == 0) return RC_OK;
+
+    file_.seekg(cursor.offset);
+    file_.read(cursor.buffer.data(), (std::streamsize)n * recordLen_);
+    if (file_.fail()) return RC_IO_ERROR;
+    cursor.offset += (int64_t)n * recordLen_;
+    cursor.remaining -= n;
+    return RC_OK;
+}
+
+RC ExternalSorter::finish() {
+    if (runs_.empty()) {
+        // 全部在内存中：直接按排序下标输出
+        return sortBuffer();
+    }
+    if (buffered_ > 0) {
+        RC rc = spillRun();
+        if (rc != RC_OK) return rc;
+    }
+    std::vector<char>().swap(buffer_);
+    std::vector<uint32_t>().swap(order_);
+    file_.flush();
+
+    // 排序缓冲区平均分给各段作读缓冲
+    size_t budget = capacity_ * (size_t)(recordLen_ + sizeof(uint32_t));
+    size_t chunk = std::max<size_t>(SORT_MERGE_MIN_CHUNK, budget / runs_.size());
+    size_t records = std::max<size_t>(1, chunk / recordLen_);
+
+    cursors_.resize(runs_.size());
+    for (size_t i = 0; i < runs_.size(); ++i) {
+        RunCursor &c = cursors_[i];
+        c.offset = runs_[i].first;
+        c.remaining = runs_[i].second;
+        c.buffer.resize(records * recordLen_);
+        RC rc = fillCursor(c);
+        if (rc != RC_OK) return rc;
+        if (c.bufferCount > 0) heap_.push_back((int)i);
+    }
+
+    auto greater = [this](int a, int b) {
+        return std::memcmp(cursorRecord(cursors_[a]), cursorRecord(cursors_[b]), recordLen_) > 0;
+    };
+    std::make_heap(heap_.begin(), heap_.end(), greater);
+    merging_ = true;
+    return RC_OK;
+}
+
+bool ExternalSorter::next(const char *&record) {
+    if (!merging_) {
+        if (emitPos_ >= order_.size()) return false;
+        record = buffer_.data() + (size_t)order_[emitPos_++] * recordLen_;
+        return true;
+    }
+
+    auto greater = [this](int a, int b) {
+        return std::memcmp(cursorRecord(cursors_[a]), cursorRecord(cursors_[b]), recordLen_) > 0;
+    };
+
+    // 上次输出的记录此时才可丢弃：前进该段并放回堆
+    if (lastRun_ >= 0) {
+        RunCursor &c = cursors_[lastRun_];
+        if (++c.pos == c.bufferCount) {
+            RC rc = fillCursor(c);
+            if (rc != RC_OK) {
+                status_ = rc;
+                return false;
+            }
+        }
+        if (c.pos < c.bufferCount) {
+            heap_.push_back(lastRun_);
+            std::push_heap(heap_.begin(), heap_.end(), greater);
+        }
+        lastRun_ = -1;
+    }
+
+    if (heap_.empty()) return false;
+    std::pop_heap(heap_.begin(), heap_.end(), greater);
+    lastRun_ = heap_.back();
+    heap_.pop_back();
+    record = cursorRecord(cursors_[lastRun_]);
+    return true;
+}
@@ -0,0 +1,577 @@
+#include "../include/index_manager.h"
+#include "../include/table_manager.h"
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <set>
+
+uint32_t hashIndexKey(const char* key, int keyLen) {
+    // FNV-1a，再经64位混合函数打散：目录下标取低位，低位须同样均匀
+    uint64_t h = 1469598103934665603ull;
+    for (int i = 0; i < keyLen; ++i) {
+        h ^= (unsigned char)key[i];
+        h *= 1099511628211ull;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return (uint32_t)h;
+}
+
+// 桶页是否为哈希值hash所在的桶（乐观读到正被改写的页时页头可能不合理）
+static bool bucketHolds(const char* page, uint32_t hash) {
+    auto* hdr = reinterpret_cast<const HashBucketHeader*>(page);
+    return hdr->nodeType == (uint8_t)IndexNodeType::HASH_BUCKET && hdr->localDepth >= 0 &&
+           hdr->localDepth <= HASH_MAX_GLOBAL_DEPTH && hashLowBits(hash, hdr->localDepth) == hdr->hashBits;
+}
+
+static inline bool entryHasRid(const char* entry, int keyLen, const RID& rid) {
+    return loadInt32(entry + keyLen) == rid.pageNum && loadInt32(entry + keyLen + 4) == rid.slotNum;
+}
+
+RC IndexManager::resetHashIndex(IndexInfo& info) {
+    const TableId indexId = info.indexId;
+    BlockNum metaPage, dirPage;
+    RC rc = diskManager_.allocBlock(indexId, metaPage);
+    if (rc == RC_OK) rc = diskManager_.allocBlock(indexId, dirPage);
+    if (rc != RC_OK) return rc;
+
+    // 初始只有一个空桶，全局深度为0
+    PageNum bucket;
+    BufferFrame* frame = nullptr;
+    rc = hashNewBucketPage(indexId, 0, 0, bucket, frame);
+    if (rc != RC_OK) return rc;
+    frame->latch.unlock();
+    releasePage(indexId, bucket);
+
+    rc = pinPage(indexId, dirPage, frame);
+    if (rc != RC_OK) return rc;
+    std::memset(frame->data, 0xFF, BLOCK_SIZE);
+    storeInt32(frame->data, bucket);
+    memManager_.markDirty(indexId, dirPage);
+    releasePage(indexId, dirPage);
+
+    rc = pinPage(indexId, metaPage, frame);
+    if (rc != RC_OK) return rc;
+    std::memset(frame->data, 0, BLOCK_SIZE);
+    auto* meta = reinterpret_cast<HashMetaHeader*>(frame->data);
+    meta->nodeType = (uint8_t)IndexNodeType::HASH_META;
+    meta->pageNum = metaPage;
+    meta->globalDepth = 0;
+    meta->dirPageCount = 1;
+    meta->bucketCount = 1;
+    storeInt32(hashDirPageSlot(frame->data, 0), dirPage);
+    memManager_.markDirty(indexId, metaPage);
+    releasePage(indexId, metaPage);
+
+    info.rootPage = metaPage;
+    info.height = 1;
+    TableFileHeader fh;
+    if (diskManager_.readTableFileHeader(indexId, fh) == RC_OK) {
+        info.totalPages = fh.usedBlocks;
+    }
+    info.totalKeys = 0;
+    return publishIndexInfo(info);
+}
+
+RC IndexManager::buildHashIndex(IndexInfo& info, const TableInfo& table) {
+    // 哈希索引无序，不需排序：逐行插入，桶满时照常分裂
+    RC rc = RC_OK;
+    int64_t total = 0;
+    KeyBytes kb;
+    char payload[BLOCK_SIZE];
+    const std::vector<int> columns = extractColumns(info);
+    RC scanRc = TableManager::scanRecords(memManager_, dataDict_, table, [&](const RID& rid, const char* data, int len) {
+        if (!extractKey(table, info, data, len, kb, payload)) return true;
+        rc = hashInsert(info, kb, rid, payload);
+        total++;
+        return rc == RC_OK;
+    }, 1, nullptr, &columns);
+    if (rc != RC_OK) return rc;
+    if (scanRc != RC_OK) return scanRc;
+
+    info.totalKeys = (int)total;
+    TableFileHeader fh;
+    if (diskManager_.readTableFileHeader(info.indexId, fh) == RC_OK) {
+        info.totalPages = fh.usedBlocks;
+    }
+    return publishIndexInfo(info);
+}
+
+RC IndexManager::hashNewBucketPage(TableId indexId, int localDepth, uint32_t hashBits, PageNum& page, BufferFrame*& frame) {
+    BlockNum block;
+    RC rc = diskManager_.allocBlock(indexId, block);
+    if (rc != RC_OK) return rc;
+    rc = pinPage(indexId, block, frame);
+    if (rc != RC_OK) return rc;
+    frame->latch.lock();
+    std::memset(frame->data, 0, BLOCK_SIZE);
+    auto* hdr = reinterpret_cast<HashBucketHeader*>(frame->data);
+    hdr->nodeType = (uint8_t)IndexNodeType::HASH_BUCKET;
+    hdr->pageNum = block;
+    hdr->localDepth = localDepth;
+    hdr->hashBits = hashBits;
+    hdr->count = 0;
+    hdr->overflowPage = -1;
+    memManager_.markDirty(indexId, block);
+    page = block;
+    return RC_OK;
+}
+
+RC IndexManager::hashBucketFor(const IndexInfo& info, uint32_t hash, PageNum& bucket) {
+    const TableId indexId = info.indexId;
+    IndexLatch& latch = latchFor(indexId);
+    while (true) {
+        uint64_t version = latch.root.readLock();
+        BufferFrame* meta = nullptr;
+        RC rc = pinPage(indexId, info.rootPage, meta);
+        if (rc != RC_OK) return rc;
+        auto* hdr = reinterpret_cast<const HashMetaHeader*>(meta->data);
+        int depth = hdr->globalDepth;
+        uint32_t slot = 0;
+        PageNum dirPage = -1;
+        if (depth >= 0 && depth <= HASH_MAX_GLOBAL_DEPTH) {
+            slot = hashLowBits(hash, depth);
+            int dirIndex = (int)(slot / HASH_DIR_PER_PAGE);
+            if (dirIndex < hdr->dirPageCount) dirPage = loadInt32(hashDirPageSlot(meta->data, dirIndex));
+        }
+        releasePage(indexId, info.rootPage);
+        if (!latch.root.validate(version)) continue;
+        if (dirPage < 0) return RC_PAGE_NOT_FOUND;
+
+        BufferFrame* dir = nullptr;
+        rc = pinPage(indexId, dirPage, dir);
+        if (rc != RC_OK) return rc;
+        bucket = loadInt32(dir->data + (slot % HASH_DIR_PER_PAGE) * 4);
+        releasePage(indexId, dirPage);
+        if (latch.root.validate(version)) return bucket >= 0 ? RC_OK : RC_PAGE_NOT_FOUND;
+    }
+}
+
+RC IndexManager::hashProbe(const IndexInfo& info, const KeyBytes& key, std::vector<char>& out, bool first) {
+    const TableId indexId = info.indexId;
+    const int keyLen = info.keyLen;
+    const int entryLen = indexLeafEntryLen(info);
+    const int capacity = hashBucketCapacity(entryLen);
+    const uint32_t hash = hashIndexKey(key.data(), keyLen);
+    const size_t base = out.size();
+    while (true) {
+        out.resize(base);
+        PageNum bucket;
+        RC rc = hashBucketFor(info, hash, bucket);
+        if (rc != RC_OK) return rc;
+        BufferFrame* frame = nullptr;
+        rc = pinPage(indexId, bucket, frame);
+        if (rc != RC_OK) return rc;
+
+        // 乐观读整条桶链，溢出页随桶页一起改写：每取到后继页号先校验桶页版本，读完再校验一次
+        uint64_t version = frame->latch.readLock();
+        bool valid = bucketHolds(frame->data, hash);
+        PageNum page = bucket;
+        const BufferFrame* cur = frame;
+        while (valid) {
+            auto* hdr = reinterpret_cast<const HashBucketHeader*>(cur->data);
+            int n = std::max(0, std::min(hdr->count, capacity));
+            for (int i = 0; i < n && !(first && out.size() > base); ++i) {
+                const char* e = hashBucketEntry(cur->data, entryLen, i);
+                if (std::memcmp(e, key.data(), keyLen) == 0) out.insert(out.end(), e, e + entryLen);
+            }
+            PageNum next = hdr->overflowPage;
+            if (page != bucket) releasePage(indexId, page);
+            valid = frame->latch.validate(version);
+            if (!valid || next < 0 || (first && out.size() > base)) break;
+            BufferFrame* nextFrame = nullptr;
+            rc = pinPage(indexId, next, nextFrame);
+            if (rc != RC_OK) {
+                releasePage(indexId, bucket);
+                return rc;
+            }
+            page = next;
+            cur = nextFrame;
+        }
+        valid = valid && frame->latch.validate(version);
+        releasePage(indexId, bucket);
+        // 桶在查目录之后被分裂（哈希位不符）或读的过程中被改写：重新查目录
+        if (valid) break;
+    }
+
+    // 按RID序产出
+    size_t n = (out.size() - base) / entryLen;
+    if (n > 1) {
+        std::vector<std::pair<uint64_t, size_t>> order(n);
+        for (size_t i = 0; i < n; ++i) {
+            const char* e = out.data() + base + i * entryLen;
+            order[i] = {ridOrdinal(RID(loadInt32(e + keyLen), (SlotNum)loadInt32(e + keyLen + 4))), i};
+        }
+        std::sort(order.begin(), order.end());
+        std::vector<char> sorted(out.size() - base);
+        for (size_t i = 0; i < n; ++i) {
+            std::memcpy(sorted.data() + i * entryLen, out.data() + base + order[i].second * entryLen, entryLen);
+        }
+        std::memcpy(out.data() + base, sorted.data(), sorted.size());
+    }
+    return RC_OK;
+}
+
+RC IndexManager::hashInsert(const IndexInfo& info, const KeyBytes& key, const RID& rid, const char* payload) {
+    const TableId indexId = info.indexId;
+    const int keyLen = info.keyLen;
+    const int entryLen = indexLeafEntryLen(info);
+    const int capacity = hashBucketCapacity(entryLen);
+    const uint32_t hash = hashIndexKey(key.data(), keyLen);
+    std::vector<char> entry(entryLen);
+    std::memcpy(entry.data(), key.data(), keyLen);
+    storeInt32(entry.data() + keyLen, rid.pageNum);
+    storeInt32(entry.data() + keyLen + 4, rid.slotNum);
+    std::memcpy(entry.data() + keyLen + 8, payload, info.payloadLen);
+
+    while (true) {
+        PageNum bucket;
+        RC rc = hashBucketFor(info, hash, bucket);
+        if (rc != RC_OK) return rc;
+        BufferFrame* frame = nullptr;
+        rc = pinPage(indexId, bucket, frame);
+        if (rc != RC_OK) return rc;
+        frame->latch.lock();
+        if (!bucketHolds(frame->data, hash)) {
+            frame->latch.unlock();
+            releasePage(indexId, bucket);
+            continue;
+        }
+
+        // 桶页写锁下沿链找第一个有空位的页；唯一索引须先看完整条链（相同键必在本桶）
+        // 键中有空值列的项不参与唯一性检查（见indexKeyHasNull）
+        const bool unique = info.unique && !indexKeyHasNull(info, payload);
+        PageNum page = bucket, target = -1;
+        BufferFrame* cur = frame;
+        BufferFrame* targetFrame = nullptr;
+        while (true) {
+            auto* hdr = reinterpret_cast<HashBucketHeader*>(cur->data);
+            for (int i = 0; unique && i < hdr->count && rc == RC_OK; ++i) {
+                const char* e = hashBucketEntry(cur->data, entryLen, i);
+                if (std::memcmp(e, key.data(), keyLen) == 0 && !indexKeyHasNull(info, e + keyLen + 8)) rc = RC_DUPLICATE_KEY;
+            }
+            if (!targetFrame && hdr->count < capacity) {
+                target = page;
+                targetFrame = cur;
+            }
+            PageNum next = hdr->overflowPage;
+            if (cur != frame && cur != targetFrame) releasePage(indexId, page);
+            if (rc != RC_OK || next < 0 || (targetFrame && !unique)) break;
+            rc = pinPage(indexId, next, cur);
+            if (rc != RC_OK) break;
+            page = next;
+        }
+        if (rc == RC_OK && targetFrame) {
+            auto* hdr = reinterpret_cast<HashBucketHeader*>(targetFrame->data);
+            std::memcpy(hashBucketEntry(targetFrame->data, entryLen, hdr->count), entry.data(), entryLen);
+            hdr->count++;
+            memManager_.markDirty(indexId, target);
+        }
+        if (targetFrame && targetFrame != frame) releasePage(indexId, target);
+        frame->latch.unlock();
+        releasePage(indexId, bucket);
+        if (rc != RC_OK || targetFrame) return rc;
+
+        // 整条链已满：分裂（或挂溢出页）后重试
+        rc = hashGrow(info, hash);
+        if (rc != RC_OK) return rc;
+    }
+}
+
+RC IndexManager::hashDelete(const IndexInfo& info, const KeyBytes& key, const RID& rid) {
+    const TableId indexId = info.indexId;
+    const int keyLen = info.keyLen;
+    const int entryLen = indexLeafEntryLen(info);
+    const uint32_t hash = hashIndexKey(key.data(), keyLen);
+    while (true) {
+        PageNum bucket;
+        RC rc = hashBucketFor(info, hash, bucket);
+        if (rc != RC_OK) return rc;
+        BufferFrame* frame = nullptr;
+        rc = pinPage(indexId, bucket, frame);
+        if (rc != RC_OK) return rc;
+        frame->latch.lock();
+        if (!bucketHolds(frame->data, hash)) {
+            frame->latch.unlock();
+            releasePage(indexId, bucket);
+            continue;
+        }
+
+        // 找到后以本页末项填补空位（页内项无序）
+        bool found = false;
+        PageNum page = bucket;
+        BufferFrame* cur = frame;
+        while (true) {
+            auto* hdr = reinterpret_cast<HashBucketHeader*>(cur->data);
+            for (int i = 0; i < hdr->count && !found; ++i) {
+                char* e = hashBucketEntry(cur->data, entryLen, i);
+                if (std::memcmp(e, key.data(), keyLen) != 0 || !entryHasRid(e, keyLen, rid)) continue;
+                if (i != hdr->count - 1) std::memcpy(e, hashBucketEntry(cur->data, entryLen, hdr->count - 1), entryLen);
+                hdr->count--;
+                memManager_.markDirty(indexId, page);
+                found = true;
+            }
+            PageNum next = hdr->overflowPage;
+            if (cur != frame) releasePage(indexId, page);
+            if (found || next < 0) break;
+            rc = pinPage(indexId, next, cur);
+            if (rc != RC_OK) break;
+            page = next;
+        }
+        frame->latch.unlock();
+        releasePage(indexId, bucket);
+        if (rc != RC_OK) return rc;
+        return found ? RC_OK : RC_SLOT_NOT_FOUND;
+    }
+}
+
+RC IndexManager::hashGrow(const IndexInfo& info, uint32_t hash) {
+    const TableId indexId = info.indexId;
+    const int keyLen = info.keyLen;
+    const int entryLen = indexLeafEntryLen(info);
+    const int capacity = hashBucketCapacity(entryLen);
+    IndexLatch& latch = latchFor(indexId);
+    std::lock_guard<std::mutex> smo(latch.smo);
+
+    // 目录只在本锁下改变，查到的即是当前的桶
+    PageNum bucket;
+    RC rc = hashBucketFor(info, hash, bucket);
+    if (rc != RC_OK) return rc;
+    BufferFrame* frame = nullptr;
+    rc = pinPage(indexId, bucket, frame);
+    if (rc != RC_OK) return rc;
+    frame->latch.lock();
+
+    // 1) 取出整条链的项；其间已有删除腾出空位时不必扩展，由调用方重试插入
+    std::vector<PageNum> chain;
+    std::vector<BufferFrame*> frames;
+    std::vector<char> entries;
+    bool room = false;
+    PageNum page = bucket;
+    BufferFrame* cur = frame;
+    while (true) {
+        auto* hdr = reinterpret_cast<HashBucketHeader*>(cur->data);
+        chain.push_back(page);
+        frames.push_back(cur);
+        room = room || hdr->count < capacity;
+        entries.insert(entries.end(), hashBucketEntry(cur->data, entryLen, 0), hashBucketEntry(cur->data, entryLen, hdr->count));
+        if (hdr->overflowPage < 0) break;
+        page = hdr->overflowPage;
+        rc = pinPage(indexId, page, cur);
+        if (rc != RC_OK) break;
+    }
+    auto finish = [&]() {
+        for (size_t i = 1; i < chain.size(); ++i) releasePage(indexId, chain[i]);
+        frame->latch.unlock();
+        releasePage(indexId, bucket);
+    };
+    if (rc != RC_OK || room) {
+        finish();
+        return rc;
+    }
+
+    auto* hdr = reinterpret_cast<HashBucketHeader*>(frame->data);
+    const int depth = hdr->localDepth;
+    const int n = (int)(entries.size() / entryLen);
+    bool same = true;
+    for (int i = 0; i < n && same; ++i) same = hashIndexKey(entries.data() + (size_t)i * entryLen, keyLen) == hash;
+
+    // 2) 各项与新键哈希值全同（重复键）或局部深度已达上限时分裂腾不出空间：在桶页后挂一个溢出页
+    if (same || depth >= HASH_MAX_GLOBAL_DEPTH) {
+        PageNum overflow;
+        BufferFrame* of = nullptr;
+        rc = hashNewBucketPage(indexId, depth, hdr->hashBits, overflow, of);
+        if (rc == RC_OK) {
+            reinterpret_cast<HashBucketHeader*>(of->data)->overflowPage = hdr->overflowPage;
+            hdr->overflowPage = overflow;
+            memManager_.markDirty(indexId, bucket);
+            of->latch.unlock();
+            releasePage(indexId, overflow);
+        }
+        finish();
+        return rc;
+    }
+
+    // 3) 局部深度等于全局深度时先将目录加倍，再按第depth位分开：为0的依次填回原链各页，为1的移到新桶
+    BufferFrame* meta = nullptr;
+    rc = pinPage(indexId, info.rootPage, meta);
+    if (rc != RC_OK) {
+        finish();
+        return rc;
+    }
+    auto* mh = reinterpret_cast<HashMetaHeader*>(meta->data);
+    if (depth == mh->globalDepth) rc = hashDoubleDirectory(info, meta);
+    const uint32_t newBits = hdr->hashBits | (1u << depth);
+    PageNum newBucket = -1;
+    BufferFrame* nf = nullptr;
+    if (rc == RC_OK) rc = hashNewBucketPage(indexId, depth + 1, newBits, newBucket, nf);
+    if (rc != RC_OK) {
+        releasePage(indexId, info.rootPage);
+        finish();
+        return rc;
+    }
+
+    std::vector<char> stay, moved;
+    for (int i = 0; i < n; ++i) {
+        const char* e = entries.data() + (size_t)i * entryLen;
+        std::vector<char>& to = (hashIndexKey(e, keyLen) >> depth) & 1 ? moved : stay;
+        to.insert(to.end(), e, e + entryLen);
+    }
+    size_t off = 0;
+    for (size_t i = 0; i < chain.size(); ++i) {
+        auto* ph = reinterpret_cast<HashBucketHeader*>(frames[i]->data);
+        int k = (int)std::min<size_t>(capacity, (stay.size() - off) / entryLen);
+        ph->localDepth = depth + 1;
+        ph->count = k;
+        std::memcpy(hashBucketEntry(frames[i]->data, entryLen, 0), stay.data() + off, (size_t)k * entryLen);
+        off += (size_t)k * entryLen;
+        memManager_.markDirty(indexId, chain[i]);
+    }
+    // 新桶的页在改目录之前写好，新桶页的写锁保持到目录改完
+    off = 0;
+    PageNum tailPage = newBucket;
+    BufferFrame* tail = nf;
+    while (rc == RC_OK) {
+        auto* th = reinterpret_cast<HashBucketHeader*>(tail->data);
+        int k = (int)std::min<size_t>(capacity, (moved.size() - off) / entryLen);
+        std::memcpy(hashBucketEntry(tail->data, entryLen, 0), moved.data() + off, (size_t)k * entryLen);
+        th->count = k;
+        off += (size_t)k * entryLen;
+        if (off >= moved.size()) break;
+        PageNum overflow;
+        BufferFrame* of = nullptr;
+        rc = hashNewBucketPage(indexId, depth + 1, newBits, overflow, of);
+        if (rc != RC_OK) break;
+        th->overflowPage = overflow;
+        if (tail != nf) {
+            tail->latch.unlock();
+            releasePage(indexId, tailPage);
+        }
+        tailPage = overflow;
+        tail = of;
+    }
+    if (tail != nf) {
+        tail->latch.unlock();
+        releasePage(indexId, tailPage);
+    }
+
+    // 4) 改目录：低depth+1位等于新桶哈希位的各项指向新桶
+    if (rc == RC_OK) {
+        latch.root.lock();
+        const uint32_t size = 1u << mh->globalDepth;
+        PageNum dirPage = -1;
+        BufferFrame* dir = nullptr;
+        for (uint32_t i = newBits; i < size && rc == RC_OK; i += 1u << (depth + 1)) {
+            PageNum want = loadInt32(hashDirPageSlot(meta->data, (int)(i / HASH_DIR_PER_PAGE)));
+            if (want != dirPage) {
+                if (dir) releasePage(indexId, dirPage);
+                dir = nullptr;
+                rc = pinPage(indexId, want, dir);
+                if (rc != RC_OK) break;
+                dirPage = want;
+            }
+            storeInt32(dir->data + (i % HASH_DIR_PER_PAGE) * 4, newBucket);
+            memManager_.markDirty(indexId, dirPage);
+        }
+        if (dir) releasePage(indexId, dirPage);
+        mh->bucketCount++;
+        memManager_.markDirty(indexId, info.rootPage);
+        latch.root.unlock();
+    }
+    nf->latch.unlock();
+    releasePage(indexId, newBucket);
+    releasePage(indexId, info.rootPage);
+    finish();
+    return rc;
+}
+
+RC IndexManager::hashDoubleDirectory(const IndexInfo& info, BufferFrame* meta) {
+    const TableId indexId = info.indexId;
+    auto* mh = reinterpret_cast<HashMetaHeader*>(meta->data);
+    const uint32_t size = 1u << mh->globalDepth;
+    // 新增的目录页先分配好，持根版本锁期间只做拷贝
+    const int pages = (int)((size * 2 + HASH_DIR_PER_PAGE - 1) / HASH_DIR_PER_PAGE);
+    std::vector<PageNum> added;
+    for (int i = mh->dirPageCount; i < pages; ++i) {
+        BlockNum block;
+        RC rc = diskManager_.allocBlock(indexId, block);
+        if (rc != RC_OK) return rc;
+        added.push_back(block);
+    }
+
+    IndexLatch& latch = latchFor(indexId);
+    latch.root.lock();
+    RC rc = RC_OK;
+    for (size_t i = 0; i < added.size(); ++i) storeInt32(hashDirPageSlot(meta->data, mh->dirPageCount + (int)i), added[i]);
+    // 后一半目录项与前一半相同：目录不足一页时在首页内拷贝，否则逐页整页拷贝
+    const int half = (int)(size / HASH_DIR_PER_PAGE);
+    for (int i = 0; i < std::max(half, 1) && rc == RC_OK; ++i) {
+        PageNum from = loadInt32(hashDirPageSlot(meta->data, i));
+        PageNum to = half == 0 ? from : loadInt32(hashDirPageSlot(meta->data, i + half));
+        BufferFrame* src = nullptr;
+        BufferFrame* dst = nullptr;
+        rc = pinPage(indexId, from, src);
+        if (rc != RC_OK) break;
+        if (half == 0) {
+            std::memcpy(src->data + size * 4, src->data, size * 4);
+        } else {
+            rc = pinPage(indexId, to, dst);
+            if (rc == RC_OK) {
+                std::memcpy(dst->data, src->data, BLOCK_SIZE);
+                releasePage(indexId, to);
+            }
+        }
+        memManager_.markDirty(indexId, to);
+        releasePage(indexId, from);
+    }
+    if (rc == RC_OK) {
+        mh->globalDepth++;
+        mh->dirPageCount = std::max(mh->dirPageCount, pages);
+        memManager_.markDirty(indexId, info.rootPage);
+    }
+    latch.root.unlock();
+    return rc;
+}
+
+RC IndexManager::showHashIndex(const IndexInfo& info, const std::function<std::string(const char*, const char*)>& keyString) {
+    const TableId indexId = info.indexId;
+    const int entryLen = indexLeafEntryLen(info);
+    char meta[BLOCK_SIZE];
+    RC rc = diskManager_.readBlock(indexId, info.rootPage, meta);
+    if (rc != RC_OK) return rc;
+    auto* mh = reinterpret_cast<HashMetaHeader*>(meta);
+    std::cout << "  Meta #" << info.rootPage << " globalDepth=" << mh->globalDepth << " dirPages=" << mh->dirPageCount
+              << " buckets=" << mh->bucketCount << " capacity=" << hashBucketCapacity(entryLen) << std::endl;
+
+    // 按目录序列出各桶（多个目录项指向同一桶时只列一次）
+    std::set<PageNum> shown;
+    const uint32_t size = 1u << mh->globalDepth;
+    char dir[BLOCK_SIZE], buf[BLOCK_SIZE];
+    for (uint32_t i = 0; i < size; ++i) {
+        if (i % HASH_DIR_PER_PAGE == 0) {
+            rc = diskManager_.readBlock(indexId, loadInt32(hashDirPageSlot(meta, (int)(i / HASH_DIR_PER_PAGE))), dir);
+            if (rc != RC_OK) return rc;
+        }
+        PageNum bucket = loadInt32(dir + (i % HASH_DIR_PER_PAGE) * 4);
+        if (!shown.insert(bucket).second) continue;
+        int rows = 0, overflow = 0;
+        for (PageNum p = bucket; p >= 0; p = reinterpret_cast<HashBucketHeader*>(buf)->overflowPage) {
+            if (diskManager_.readBlock(indexId, p, buf) != RC_OK) break;
+            if (p != bucket) overflow++;
+            rows += reinterpret_cast<HashBucketHeader*>(buf)->count;
+        }
+        if (diskManager_.readBlock(indexId, bucket, buf) != RC_OK) continue;
+        auto* bh = reinterpret_cast<HashBucketHeader*>(buf);
+        std::cout << "  Bucket #" << bucket << " depth=" << bh->localDepth << " bits=" << bh->hashBits << " keys=" << rows
+                  << " overflow=" << overflow << std::endl;
+        for (int k = 0; k < std::min(bh->count, 3); ++k) {
+            const char* e = hashBucketEntry(buf, entryLen, k);
+            std::cout << "    [" << k << "] key=" << keyString(e, e + info.keyLen + 8) << " -> (" << loadInt32(e + info.keyLen) << ","
+                      << loadInt32(e + info.keyLen + 4) << ")" << std::endl;
+        }
+    }
+    return RC_OK;
+}
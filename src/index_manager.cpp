@@ -1,103 +1,653 @@
 #include "../include/index_manager.h"
 #include "../include/table_manager.h" // for page structures
+#include "../include/external_sort.h"
 #include <iostream>
 #include <cstring>
 #include <algorithm>
+#include <cstdlib>
+
+static inline void storeBigEndian32(uint32_t v, char* out) {
+    out[0] = (char)(v >> 24);
+    out[1] = (char)(v >> 16);
+    out[2] = (char)(v >> 8);
+    out[3] = (char)v;
+}
+
+static inline uint32_t loadBigEndian32(const char* in) {
+    const auto* p = reinterpret_cast<const unsigned char*>(in);
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+int indexKeyLength(AttrType type, int attrLength) {
+    return type == STRING ? attrLength + KEY_STRING_LEN_BYTES : 4;
+}
+
+void encodeIndexKey(AttrType type, const char* data, int len, int keyLen, char* out) {
+    switch (type) {
+        case INT: {
+            uint32_t bits;
+            std::memcpy(&bits, data, sizeof(bits));
+            storeBigEndian32(bits ^ 0x80000000u, out);
+            break;
+        }
+        case FLOAT: {
+            float f;
+            std::memcpy(&f, data, sizeof(f));
+            if (f == 0.0f) f = 0.0f;
+            uint32_t bits;
+            std::memcpy(&bits, &f, sizeof(bits));
+            bits = (bits & 0x80000000u) ? ~bits : (bits ^ 0x80000000u);
+            storeBigEndian32(bits, out);
+            break;
+        }
+        case STRING: {
+            int body = keyLen - KEY_STRING_LEN_BYTES;
+            int n = std::min(len, body);
+            std::memcpy(out, data, n);
+            std::memset(out + n, 0, body - n);
+            out[body] = (char)(n >> 8);
+            out[body + 1] = (char)n;
+            break;
+        }
+    }
+}
+
+void encodeValueKey(const Value& value, int keyLen, KeyBytes& key) {
+    key = KeyBytes(keyLen);
+    switch (value.type) {
+        case INT:
+            encodeIndexKey(INT, reinterpret_cast<const char*>(&value.intVal), 4, keyLen, key.data());
+            break;
+        case FLOAT:
+            encodeIndexKey(FLOAT, reinterpret_cast<const char*>(&value.floatVal), 4, keyLen, key.data());
+            break;
+        case STRING:
+            encodeIndexKey(STRING, value.strVal.data(), (int)value.strVal.size(), keyLen, key.data());
+            break;
+    }
+}
+
+void decodeIndexKey(AttrType type, const char* key, int keyLen, Value& value) {
+    value = Value();
+    value.type = type;
+    switch (type) {
+        case INT: {
+            uint32_t bits = loadBigEndian32(key) ^ 0x80000000u;
+            std::memcpy(&value.intVal, &bits, sizeof(bits));
+            break;
+        }
+        case FLOAT: {
+            uint32_t bits = loadBigEndian32(key);
+            bits = (bits & 0x80000000u) ? (bits ^ 0x80000000u) : ~bits;
+            std::memcpy(&value.floatVal, &bits, sizeof(bits));
+            break;
+        }
+        case STRING: {
+            int body = keyLen - KEY_STRING_LEN_BYTES;
+            int n = ((unsigned char)key[body] << 8) | (unsigned char)key[body + 1];
+            // 后缀截断的分隔键不含长度字段（为0），取补0之前的字符
+            if (n == 0) n = (int)strnlen(key, body);
+            value.strVal.assign(key, std::min(n, body));
+            break;
+        }
+    }
+}
+
+// 叶子项尾：RID(8字节) + 负载[payloadLen]；内部节点项尾：孩子页号(4字节) + 保留(4字节)
+// 项在页内按压缩后的键长排列，不保证对齐，项尾中的整数按字节拷贝读写
+static inline int leafTailLen(const IndexInfo& info) { return 8 + info.payloadLen; }
+
+static inline NodeFormat leafFormat(const char* page, const IndexInfo& info) {
+    return NodeFormat(page, info.keyLen, leafTailLen(info));
+}
+
+static inline NodeFormat internalFormat(const char* page, int keyLen) {
+    return NodeFormat(page, keyLen, INTERNAL_TAIL_LEN);
+}
+
+// 结构修改（分裂、借位/合并、转为posting列表）期间本线程经readPage取到的页：
+//   首次取到时加写锁并多固定一次，结构修改结束（析构）时统一解锁、解除固定
+//   结构修改的代码因此沿用readPage/releasePage配对，不必逐处加锁，释放后页仍被锁住
+class SmoLatches {
+public:
+    SmoLatches(MemManager& memManager, TableId indexId) : memManager_(memManager), indexId_(indexId) { active_ = this; }
+    ~SmoLatches() {
+        for (auto& held : held_) {
+            held.second->latch.unlock();
+            memManager_.releasePage(indexId_, held.first);
+        }
+        active_ = nullptr;
+    }
+
+    /**
+     * 本线程正在对indexId做结构修改时返回其作用域，否则返回nullptr
+     */
+    static SmoLatches* active(TableId indexId) { return active_ && active_->indexId_ == indexId ? active_ : nullptr; }
+
+    bool holds(PageNum page) const {
+        for (auto& held : held_) {
+            if (held.first == page) return true;
+        }
+        return false;
+    }
+
+    /**
+     * 锁住已固定于frame的页直到结构修改结束（已锁住时不重复加锁）
+     */
+    RC hold(PageNum page, BufferFrame* frame) {
+        if (holds(page)) return RC_OK;
+        BufferFrame* again = nullptr;
+        RC rc = memManager_.getPage(indexId_, page, again, DATA_SPACE);
+        if (rc != RC_OK) return rc;
+        frame->latch.lock();
+        held_.emplace_back(page, frame);
+        return RC_OK;
+    }
+
+private:
+    MemManager& memManager_;
+    TableId indexId_;
+    std::vector<std::pair<PageNum, BufferFrame*>> held_;
+    static thread_local SmoLatches* active_;
+};
+
+thread_local SmoLatches* SmoLatches::active_ = nullptr;
+
+// 改写不经readPage锁住的页（posting页、新分配的页）前加写锁：本线程的结构修改已锁住该页时不再加锁
+// @return 是否由本次加锁，是则改写后由调用方解锁
+static bool latchPage(TableId indexId, PageNum page, BufferFrame* frame) {
+    SmoLatches* smo = SmoLatches::active(indexId);
+    if (smo && smo->holds(page)) return false;
+    frame->latch.lock();
+    return true;
+}
+
+// 键去掉末尾0之后的长度（截断的分隔键其后均为0）
+static inline int significantLength(const char* key, int keyLen) {
+    while (keyLen > 0 && key[keyLen - 1] == 0) --keyLen;
+    return keyLen;
+}
+
+// 分裂点：在中点附近（约各1/8项数的窗口内）选分隔键最短的位置，长度相同时取更靠近中点的
+//   separatorLen(k)给出以k为分裂点时上提的分隔键长度
+template <typename SepLen>
+static int chooseSplitPoint(int lo, int hi, int mid, const SepLen& separatorLen) {
+    int window = std::max(1, (hi - lo) / 8);
+    int from = std::max(lo, mid - window), to = std::min(hi, mid + window);
+    int best = std::max(lo, std::min(hi, mid)), bestLen = separatorLen(best);
+    for (int k = from; k <= to; ++k) {
+        int len = separatorLen(k);
+        if (len < bestLen || (len == bestLen && std::abs(k - mid) < std::abs(best - mid))) {
+            best = k;
+            bestLen = len;
+        }
+    }
+    return best;
+}
 
 IndexManager::IndexManager(DataDict &dataDict, DiskManager &diskManager, MemManager &memManager, LogManager &logManager)
         : dataDict_(dataDict), diskManager_(diskManager), memManager_(memManager), logManager_(logManager) {}
 
 RC IndexManager::getKeyConfig(const char *tableName, const char *columnName, AttrType &type, int &keyLen) {
-    TableInfo t;
-    RC rc = dataDict_.findTable(tableName, t);
+    TableRef table;
+    RC rc = dataDict_.getTable(tableName, table);
     if (rc != RC_OK) return rc;
+    const TableInfo &t = table->info;
     for (int i = 0; i < t.attrCount; ++i) {
         if (strcmp(t.attrs[i].name, columnName) == 0) {
             type = t.attrs[i].type;
-            keyLen = (type == STRING) ? t.attrs[i].length : 4;
+            keyLen = indexKeyLength(type, t.attrs[i].length);
             return RC_OK;
         }
     }
     return RC_ATTR_NOT_FOUND;
 }
 
-KeyBytes IndexManager::extractKey(const char *data, int len, AttrType type, int keyLen) {
-    KeyBytes kb(keyLen);
-    // 简化：默认索引列在起始偏移（单列表或列为第一个）
-    // 更完整实现应根据DataDict计算列偏移
-    int copyLen = std::min(keyLen, len);
-    std::memcpy(kb.bytes.data(), data, copyLen);
-    if (type == STRING && copyLen < keyLen) {
-        // zero-pad
-        std::memset(kb.bytes.data() + copyLen, 0, keyLen - copyLen);
+// 谓词比较结果：cmp为列值与字面量的比较
+static bool predicateHolds(const char* op, int cmp) {
+    if (std::strcmp(op, "=") == 0) return cmp == 0;
+    if (std::strcmp(op, "!=") == 0) return cmp != 0;
+    if (std::strcmp(op, "<") == 0) return cmp < 0;
+    if (std::strcmp(op, "<=") == 0) return cmp <= 0;
+    if (std::strcmp(op, ">") == 0) return cmp > 0;
+    return cmp >= 0;
+}
+
+bool IndexManager::extractKey(const TableInfo &table, const IndexInfo &info, const char *data, int len, KeyBytes &key, char *payload) {
+    const RowLayout* layout = nullptr;
+    if (dataDict_.getRowLayout(table.tableId, layout) != RC_OK) return false;
+    RowView row(*layout, data, len);
+    if (row.isNull(info.keyColumns[0])) return false;
+
+    // 部分索引：列值与字面量都编码为保序键后比较，空值不满足任何谓词
+    for (int i = 0; i < info.predicateCount; ++i) {
+        const IndexPredicate& pred = info.predicates[i];
+        if (row.isNull(pred.column)) return false;
+        const AttrInfo& attr = table.attrs[pred.column];
+        int width = indexKeyLength(attr.type, attr.length);
+        int offset = 0, colLen = 0;
+        char buf[INDEX_PREDICATE_KEY_LEN];
+        row.columnRange(pred.column, offset, colLen);
+        encodeIndexKey(attr.type, data + offset, colLen, width, buf);
+        if (!predicateHolds(pred.op, std::memcmp(buf, pred.key, width))) return false;
+    }
+
+    // 按行布局直接定位各键列，依次编码拼接为保序键（表达式键列先对列值求表达式）；空列编码为全0并记入负载的空值位图
+    key = KeyBytes(info.keyLen);
+    char* nulls = payload;
+    if (info.payloadLen > 0) std::memset(payload, 0, info.payloadLen);
+    char exprBuf[MAX_INDEX_KEY_LEN];   // 表达式键列宽不超过键长，前缀只取前arg个字符
+    auto encodeColumn = [&](int col, ColumnExpr expr, int width, int bit, char* out) {
+        const AttrInfo& attr = table.attrs[col];
+        if (row.isNull(col)) {
+            std::memset(out, 0, width);
+            nulls[bit >> 3] |= (char)(1 << (bit & 7));
+        } else {
+            int offset = 0, colLen = 0;
+            row.columnRange(col, offset, colLen);
+            const char* src = data + offset;
+            if (expr != ColumnExpr::NONE) {
+                colLen = applyColumnExpr(expr, info.keyExprArgs[bit], src, colLen, exprBuf);
+                src = exprBuf;
+            }
+            encodeIndexKey(attr.type, src, colLen, width, out);
+        }
+        return width;
+    };
+    int offset = 0;
+    for (int i = 0; i < info.keyColumnCount; ++i) {
+        offset += encodeColumn(info.keyColumns[i], (ColumnExpr)info.keyExprs[i], indexKeyPartLength(table, info, i), i,
+                               key.data() + offset);
+    }
+    offset = INDEX_NULL_BITMAP_LEN;
+    for (int i = 0; i < info.includeCount; ++i) {
+        const AttrInfo& attr = table.attrs[info.includeColumns[i]];
+        offset += encodeColumn(info.includeColumns[i], ColumnExpr::NONE, indexKeyLength(attr.type, attr.length),
+                               info.keyColumnCount + i, payload + offset);
+    }
+    return true;
+}
+
+std::vector<int> IndexManager::extractColumns(const IndexInfo& info) {
+    std::vector<int> columns(info.keyColumns, info.keyColumns + info.keyColumnCount);
+    columns.insert(columns.end(), info.includeColumns, info.includeColumns + info.includeCount);
+    for (int i = 0; i < info.predicateCount; ++i) columns.push_back(info.predicates[i].column);
+    return columns;
+}
+
+int indexKeyPartLength(const TableInfo& table, const IndexInfo& info, int i) {
+    const AttrInfo& attr = table.attrs[info.keyColumns[i]];
+    return indexKeyLength(attr.type, (ColumnExpr)info.keyExprs[i] == ColumnExpr::PREFIX ? info.keyExprArgs[i] : attr.length);
+}
+
+// 第bit个空值位是否置位（payload为nullptr或无位图时视为非空）
+static bool payloadNull(const IndexInfo& info, const char* payload, int bit) {
+    return payload && info.payloadLen > 0 && (payload[bit >> 3] >> (bit & 7)) & 1;
+}
+
+void decodeIndexKeyPart(const TableInfo& table, const IndexInfo& info, const char* key, const char* payload, int i, Value& value) {
+    int offset = 0;
+    for (int k = 0; k < i; ++k) offset += indexKeyPartLength(table, info, k);
+    const AttrInfo& attr = table.attrs[info.keyColumns[i]];
+    if (payloadNull(info, payload, i)) {
+        value = Value();
+        value.type = attr.type;
+        value.isNull = true;
+        return;
+    }
+    decodeIndexKey(attr.type, key + offset, indexKeyPartLength(table, info, i), value);
+}
+
+bool indexCoversColumn(const IndexInfo& info, int col) {
+    for (int i = 0; i < info.keyColumnCount; ++i) {
+        if (info.keyColumns[i] == col && (ColumnExpr)info.keyExprs[i] == ColumnExpr::NONE) return true;
+    }
+    for (int i = 0; i < info.includeCount; ++i) {
+        if (info.includeColumns[i] == col) return true;
+    }
+    return false;
+}
+
+bool decodeIndexColumn(const TableInfo& table, const IndexInfo& info, const char* key, const char* payload, int col, Value& value) {
+    for (int i = 0; i < info.keyColumnCount; ++i) {
+        if (info.keyColumns[i] == col && (ColumnExpr)info.keyExprs[i] == ColumnExpr::NONE) {
+            decodeIndexKeyPart(table, info, key, payload, i, value);
+            return true;
+        }
+    }
+    if (!payload) return false;
+    int offset = INDEX_NULL_BITMAP_LEN;
+    for (int i = 0; i < info.includeCount; ++i) {
+        const AttrInfo& attr = table.attrs[info.includeColumns[i]];
+        if (info.includeColumns[i] == col) {
+            if (payloadNull(info, payload, info.keyColumnCount + i)) {
+                value = Value();
+                value.type = attr.type;
+                value.isNull = true;
+            } else {
+                decodeIndexKey(attr.type, payload + offset, indexKeyLength(attr.type, attr.length), value);
+            }
+            return true;
+        }
+        offset += indexKeyLength(attr.type, attr.length);
+    }
+    return false;
+}
+
+// 部分索引的谓词：字面量按列的保序键编码存放（空值字面量不匹配任何行，不允许）
+static RC encodePredicates(const TableInfo& table, const std::vector<IndexCondition>& where, std::vector<IndexPredicate>& out) {
+    static const char* const ops[] = {"=", "!=", "<", "<=", ">", ">="};
+    for (const auto& cond : where) {
+        IndexPredicate pred{};
+        int col = findAttrIndex(table.attrCount, table.attrs, cond.column.c_str());
+        if (col < 0) return RC_ATTR_NOT_FOUND;
+        std::string op = cond.op == "==" ? "=" : (cond.op == "<>" ? "!=" : cond.op);
+        if (std::none_of(std::begin(ops), std::end(ops), [&](const char* o) { return op == o; })) return RC_INVALID_ARG;
+        const AttrInfo& attr = table.attrs[col];
+        int width = indexKeyLength(attr.type, attr.length);
+        if (width > INDEX_PREDICATE_KEY_LEN) return RC_INVALID_ARG;
+        Value v;
+        RC rc = parseValue(attr, cond.literal, v);
+        if (rc != RC_OK) return rc;
+        if (v.isNull) return RC_INVALID_ARG;
+        KeyBytes key;
+        encodeValueKey(v, width, key);
+        pred.column = (int16_t)col;
+        std::strcpy(pred.op, op.c_str());
+        std::memcpy(pred.key, key.data(), width);
+        out.push_back(pred);
     }
-    return kb;
+    return RC_OK;
 }
 
-RC IndexManager::createIndex(TransactionId txId, const char* indexName, const char* tableName, const char* columnName, bool unique) {
+RC IndexManager::createIndex(TransactionId txId, const char* indexName, const char* tableName, const char* columnName, bool unique,
+                             int fillPct) {
     if (!indexName || !tableName || !columnName) return RC_INVALID_ARG;
+    return createIndex(txId, indexName, tableName, std::vector<std::string>{columnName}, {}, unique, fillPct);
+}
+
+RC IndexManager::createIndex(TransactionId txId, const char* indexName, const char* tableName, const std::vector<std::string>& keyColumns,
+                             const std::vector<std::string>& includeColumns, bool unique, int fillPct, IndexMethod method,
+                             const std::vector<IndexCondition>& where) {
+    if (!indexName || !tableName) return RC_INVALID_ARG;
+    TableRef tableRef;
+    RC rc = dataDict_.getTable(tableName, tableRef);
+    if (rc != RC_OK) return rc;
+    const TableInfo &table = tableRef->info;
+    std::vector<IndexPredicate> predicates;
+    rc = encodePredicates(table, where, predicates);
+    if (rc != RC_OK) return rc;
 
     // 1) 在数据字典中创建索引元数据（并创建索引文件）
     IndexInfo info{};
-    RC rc = dataDict_.createIndexMetadata(txId, indexName, tableName, columnName, unique, info);
+    rc = dataDict_.createIndexMetadata(txId, indexName, tableName, keyColumns, includeColumns, unique, method, predicates, info);
     if (rc != RC_OK) return rc;
 
-    // 2) 分配并初始化根页（叶子）
-    int maxKeys = calcMaxKeys(info.keyLen);
-    BlockNum rootBlock;
-    rc = diskManager_.allocBlock(info.indexId, rootBlock);
-    if (rc != RC_OK) return rc;
-    rc = initNewIndexRoot(info.indexId, rootBlock, maxKeys, true);
+    // 2) 分配并初始化根页（叶子；哈希索引为元页与空桶），将当前统计写回
+    rc = resetIndex(info);
     if (rc != RC_OK) return rc;
 
-    info.rootPage = rootBlock;
-    info.height = 1;
+    // 3) 从现有表数据批量构建索引（部分索引只收集满足谓词的行）
+    if (table.firstPage == -1 || table.recordCount == 0) return RC_OK;
+    if (info.method == IndexMethod::HASH) return buildHashIndex(info, table);
+    return bulkBuild(info, table, fillPct);
+}
 
-    // 3) 将当前统计写回（pages等由文件头决定）
-    TableFileHeader fh; rc = diskManager_.readTableFileHeader(info.indexId, fh);
-    if (rc == RC_OK) {
-        info.totalPages = fh.usedBlocks;
-    }
-    info.totalKeys = 0;
+RC IndexManager::bulkBuild(IndexInfo& info, const TableInfo& table, int fillPct) {
+    const TableId indexId = info.indexId;
+    const int keyLen = info.keyLen;
+    const int entryLen = indexLeafEntryLen(info);
+    const int tailLen = leafTailLen(info);
+    const int maxKeys = calcMaxKeys(keyLen);
+    const int leafMaxKeys = calcLeafMaxKeys(info);
+    fillPct = std::max(50, std::min(100, fillPct));
+    // 节点按压缩后的字节数填充：前缀与0区段随页内的键而定，逐项估计
+    const int fillBytes = BLOCK_SIZE * fillPct / 100;
+
+    // 1) 顺序扫描表（按表的页面格式解码，溢出记录已拼接完整），收集(键, RID, 负载)并排序
+    //    RID按大端序附在键后，整条记录按memcmp排序即为(键, RID)顺序（(键, RID)唯一，负载不影响顺序）
+    ExternalSorter sorter(entryLen, buildSortMem_, diskManager_.getDbName() + "_sort" + std::to_string(indexId) + ".tmp");
+    RC rc = RC_OK;
+    KeyBytes kb;
+    std::vector<char> rec(entryLen);
+    const std::vector<int> columns = extractColumns(info);
+    RC scanRc = TableManager::scanRecords(memManager_, dataDict_, table, [&](const RID& rid, const char* data, int len) {
+        if (!extractKey(table, info, data, len, kb, rec.data() + keyLen + 8)) return true;
+        std::memcpy(rec.data(), kb.data(), keyLen);
+        storeBigEndian32((uint32_t)rid.pageNum, rec.data() + keyLen);
+        storeBigEndian32((uint32_t)(int32_t)rid.slotNum, rec.data() + keyLen + 4);
+        rc = sorter.add(rec.data());
+        return rc == RC_OK;
+    }, 1, nullptr, &columns);
+    if (rc != RC_OK) return rc;
+    if (scanRc != RC_OK) return scanRc;
+    rc = sorter.finish();
+    if (rc != RC_OK) return rc;
 
-    dataDict_.updateIndexInfo(info);
+    // 2) 自左向右填充叶子：压缩后将超过fillBytes时写出当前叶子并换新页；resetIndex分配的空根叶子作为第一个叶子
+    //    level记录当前层各节点的 (分隔键 + 页号)，叶子的分隔键取与前一叶子末键之间的最短键（第一个节点的不用）
+    const int levelEntry = keyLen + 4;
+    std::vector<char> level(levelEntry, 0);
+    std::memcpy(level.data() + keyLen, &info.rootPage, 4);
 
-    // 4) 从现有表数据回填构建索引
-    TableInfo table;
-    rc = dataDict_.findTable(tableName, table);
+    PageNum leafPage = info.rootPage;
+    BufferFrame* leaf = nullptr;
+    rc = readPage(indexId, leafPage, leaf);
     if (rc != RC_OK) return rc;
+    NodeImage node(keyLen, tailLen);
+    NodeSizer sizer(keyLen, tailLen);
+    node.load(leaf->data);
+    std::vector<char> tail(tailLen);
+    int64_t total = 0;
+
+    // 追加一个叶子项：压缩后将超过fillBytes时先写出当前叶子并换新页
+    auto emit = [&](const char* key) -> RC {
+        int n = node.count();
+        if (n > 0 && sizer.sizeWith(key) > fillBytes) {
+            BlockNum next;
+            RC erc = diskManager_.allocBlock(indexId, next);
+            if (erc == RC_OK) erc = initNewIndexRoot(indexId, next, leafMaxKeys, true);
+            if (erc != RC_OK) return erc;
+            node.header().nextPage = next;
+            node.store(leaf->data);
+            memManager_.markDirty(indexId, leafPage);
+            releasePage(indexId, leafPage);
+
+            size_t at = level.size();
+            level.resize(at + levelEntry);
+            makeSeparator(node.key(n - 1), key, keyLen, level.data() + at);
+            std::memcpy(level.data() + at + keyLen, &next, 4);
+
+            PageNum prev = leafPage;
+            leafPage = next;
+            erc = readPage(indexId, leafPage, leaf);
+            if (erc != RC_OK) { leaf = nullptr; return erc; }
+            node.load(leaf->data);
+            node.header().prevPage = prev;
+            sizer.reset();
+        }
+        node.insert(node.count(), key, tail.data());
+        sizer.add(key);
+        return RC_OK;
+    };
+
+    // posting索引：同一键的各RID（已按RID有序）收集为一组，达到postingThreshold时写入posting链，否则逐行存放
+    const bool postings = indexUsesPostings(info);
+    const int threshold = postingThreshold(info);
+    std::vector<char> runKey(keyLen);
+    std::vector<uint64_t> run;
+    auto flushRun = [&]() -> RC {
+        RC frc = RC_OK;
+        if ((int)run.size() >= threshold) {
+            PageNum head;
+            frc = writePostingChain(indexId, run.data(), (int)run.size(), head);
+            storeInt32(tail.data(), POSTING_RID_PAGE);
+            storeInt32(tail.data() + 4, head);
+            if (frc == RC_OK) frc = emit(runKey.data());
+        } else {
+            for (size_t k = 0; k < run.size() && frc == RC_OK; ++k) {
+                RID one = ridFromOrdinal(run[k]);
+                storeInt32(tail.data(), one.pageNum);
+                storeInt32(tail.data() + 4, one.slotNum);
+                frc = emit(runKey.data());
+            }
+        }
+        run.clear();
+        return frc;
+    };
+
+    std::vector<char> valueKey(keyLen);   // 唯一索引：最近一个键中无空值列的项的键
+    bool haveValue = false;
+    const char* r = nullptr;
+    while (rc == RC_OK && sorter.next(r)) {
+        PageNum ridPage = (int32_t)loadBigEndian32(r + keyLen);
+        SlotNum ridSlot = (SlotNum)(int32_t)loadBigEndian32(r + keyLen + 4);
+        total++;
+        if (postings) {
+            if (!run.empty() && std::memcmp(runKey.data(), r, keyLen) != 0) rc = flushRun();
+            if (run.empty()) std::memcpy(runKey.data(), r, keyLen);
+            run.push_back(ridOrdinal(RID(ridPage, ridSlot)));
+            continue;
+        }
+        // 唯一索引跳过重复键（与逐行插入时违反唯一性的行为一致）；键中有空值列的项不参与比较
+        if (info.unique && !indexKeyHasNull(info, r + keyLen + 8)) {
+            if (haveValue && std::memcmp(valueKey.data(), r, keyLen) == 0) { total--; continue; }
+            std::memcpy(valueKey.data(), r, keyLen);
+            haveValue = true;
+        }
+        storeInt32(tail.data(), ridPage);
+        storeInt32(tail.data() + 4, ridSlot);
+        std::memcpy(tail.data() + 8, r + keyLen + 8, info.payloadLen);
+        rc = emit(r);
+    }
+    if (rc == RC_OK) rc = flushRun();
+    if (rc != RC_OK) { if (leaf) releasePage(indexId, leafPage); return rc; }
+    if (sorter.status() != RC_OK) { releasePage(indexId, leafPage); return sorter.status(); }
+
+    // 最后一个叶子不足半满时，从前一个叶子匀过来若干项（两页重新压缩后都放得下时），并更新其分隔键
+    if (node.header().prevPage != -1 && node.count() < minKeysForNode(leafMaxKeys)) {
+        PageNum prevPage = node.header().prevPage;
+        BufferFrame* prev = nullptr;
+        rc = readPage(indexId, prevPage, prev);
+        if (rc != RC_OK) { releasePage(indexId, leafPage); return rc; }
+        NodeImage left(keyLen, tailLen), right(keyLen, tailLen);
+        left.load(prev->data);
+        int move = (left.count() + node.count()) / 2 - node.count();
+        right.header() = node.header();
+        right.append(left, left.count() - move, left.count());
+        right.append(node, 0, node.count());
+        left.erase(left.count() - move, left.count());
+        if (move > 0 && right.packedSize() <= BLOCK_SIZE) {
+            left.store(prev->data);
+            node = right;
+            makeSeparator(left.key(left.count() - 1), node.key(0), keyLen, level.data() + level.size() - levelEntry);
+            memManager_.markDirty(indexId, prevPage);
+        }
+        releasePage(indexId, prevPage);
+    }
+    node.store(leaf->data);
+    memManager_.markDirty(indexId, leafPage);
+    releasePage(indexId, leafPage);
 
-    if (table.firstPage != -1 && table.recordCount > 0) {
-        // 顺序扫描（简化：假设页连续）
-        for (PageNum p = table.firstPage; p <= table.lastPage; ++p) {
-            BufferFrame* f = nullptr; RC rr = memManager_.getPage(table.tableId, p, f, DATA_SPACE);
-            if (rr != RC_OK) continue;
-            auto* vh = reinterpret_cast<VarPageHeader*>(f->data);
-            int slots = vh->recordCount + vh->deletedCount;
-            for (int s = 0; s < slots; ++s) {
-                auto* slot = reinterpret_cast<RecordSlot*>(f->data + sizeof(VarPageHeader) + s * sizeof(RecordSlot));
-                if (slot->isDeleted) continue;
-                char* rec = f->data + slot->offset; int len = slot->length;
-                KeyBytes kb = extractKey(rec, len, info.keyType, info.keyLen);
-                RC irc = insertKey(info.indexId, info, kb, RID(p, (SlotNum)s));
-                if (irc == RC_OK) info.totalKeys++;
+    // 3) 逐层向上构建内部节点：按压缩后的字节数分组，每组首个孩子的分隔键上提一层
+    //    最后一组只有一个孩子（没有键）时，从前一组移过来一个孩子
+    int height = 1;
+    char childTail[INTERNAL_TAIL_LEN] = {0};
+    NodeSizer groupSizer(keyLen, INTERNAL_TAIL_LEN);
+    while (level.size() > (size_t)levelEntry) {
+        int children = (int)(level.size() / levelEntry);
+        std::vector<int> starts{0};
+        groupSizer.reset();
+        for (int k = 1; k < children; ++k) {
+            const char* sep = level.data() + (size_t)k * levelEntry;
+            if (groupSizer.count() > 0 && groupSizer.sizeWith(sep) > fillBytes) {
+                starts.push_back(k);
+                groupSizer.reset();
+                continue;
             }
-            memManager_.releasePage(table.tableId, p);
+            groupSizer.add(sep);
+        }
+        if (starts.size() > 1 && starts.back() == children - 1) {
+            if (starts.back() - starts[starts.size() - 2] >= 3) starts.back()--;
+            else starts.pop_back();  // 前一组只有两个孩子（键很长时）：并入前一组，两个键总能放下
         }
-        // 更新统计（usedBlocks可能增长）
-        if (diskManager_.readTableFileHeader(info.indexId, fh) == RC_OK) {
-            info.totalPages = fh.usedBlocks;
+        starts.push_back(children);
+
+        std::vector<char> upper;
+        upper.reserve((starts.size() - 1) * levelEntry);
+        for (size_t j = 0; j + 1 < starts.size(); ++j) {
+            BlockNum page;
+            rc = diskManager_.allocBlock(indexId, page);
+            if (rc == RC_OK) rc = initNewIndexRoot(indexId, page, maxKeys, false);
+            BufferFrame* frame = nullptr;
+            if (rc == RC_OK) rc = readPage(indexId, page, frame);
+            if (rc != RC_OK) return rc;
+
+            NodeImage inner(keyLen, INTERNAL_TAIL_LEN);
+            inner.load(frame->data);
+            for (int k = starts[j]; k < starts[j + 1]; ++k) {
+                const char* src = level.data() + (size_t)k * levelEntry;
+                PageNum child;
+                std::memcpy(&child, src + keyLen, 4);
+                if (k == starts[j]) {
+                    inner.header().leftMostChild = child;
+                    continue;
+                }
+                storeInt32(childTail, child);
+                inner.insert(inner.count(), src, childTail);
+            }
+            bool stored = inner.store(frame->data);
+            memManager_.markDirty(indexId, page);
+            releasePage(indexId, page);
+            if (!stored) return RC_INVALID_OP;
+
+            const char* first = level.data() + (size_t)starts[j] * levelEntry;
+            upper.insert(upper.end(), first, first + keyLen);
+            upper.insert(upper.end(), reinterpret_cast<const char*>(&page), reinterpret_cast<const char*>(&page) + 4);
         }
-        dataDict_.updateIndexInfo(info);
+        level.swap(upper);
+        height++;
     }
 
-    return RC_OK;
+    std::memcpy(&info.rootPage, level.data() + keyLen, 4);
+    info.height = height;
+    info.totalKeys = (int)total;
+    TableFileHeader fh;
+    if (diskManager_.readTableFileHeader(indexId, fh) == RC_OK) {
+        info.totalPages = fh.usedBlocks;
+    }
+    return publishIndexInfo(info);
+}
+
+RC IndexManager::resetIndex(IndexInfo& info) {
+    if (info.method == IndexMethod::HASH) return resetHashIndex(info);
+    dropCache(info.indexId);
+    int maxKeys = calcLeafMaxKeys(info);
+    BlockNum rootBlock;
+    RC rc = diskManager_.allocBlock(info.indexId, rootBlock);
+    if (rc != RC_OK) return rc;
+    rc = initNewIndexRoot(info.indexId, rootBlock, maxKeys, true);
+    if (rc != RC_OK) return rc;
+
+    info.rootPage = rootBlock;
+    info.height = 1;
+
+    // pages等由文件头决定
+    TableFileHeader fh;
+    if (diskManager_.readTableFileHeader(info.indexId, fh) == RC_OK) {
+        info.totalPages = fh.usedBlocks;
+    }
+    info.totalKeys = 0;
+
+    return publishIndexInfo(info);
 }
 
 RC IndexManager::initNewIndexRoot(TableId indexId, PageNum rootPage, int maxKeys, bool leaf) {
     BufferFrame* frame = nullptr;
     RC rc = memManager_.getPage(indexId, rootPage, frame, DATA_SPACE);
     if (rc != RC_OK) return rc;
+    // 页号可能是刚释放的页，仍有乐观读者固定着它：改写期间加锁使其校验失败
+    bool locked = latchPage(indexId, rootPage, frame);
     std::memset(frame->data, 0, BLOCK_SIZE);
     auto* hdr = reinterpret_cast<IndexPageHeader*>(frame->data);
     hdr->nodeType = leaf ? (uint8_t)IndexNodeType::LEAF : (uint8_t)IndexNodeType::INTERNAL;
@@ -106,14 +656,24 @@ RC IndexManager::initNewIndexRoot(TableId indexId, PageNum rootPage, int maxKeys
     hdr->nextPage = -1;
     hdr->keyCount = 0;
     hdr->maxKeys = (int16_t)maxKeys;
-    hdr->parentPage = -1;
     hdr->leftMostChild = -1; // always initialize as invalid
+    if (locked) frame->latch.unlock();
     memManager_.markDirty(indexId, rootPage);
     memManager_.releasePage(indexId, rootPage);
     return RC_OK;
 }
 
 RC IndexManager::readPage(TableId indexId, PageNum pageNum, BufferFrame *&frame) {
+    RC rc = memManager_.getPage(indexId, pageNum, frame, DATA_SPACE);
+    SmoLatches* smo = SmoLatches::active(indexId);
+    if (rc == RC_OK && smo) {
+        rc = smo->hold(pageNum, frame);
+        if (rc != RC_OK) memManager_.releasePage(indexId, pageNum);
+    }
+    return rc;
+}
+
+RC IndexManager::pinPage(TableId indexId, PageNum pageNum, BufferFrame *&frame) {
     return memManager_.getPage(indexId, pageNum, frame, DATA_SPACE);
 }
 
@@ -121,22 +681,88 @@ void IndexManager::releasePage(TableId indexId, PageNum pageNum) {
     memManager_.releasePage(indexId, pageNum);
 }
 
-static inline char* leafEntryPtr(char* base, int keyLen, int pos) {
-    return base + sizeof(IndexPageHeader) + pos * (keyLen + 8);
+IndexManager::IndexLatch& IndexManager::latchFor(TableId indexId) {
+    std::lock_guard<std::mutex> guard(latchesMutex_);
+    std::unique_ptr<IndexLatch>& latch = latches_[indexId];
+    if (!latch) {
+        latch.reset(new IndexLatch());
+        // 此前的换根都经过updateRoot/publishIndexInfo，会先建立这里的状态，因此字典中的值就是当前值
+        IndexInfo info;
+        if (dataDict_.findIndexById(indexId, info) == RC_OK) {
+            latch->rootPage = info.rootPage;
+            latch->height = info.height;
+        }
+    }
+    return *latch;
 }
 
-static inline char* internalEntryPtr(char* base, int keyLen, int pos) {
-    // entries arranged immediately after header: repeated (key[keyLen] + childPage[4] + pad[4])
-    return base + sizeof(IndexPageHeader) + pos * (keyLen + 8);
+RC IndexManager::descend(TableId indexId, const IndexInfo& info, const KeyBytes* key, bool leftmost, PageNum& leafPage,
+                         BufferFrame*& frame, uint64_t& version, KeyBytes* fence) {
+    IndexLatch& latch = latchFor(indexId);
+    while (true) {
+        if (fence) fence->len = 0;
+        // 根页号由根版本锁保护：固定根页并取到其版本号后校验根未被更换
+        uint64_t rootVersion = latch.root.readLock();
+        PageNum cur = latch.rootPage.load(std::memory_order_acquire);
+        if (cur < 0) return RC_PAGE_NOT_FOUND;
+        BufferFrame* node = nullptr;
+        RC rc = pinPage(indexId, cur, node);
+        if (rc != RC_OK) return rc;
+        uint64_t v = node->latch.readLock();
+        bool valid = latch.root.validate(rootVersion);
+
+        while (valid) {
+            auto* hdr = reinterpret_cast<IndexPageHeader*>(node->data);
+            if (hdr->nodeType == (uint8_t)IndexNodeType::LEAF) {
+                leafPage = cur;
+                frame = node;
+                version = v;
+                return RC_OK;
+            }
+            // internal: 第一个大于（leftmost时为不小于）key的分隔键左侧的孩子；无key时取最左/最右孩子
+            // 页可能正被改写，格式不合理时不查找，读出的孩子页号经校验后才使用
+            NodeFormat fmt = internalFormat(node->data, info.keyLen);
+            int32_t child = -1;
+            if (fmt.consistent(node->data)) {
+                int n = hdr->keyCount;
+                int pos = key ? (leftmost ? nodeLowerBound(node->data, fmt, key->data()) : nodeUpperBound(node->data, fmt, key->data()))
+                              : (leftmost ? 0 : n);
+                child = pos == 0 ? hdr->leftMostChild : loadInt32(nodeTail(node->data, fmt, pos - 1));
+                // 孩子右侧的分隔键即其上界；越往下越紧，没有右侧分隔键时沿用上层的
+                if (fence && pos < n) {
+                    nodeGetKey(node->data, fmt, pos, fence->bytes);
+                    fence->len = info.keyLen;
+                }
+            }
+            if (!node->latch.validate(v)) break;
+            if (child < 0) { releasePage(indexId, cur); return RC_PAGE_NOT_FOUND; }
+
+            BufferFrame* next = nullptr;
+            rc = pinPage(indexId, child, next);
+            if (rc != RC_OK) { releasePage(indexId, cur); return rc; }
+            uint64_t nv = next->latch.readLock();
+            // 取到孩子的版本号后再校验父页：此后孩子若被拆分/合并，其版本号必定改变
+            valid = node->latch.validate(v);
+            releasePage(indexId, valid ? cur : child);
+            if (valid) {
+                cur = child;
+                node = next;
+                v = nv;
+            }
+        }
+        releasePage(indexId, cur);
+    }
 }
 
-RC IndexManager::findLeaf(TableId indexId, const IndexInfo& info, const KeyBytes &key, PageNum &leafPage, std::vector<PageNum>* path) {
-    PageNum cur = info.rootPage;
+RC IndexManager::descendForSmo(TableId indexId, const IndexInfo& info, const KeyBytes& key, bool leftmost, PageNum& leafPage,
+                                std::vector<PageNum>& path) {
+    // 调用方持有结构修改互斥锁，根在此期间不会改变
+    PageNum cur = latchFor(indexId).rootPage.load(std::memory_order_acquire);
     if (cur < 0) return RC_PAGE_NOT_FOUND; // should not
+    path.clear();
     while (true) {
-        if (path) path->push_back(cur);
         BufferFrame* frame = nullptr;
-        RC rc = readPage(indexId, cur, frame);
+        RC rc = pinPage(indexId, cur, frame);
         if (rc != RC_OK) return rc;
         auto* hdr = reinterpret_cast<IndexPageHeader*>(frame->data);
         if (hdr->nodeType == (uint8_t)IndexNodeType::LEAF) {
@@ -144,376 +770,1026 @@ RC IndexManager::findLeaf(TableId indexId, const IndexInfo& info, const KeyBytes
             releasePage(indexId, cur);
             return RC_OK;
         }
-        // internal: decide child
-        int n = hdr->keyCount;
-        int keyLen = info.keyLen;
-        int32_t child = hdr->leftMostChild; // default
-        bool decided = false;
-        for (int i = 0; i < n; ++i) {
-            char* entry = internalEntryPtr(frame->data, keyLen, i);
-            KeyBytes k(keyLen); std::memcpy(k.bytes.data(), entry, keyLen);
-            int cmp = key.compare(k);
-            if (cmp < 0) {
-                // go to child to the left of this key
-                if (i == 0) child = hdr->leftMostChild;
-                else child = *reinterpret_cast<int32_t*>(internalEntryPtr(frame->data, keyLen, i-1) + keyLen);
-                decided = true;
-                break;
-            }
-        }
-        if (!decided) {
-            if (n == 0) { releasePage(indexId, cur); return RC_PAGE_NOT_FOUND; }
-            child = *reinterpret_cast<int32_t*>(internalEntryPtr(frame->data, keyLen, n-1) + keyLen);
-        }
+        NodeFormat fmt = internalFormat(frame->data, info.keyLen);
+        int pos = leftmost ? nodeLowerBound(frame->data, fmt, key.data()) : nodeUpperBound(frame->data, fmt, key.data());
+        int32_t child = pos == 0 ? hdr->leftMostChild : loadInt32(nodeTail(frame->data, fmt, pos - 1));
         releasePage(indexId, cur);
+        if (child < 0) return RC_PAGE_NOT_FOUND;
+        path.push_back(cur);
         cur = child;
     }
 }
 
-RC IndexManager::insertKey(TableId indexId, const IndexInfo &info, const KeyBytes &key, const RID &rid) {
-    // 1. 定位叶子
-    PageNum leafPage;
-    std::vector<PageNum> path;
-    RC rc = findLeaf(indexId, info, key, leafPage, &path);
+RC IndexManager::openScan(const char* indexName, const KeyBytes* low, bool lowInclusive, const KeyBytes* high, bool highInclusive,
+                          ScanDirection direction, IndexScan& scan, bool prefetch) {
+    IndexRef ref;
+    RC rc = dataDict_.getIndex(indexName, ref);
     if (rc != RC_OK) return rc;
+    const IndexInfo& info = ref->info;
+    auto validBound = [&](const KeyBytes* b) { return !b || (b->size() > 0 && b->size() <= info.keyLen); };
+    if (!validBound(low) || !validBound(high)) return RC_INVALID_ARG;
+
+    scan.mgr_ = this;
+    scan.index_ = ref;
+    scan.keyLen_ = info.keyLen;
+    scan.tailLen_ = leafTailLen(info);
+    scan.hasLow_ = low != nullptr;
+    scan.hasHigh_ = high != nullptr;
+    if (low) scan.low_ = *low;
+    if (high) scan.high_ = *high;
+    scan.lowInclusive_ = lowInclusive;
+    scan.highInclusive_ = highInclusive;
+    scan.direction_ = direction;
+    scan.prefetch_ = prefetch;
+    scan.status_ = RC_OK;
+    scan.lastKey_ = nullptr;
+    scan.lastTail_ = nullptr;
+    scan.postings_.clear();
+    scan.postingPos_ = 0;
+    scan.done_ = true;
+    scan.point_ = false;
+    scan.pointEntries_.clear();
+    scan.pointPos_ = 0;
+
+    // 哈希索引：一次探测取出该键的全部项
+    bool pointLookup = low && high && lowInclusive && highInclusive && low->size() == info.keyLen && low->compare(*high) == 0;
+    if (info.method == IndexMethod::HASH) {
+        if (!pointLookup) return RC_INVALID_ARG;
+        rc = hashProbe(info, *low, scan.pointEntries_);
+        if (rc != RC_OK) return rc;
+        scan.point_ = true;
+        scan.done_ = false;
+        return RC_OK;
+    }
+    // 有ART镜像时完整键的等值扫描先查镜像，未命中再下降B+树
+    if (pointLookup && info.cached && cacheLookup(info, *low, scan.pointEntries_)) {
+        scan.point_ = true;
+        scan.done_ = false;
+        return RC_OK;
+    }
 
-    BufferFrame* leafFrame = nullptr;
-    rc = readPage(indexId, leafPage, leafFrame);
+    // 下降到起点所在叶子：包含边界时定位到相同键的最外侧，不包含时越过相同键
+    // 前缀边界补齐到键长：定位到前缀相同的第一项之前时补0x00，越过前缀相同的各项时补0xFF
+    const bool forward = direction == ScanDirection::FORWARD;
+    const KeyBytes* bound = forward ? low : high;
+    bool inclusive = forward ? lowInclusive : highInclusive;
+    scan.hasStart_ = bound != nullptr;
+    scan.startUpper_ = forward != inclusive;
+    scan.start_ = KeyBytes(info.keyLen);
+    if (bound) {
+        std::memcpy(scan.start_.data(), bound->data(), bound->size());
+        std::memset(scan.start_.data() + bound->size(), scan.startUpper_ ? 0xFF : 0x00, info.keyLen - bound->size());
+    }
+    scan.runKey_ = KeyBytes(info.keyLen);
+    scan.runIds_.clear();
+    scan.examined_ = false;
+    scan.resumed_ = false;
+    rc = scan.seek(bound ? scan.start_.data() : nullptr, scan.startUpper_);
     if (rc != RC_OK) return rc;
-    auto* hdr = reinterpret_cast<IndexPageHeader*>(leafFrame->data);
-    int n = hdr->keyCount;
-    int keyLen = info.keyLen;
-
-    // 唯一性检查（线性）
-    if (info.unique) {
-        for (int i = 0; i < n; ++i) {
-            char* p = leafEntryPtr(leafFrame->data, keyLen, i);
-            if (std::memcmp(p, key.bytes.data(), keyLen) == 0) {
-                releasePage(indexId, leafPage);
-                return RC_INVALID_OP; // 违反唯一性
-            }
-        }
+    scan.done_ = false;
+    return RC_OK;
+}
+
+RC IndexScan::seek(const char* key, bool upper) {
+    const IndexInfo& info = index_->info;
+    const bool forward = direction_ == ScanDirection::FORWARD;
+    KeyBytes target(keyLen_);
+    if (key) std::memcpy(target.data(), key, keyLen_);
+    // 拷贝的须是下降时校验过的那个版本，否则起点附近的项可能已被分裂移到相邻叶子
+    while (true) {
+        PageNum leaf;
+        BufferFrame* frame = nullptr;
+        uint64_t version;
+        RC rc = mgr_->descend(info.indexId, info, key ? &target : nullptr, key ? !upper : forward, leaf, frame, version);
+        if (rc != RC_OK) return rc;
+        bool copied = copyLeaf(frame, version);
+        mgr_->releasePage(info.indexId, leaf);
+        if (copied) break;
     }
 
-    // 2. 查找插入位置
-    int pos = 0;
-    for (; pos < n; ++pos) {
-        char* p = leafEntryPtr(leafFrame->data, keyLen, pos);
-        KeyBytes k(keyLen); std::memcpy(k.bytes.data(), p, keyLen);
-        if (key.compare(k) < 0) break;
+    if (key) {
+        int pos = upper ? nodeUpperBound(leaf_, fmt_, target.data()) : nodeLowerBound(leaf_, fmt_, target.data());
+        pos_ = forward ? pos : pos - 1;
+    } else {
+        pos_ = forward ? 0 : reinterpret_cast<IndexPageHeader*>(leaf_)->keyCount - 1;
     }
+    return RC_OK;
+}
 
-    if (n < hdr->maxKeys) {
-        // 直接插入：移动尾部
-        for (int i = n; i > pos; --i) {
-            char* dst = leafEntryPtr(leafFrame->data, keyLen, i);
-            char* src = leafEntryPtr(leafFrame->data, keyLen, i-1);
-            std::memmove(dst, src, keyLen + 8);
-        }
-        char* slot = leafEntryPtr(leafFrame->data, keyLen, pos);
-        std::memcpy(slot, key.bytes.data(), keyLen);
-        *reinterpret_cast<int32_t*>(slot + keyLen) = rid.pageNum;
-        *reinterpret_cast<int32_t*>(slot + keyLen + 4) = rid.slotNum;
-        hdr->keyCount++;
-        memManager_.markDirty(indexId, leafPage);
-        releasePage(indexId, leafPage);
-        return RC_OK;
+RC IndexScan::moveToLeaf(PageNum from, PageNum to, bool& stale) {
+    // 读到相邻叶子时当前叶子须仍是拷贝时的版本：否则其间可能发生了拆分、合并或借位，相邻叶子中的项与已产出的项不再衔接
+    TableId indexId = index_->info.indexId;
+    BufferFrame* fromFrame = nullptr;
+    BufferFrame* toFrame = nullptr;
+    RC rc = mgr_->pinPage(indexId, from, fromFrame);
+    if (rc != RC_OK) return rc;
+    rc = mgr_->pinPage(indexId, to, toFrame);
+    if (rc != RC_OK) { mgr_->releasePage(indexId, from); return rc; }
+    while (true) {
+        uint64_t version = toFrame->latch.readLock();
+        stale = !fromFrame->latch.validate(leafVersion_);
+        if (stale || copyLeaf(toFrame, version)) break;
     }
+    mgr_->releasePage(indexId, to);
+    mgr_->releasePage(indexId, from);
+    return RC_OK;
+}
 
-    // 3. 需要分裂
-    rc = splitLeafAndInsert(indexId, info, leafFrame, key, rid);
-    releasePage(indexId, leafPage);
-    return rc;
+bool IndexScan::copyLeaf(const BufferFrame* frame, uint64_t version) {
+    std::memcpy(leaf_, frame->data, BLOCK_SIZE);
+    if (!frame->latch.validate(version)) return false;
+    leafVersion_ = version;
+    fmt_ = NodeFormat(leaf_, keyLen_, tailLen_);
+
+    if (prefetch_) {
+        auto* hdr = reinterpret_cast<IndexPageHeader*>(leaf_);
+        PageNum ahead = direction_ == ScanDirection::FORWARD ? hdr->nextPage : hdr->prevPage;
+        if (ahead != -1) mgr_->diskManager_.prefetchBlock(index_->info.indexId, ahead);
+    }
+    return true;
 }
 
-RC IndexManager::splitLeafAndInsert(TableId indexId, const IndexInfo &info, BufferFrame *leafFrame, const KeyBytes &key, const RID &rid) {
-    auto* hdr = reinterpret_cast<IndexPageHeader*>(leafFrame->data);
-    int keyLen = info.keyLen;
-    int n = hdr->keyCount;
+// 键是否在扫描起点之前（正向：低于下界；逆向：高于上界），按边界长度的键前缀比较
+bool IndexScan::beforeStart(const char* key) const {
+    if (direction_ == ScanDirection::FORWARD) {
+        if (!hasLow_) return false;
+        int c = std::memcmp(key, low_.data(), low_.size());
+        return c < 0 || (c == 0 && !lowInclusive_);
+    }
+    if (!hasHigh_) return false;
+    int c = std::memcmp(key, high_.data(), high_.size());
+    return c > 0 || (c == 0 && !highInclusive_);
+}
 
-    // 临时数组收集所有项
-    std::vector<char> tmp((n + 1) * (keyLen + 8));
-    for (int i = 0; i < n; ++i) {
-        std::memcpy(tmp.data() + i*(keyLen+8), leafEntryPtr(leafFrame->data, keyLen, i), keyLen+8);
+// 键是否已越过扫描终点（正向：高于上界；逆向：低于下界）
+bool IndexScan::pastEnd(const char* key) const {
+    if (direction_ == ScanDirection::FORWARD) {
+        if (!hasHigh_) return false;
+        int c = std::memcmp(key, high_.data(), high_.size());
+        return c > 0 || (c == 0 && !highInclusive_);
     }
-    // 找插入位置
-    int pos = 0;
-    for (; pos < n; ++pos) {
-        KeyBytes k(keyLen);
-        std::memcpy(k.bytes.data(), tmp.data() + pos*(keyLen+8), keyLen);
-        if (key.compare(k) < 0) break;
+    if (!hasLow_) return false;
+    int c = std::memcmp(key, low_.data(), low_.size());
+    return c < 0 || (c == 0 && !lowInclusive_);
+}
+
+bool IndexScan::next(RID& rid) {
+    const bool forward = direction_ == ScanDirection::FORWARD;
+    if (point_) {
+        const int entryLen = keyLen_ + tailLen_;
+        if (done_ || (pointPos_ + 1) * entryLen > pointEntries_.size()) {
+            done_ = true;
+            return false;
+        }
+        size_t i = pointPos_++;
+        if (!forward) i = pointEntries_.size() / entryLen - 1 - i;
+        lastKey_ = pointEntries_.data() + i * entryLen;
+        lastTail_ = lastKey_ + keyLen_;
+        rid = RID(loadInt32(lastTail_), (SlotNum)loadInt32(lastTail_ + 4));
+        return true;
     }
-    // 插入到tmp
-    for (int i = n; i > pos; --i) {
-        std::memcpy(tmp.data() + i*(keyLen+8), tmp.data() + (i-1)*(keyLen+8), keyLen+8);
+    while (!done_) {
+        // 正在产出重复键的posting列表（逆向扫描时从大到小）
+        if (postingPos_ < postings_.size()) {
+            size_t i = postingPos_++;
+            rid = ridFromOrdinal(postings_[forward ? i : postings_.size() - 1 - i]);
+            return true;
+        }
+        auto* hdr = reinterpret_cast<IndexPageHeader*>(leaf_);
+        if (pos_ < 0 || pos_ >= hdr->keyCount) {
+            PageNum page = forward ? hdr->nextPage : hdr->prevPage;
+            if (page == -1) { done_ = true; break; }
+            bool stale = false;
+            status_ = moveToLeaf(hdr->pageNum, page, stale);
+            if (status_ == RC_OK && stale) {
+                // 叶子在拷贝后被修改：按最后看过的键重新下降，回到其相同项的起始处，跳过其中已产出的项
+                status_ = examined_ ? seek(runKey_.data(), !forward) : seek(hasStart_ ? start_.data() : nullptr, startUpper_);
+                resumed_ = true;
+                if (status_ != RC_OK) { done_ = true; break; }
+                continue;
+            }
+            if (status_ != RC_OK) { done_ = true; break; }
+            pos_ = forward ? 0 : reinterpret_cast<IndexPageHeader*>(leaf_)->keyCount - 1;
+            continue;
+        }
+
+        // 页内只存压缩后的键，还原完整键后再与边界比较
+        nodeGetKey(leaf_, fmt_, pos_, keyBuf_);
+        const char* t = nodeTail(leaf_, fmt_, pos_);
+        pos_ += forward ? 1 : -1;
+        // 起点附近可能残留不满足起始边界的相同键（跨叶子），跳过
+        if (beforeStart(keyBuf_)) continue;
+        if (pastEnd(keyBuf_)) { done_ = true; break; }
+
+        // 记下当前键已产出的项（posting项按其链首记），重新定位后据此跳过
+        uint64_t id = ridOrdinal(RID(loadInt32(t), (SlotNum)loadInt32(t + 4)));
+        bool sameRun = examined_ && std::memcmp(keyBuf_, runKey_.data(), keyLen_) == 0;
+        if (!sameRun) {
+            std::memcpy(runKey_.data(), keyBuf_, keyLen_);
+            runIds_.clear();
+            resumed_ = false;
+            examined_ = true;
+        } else if (resumed_ && std::find(runIds_.begin(), runIds_.end(), id) != runIds_.end()) {
+            continue;
+        }
+        runIds_.push_back(id);
+
+        if (loadInt32(t) == POSTING_RID_PAGE) {
+            lastKey_ = keyBuf_;
+            lastTail_ = t;
+            postingPos_ = 0;
+            status_ = mgr_->readPostings(index_->info.indexId, loadInt32(t + 4), postings_);
+            if (status_ != RC_OK) { done_ = true; break; }
+            continue;
+        }
+        rid.pageNum = loadInt32(t);
+        rid.slotNum = (SlotNum)loadInt32(t + 4);
+        lastKey_ = keyBuf_;
+        lastTail_ = t;
+        return true;
     }
-    std::memcpy(tmp.data() + pos*(keyLen+8), key.bytes.data(), keyLen);
-    *reinterpret_cast<int32_t*>(tmp.data() + pos*(keyLen+8) + keyLen) = rid.pageNum;
-    *reinterpret_cast<int32_t*>(tmp.data() + pos*(keyLen+8) + keyLen + 4) = rid.slotNum;
+    return false;
+}
 
-    int splitPoint = (n + 1) / 2; // 右侧数量 = (n+1) - splitPoint
+RC IndexManager::insertKey(TableId indexId, const IndexInfo &info, const KeyBytes &key, const RID &rid, const char *payload) {
+    std::vector<char> tail(leafTailLen(info));
+    storeInt32(tail.data(), rid.pageNum);
+    storeInt32(tail.data() + 4, rid.slotNum);
+    std::memcpy(tail.data() + 8, payload, info.payloadLen);
+    return insertEntry(indexId, info, key, tail.data(), rid);
+}
 
-    // 分配新叶子
-    BlockNum newBlock;
-    RC rc = diskManager_.allocBlock(indexId, newBlock);
-    if (rc != RC_OK) return rc;
+RC IndexManager::insertEntry(TableId indexId, const IndexInfo& info, const KeyBytes& key, const char* tail, const RID& rid) {
+    while (true) {
+        // 1. 乐观下降到叶子，读到的版本未变时升级为写锁（叶子在此期间被修改则重新下降）
+        PageNum leafPage;
+        BufferFrame* leafFrame = nullptr;
+        uint64_t version;
+        RC rc = descend(indexId, info, &key, false, leafPage, leafFrame, version);
+        if (rc != RC_OK) return rc;
+        if (!leafFrame->latch.tryUpgrade(version)) {
+            releasePage(indexId, leafPage);
+            continue;
+        }
 
-    // 初始化新叶页
-    initNewIndexRoot(indexId, newBlock, hdr->maxKeys, true);
+        // 2. 只改这个叶子就能完成时就地插入
+        LeafInsert result = insertIntoLeaf(indexId, info, leafFrame, key, tail, rid, false, rc);
+        leafFrame->latch.unlock();
+        releasePage(indexId, leafPage);
+        if (result == LeafInsert::DONE) return rc;
 
-    // 左叶：写入前半部分
-    hdr->keyCount = splitPoint;
-    for (int i = 0; i < splitPoint; ++i) {
-        std::memcpy(leafEntryPtr(leafFrame->data, keyLen, i), tmp.data() + i*(keyLen+8), keyLen+8);
-    }
-    // 右叶：写入后半部分
-    BufferFrame* rightFrame = nullptr;
-    rc = readPage(indexId, newBlock, rightFrame);
-    if (rc != RC_OK) return rc;
-    auto* rHdr = reinterpret_cast<IndexPageHeader*>(rightFrame->data);
-    int rightCount = (n + 1) - splitPoint;
-    rHdr->keyCount = rightCount;
-    for (int i = 0; i < rightCount; ++i) {
-        std::memcpy(leafEntryPtr(rightFrame->data, keyLen, i), tmp.data() + (splitPoint + i)*(keyLen+8), keyLen+8);
+        // 3. 需要分裂或跨叶子处理：交给结构修改
+        return insertInSmo(indexId, info, key, tail, rid);
     }
+}
 
-    // 维护链表和父指针
-    rHdr->prevPage = hdr->pageNum;
-    rHdr->nextPage = hdr->nextPage;
-    hdr->nextPage = newBlock;
-    rHdr->parentPage = hdr->parentPage;
+RC IndexManager::insertInSmo(TableId indexId, const IndexInfo& info, const KeyBytes& key, const char* tail, const RID& rid) {
+    std::lock_guard<std::mutex> smo(latchFor(indexId).smo);
+    while (true) {
+        // 分裂后根与叶子可能改变，每轮重新下降
+        PageNum leafPage;
+        std::vector<PageNum> path;
+        RC rc = descendForSmo(indexId, info, key, false, leafPage, path);
+        if (rc != RC_OK) return rc;
 
-    memManager_.markDirty(indexId, hdr->pageNum);
-    memManager_.markDirty(indexId, newBlock);
+        SmoLatches latches(memManager_, indexId);
+        BufferFrame* leafFrame = nullptr;
+        rc = readPage(indexId, leafPage, leafFrame);
+        if (rc != RC_OK) return rc;
+        LeafInsert result = insertIntoLeaf(indexId, info, leafFrame, key, tail, rid, true, rc);
+        if (result == LeafInsert::DONE) {
+            releasePage(indexId, leafPage);
+            return rc;
+        }
 
-    // 上提的键（右叶的最小键）
-    KeyBytes upKey(keyLen);
-    if (rightCount > 0) std::memcpy(upKey.bytes.data(), leafEntryPtr(rightFrame->data, keyLen, 0), keyLen);
+        // 放不下：分裂后重试
+        rc = splitLeaf(indexId, info, leafFrame, path);
+        releasePage(indexId, leafPage);
+        if (rc != RC_OK) return rc;
+    }
+}
 
-    // 插入父节点
-    rc = insertIntoParent(indexId, info, hdr->pageNum, upKey, newBlock);
+IndexManager::LeafInsert IndexManager::insertIntoLeaf(TableId indexId, const IndexInfo& info, BufferFrame* leafFrame, const KeyBytes& key,
+                                                      const char* tail, const RID& rid, bool smo, RC& rc) {
+    rc = RC_OK;
+    char* page = leafFrame->data;
+    auto* hdr = reinterpret_cast<IndexPageHeader*>(page);
+    NodeFormat fmt = leafFormat(page, info);
+
+    // 查找插入位置（相同键插在已有项之后）
+    int pos = nodeUpperBound(page, fmt, key.data());
+
+    if (info.unique && !indexKeyHasNull(info, tail + 8)) {
+        // 唯一索引（键中有空值列的项不参与检查，见indexKeyHasNull）：持叶子写锁检查，不依赖插入前的无锁探查
+        //   下降按上界选子树，插入位置及右侧叶子中的键都大于key；相同键都在插入位置之前，
+        //   多列键中含空值的相同键项可能一直延续到前面的叶子，须在结构修改中读入前面的叶子一并检查
+        int start = pos;
+        while (rc == RC_OK && start > 0 && nodeCompareKey(page, fmt, start - 1, key.data()) == 0) {
+            if (!indexKeyHasNull(info, nodeTail(page, fmt, start - 1) + 8)) rc = RC_DUPLICATE_KEY;
+            --start;
+        }
+        PageNum prev = start == 0 && rc == RC_OK && info.keyColumnCount > 1 ? hdr->prevPage : -1;
+        if (prev != -1 && !smo) return LeafInsert::SLOW;
+        while (prev != -1 && rc == RC_OK) {
+            BufferFrame* pf = nullptr;
+            rc = readPage(indexId, prev, pf);
+            if (rc != RC_OK) return LeafInsert::DONE;
+            releasePage(indexId, prev);   // 结构修改结束前页仍被锁住并固定
+            NodeFormat pfmt = leafFormat(pf->data, info);
+            int s = reinterpret_cast<IndexPageHeader*>(pf->data)->keyCount;
+            while (rc == RC_OK && s > 0 && nodeCompareKey(pf->data, pfmt, s - 1, key.data()) == 0) {
+                if (!indexKeyHasNull(info, nodeTail(pf->data, pfmt, s - 1) + 8)) rc = RC_DUPLICATE_KEY;
+                --s;
+            }
+            prev = s == 0 ? reinterpret_cast<IndexPageHeader*>(pf->data)->prevPage : -1;
+        }
+        if (rc != RC_OK) return LeafInsert::DONE;
+    } else if (indexUsesPostings(info)) {
+        // posting索引：已有posting列表时只有一项，追加到列表；否则数出行内的重复项
+        int start = pos;
+        while (start > 0 && nodeCompareKey(page, fmt, start - 1, key.data()) == 0) --start;
+        if (start < pos && loadInt32(nodeTail(page, fmt, pos - 1)) == POSTING_RID_PAGE) {
+            rc = insertPosting(indexId, loadInt32(nodeTail(page, fmt, pos - 1) + 4), ridOrdinal(rid));
+            return LeafInsert::DONE;
+        }
+        // 相同键可能延续到前面的叶子，或重复项将达到阈值：需读写相邻叶子，在结构修改中处理
+        bool spans = start == 0 && hdr->prevPage != -1;
+        if (spans || pos - start + 1 >= postingThreshold(info)) {
+            if (!smo) return LeafInsert::SLOW;
+            std::vector<RunPart> run;   // 自左向右
+            int count = pos - start;
+            if (start < pos) run.push_back({leafFrame, start, pos});
+            PageNum prev = spans ? hdr->prevPage : -1;
+            while (prev != -1) {
+                BufferFrame* pf = nullptr;
+                rc = readPage(indexId, prev, pf);
+                if (rc != RC_OK) return LeafInsert::DONE;
+                releasePage(indexId, prev);   // 结构修改结束前页仍被锁住并固定
+                NodeFormat pfmt = leafFormat(pf->data, info);
+                int n = reinterpret_cast<IndexPageHeader*>(pf->data)->keyCount;
+                int s = n;
+                while (s > 0 && nodeCompareKey(pf->data, pfmt, s - 1, key.data()) == 0) --s;
+                if (s < n) {
+                    run.insert(run.begin(), RunPart{pf, s, n});
+                    count += n - s;
+                }
+                prev = s == 0 ? reinterpret_cast<IndexPageHeader*>(pf->data)->prevPage : -1;
+            }
+            for (const RunPart& part : run) {
+                NodeFormat pfmt = leafFormat(part.frame->data, info);
+                for (int i = part.from; i < part.to; ++i) {
+                    const char* t = nodeTail(part.frame->data, pfmt, i);
+                    if (loadInt32(t) != POSTING_RID_PAGE) continue;
+                    rc = insertPosting(indexId, loadInt32(t + 4), ridOrdinal(rid));
+                    return LeafInsert::DONE;
+                }
+            }
+            if (count + 1 >= postingThreshold(info)) {
+                rc = convertToPosting(indexId, info, run, rid);
+                return LeafInsert::DONE;
+            }
+        }
+    }
 
-    releasePage(indexId, newBlock);
-    return rc;
+    // 符合页内格式且有空位时直接插入，否则展开后重新压缩
+    bool done = nodeInsertInPlace(page, fmt, pos, key.data(), tail);
+    if (!done) {
+        NodeImage img(info.keyLen, leafTailLen(info));
+        img.load(page);
+        img.insert(pos, key.data(), tail);
+        done = img.store(page);
+    }
+    if (!done) return LeafInsert::FULL;
+    memManager_.markDirty(indexId, hdr->pageNum);
+    return LeafInsert::DONE;
 }
 
-RC IndexManager::insertIntoParent(TableId indexId, const IndexInfo &info, PageNum left, const KeyBytes &upKey, PageNum right) {
-    // 读取左节点以获父页
-    BufferFrame* leftFrame = nullptr;
-    RC rc = readPage(indexId, left, leftFrame);
-    if (rc != RC_OK) return rc;
-    auto* leftHdr = reinterpret_cast<IndexPageHeader*>(leftFrame->data);
-    PageNum parent = leftHdr->parentPage;
-
-    if (parent == -1) {
-        // 创建新根
-        BlockNum newRoot;
-        rc = diskManager_.allocBlock(indexId, newRoot);
-        if (rc != RC_OK) { releasePage(indexId, left); return rc; }
-        initNewIndexRoot(indexId, newRoot, calcMaxKeys(info.keyLen), false);
-
-        BufferFrame* r = nullptr;
-        rc = readPage(indexId, newRoot, r);
-        if (rc != RC_OK) { releasePage(indexId, left); return rc; }
-        auto* rh = reinterpret_cast<IndexPageHeader*>(r->data);
-        rh->leftMostChild = left;
-        rh->keyCount = 1;
-        // 写第一个key和右孩子
-        char* e0 = internalEntryPtr(r->data, info.keyLen, 0);
-        std::memcpy(e0, upKey.bytes.data(), info.keyLen);
-        *reinterpret_cast<int32_t*>(e0 + info.keyLen) = right;
-        // 更新孩子父指针
-        leftHdr->parentPage = newRoot;
-        BufferFrame* rightFrame = nullptr; readPage(indexId, right, rightFrame);
-        auto* rightHdr = reinterpret_cast<IndexPageHeader*>(rightFrame->data);
-        rightHdr->parentPage = newRoot;
-        memManager_.markDirty(indexId, newRoot);
-        memManager_.markDirty(indexId, left);
-        memManager_.markDirty(indexId, right);
-        releasePage(indexId, right);
-        releasePage(indexId, newRoot);
-
-        // 更新索引根信息
-        IndexInfo updated = info;
-        updated.rootPage = newRoot;
-        updated.height = std::max(1, info.height) + 1;
-        dataDict_.updateIndexInfo(updated);
-        releasePage(indexId, left);
-        return RC_OK;
+RC IndexManager::convertToPosting(TableId indexId, const IndexInfo& info, const std::vector<RunPart>& run, const RID& rid) {
+    std::vector<uint64_t> rids{ridOrdinal(rid)};
+    for (const RunPart& part : run) {
+        NodeFormat fmt = leafFormat(part.frame->data, info);
+        for (int i = part.from; i < part.to; ++i) {
+            const char* t = nodeTail(part.frame->data, fmt, i);
+            rids.push_back(ridOrdinal(RID(loadInt32(t), (SlotNum)loadInt32(t + 4))));
+        }
     }
+    std::sort(rids.begin(), rids.end());
+    rids.erase(std::unique(rids.begin(), rids.end()), rids.end());
+    PageNum head;
+    RC rc = writePostingChain(indexId, rids.data(), (int)rids.size(), head);
+    if (rc != RC_OK) return rc;
 
-    // 将(upKey, right)插入到父节点的合适位置
-    BufferFrame* pFrame = nullptr;
-    rc = readPage(indexId, parent, pFrame);
-    if (rc != RC_OK) { releasePage(indexId, left); return rc; }
-    auto* ph = reinterpret_cast<IndexPageHeader*>(pFrame->data);
-    int n = ph->keyCount;
-    int keyLen = info.keyLen;
-
-    // 找left在父中的位置：需要比较孩子指针
-    int insertPos = 0;
-    // 首先检查left是否是leftMostChild
-    if (ph->leftMostChild == left) insertPos = 0;
-    else {
-        for (int i = 0; i < n; ++i) {
-            int32_t child = *reinterpret_cast<int32_t*>(internalEntryPtr(pFrame->data, keyLen, i) + keyLen);
-            if (child == left) { insertPos = i + 1; break; }
-        }
-    }
-
-    if (n < ph->maxKeys) {
-        // 向后移动entry为新键腾出空间
-        for (int i = n; i > insertPos; --i) {
-            char* dst = internalEntryPtr(pFrame->data, keyLen, i);
-            char* src = internalEntryPtr(pFrame->data, keyLen, i-1);
-            std::memmove(dst, src, keyLen + 8);
-        }
-        char* slot = internalEntryPtr(pFrame->data, keyLen, insertPos);
-        std::memcpy(slot, upKey.bytes.data(), keyLen);
-        *reinterpret_cast<int32_t*>(slot + keyLen) = right;
-        ph->keyCount++;
-        // 确保右孩子的父指针正确
-        BufferFrame* rightFrame = nullptr;
-        if (readPage(indexId, right, rightFrame) == RC_OK) {
-            auto* rh = reinterpret_cast<IndexPageHeader*>(rightFrame->data);
-            rh->parentPage = ph->pageNum;
-            memManager_.markDirty(indexId, right);
-            releasePage(indexId, right);
-        }
-        memManager_.markDirty(indexId, parent);
-        releasePage(indexId, parent);
-        releasePage(indexId, left);
-        return RC_OK;
+    // 第一项改为指向posting链，其余各项删去；删去后叶子可能低于半满，不在此重平衡
+    for (size_t k = 0; k < run.size(); ++k) {
+        char* page = run[k].frame->data;
+        NodeFormat fmt = leafFormat(page, info);
+        int from = run[k].from;
+        if (k == 0) {
+            char* t = nodeTail(page, fmt, from);
+            storeInt32(t, POSTING_RID_PAGE);
+            storeInt32(t + 4, head);
+            ++from;
+        }
+        for (int i = run[k].to - 1; i >= from; --i) nodeRemove(page, fmt, i);
+        memManager_.markDirty(indexId, reinterpret_cast<IndexPageHeader*>(page)->pageNum);
     }
-
-    // 需要分裂父节点
-    rc = splitInternalAndInsert(indexId, info, pFrame, upKey, right);
-    releasePage(indexId, parent);
-    releasePage(indexId, left);
-    return rc;
+    return RC_OK;
 }
 
-RC IndexManager::splitInternalAndInsert(TableId indexId, const IndexInfo &info, BufferFrame *internalFrame, const KeyBytes &upKey, PageNum right) {
-    auto* hdr = reinterpret_cast<IndexPageHeader*>(internalFrame->data);
-    int n = hdr->keyCount;
-    int keyLen = info.keyLen;
+RC IndexManager::splitLeaf(TableId indexId, const IndexInfo &info, BufferFrame *leafFrame, std::vector<PageNum>& path) {
+    const int keyLen = info.keyLen;
+    NodeImage left(keyLen, leafTailLen(info));
+    left.load(leafFrame->data);
+    int n = left.count();
+    if (n < 2) return RC_INVALID_OP;
 
-    // 收集现有keys和children（children通过leftMost + 每个entry的右孩子）
-    std::vector<char> tmpKeys((n + 1) * (keyLen + 8));
-    int32_t leftMost = hdr->leftMostChild;
-    for (int i = 0; i < n; ++i) {
-        std::memcpy(tmpKeys.data() + i*(keyLen+8), internalEntryPtr(internalFrame->data, keyLen, i), keyLen+8);
-    }
+    // 分裂点：右叶首项的下标，使上提的分隔键（左叶末键与右叶首键之间的最短键）尽量短
+    char sep[MAX_INDEX_KEY_LEN];
+    int split = chooseSplitPoint(1, n - 1, n / 2, [&](int k) { return makeSeparator(left.key(k - 1), left.key(k), keyLen, sep); });
+    KeyBytes upKey(keyLen);
+    makeSeparator(left.key(split - 1), left.key(split), keyLen, upKey.data());
 
-    // 确定插入位置：根据upKey顺序
-    int pos = 0;
-    for (; pos < n; ++pos) {
-        KeyBytes k(keyLen); std::memcpy(k.bytes.data(), tmpKeys.data() + pos*(keyLen+8), keyLen);
-        if (upKey.compare(k) < 0) break;
-    }
-    for (int i = n; i > pos; --i) {
-        std::memcpy(tmpKeys.data() + i*(keyLen+8), tmpKeys.data() + (i-1)*(keyLen+8), keyLen+8);
+    // 分配并初始化新叶子
+    BlockNum newBlock;
+    RC rc = diskManager_.allocBlock(indexId, newBlock);
+    if (rc != RC_OK) return rc;
+    rc = initNewIndexRoot(indexId, newBlock, left.header().maxKeys, true);
+    if (rc != RC_OK) return rc;
+    BufferFrame* rightFrame = nullptr;
+    rc = readPage(indexId, newBlock, rightFrame);
+    if (rc != RC_OK) return rc;
+    NodeImage right(keyLen, leafTailLen(info));
+    right.load(rightFrame->data);
+    right.append(left, split, n);
+    left.erase(split, n);
+
+    // 维护链表
+    IndexPageHeader& hdr = left.header();
+    IndexPageHeader& rHdr = right.header();
+    rHdr.prevPage = hdr.pageNum;
+    rHdr.nextPage = hdr.nextPage;
+    hdr.nextPage = newBlock;
+    if (rHdr.nextPage != -1) {
+        BufferFrame* nxt = nullptr;
+        if (readPage(indexId, rHdr.nextPage, nxt) == RC_OK) {
+            reinterpret_cast<IndexPageHeader*>(nxt->data)->prevPage = newBlock;
+            memManager_.markDirty(indexId, rHdr.nextPage);
+            releasePage(indexId, rHdr.nextPage);
+        }
     }
-    // 插入(upKey,right)
-    std::memcpy(tmpKeys.data() + pos*(keyLen+8), upKey.bytes.data(), keyLen);
-    *reinterpret_cast<int32_t*>(tmpKeys.data() + pos*(keyLen+8) + keyLen) = right;
 
-    int total = n + 1;
-    int mid = total / 2; // 提升中间键 [mid]
+    // 两半各自重新压缩（项数减半，总能放下）
+    left.store(leafFrame->data);
+    right.store(rightFrame->data);
+    memManager_.markDirty(indexId, hdr.pageNum);
+    memManager_.markDirty(indexId, newBlock);
 
-    // 新右内部页
-    BlockNum newBlock; RC rc = diskManager_.allocBlock(indexId, newBlock); if (rc != RC_OK) return rc;
-    initNewIndexRoot(indexId, newBlock, hdr->maxKeys, false);
+    // 插入父节点
+    rc = insertIntoParent(indexId, info, hdr.pageNum, upKey, newBlock, path);
+    releasePage(indexId, newBlock);
+    return rc;
+}
 
-    // 左页：保留[0..mid-1]
-    hdr->keyCount = mid;
-    for (int i = 0; i < mid; ++i) {
-        std::memcpy(internalEntryPtr(internalFrame->data, keyLen, i), tmpKeys.data() + i*(keyLen+8), keyLen+8);
-    }
+RC IndexManager::insertIntoParent(TableId indexId, const IndexInfo &info, PageNum left, const KeyBytes &upKey, PageNum right,
+                                  std::vector<PageNum>& path) {
+    const int keyLen = info.keyLen;
+    char childTail[INTERNAL_TAIL_LEN] = {0};
+    storeInt32(childTail, right);
 
-    // 计算右页的leftMostChild = c_(mid)（被提升键右侧的孩子）
-    int32_t c_mid_plus = (mid == 0) ? leftMost : *reinterpret_cast<int32_t*>(tmpKeys.data() + (mid-1)*(keyLen+8) + keyLen);
-    // 注意：上式给出了c_(mid)，即第mid-1个键的右孩子。真正的右页leftMost应为被提升键（mid）的右孩子：
-    // 它存储在第mid个entry的child字段中。
-    int32_t rightLeftMost = *reinterpret_cast<int32_t*>(tmpKeys.data() + mid*(keyLen+8) + keyLen);
+    while (true) {
+        if (path.empty()) {
+            // left是根：创建新根
+            BlockNum newRoot;
+            RC rc = diskManager_.allocBlock(indexId, newRoot);
+            if (rc == RC_OK) rc = initNewIndexRoot(indexId, newRoot, calcMaxKeys(keyLen), false);
+            BufferFrame* r = nullptr;
+            if (rc == RC_OK) rc = readPage(indexId, newRoot, r);
+            if (rc != RC_OK) return rc;
+            NodeImage root(keyLen, INTERNAL_TAIL_LEN);
+            root.load(r->data);
+            root.header().leftMostChild = left;
+            root.insert(0, upKey.data(), childTail);
+            root.store(r->data);
+            memManager_.markDirty(indexId, newRoot);
+            releasePage(indexId, newRoot);
+
+            // 更新索引根信息（根版本锁使正在下降的读者重新读取根页号）
+            updateRoot(indexId, newRoot, std::max(1, latchFor(indexId).height.load()) + 1);
+            path.push_back(newRoot);
+            return RC_OK;
+        }
 
-    // 提升键 = mid项的key
-    KeyBytes promote(keyLen); std::memcpy(promote.bytes.data(), tmpKeys.data() + mid*(keyLen+8), keyLen);
+        // 将(upKey, right)插入到父节点中left之后
+        PageNum parent = path.back();
+        BufferFrame* pFrame = nullptr;
+        RC rc = readPage(indexId, parent, pFrame);
+        if (rc != RC_OK) return rc;
+        int insertPos = findChildIndex(pFrame->data, keyLen, left);
+        if (insertPos < 0) { releasePage(indexId, parent); return RC_PAGE_NOT_FOUND; }
+
+        bool done = nodeInsertInPlace(pFrame->data, internalFormat(pFrame->data, keyLen), insertPos, upKey.data(), childTail);
+        if (!done) {
+            NodeImage img(keyLen, INTERNAL_TAIL_LEN);
+            img.load(pFrame->data);
+            img.insert(insertPos, upKey.data(), childTail);
+            done = img.store(pFrame->data);
+        }
+        if (done) {
+            memManager_.markDirty(indexId, parent);
+            releasePage(indexId, parent);
+            return RC_OK;
+        }
 
-    // 右页：写入[mid+1..end)
-    BufferFrame* r = nullptr; rc = readPage(indexId, newBlock, r); if (rc != RC_OK) return rc;
-    auto* rh = reinterpret_cast<IndexPageHeader*>(r->data);
-    int rightCount = total - (mid + 1);
-    rh->keyCount = rightCount;
-    rh->leftMostChild = rightLeftMost;
-    for (int i = 0; i < rightCount; ++i) {
-        std::memcpy(internalEntryPtr(r->data, keyLen, i), tmpKeys.data() + (mid+1+i)*(keyLen+8), keyLen+8);
+        // 父节点放不下：先分裂父节点，再到含left的那一半中重试
+        path.pop_back();
+        PageNum newHalf;
+        rc = splitInternal(indexId, info, pFrame, path, newHalf);
+        if (rc == RC_OK) path.push_back(findChildIndex(pFrame->data, keyLen, left) >= 0 ? parent : newHalf);
+        releasePage(indexId, parent);
+        if (rc != RC_OK) return rc;
     }
+}
 
-    // 更新移动到右页的所有孩子的parent指针
-    std::vector<PageNum> movedChildren;
-    movedChildren.reserve(rightCount + 1);
-    // 右页的最左孩子
-    movedChildren.push_back(rightLeftMost);
-    // 右页其它entry的右孩子
-    for (int i = 0; i < rightCount; ++i) {
-        int32_t childR = *reinterpret_cast<int32_t*>(tmpKeys.data() + (mid+1+i)*(keyLen+8) + keyLen);
-        movedChildren.push_back(childR);
-    }
-    setChildrenParent(indexId, movedChildren, newBlock);
+RC IndexManager::splitInternal(TableId indexId, const IndexInfo &info, BufferFrame *internalFrame, std::vector<PageNum>& path,
+                               PageNum& newPage) {
+    const int keyLen = info.keyLen;
+    NodeImage left(keyLen, INTERNAL_TAIL_LEN);
+    left.load(internalFrame->data);
+    int n = left.count();
+    if (n < 3) return RC_INVALID_OP;
 
-    memManager_.markDirty(indexId, hdr->pageNum);
+    // 提升第mid项的键（两侧各至少留一个键），在中点附近取最短的分隔键
+    int mid = chooseSplitPoint(1, n - 2, n / 2, [&](int k) { return significantLength(left.key(k), keyLen); });
+    KeyBytes promote(keyLen);
+    std::memcpy(promote.data(), left.key(mid), keyLen);
+
+    // 新右内部页：最左孩子为被提升键的右孩子，其余为[mid+1..end)
+    BlockNum newBlock;
+    RC rc = diskManager_.allocBlock(indexId, newBlock);
+    if (rc != RC_OK) return rc;
+    rc = initNewIndexRoot(indexId, newBlock, left.header().maxKeys, false);
+    if (rc != RC_OK) return rc;
+    BufferFrame* r = nullptr;
+    rc = readPage(indexId, newBlock, r);
+    if (rc != RC_OK) return rc;
+    NodeImage right(keyLen, INTERNAL_TAIL_LEN);
+    right.load(r->data);
+    right.header().leftMostChild = loadInt32(left.tail(mid));
+    right.append(left, mid + 1, n);
+    left.erase(mid, n);
+    left.store(internalFrame->data);
+    right.store(r->data);
+
+    memManager_.markDirty(indexId, left.header().pageNum);
     memManager_.markDirty(indexId, newBlock);
 
     // 插入到父
-    rc = insertIntoParent(indexId, info, hdr->pageNum, promote, newBlock);
+    newPage = newBlock;
+    rc = insertIntoParent(indexId, info, left.header().pageNum, promote, newBlock, path);
     releasePage(indexId, newBlock);
     return rc;
 }
 
 RC IndexManager::deleteKey(TableId indexId, const IndexInfo &info, const KeyBytes &key, const RID &rid) {
-    // 找叶子
+    while (true) {
+        // 1. 乐观下降到可能含key的最左叶子（相同键可能跨越多个叶子）
+        PageNum leaf;
+        BufferFrame* frame = nullptr;
+        uint64_t version;
+        RC rc = descend(indexId, info, &key, true, leaf, frame, version);
+        if (rc != RC_OK) return rc;
+
+        // 2. 二分定位第一个相同键，再沿叶子链在相同键范围内匹配rid；每页读完校验版本，变了则重来
+        int pos = -1;
+        bool posting = false;
+        bool retry = false;
+        while (true) {
+            auto* hdr = reinterpret_cast<IndexPageHeader*>(frame->data);
+            NodeFormat fmt = leafFormat(frame->data, info);
+            int n = 0;
+            int i = 0;
+            if (fmt.consistent(frame->data)) {
+                n = hdr->keyCount;
+                i = nodeLowerBound(frame->data, fmt, key.data());
+                for (; i < n; ++i) {
+                    if (nodeCompareKey(frame->data, fmt, i, key.data()) != 0) break;
+                    const char* t = nodeTail(frame->data, fmt, i);
+                    if (loadInt32(t) == POSTING_RID_PAGE) { pos = i; posting = true; break; }
+                    if (loadInt32(t) == rid.pageNum && loadInt32(t + 4) == rid.slotNum) { pos = i; break; }
+                }
+            }
+            PageNum next = hdr->nextPage;
+            if (!frame->latch.validate(version)) { retry = true; break; }
+            if (pos != -1) break;
+            if (i < n || next == -1) { releasePage(indexId, leaf); return RC_SLOT_NOT_FOUND; } // 已越过相同键范围
+
+            BufferFrame* nf = nullptr;
+            rc = pinPage(indexId, next, nf);
+            if (rc != RC_OK) { releasePage(indexId, leaf); return rc; }
+            uint64_t nv = nf->latch.readLock();
+            if (!frame->latch.validate(version)) { releasePage(indexId, next); retry = true; break; }
+            releasePage(indexId, leaf);
+            leaf = next;
+            frame = nf;
+            version = nv;
+        }
+        if (retry || !frame->latch.tryUpgrade(version)) {
+            releasePage(indexId, leaf);
+            continue;
+        }
+
+        // 3. 重复键：从posting列表中删除，只剩一个RID时改回行内存放；叶子项数不变
+        auto* hdr = reinterpret_cast<IndexPageHeader*>(frame->data);
+        NodeFormat fmt = leafFormat(frame->data, info);
+        if (posting) {
+            rc = removeFromPosting(indexId, frame, fmt, pos, rid);
+            frame->latch.unlock();
+            releasePage(indexId, leaf);
+            return rc;
+        }
+
+        // 4. 删除后不下溢（或叶子即根）时就地删除：后续项前移，页内格式不变
+        if (leaf == latchFor(indexId).rootPage.load() || hdr->keyCount - 1 >= minKeysForNode(hdr->maxKeys)) {
+            nodeRemove(frame->data, fmt, pos);
+            memManager_.markDirty(indexId, leaf);
+            frame->latch.unlock();
+            releasePage(indexId, leaf);
+            return RC_OK;
+        }
+
+        // 5. 会下溢：交给结构修改删除并重平衡
+        frame->latch.unlock();
+        releasePage(indexId, leaf);
+        return deleteInSmo(indexId, info, key, rid);
+    }
+}
+
+RC IndexManager::deleteInSmo(TableId indexId, const IndexInfo& info, const KeyBytes& key, const RID& rid) {
+    std::lock_guard<std::mutex> smo(latchFor(indexId).smo);
     PageNum leaf;
-    RC rc = findLeaf(indexId, info, key, leaf, nullptr);
+    std::vector<PageNum> path;
+    RC rc = descendForSmo(indexId, info, key, true, leaf, path);
     if (rc != RC_OK) return rc;
-    BufferFrame* frame = nullptr; rc = readPage(indexId, leaf, frame); if (rc != RC_OK) return rc;
-    auto* hdr = reinterpret_cast<IndexPageHeader*>(frame->data);
-    int keyLen = info.keyLen; int n = hdr->keyCount;
 
-    // 线性查找匹配的key+rid
+    // 释放锁之后该项可能已被其他线程改为posting列表或删去，重新匹配
+    SmoLatches latches(memManager_, indexId);
+    BufferFrame* frame = nullptr;
+    NodeFormat fmt;
     int pos = -1;
-    for (int i = 0; i < n; ++i) {
-        char* p = leafEntryPtr(frame->data, keyLen, i);
-        if (std::memcmp(p, key.bytes.data(), keyLen) == 0) {
-            int32_t pnum = *reinterpret_cast<int32_t*>(p + keyLen);
-            int32_t snum = *reinterpret_cast<int32_t*>(p + keyLen + 4);
-            if (pnum == rid.pageNum && snum == rid.slotNum) { pos = i; break; }
+    bool posting = false;
+    while (true) {
+        rc = readPage(indexId, leaf, frame); if (rc != RC_OK) return rc;
+        auto* hdr = reinterpret_cast<IndexPageHeader*>(frame->data);
+        int n = hdr->keyCount;
+        fmt = leafFormat(frame->data, info);
+        int i = nodeLowerBound(frame->data, fmt, key.data());
+        for (; i < n; ++i) {
+            if (nodeCompareKey(frame->data, fmt, i, key.data()) != 0) break;
+            const char* t = nodeTail(frame->data, fmt, i);
+            if (loadInt32(t) == POSTING_RID_PAGE) { pos = i; posting = true; break; }
+            if (loadInt32(t) == rid.pageNum && loadInt32(t + 4) == rid.slotNum) { pos = i; break; }
         }
+        if (pos != -1) break;
+        PageNum next = hdr->nextPage;
+        releasePage(indexId, leaf);
+        if (i < n || next == -1) return RC_SLOT_NOT_FOUND; // 已越过相同键范围
+        rc = stepRight(indexId, info, path, leaf);
+        if (rc != RC_OK) return rc;
     }
-    if (pos == -1) { releasePage(indexId, leaf); return RC_SLOT_NOT_FOUND; }
 
-    // 删除：向前覆盖
-    for (int i = pos; i < n-1; ++i) {
-        char* dst = leafEntryPtr(frame->data, keyLen, i);
-        char* src = leafEntryPtr(frame->data, keyLen, i+1);
-        std::memmove(dst, src, keyLen + 8);
+    if (posting) {
+        rc = removeFromPosting(indexId, frame, fmt, pos, rid);
+        releasePage(indexId, leaf);
+        return rc;
     }
-    hdr->keyCount--;
+
+    // 删除：后续项前移，页内格式不变
+    nodeRemove(frame->data, fmt, pos);
     memManager_.markDirty(indexId, leaf);
 
     // 叶子下溢重平衡
     PageNum leafPageNum = leaf;
     releasePage(indexId, leaf);
 
-    return rebalanceAfterDelete(indexId, info, leafPageNum);
+    return rebalanceAfterDelete(indexId, info, leafPageNum, path);
+}
+
+RC IndexManager::removeFromPosting(TableId indexId, BufferFrame* leafFrame, const NodeFormat& fmt, int pos, const RID& rid) {
+    char* t = nodeTail(leafFrame->data, fmt, pos);
+    PageNum head = loadInt32(t + 4);
+    int remaining = 0;
+    uint64_t survivor = 0;
+    RC rc = removePosting(indexId, head, ridOrdinal(rid), remaining, survivor);
+    if (rc == RC_OK && remaining == 1) {
+        RID last = ridFromOrdinal(survivor);
+        storeInt32(t, last.pageNum);
+        storeInt32(t + 4, last.slotNum);
+        diskManager_.freeBlock(indexId, head);
+        memManager_.markDirty(indexId, reinterpret_cast<IndexPageHeader*>(leafFrame->data)->pageNum);
+    }
+    return rc;
+}
+
+RC IndexManager::stepRight(TableId indexId, const IndexInfo& info, std::vector<PageNum>& path, PageNum& page) {
+    // 自下而上找到page所在子树还有右兄弟的那一层，再沿右兄弟的最左孩子下降
+    PageNum child = page;
+    while (!path.empty()) {
+        PageNum parent = path.back();
+        BufferFrame* frame = nullptr;
+        RC rc = pinPage(indexId, parent, frame);
+        if (rc != RC_OK) return rc;
+        int idx = findChildIndex(frame->data, info.keyLen, child);
+        int n = reinterpret_cast<IndexPageHeader*>(frame->data)->keyCount;
+        PageNum cur = idx >= 0 && idx < n ? getChildAt(frame->data, info.keyLen, idx + 1) : -1;
+        releasePage(indexId, parent);
+        if (idx < 0) return RC_PAGE_NOT_FOUND;
+        if (cur == -1) {
+            child = parent;
+            path.pop_back();
+            continue;
+        }
+        while (true) {
+            rc = pinPage(indexId, cur, frame);
+            if (rc != RC_OK) return rc;
+            auto* hdr = reinterpret_cast<IndexPageHeader*>(frame->data);
+            bool leaf = hdr->nodeType == (uint8_t)IndexNodeType::LEAF;
+            PageNum next = hdr->leftMostChild;
+            releasePage(indexId, cur);
+            if (leaf) {
+                page = cur;
+                return RC_OK;
+            }
+            path.push_back(cur);
+            cur = next;
+        }
+    }
+    return RC_PAGE_NOT_FOUND;
+}
+
+RC IndexManager::findKeyEntry(TableId indexId, const IndexInfo& info, const KeyBytes& key, PageNum& leafPage, int& pos, bool& found) {
+    while (true) {
+        BufferFrame* frame = nullptr;
+        uint64_t version;
+        RC rc = descend(indexId, info, &key, true, leafPage, frame, version);
+        if (rc != RC_OK) return rc;
+        // 乐观读：每页读完校验版本，变了则自根重来
+        bool retry = false;
+        while (true) {
+            auto* hdr = reinterpret_cast<IndexPageHeader*>(frame->data);
+            NodeFormat fmt = leafFormat(frame->data, info);
+            int n = 0;
+            pos = 0;
+            found = false;
+            if (fmt.consistent(frame->data)) {
+                n = hdr->keyCount;
+                pos = nodeLowerBound(frame->data, fmt, key.data());
+                while (pos < n && nodeCompareKey(frame->data, fmt, pos, key.data()) == 0) {
+                    if (!indexKeyHasNull(info, nodeTail(frame->data, fmt, pos) + 8)) { found = true; break; }
+                    ++pos;
+                }
+            }
+            PageNum next = hdr->nextPage;
+            if (!frame->latch.validate(version)) { retry = true; break; }
+            if (pos < n || next == -1) break;
+
+            BufferFrame* nf = nullptr;
+            rc = pinPage(indexId, next, nf);
+            if (rc != RC_OK) { releasePage(indexId, leafPage); return rc; }
+            uint64_t nv = nf->latch.readLock();
+            if (!frame->latch.validate(version)) { releasePage(indexId, next); retry = true; break; }
+            releasePage(indexId, leafPage);
+            leafPage = next;
+            frame = nf;
+            version = nv;
+        }
+        releasePage(indexId, leafPage);
+        if (!retry) return RC_OK;
+    }
+}
+
+RC IndexManager::writePostingChain(TableId indexId, const uint64_t* rids, int n, PageNum& head) {
+    head = -1;
+    PageNum prev = -1;
+    int done = 0;
+    while (done < n) {
+        BlockNum page;
+        RC rc = diskManager_.allocBlock(indexId, page);
+        if (rc != RC_OK) return rc;
+        BufferFrame* frame = nullptr;
+        rc = pinPage(indexId, page, frame);
+        if (rc != RC_OK) return rc;
+        bool locked = latchPage(indexId, page, frame);
+        std::memset(frame->data, 0, BLOCK_SIZE);
+        auto* hdr = reinterpret_cast<PostingPageHeader*>(frame->data);
+        hdr->nodeType = (uint8_t)IndexNodeType::POSTING;
+        hdr->pageNum = page;
+        hdr->nextPage = -1;
+        hdr->count = encodePostings(rids + done, n - done, frame->data + sizeof(PostingPageHeader), POSTING_DATA_CAPACITY, hdr->dataLen);
+        hdr->totalCount = head == -1 ? n : 0;
+        done += hdr->count;
+        if (locked) frame->latch.unlock();
+        memManager_.markDirty(indexId, page);
+        releasePage(indexId, page);
+
+        if (head == -1) {
+            head = page;
+        } else {
+            BufferFrame* pf = nullptr;
+            rc = pinPage(indexId, prev, pf);
+            if (rc != RC_OK) return rc;
+            pf->latch.lock();
+            reinterpret_cast<PostingPageHeader*>(pf->data)->nextPage = page;
+            pf->latch.unlock();
+            memManager_.markDirty(indexId, prev);
+            releasePage(indexId, prev);
+        }
+        prev = page;
+    }
+    return RC_OK;
+}
+
+RC IndexManager::seekPostingPage(TableId indexId, PageNum head, uint64_t rid, PageNum& page, PageNum& prev, BufferFrame*& frame) {
+    // 调用方持有链所在叶子的写锁，链不会被并发修改，直接读
+    page = head;
+    prev = -1;
+    while (true) {
+        RC rc = pinPage(indexId, page, frame);
+        if (rc != RC_OK) return rc;
+        PageNum next = reinterpret_cast<PostingPageHeader*>(frame->data)->nextPage;
+        if (next == -1) return RC_OK;
+        BufferFrame* nf = nullptr;
+        rc = pinPage(indexId, next, nf);
+        if (rc != RC_OK) { releasePage(indexId, page); return rc; }
+        bool beyond = rid < firstPosting(nf->data);
+        releasePage(indexId, next);
+        if (beyond) return RC_OK;
+        releasePage(indexId, page);
+        prev = page;
+        page = next;
+    }
+}
+
+RC IndexManager::insertPosting(TableId indexId, PageNum head, uint64_t rid) {
+    PageNum page, prev;
+    BufferFrame* frame = nullptr;
+    RC rc = seekPostingPage(indexId, head, rid, page, prev, frame);
+    if (rc != RC_OK) return rc;
+    auto* hdr = reinterpret_cast<PostingPageHeader*>(frame->data);
+
+    std::vector<uint64_t> rids;
+    decodePostings(frame->data, rids);
+    auto it = std::lower_bound(rids.begin(), rids.end(), rid);
+    if (it != rids.end() && *it == rid) { releasePage(indexId, page); return RC_OK; }
+    rids.insert(it, rid);
+
+    // 改写posting页时加页闩，供读者校验
+    int n = (int)rids.size();
+    char* data = frame->data + sizeof(PostingPageHeader);
+    frame->latch.lock();
+    int fit = encodePostings(rids.data(), n, data, POSTING_DATA_CAPACITY, hdr->dataLen);
+    if (fit < n) {
+        // 本页放不下：后一半移到新页，插在本页之后（每半各自差分编码，总能放下）
+        int half = n / 2;
+        BlockNum newPage;
+        rc = diskManager_.allocBlock(indexId, newPage);
+        BufferFrame* nf = nullptr;
+        if (rc == RC_OK) rc = pinPage(indexId, newPage, nf);
+        if (rc != RC_OK) {
+            // 本页已被部分改写：按原样重新编码
+            rids.erase(std::lower_bound(rids.begin(), rids.end(), rid));
+            hdr->count = encodePostings(rids.data(), n - 1, data, POSTING_DATA_CAPACITY, hdr->dataLen);
+            frame->latch.unlock();
+            releasePage(indexId, page);
+            return rc;
+        }
+        nf->latch.lock();
+        std::memset(nf->data, 0, BLOCK_SIZE);
+        auto* nh = reinterpret_cast<PostingPageHeader*>(nf->data);
+        nh->nodeType = (uint8_t)IndexNodeType::POSTING;
+        nh->pageNum = newPage;
+        nh->nextPage = hdr->nextPage;
+        nh->count = encodePostings(rids.data() + half, n - half, nf->data + sizeof(PostingPageHeader), POSTING_DATA_CAPACITY, nh->dataLen);
+        nf->latch.unlock();
+        hdr->nextPage = newPage;
+        fit = encodePostings(rids.data(), half, data, POSTING_DATA_CAPACITY, hdr->dataLen);
+        memManager_.markDirty(indexId, newPage);
+        releasePage(indexId, newPage);
+    }
+    hdr->count = fit;
+    std::memset(data + hdr->dataLen, 0, POSTING_DATA_CAPACITY - hdr->dataLen);
+    if (page == head) hdr->totalCount++;
+    frame->latch.unlock();
+    memManager_.markDirty(indexId, page);
+    releasePage(indexId, page);
+    if (page == head) return RC_OK;
+
+    // 链首记录总数
+    BufferFrame* hf = nullptr;
+    rc = pinPage(indexId, head, hf);
+    if (rc != RC_OK) return rc;
+    hf->latch.lock();
+    reinterpret_cast<PostingPageHeader*>(hf->data)->totalCount++;
+    hf->latch.unlock();
+    memManager_.markDirty(indexId, head);
+    releasePage(indexId, head);
+    return RC_OK;
+}
+
+RC IndexManager::removePosting(TableId indexId, PageNum head, uint64_t rid, int& remaining, uint64_t& survivor) {
+    PageNum page, prev;
+    BufferFrame* frame = nullptr;
+    RC rc = seekPostingPage(indexId, head, rid, page, prev, frame);
+    if (rc != RC_OK) return rc;
+    auto* hdr = reinterpret_cast<PostingPageHeader*>(frame->data);
+
+    std::vector<uint64_t> rids;
+    decodePostings(frame->data, rids);
+    auto it = std::lower_bound(rids.begin(), rids.end(), rid);
+    if (it == rids.end() || *it != rid) { releasePage(indexId, page); return RC_SLOT_NOT_FOUND; }
+    rids.erase(it);
+    // 删去一项后差分合并，编码不会变长
+    char* data = frame->data + sizeof(PostingPageHeader);
+    frame->latch.lock();
+    hdr->count = encodePostings(rids.data(), (int)rids.size(), data, POSTING_DATA_CAPACITY, hdr->dataLen);
+    std::memset(data + hdr->dataLen, 0, POSTING_DATA_CAPACITY - hdr->dataLen);
+    memManager_.markDirty(indexId, page);
+
+    // 页空了：非链首页从链中摘除；链首页由后继页的内容补上（链首页号记在叶子项中，不能变）
+    PageNum next = hdr->nextPage;
+    if (hdr->count == 0 && page != head) {
+        frame->latch.unlock();
+        releasePage(indexId, page);
+        BufferFrame* pf = nullptr;
+        rc = pinPage(indexId, prev, pf);
+        if (rc != RC_OK) return rc;
+        pf->latch.lock();
+        reinterpret_cast<PostingPageHeader*>(pf->data)->nextPage = next;
+        pf->latch.unlock();
+        memManager_.markDirty(indexId, prev);
+        releasePage(indexId, prev);
+        diskManager_.freeBlock(indexId, page);
+    } else if (hdr->count == 0 && next != -1) {
+        BufferFrame* nf = nullptr;
+        rc = pinPage(indexId, next, nf);
+        if (rc != RC_OK) { frame->latch.unlock(); releasePage(indexId, page); return rc; }
+        auto* nh = reinterpret_cast<PostingPageHeader*>(nf->data);
+        std::memcpy(data, nf->data + sizeof(PostingPageHeader), POSTING_DATA_CAPACITY);
+        hdr->count = nh->count;
+        hdr->dataLen = nh->dataLen;
+        hdr->nextPage = nh->nextPage;
+        frame->latch.unlock();
+        releasePage(indexId, next);
+        releasePage(indexId, page);
+        diskManager_.freeBlock(indexId, next);
+    } else {
+        frame->latch.unlock();
+        releasePage(indexId, page);
+    }
+
+    BufferFrame* hf = nullptr;
+    rc = pinPage(indexId, head, hf);
+    if (rc != RC_OK) return rc;
+    auto* hh = reinterpret_cast<PostingPageHeader*>(hf->data);
+    hf->latch.lock();
+    remaining = --hh->totalCount;
+    hf->latch.unlock();
+    survivor = firstPosting(hf->data);
+    memManager_.markDirty(indexId, head);
+    releasePage(indexId, head);
+    return RC_OK;
+}
+
+RC IndexManager::readPostings(TableId indexId, PageNum head, std::vector<uint64_t>& out) {
+    // 不加锁读：每页解码后校验版本，页被并发修改时重读该页
+    out.clear();
+    for (PageNum page = head; page != -1;) {
+        BufferFrame* frame = nullptr;
+        RC rc = pinPage(indexId, page, frame);
+        if (rc != RC_OK) return rc;
+        size_t size = out.size();
+        uint64_t version = frame->latch.readLock();
+        auto* hdr = reinterpret_cast<PostingPageHeader*>(frame->data);
+        PageNum next = hdr->nextPage;
+        bool sane = hdr->nodeType == (uint8_t)IndexNodeType::POSTING && hdr->count >= 0 && hdr->count <= hdr->dataLen &&
+                    hdr->dataLen <= POSTING_DATA_CAPACITY;
+        if (sane) decodePostings(frame->data, out);
+        bool valid = frame->latch.validate(version);
+        releasePage(indexId, page);
+        if (!valid) {
+            out.resize(size);
+            continue;
+        }
+        if (!sane) return RC_PAGE_NOT_FOUND;
+        page = next;
+    }
+    return RC_OK;
 }
 
 int32_t IndexManager::getChildAt(char* parentPageData, int keyLen, int childIndex) const {
     auto* ph = reinterpret_cast<IndexPageHeader*>(parentPageData);
     if (childIndex == 0) return ph->leftMostChild;
     if (childIndex - 1 < ph->keyCount) {
-        char* e = internalEntryPtr(parentPageData, keyLen, childIndex - 1);
-        return *reinterpret_cast<int32_t*>(e + keyLen);
+        return loadInt32(nodeTail(parentPageData, internalFormat(parentPageData, keyLen), childIndex - 1));
     }
     return -1;
 }
@@ -521,45 +1797,24 @@ int32_t IndexManager::getChildAt(char* parentPageData, int keyLen, int childInde
 int IndexManager::findChildIndex(char* parentPageData, int keyLen, PageNum childPage) const {
     auto* ph = reinterpret_cast<IndexPageHeader*>(parentPageData);
     if (ph->leftMostChild == childPage) return 0;
+    NodeFormat fmt = internalFormat(parentPageData, keyLen);
     for (int i = 0; i < ph->keyCount; ++i) {
-        char* e = internalEntryPtr(parentPageData, keyLen, i);
-        int32_t ch = *reinterpret_cast<int32_t*>(e + keyLen);
-        if (ch == childPage) return i + 1; // index of child in [0..keyCount]
+        if (loadInt32(nodeTail(parentPageData, fmt, i)) == childPage) return i + 1; // index of child in [0..keyCount]
     }
     return -1;
 }
 
-RC IndexManager::updateParentKeyForRightChild(TableId indexId, BufferFrame* parentFrame, int keyLen, int keyPos, BufferFrame* rightChildFrame) {
-    auto* rh = reinterpret_cast<IndexPageHeader*>(rightChildFrame->data);
-    if (rh->keyCount <= 0) return RC_OK; // nothing to update
-    // 取右孩子的最小键（叶：第0项；内部：第0项）
-    char* src = (rh->nodeType == (uint8_t)IndexNodeType::LEAF)
-                ? leafEntryPtr(rightChildFrame->data, keyLen, 0)
-                : internalEntryPtr(rightChildFrame->data, keyLen, 0);
-    char* dst = internalEntryPtr(parentFrame->data, keyLen, keyPos);
-    std::memcpy(dst, src, keyLen);
-    memManager_.markDirty(parentFrame->tableId, parentFrame->pageNum);
-    return RC_OK;
-}
-
-RC IndexManager::removeParentEntryAt(TableId indexId, const IndexInfo& info, BufferFrame* parentFrame, int removeKeyPos) {
+RC IndexManager::removeParentEntryAt(TableId indexId, const IndexInfo& info, BufferFrame* parentFrame, int removeKeyPos,
+                                     const std::vector<PageNum>& path) {
     auto* ph = reinterpret_cast<IndexPageHeader*>(parentFrame->data);
-    int n = ph->keyCount;
-    int keyLen = info.keyLen;
-    if (removeKeyPos < 0 || removeKeyPos >= n) return RC_INVALID_ARG;
+    if (removeKeyPos < 0 || removeKeyPos >= ph->keyCount) return RC_INVALID_ARG;
 
-    // 将[removeKeyPos+1..n-1]左移一位
-    for (int i = removeKeyPos; i < n - 1; ++i) {
-        char* dst = internalEntryPtr(parentFrame->data, keyLen, i);
-        char* src = internalEntryPtr(parentFrame->data, keyLen, i + 1);
-        std::memmove(dst, src, keyLen + 8);
-    }
-    ph->keyCount--;
+    nodeRemove(parentFrame->data, internalFormat(parentFrame->data, info.keyLen), removeKeyPos);
     memManager_.markDirty(indexId, ph->pageNum);
 
     // 根可能需要收缩
-    if (ph->parentPage == -1) {
-        return shrinkRootIfNeeded(indexId, info, parentFrame);
+    if (path.empty()) {
+        return shrinkRootIfNeeded(indexId, parentFrame);
     }
 
     // 非根：若下溢则递归重平衡
@@ -567,189 +1822,177 @@ RC IndexManager::removeParentEntryAt(TableId indexId, const IndexInfo& info, Buf
     if (ph->keyCount < minKeys) {
         PageNum pnum = ph->pageNum;
         // 递归处理
-        return rebalanceInternalAfterDelete(indexId, info, pnum);
+        return rebalanceInternalAfterDelete(indexId, info, pnum, path);
     }
     return RC_OK;
 }
 
 // 收缩根：若根是内部节点且没有键且只有一个孩子，则让孩子成为新根
-RC IndexManager::shrinkRootIfNeeded(TableId indexId, const IndexInfo& infoIn, BufferFrame* rootFrame) {
+RC IndexManager::shrinkRootIfNeeded(TableId indexId, BufferFrame* rootFrame) {
     auto* rh = reinterpret_cast<IndexPageHeader*>(rootFrame->data);
-    IndexInfo info = infoIn; // 本地副本以便更新
+    IndexLatch& latch = latchFor(indexId);
 
-    if (rh->parentPage != -1) return RC_OK; // 非根
+    if (rh->pageNum != latch.rootPage.load()) return RC_OK; // 非根
 
     if (rh->nodeType == (uint8_t)IndexNodeType::INTERNAL && rh->keyCount == 0) {
         // 仅一个孩子
         PageNum child = rh->leftMostChild;
         if (child >= 0) {
-            BufferFrame* cf = nullptr; RC rc = readPage(indexId, child, cf); if (rc != RC_OK) return rc;
-            auto* ch = reinterpret_cast<IndexPageHeader*>(cf->data);
-            ch->parentPage = -1;
-            memManager_.markDirty(indexId, child);
-            releasePage(indexId, child);
-            info.rootPage = child;
-            info.height = std::max(1, info.height - 1);
-            dataDict_.updateIndexInfo(info);
+            updateRoot(indexId, child, std::max(1, latch.height.load() - 1));
         }
     }
     return RC_OK;
 }
 
 // 叶子删除后的借位/合并
-RC IndexManager::rebalanceAfterDelete(TableId indexId, const IndexInfo &info, PageNum leafPage) {
+//   键压缩后借位会改变父节点中的分隔键长度，父节点放不下新的分隔键时放弃该次借位；合并后放不下时不合并
+RC IndexManager::rebalanceAfterDelete(TableId indexId, const IndexInfo &info, PageNum leafPage, const std::vector<PageNum>& path) {
     BufferFrame* leaf = nullptr; RC rc = readPage(indexId, leafPage, leaf); if (rc != RC_OK) return rc;
     auto* lh = reinterpret_cast<IndexPageHeader*>(leaf->data);
-    int keyLen = info.keyLen;
+    const int keyLen = info.keyLen;
+    const int tailLen = leafTailLen(info);
 
     // 若是根或未下溢，则直接返回
     int minKeys = minKeysForNode(lh->maxKeys);
-    if (lh->parentPage == -1 || lh->keyCount >= minKeys) { releasePage(indexId, leafPage); return RC_OK; }
+    if (path.empty() || lh->keyCount >= minKeys) { releasePage(indexId, leafPage); return RC_OK; }
 
-    // 加载父
-    BufferFrame* parent = nullptr; rc = readPage(indexId, lh->parentPage, parent); if (rc != RC_OK) { releasePage(indexId, leafPage); return rc; }
+    // 加载父（路径末尾），其祖先路径供父节点下溢时继续向上处理
+    PageNum parentPage = path.back();
+    const std::vector<PageNum> above(path.begin(), path.end() - 1);
+    BufferFrame* parent = nullptr; rc = readPage(indexId, parentPage, parent); if (rc != RC_OK) { releasePage(indexId, leafPage); return rc; }
     int childIndex = findChildIndex(parent->data, keyLen, leafPage);
-    if (childIndex < 0) { releasePage(indexId, lh->parentPage); releasePage(indexId, leafPage); return RC_PAGE_NOT_FOUND; }
+    if (childIndex < 0) { releasePage(indexId, parentPage); releasePage(indexId, leafPage); return RC_PAGE_NOT_FOUND; }
+    int parentKeys = reinterpret_cast<IndexPageHeader*>(parent->data)->keyCount;
+    NodeImage cur(keyLen, tailLen);
+    cur.load(leaf->data);
+    char sep[MAX_INDEX_KEY_LEN];
 
-    // 尝试向左借
+    // 尝试向左借：左兄弟最后一项移到当前页开头，父分隔键改为左兄弟新末键与之间的最短键
     if (childIndex - 1 >= 0) {
         int32_t leftPage = getChildAt(parent->data, keyLen, childIndex - 1);
-        if (leftPage != -1) {
-            BufferFrame* left = nullptr; if (readPage(indexId, leftPage, left) == RC_OK) {
-                auto* lhdr = reinterpret_cast<IndexPageHeader*>(left->data);
-                if (lhdr->nodeType == (uint8_t)IndexNodeType::LEAF && lhdr->keyCount > minKeys) {
-                    // 将左兄弟最后一项移到当前页开头
-                    int lpos = lhdr->keyCount - 1;
-                    // 右移当前页项
-                    for (int i = lh->keyCount; i > 0; --i) {
-                        std::memmove(leafEntryPtr(leaf->data, keyLen, i), leafEntryPtr(leaf->data, keyLen, i-1), keyLen + 8);
-                    }
-                    std::memcpy(leafEntryPtr(leaf->data, keyLen, 0), leafEntryPtr(left->data, keyLen, lpos), keyLen + 8);
-                    lh->keyCount++;
-                    lhdr->keyCount--;
-                    // 更新父分隔键为当前页新的最小键
-                    char* sepDst = internalEntryPtr(parent->data, keyLen, childIndex - 1);
-                    std::memcpy(sepDst, leafEntryPtr(leaf->data, keyLen, 0), keyLen);
+        BufferFrame* left = nullptr;
+        if (leftPage != -1 && readPage(indexId, leftPage, left) == RC_OK) {
+            auto* lhdr = reinterpret_cast<IndexPageHeader*>(left->data);
+            if (lhdr->nodeType == (uint8_t)IndexNodeType::LEAF && lhdr->keyCount > minKeys) {
+                NodeImage sib(keyLen, tailLen);
+                sib.load(left->data);
+                int lpos = sib.count() - 1;
+                makeSeparator(sib.key(lpos - 1), sib.key(lpos), keyLen, sep);
+                if (nodeReplaceKey(parent->data, keyLen, INTERNAL_TAIL_LEN, childIndex - 1, sep)) {
+                    cur.insert(0, sib.key(lpos), sib.tail(lpos));
+                    cur.store(leaf->data);
+                    nodeRemove(left->data, leafFormat(left->data, info), lpos);
                     memManager_.markDirty(indexId, leftPage);
-                    memManager_.markDirty(indexId, lh->parentPage);
+                    memManager_.markDirty(indexId, parentPage);
                     memManager_.markDirty(indexId, leafPage);
-                    releasePage(indexId, leftPage); releasePage(indexId, lh->parentPage); releasePage(indexId, leafPage);
+                    releasePage(indexId, leftPage); releasePage(indexId, parentPage); releasePage(indexId, leafPage);
                     return RC_OK;
                 }
-                releasePage(indexId, leftPage);
             }
+            releasePage(indexId, leftPage);
         }
     }
 
-    // 尝试向右借
-    if (childIndex + 1 <= reinterpret_cast<IndexPageHeader*>(parent->data)->keyCount) {
+    // 尝试向右借：右兄弟第一项移到当前页末尾，父分隔键改为其与右兄弟新首键之间的最短键
+    if (childIndex + 1 <= parentKeys) {
         int32_t rightPage = getChildAt(parent->data, keyLen, childIndex + 1);
-        if (rightPage != -1) {
-            BufferFrame* right = nullptr; if (readPage(indexId, rightPage, right) == RC_OK) {
-                auto* rh = reinterpret_cast<IndexPageHeader*>(right->data);
-                if (rh->nodeType == (uint8_t)IndexNodeType::LEAF && rh->keyCount > minKeys) {
-                    // 将右兄弟第一项移到当前页末尾
-                    char* src = leafEntryPtr(right->data, keyLen, 0);
-                    std::memcpy(leafEntryPtr(leaf->data, keyLen, lh->keyCount), src, keyLen + 8);
-                    lh->keyCount++;
-                    // 右页整体左移一位
-                    for (int i = 0; i < rh->keyCount - 1; ++i) {
-                        std::memmove(leafEntryPtr(right->data, keyLen, i), leafEntryPtr(right->data, keyLen, i+1), keyLen + 8);
-                    }
-                    rh->keyCount--;
-                    // 更新父分隔键为右页新的最小键
-                    char* sepDst = internalEntryPtr(parent->data, keyLen, childIndex);
-                    if (rh->keyCount > 0) std::memcpy(sepDst, leafEntryPtr(right->data, keyLen, 0), keyLen);
+        BufferFrame* right = nullptr;
+        if (rightPage != -1 && readPage(indexId, rightPage, right) == RC_OK) {
+            auto* rh = reinterpret_cast<IndexPageHeader*>(right->data);
+            if (rh->nodeType == (uint8_t)IndexNodeType::LEAF && rh->keyCount > minKeys) {
+                NodeImage sib(keyLen, tailLen);
+                sib.load(right->data);
+                makeSeparator(sib.key(0), sib.key(1), keyLen, sep);
+                if (nodeReplaceKey(parent->data, keyLen, INTERNAL_TAIL_LEN, childIndex, sep)) {
+                    cur.insert(cur.count(), sib.key(0), sib.tail(0));
+                    cur.store(leaf->data);
+                    nodeRemove(right->data, leafFormat(right->data, info), 0);
                     memManager_.markDirty(indexId, rightPage);
-                    memManager_.markDirty(indexId, lh->parentPage);
+                    memManager_.markDirty(indexId, parentPage);
                     memManager_.markDirty(indexId, leafPage);
-                    releasePage(indexId, rightPage); releasePage(indexId, lh->parentPage); releasePage(indexId, leafPage);
+                    releasePage(indexId, rightPage); releasePage(indexId, parentPage); releasePage(indexId, leafPage);
                     return RC_OK;
                 }
-                releasePage(indexId, rightPage);
             }
+            releasePage(indexId, rightPage);
         }
     }
 
     // 借不到则合并（左优先）
     if (childIndex - 1 >= 0) {
         int32_t leftPage = getChildAt(parent->data, keyLen, childIndex - 1);
-        if (leftPage != -1) {
-            BufferFrame* left = nullptr; if (readPage(indexId, leftPage, left) == RC_OK) {
-                auto* lhdr = reinterpret_cast<IndexPageHeader*>(left->data);
-                if (lhdr->nodeType == (uint8_t)IndexNodeType::LEAF) {
-                    // 左页吸收当前页
-                    for (int i = 0; i < lh->keyCount; ++i) {
-                        std::memcpy(leafEntryPtr(left->data, keyLen, lhdr->keyCount + i), leafEntryPtr(leaf->data, keyLen, i), keyLen + 8);
-                    }
-                    lhdr->keyCount += lh->keyCount;
-                    // 维护链表
-                    lhdr->nextPage = lh->nextPage;
-                    if (lh->nextPage != -1) {
-                        BufferFrame* nxt = nullptr; if (readPage(indexId, lh->nextPage, nxt) == RC_OK) {
-                            auto* nh = reinterpret_cast<IndexPageHeader*>(nxt->data);
-                            nh->prevPage = lhdr->pageNum;
-                            memManager_.markDirty(indexId, nh->pageNum);
-                            releasePage(indexId, nh->pageNum);
-                        }
+        BufferFrame* left = nullptr;
+        if (leftPage != -1 && readPage(indexId, leftPage, left) == RC_OK) {
+            auto* lhdr = reinterpret_cast<IndexPageHeader*>(left->data);
+            NodeImage merged(keyLen, tailLen);
+            merged.load(left->data);
+            merged.append(cur, 0, cur.count());
+            merged.header().nextPage = lh->nextPage;
+            // 左页吸收当前页
+            if (lhdr->nodeType == (uint8_t)IndexNodeType::LEAF && merged.store(left->data)) {
+                // 维护链表
+                if (lh->nextPage != -1) {
+                    BufferFrame* nxt = nullptr; if (readPage(indexId, lh->nextPage, nxt) == RC_OK) {
+                        auto* nh = reinterpret_cast<IndexPageHeader*>(nxt->data);
+                        nh->prevPage = leftPage;
+                        memManager_.markDirty(indexId, nh->pageNum);
+                        releasePage(indexId, nh->pageNum);
                     }
-                    memManager_.markDirty(indexId, leftPage);
-                    // 从父删除分隔键 childIndex-1
-                    RC rrc = removeParentEntryAt(indexId, info, parent, childIndex - 1);
-                    releasePage(indexId, leftPage); releasePage(indexId, lhdr->parentPage); releasePage(indexId, leafPage);
-                    return rrc;
                 }
-                releasePage(indexId, leftPage);
+                memManager_.markDirty(indexId, leftPage);
+                // 从父删除分隔键 childIndex-1
+                RC rrc = removeParentEntryAt(indexId, info, parent, childIndex - 1, above);
+                releasePage(indexId, leftPage); releasePage(indexId, parentPage); releasePage(indexId, leafPage);
+                return rrc;
             }
+            releasePage(indexId, leftPage);
         }
     }
 
     // 与右合并
-    if (childIndex + 1 <= reinterpret_cast<IndexPageHeader*>(parent->data)->keyCount) {
+    if (childIndex + 1 <= parentKeys) {
         int32_t rightPage = getChildAt(parent->data, keyLen, childIndex + 1);
-        if (rightPage != -1) {
-            BufferFrame* right = nullptr; if (readPage(indexId, rightPage, right) == RC_OK) {
-                auto* rh = reinterpret_cast<IndexPageHeader*>(right->data);
-                if (rh->nodeType == (uint8_t)IndexNodeType::LEAF) {
-                    // 当前页吸收右页
-                    for (int i = 0; i < rh->keyCount; ++i) {
-                        std::memcpy(leafEntryPtr(leaf->data, keyLen, lh->keyCount + i), leafEntryPtr(right->data, keyLen, i), keyLen + 8);
-                    }
-                    lh->keyCount += rh->keyCount;
-                    // 维护链表
-                    lh->nextPage = rh->nextPage;
-                    if (rh->nextPage != -1) {
-                        BufferFrame* nxt = nullptr; if (readPage(indexId, rh->nextPage, nxt) == RC_OK) {
-                            auto* nh = reinterpret_cast<IndexPageHeader*>(nxt->data);
-                            nh->prevPage = lh->pageNum;
-                            memManager_.markDirty(indexId, nh->pageNum);
-                            releasePage(indexId, nh->pageNum);
-                        }
+        BufferFrame* right = nullptr;
+        if (rightPage != -1 && readPage(indexId, rightPage, right) == RC_OK) {
+            auto* rh = reinterpret_cast<IndexPageHeader*>(right->data);
+            NodeImage sib(keyLen, tailLen);
+            sib.load(right->data);
+            cur.append(sib, 0, sib.count());
+            cur.header().nextPage = rh->nextPage;
+            // 当前页吸收右页
+            if (rh->nodeType == (uint8_t)IndexNodeType::LEAF && cur.store(leaf->data)) {
+                // 维护链表
+                if (rh->nextPage != -1) {
+                    BufferFrame* nxt = nullptr; if (readPage(indexId, rh->nextPage, nxt) == RC_OK) {
+                        auto* nh = reinterpret_cast<IndexPageHeader*>(nxt->data);
+                        nh->prevPage = leafPage;
+                        memManager_.markDirty(indexId, nh->pageNum);
+                        releasePage(indexId, nh->pageNum);
                     }
-                    memManager_.markDirty(indexId, leafPage);
-                    // 从父删除分隔键 childIndex
-                    RC rrc = removeParentEntryAt(indexId, info, parent, childIndex);
-                    releasePage(indexId, rightPage); releasePage(indexId, lh->parentPage); releasePage(indexId, leafPage);
-                    return rrc;
                 }
-                releasePage(indexId, rightPage);
+                memManager_.markDirty(indexId, leafPage);
+                // 从父删除分隔键 childIndex
+                RC rrc = removeParentEntryAt(indexId, info, parent, childIndex, above);
+                releasePage(indexId, rightPage); releasePage(indexId, parentPage); releasePage(indexId, leafPage);
+                return rrc;
             }
+            releasePage(indexId, rightPage);
         }
     }
 
     // 默认
-    releasePage(indexId, lh->parentPage); releasePage(indexId, leafPage);
+    releasePage(indexId, parentPage); releasePage(indexId, leafPage);
     return RC_OK;
 }
 
-RC IndexManager::rebalanceInternalAfterDelete(TableId indexId, const IndexInfo& info, PageNum pageNum) {
+RC IndexManager::rebalanceInternalAfterDelete(TableId indexId, const IndexInfo& info, PageNum pageNum, const std::vector<PageNum>& path) {
     BufferFrame* frame = nullptr; RC rc = readPage(indexId, pageNum, frame); if (rc != RC_OK) return rc;
     auto* hdr = reinterpret_cast<IndexPageHeader*>(frame->data);
-    int keyLen = info.keyLen;
+    const int keyLen = info.keyLen;
 
     // 根处理
-    if (hdr->parentPage == -1) {
-        RC s = shrinkRootIfNeeded(indexId, info, frame);
+    if (path.empty()) {
+        RC s = shrinkRootIfNeeded(indexId, frame);
         releasePage(indexId, pageNum);
         return s;
     }
@@ -758,183 +2001,546 @@ RC IndexManager::rebalanceInternalAfterDelete(TableId indexId, const IndexInfo&
     if (hdr->keyCount >= minKeys) { releasePage(indexId, pageNum); return RC_OK; }
 
     // 取父
-    BufferFrame* parent = nullptr; rc = readPage(indexId, hdr->parentPage, parent); if (rc != RC_OK) { releasePage(indexId, pageNum); return rc; }
+    PageNum parentPage = path.back();
+    const std::vector<PageNum> above(path.begin(), path.end() - 1);
+    BufferFrame* parent = nullptr; rc = readPage(indexId, parentPage, parent); if (rc != RC_OK) { releasePage(indexId, pageNum); return rc; }
     auto* ph = reinterpret_cast<IndexPageHeader*>(parent->data);
-    int childIndex = findChildIndex(parent->data, keyLen, hdr->pageNum);
-    if (childIndex < 0) { releasePage(indexId, hdr->parentPage); releasePage(indexId, pageNum); return RC_PAGE_NOT_FOUND; }
-
-    // 先尝试向左借
+    int childIndex = findChildIndex(parent->data, keyLen, pageNum);
+    if (childIndex < 0) { releasePage(indexId, parentPage); releasePage(indexId, pageNum); return RC_PAGE_NOT_FOUND; }
+    NodeImage cur(keyLen, INTERNAL_TAIL_LEN);
+    cur.load(frame->data);
+    NodeFormat pfmt = internalFormat(parent->data, keyLen);
+    char parentSep[MAX_INDEX_KEY_LEN];
+    char childTail[INTERNAL_TAIL_LEN] = {0};
+
+    // 先尝试向左借：父分隔键下移到当前页开头，左兄弟最后一个键上移替换它
     if (childIndex - 1 >= 0) {
         int32_t leftPage = getChildAt(parent->data, keyLen, childIndex - 1);
-        if (leftPage != -1) {
-            BufferFrame* left = nullptr; if (readPage(indexId, leftPage, left) == RC_OK) {
-                auto* lh = reinterpret_cast<IndexPageHeader*>(left->data);
-                if (lh->nodeType == (uint8_t)IndexNodeType::INTERNAL && lh->keyCount > minKeys) {
-                    // 左兄弟的最后一个entry下的右孩子
-                    int lpos = lh->keyCount - 1;
-                    int32_t borrowChild = *reinterpret_cast<int32_t*>(internalEntryPtr(left->data, keyLen, lpos) + keyLen);
-                    // 将父分隔键下移到当前页开头，右孩子=当前leftMostChild
-                    for (int i = hdr->keyCount; i > 0; --i) {
-                        std::memmove(internalEntryPtr(frame->data, keyLen, i), internalEntryPtr(frame->data, keyLen, i-1), keyLen + 8);
-                    }
-                    char* parentSep = internalEntryPtr(parent->data, keyLen, childIndex - 1);
-                    std::memcpy(internalEntryPtr(frame->data, keyLen, 0), parentSep, keyLen);
-                    *reinterpret_cast<int32_t*>(internalEntryPtr(frame->data, keyLen, 0) + keyLen) = hdr->leftMostChild;
-                    hdr->leftMostChild = borrowChild;
-                    hdr->keyCount++;
-                    // 父分隔键替换为左兄弟最后一个key
-                    char* leftLastKey = internalEntryPtr(left->data, keyLen, lpos);
-                    std::memcpy(parentSep, leftLastKey, keyLen);
+        BufferFrame* left = nullptr;
+        if (leftPage != -1 && readPage(indexId, leftPage, left) == RC_OK) {
+            auto* lh = reinterpret_cast<IndexPageHeader*>(left->data);
+            if (lh->nodeType == (uint8_t)IndexNodeType::INTERNAL && lh->keyCount > minKeys) {
+                NodeImage sib(keyLen, INTERNAL_TAIL_LEN);
+                sib.load(left->data);
+                int lpos = sib.count() - 1;
+                // 左兄弟最后一个entry下的右孩子
+                int32_t borrowChild = loadInt32(sib.tail(lpos));
+                nodeGetKey(parent->data, pfmt, childIndex - 1, parentSep);
+                if (nodeReplaceKey(parent->data, keyLen, INTERNAL_TAIL_LEN, childIndex - 1, sib.key(lpos))) {
+                    storeInt32(childTail, cur.header().leftMostChild);
+                    cur.insert(0, parentSep, childTail);
+                    cur.header().leftMostChild = borrowChild;
+                    cur.store(frame->data);
                     // 删除左兄弟最后一个entry
-                    lh->keyCount--;
+                    nodeRemove(left->data, internalFormat(left->data, keyLen), lpos);
                     memManager_.markDirty(indexId, leftPage);
-                    memManager_.markDirty(indexId, hdr->parentPage);
+                    memManager_.markDirty(indexId, parentPage);
                     memManager_.markDirty(indexId, pageNum);
-                    setChildrenParent(indexId, std::vector<PageNum>{borrowChild}, pageNum);
-                    releasePage(indexId, leftPage); releasePage(indexId, hdr->parentPage); releasePage(indexId, pageNum);
+                    releasePage(indexId, leftPage); releasePage(indexId, parentPage); releasePage(indexId, pageNum);
                     return RC_OK;
                 }
-                releasePage(indexId, leftPage);
             }
+            releasePage(indexId, leftPage);
         }
     }
 
-    // 再尝试向右借
+    // 再尝试向右借：父分隔键下移到当前页末尾，右兄弟第一个键上移替换它
     if (childIndex + 1 <= ph->keyCount) {
         int32_t rightPage = getChildAt(parent->data, keyLen, childIndex + 1);
-        if (rightPage != -1) {
-            BufferFrame* right = nullptr; if (readPage(indexId, rightPage, right) == RC_OK) {
-                auto* rh = reinterpret_cast<IndexPageHeader*>(right->data);
-                if (rh->nodeType == (uint8_t)IndexNodeType::INTERNAL && rh->keyCount > minKeys) {
+        BufferFrame* right = nullptr;
+        if (rightPage != -1 && readPage(indexId, rightPage, right) == RC_OK) {
+            auto* rh = reinterpret_cast<IndexPageHeader*>(right->data);
+            if (rh->nodeType == (uint8_t)IndexNodeType::INTERNAL && rh->keyCount > minKeys) {
+                NodeFormat rfmt = internalFormat(right->data, keyLen);
+                char rfirst[MAX_INDEX_KEY_LEN];
+                nodeGetKey(right->data, rfmt, 0, rfirst);
+                nodeGetKey(parent->data, pfmt, childIndex, parentSep);
+                if (nodeReplaceKey(parent->data, keyLen, INTERNAL_TAIL_LEN, childIndex, rfirst)) {
                     int32_t moveChild = rh->leftMostChild;
-                    char* parentSep = internalEntryPtr(parent->data, keyLen, childIndex);
-                    char* dst = internalEntryPtr(frame->data, keyLen, hdr->keyCount);
-                    std::memcpy(dst, parentSep, keyLen);
-                    *reinterpret_cast<int32_t*>(dst + keyLen) = moveChild;
-                    hdr->keyCount++;
-                    char* rfirst = internalEntryPtr(right->data, keyLen, 0);
-                    int32_t newLeftMost = *reinterpret_cast<int32_t*>(rfirst + keyLen);
-                    rh->leftMostChild = newLeftMost;
-                    std::memcpy(parentSep, rfirst, keyLen);
-                    for (int i = 0; i < rh->keyCount - 1; ++i) {
-                        std::memmove(internalEntryPtr(right->data, keyLen, i), internalEntryPtr(right->data, keyLen, i+1), keyLen + 8);
-                    }
-                    rh->keyCount--;
+                    storeInt32(childTail, moveChild);
+                    cur.insert(cur.count(), parentSep, childTail);
+                    cur.store(frame->data);
+                    rh->leftMostChild = loadInt32(nodeTail(right->data, rfmt, 0));
+                    nodeRemove(right->data, rfmt, 0);
                     memManager_.markDirty(indexId, rightPage);
-                    memManager_.markDirty(indexId, hdr->parentPage);
+                    memManager_.markDirty(indexId, parentPage);
                     memManager_.markDirty(indexId, pageNum);
-                    setChildrenParent(indexId, std::vector<PageNum>{moveChild}, pageNum);
-                    releasePage(indexId, rightPage); releasePage(indexId, hdr->parentPage); releasePage(indexId, pageNum);
+                    releasePage(indexId, rightPage); releasePage(indexId, parentPage); releasePage(indexId, pageNum);
                     return RC_OK;
                 }
-                releasePage(indexId, rightPage);
             }
+            releasePage(indexId, rightPage);
         }
     }
 
-    // 借不到则合并（左优先）
+    // 借不到则合并（左优先）：父分隔键下移，右侧节点的最左孩子作为它的右孩子
     if (childIndex - 1 >= 0) {
         int32_t leftPage = getChildAt(parent->data, keyLen, childIndex - 1);
-        if (leftPage != -1) {
-            BufferFrame* left = nullptr; if (readPage(indexId, leftPage, left) == RC_OK) {
-                auto* lh2 = reinterpret_cast<IndexPageHeader*>(left->data);
-                if (lh2->nodeType == (uint8_t)IndexNodeType::INTERNAL) {
-                    std::vector<PageNum> movedChildren;
-                    movedChildren.reserve(hdr->keyCount + 1);
-                    // 将父分隔键下移到左页末尾，右孩子=当前页leftMostChild
-                    char* parentSep = internalEntryPtr(parent->data, keyLen, childIndex - 1);
-                    char* dst = internalEntryPtr(left->data, keyLen, lh2->keyCount);
-                    std::memcpy(dst, parentSep, keyLen);
-                    *reinterpret_cast<int32_t*>(dst + keyLen) = hdr->leftMostChild;
-                    movedChildren.push_back(hdr->leftMostChild);
-                    // 将当前页的所有entry依次追加到左页
-                    for (int i = 0; i < hdr->keyCount; ++i) {
-                        char* src = internalEntryPtr(frame->data, keyLen, i);
-                        std::memcpy(internalEntryPtr(left->data, keyLen, lh2->keyCount + 1 + i), src, keyLen + 8);
-                        int32_t childR = *reinterpret_cast<int32_t*>(src + keyLen);
-                        movedChildren.push_back(childR);
-                    }
-                    lh2->keyCount += 1 + hdr->keyCount;
-                    memManager_.markDirty(indexId, leftPage);
-                    setChildrenParent(indexId, movedChildren, leftPage);
-                    // 从父删除分隔键 childIndex-1
-                    RC rrc = removeParentEntryAt(indexId, info, parent, childIndex - 1);
-                    releasePage(indexId, leftPage); releasePage(indexId, lh2->parentPage); releasePage(indexId, pageNum);
-                    return rrc;
-                }
-                releasePage(indexId, leftPage);
+        BufferFrame* left = nullptr;
+        if (leftPage != -1 && readPage(indexId, leftPage, left) == RC_OK) {
+            auto* lh2 = reinterpret_cast<IndexPageHeader*>(left->data);
+            NodeImage merged(keyLen, INTERNAL_TAIL_LEN);
+            merged.load(left->data);
+            nodeGetKey(parent->data, pfmt, childIndex - 1, parentSep);
+            storeInt32(childTail, cur.header().leftMostChild);
+            merged.insert(merged.count(), parentSep, childTail);
+            merged.append(cur, 0, cur.count());
+            if (lh2->nodeType == (uint8_t)IndexNodeType::INTERNAL && merged.store(left->data)) {
+                memManager_.markDirty(indexId, leftPage);
+                // 从父删除分隔键 childIndex-1
+                RC rrc = removeParentEntryAt(indexId, info, parent, childIndex - 1, above);
+                releasePage(indexId, leftPage); releasePage(indexId, parentPage); releasePage(indexId, pageNum);
+                return rrc;
             }
+            releasePage(indexId, leftPage);
         }
     }
 
     if (childIndex + 1 <= ph->keyCount) {
         int32_t rightPage = getChildAt(parent->data, keyLen, childIndex + 1);
-        if (rightPage != -1) {
-            BufferFrame* right = nullptr; if (readPage(indexId, rightPage, right) == RC_OK) {
-                auto* rh2 = reinterpret_cast<IndexPageHeader*>(right->data);
-                if (rh2->nodeType == (uint8_t)IndexNodeType::INTERNAL) {
-                    std::vector<PageNum> movedChildren;
-                    movedChildren.reserve(rh2->keyCount + 1);
-                    char* parentSep = internalEntryPtr(parent->data, keyLen, childIndex);
-                    char* dst = internalEntryPtr(frame->data, keyLen, hdr->keyCount);
-                    std::memcpy(dst, parentSep, keyLen);
-                    *reinterpret_cast<int32_t*>(dst + keyLen) = rh2->leftMostChild;
-                    movedChildren.push_back(rh2->leftMostChild);
-                    for (int i = 0; i < rh2->keyCount; ++i) {
-                        char* src = internalEntryPtr(right->data, keyLen, i);
-                        std::memcpy(internalEntryPtr(frame->data, keyLen, hdr->keyCount + 1 + i), src, keyLen + 8);
-                        int32_t childR = *reinterpret_cast<int32_t*>(src + keyLen);
-                        movedChildren.push_back(childR);
-                    }
-                    hdr->keyCount += 1 + rh2->keyCount;
-                    memManager_.markDirty(indexId, pageNum);
-                    setChildrenParent(indexId, movedChildren, pageNum);
-                    RC rrc = removeParentEntryAt(indexId, info, parent, childIndex);
-                    releasePage(indexId, rightPage); releasePage(indexId, ph->parentPage); releasePage(indexId, pageNum);
-                    return rrc;
-                }
-                releasePage(indexId, rightPage);
+        BufferFrame* right = nullptr;
+        if (rightPage != -1 && readPage(indexId, rightPage, right) == RC_OK) {
+            auto* rh2 = reinterpret_cast<IndexPageHeader*>(right->data);
+            NodeImage sib(keyLen, INTERNAL_TAIL_LEN);
+            sib.load(right->data);
+            nodeGetKey(parent->data, pfmt, childIndex, parentSep);
+            storeInt32(childTail, rh2->leftMostChild);
+            cur.insert(cur.count(), parentSep, childTail);
+            cur.append(sib, 0, sib.count());
+            if (rh2->nodeType == (uint8_t)IndexNodeType::INTERNAL && cur.store(frame->data)) {
+                memManager_.markDirty(indexId, pageNum);
+                RC rrc = removeParentEntryAt(indexId, info, parent, childIndex, above);
+                releasePage(indexId, rightPage); releasePage(indexId, parentPage); releasePage(indexId, pageNum);
+                return rrc;
             }
+            releasePage(indexId, rightPage);
         }
     }
 
     // 默认
-    releasePage(indexId, hdr->parentPage); releasePage(indexId, pageNum);
+    releasePage(indexId, parentPage); releasePage(indexId, pageNum);
     return RC_OK;
 }
 
-RC IndexManager::setChildrenParent(TableId indexId, const std::vector<PageNum>& children, PageNum newParent) {
-    for (PageNum c : children) {
-        if (c < 0) continue;
-        BufferFrame* f = nullptr; RC rc = readPage(indexId, c, f); if (rc != RC_OK) return rc;
-        auto* h = reinterpret_cast<IndexPageHeader*>(f->data);
-        h->parentPage = newParent;
-        memManager_.markDirty(indexId, c);
-        releasePage(indexId, c);
+RC IndexManager::setIndexCache(const char* indexName, bool enabled) {
+    IndexInfo info;
+    RC rc = dataDict_.findIndex(indexName, info);
+    if (rc != RC_OK) return rc;
+    if (info.method != IndexMethod::BTREE) return RC_INVALID_ARG;
+    if (info.cached != enabled) {
+        // 与换根互斥：在结构修改互斥锁与根版本锁下重新读出索引信息再写回
+        IndexLatch& latch = latchFor(info.indexId);
+        std::lock_guard<std::mutex> smo(latch.smo);
+        std::lock_guard<std::mutex> guard(dictMutex_);
+        latch.root.lock();
+        rc = dataDict_.findIndex(indexName, info);
+        if (rc == RC_OK) {
+            info.cached = enabled;
+            rc = dataDict_.updateIndexInfo(info);
+        }
+        latch.root.unlock();
+        if (rc != RC_OK) return rc;
+    }
+    if (!enabled) {
+        dropCache(info.indexId);
+        return RC_OK;
+    }
+    return cacheFor(info, true) ? RC_OK : RC_INVALID_OP;
+}
+
+void IndexManager::dropCache(TableId indexId) {
+    std::lock_guard<std::mutex> guard(cachesMutex_);
+    caches_.erase(indexId);
+    cacheCount_ = caches_.size();
+}
+
+std::shared_ptr<IndexManager::IndexCache> IndexManager::cacheFor(const IndexInfo& info, bool build) {
+    if (info.method != IndexMethod::BTREE || (build && !info.cached)) return nullptr;
+    if (!build) {
+        // 修改B+树之后才查登记表：登记（及其后的扫描）在修改之前时，必定看到计数非零
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (cacheCount_.load() == 0) return nullptr;
+    }
+    std::shared_ptr<IndexCache> cache;
+    std::unique_lock<std::shared_mutex> building;
+    {
+        std::lock_guard<std::mutex> guard(cachesMutex_);
+        auto it = caches_.find(info.indexId);
+        if (it != caches_.end()) return it->second;
+        if (!build) return nullptr;
+        // 句柄可能早于关闭镜像取得：以字典中的当前值为准，已关闭时不再构建
+        IndexInfo current;
+        if (dataDict_.findIndexById(info.indexId, current) != RC_OK || !current.cached) return nullptr;
+        // 登记时即持有写锁：其后的点查与同步都等到构建完成
+        cache = std::make_shared<IndexCache>(info.keyLen, leafTailLen(info));
+        building = std::unique_lock<std::shared_mutex>(cache->mutex);
+        caches_[info.indexId] = cache;
+        cacheCount_ = caches_.size();
+    }
+    if (buildCache(info, cache->art) != RC_OK) {
+        std::lock_guard<std::mutex> guard(cachesMutex_);
+        auto it = caches_.find(info.indexId);
+        if (it != caches_.end() && it->second == cache) caches_.erase(it);
+        cacheCount_ = caches_.size();
+        return nullptr;
+    }
+    return cache;
+}
+
+RC IndexManager::buildCache(const IndexInfo& info, ArtCache& art) {
+    // 沿叶子链扫描全部项（posting列表展开为逐行的项）
+    IndexScan scan;
+    RC rc = openScan(info.indexName, nullptr, true, nullptr, true, ScanDirection::FORWARD, scan, true);
+    if (rc != RC_OK) return rc;
+    std::vector<char> tail(leafTailLen(info));
+    RID rid;
+    while (scan.next(rid)) {
+        storeInt32(tail.data(), rid.pageNum);
+        storeInt32(tail.data() + 4, rid.slotNum);
+        if (info.payloadLen > 0) std::memcpy(tail.data() + 8, scan.payload(), info.payloadLen);
+        art.insert(scan.key(), tail.data());
+    }
+    return scan.status();
+}
+
+bool IndexManager::cacheLookup(const IndexInfo& info, const KeyBytes& key, std::vector<char>& out, bool first) {
+    std::shared_ptr<IndexCache> cache = cacheFor(info, true);
+    if (!cache) return false;
+    std::shared_lock<std::shared_mutex> guard(cache->mutex);
+    return cache->art.lookup(key.data(), out, first);
+}
+
+void IndexManager::cacheApply(const IndexInfo& info, const KeyBytes& key, const RID& rid, const char* payload, bool insert) {
+    std::shared_ptr<IndexCache> cache = cacheFor(info, false);
+    if (!cache) return;
+    std::unique_lock<std::shared_mutex> guard(cache->mutex);
+    if (!insert) {
+        cache->art.remove(key.data(), rid);
+        return;
+    }
+    std::vector<char> tail(leafTailLen(info));
+    storeInt32(tail.data(), rid.pageNum);
+    storeInt32(tail.data() + 4, rid.slotNum);
+    std::memcpy(tail.data() + 8, payload, info.payloadLen);
+    cache->art.insert(key.data(), tail.data());
+}
+
+RC IndexManager::updateRoot(TableId indexId, PageNum rootPage, int height) {
+    IndexLatch& latch = latchFor(indexId);
+    std::lock_guard<std::mutex> guard(dictMutex_);
+    latch.root.lock();
+    IndexInfo info;
+    RC rc = dataDict_.findIndexById(indexId, info);
+    if (rc == RC_OK) {
+        info.rootPage = rootPage;
+        info.height = height;
+        rc = dataDict_.updateIndexInfo(info);
+    }
+    latch.rootPage.store(rootPage, std::memory_order_release);
+    latch.height.store(height, std::memory_order_release);
+    latch.root.unlock();
+    return rc;
+}
+
+RC IndexManager::publishIndexInfo(const IndexInfo& info) {
+    IndexLatch& latch = latchFor(info.indexId);
+    std::lock_guard<std::mutex> guard(dictMutex_);
+    latch.root.lock();
+    RC rc = dataDict_.updateIndexInfo(info);
+    latch.rootPage.store(info.rootPage, std::memory_order_release);
+    latch.height.store(info.height, std::memory_order_release);
+    latch.root.unlock();
+    return rc;
+}
+
+RC IndexManager::keyExists(const IndexInfo& info, const KeyBytes& key, bool& found) {
+    // 命中的各项为 键 + RID + 负载，跳过键中有空值列的项
+    std::vector<char> hit;
+    const int entryLen = indexLeafEntryLen(info);
+    auto anyValue = [&]() {
+        for (size_t off = 0; off < hit.size(); off += entryLen) {
+            if (!indexKeyHasNull(info, hit.data() + off + info.keyLen + 8)) return true;
+        }
+        return false;
+    };
+    if (info.method == IndexMethod::HASH) {
+        RC rc = hashProbe(info, key, hit, false);
+        found = anyValue();
+        return rc;
+    }
+    found = info.cached && cacheLookup(info, key, hit, false) && anyValue();
+    if (found) return RC_OK;
+    PageNum leaf;
+    int pos;
+    return findKeyEntry(info.indexId, info, key, leaf, pos, found);
+}
+
+RC IndexManager::checkUnique(const TableInfo &table, const char *data, int len) {
+    std::vector<IndexRef> idxs; dataDict_.listIndexRefsForTable(table.tableId, idxs);
+    for (auto& ref : idxs) {
+        const IndexInfo& idx = ref->info;
+        if (!idx.unique) continue;
+        KeyBytes kb;
+        char payload[BLOCK_SIZE];
+        if (!extractKey(table, idx, data, len, kb, payload) || indexKeyHasNull(idx, payload)) continue;
+        bool found;
+        RC rc = keyExists(idx, kb, found);
+        if (rc != RC_OK) return rc;
+        if (found) return RC_DUPLICATE_KEY;
+    }
+    return RC_OK;
+}
+
+RC IndexManager::checkUnique(const TableInfo &table, const std::vector<RowChange> &rows) {
+    std::vector<IndexRef> idxs; dataDict_.listIndexRefsForTable(table.tableId, idxs);
+    std::vector<BatchEntry> entries;
+    std::vector<char> tails;
+    for (auto& ref : idxs) {
+        const IndexInfo& idx = ref->info;
+        if (!idx.unique) continue;
+        // 排序后批内的相同键相邻；键中有空值列的项不参与检查
+        collectBatch(table, idx, rows, entries, tails);
+        const KeyBytes* prev = nullptr;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (indexKeyHasNull(idx, tails.data() + entries[i].tail + 8)) continue;
+            if (prev && entries[i].key.compare(*prev) == 0) return RC_DUPLICATE_KEY;
+            prev = &entries[i].key;
+            bool found;
+            RC rc = keyExists(idx, entries[i].key, found);
+            if (rc != RC_OK) return rc;
+            if (found) return RC_DUPLICATE_KEY;
+        }
     }
     return RC_OK;
 }
 
 RC IndexManager::onRecordInserted(const TableInfo &table, const char *data, int len, const RID &rid) {
-    // 针对该表的所有索引插入键
-    std::vector<IndexInfo> idxs; dataDict_.listIndexesForTable(table.tableId, idxs);
-    for (auto& idx : idxs) {
-        KeyBytes kb = extractKey(data, len, idx.keyType, idx.keyLen);
-        insertKey(idx.indexId, idx, kb, rid);
+    // 针对该表的所有索引插入键；唯一性以叶子（哈希桶）写锁下的检查为准，失败时其余索引不再插入
+    std::vector<IndexRef> idxs; dataDict_.listIndexRefsForTable(table.tableId, idxs);
+    for (auto& ref : idxs) {
+        const IndexInfo& idx = ref->info;
+        KeyBytes kb;
+        char payload[BLOCK_SIZE];
+        if (!extractKey(table, idx, data, len, kb, payload)) continue;
+        RC rc = idx.method == IndexMethod::HASH ? hashInsert(idx, kb, rid, payload) : insertKey(idx.indexId, idx, kb, rid, payload);
+        if (rc != RC_OK) return rc;
+        if (idx.method != IndexMethod::HASH) cacheApply(idx, kb, rid, payload, true);
     }
     return RC_OK;
 }
 
 RC IndexManager::onRecordDeleted(const TableInfo &table, const char *data, int len, const RID &rid) {
     // 针对该表的所有索引删除键
-    std::vector<IndexInfo> idxs; dataDict_.listIndexesForTable(table.tableId, idxs);
-    for (auto& idx : idxs) {
-        KeyBytes kb = extractKey(data, len, idx.keyType, idx.keyLen);
-        deleteKey(idx.indexId, idx, kb, rid);
+    std::vector<IndexRef> idxs; dataDict_.listIndexRefsForTable(table.tableId, idxs);
+    for (auto& ref : idxs) {
+        const IndexInfo& idx = ref->info;
+        KeyBytes kb;
+        char payload[BLOCK_SIZE];
+        if (!extractKey(table, idx, data, len, kb, payload)) continue;
+        if (idx.method == IndexMethod::HASH) hashDelete(idx, kb, rid);
+        else {
+            deleteKey(idx.indexId, idx, kb, rid);
+            cacheApply(idx, kb, rid, payload, false);
+        }
     }
     return RC_OK;
 }
 
+void IndexManager::collectBatch(const TableInfo &table, const IndexInfo &info, const std::vector<RowChange> &rows,
+                                std::vector<BatchEntry> &entries, std::vector<char> &tails) {
+    int tailLen = leafTailLen(info);
+    entries.clear();
+    tails.clear();
+    entries.reserve(rows.size());
+    tails.reserve(rows.size() * tailLen);
+    char payload[BLOCK_SIZE];
+    for (const RowChange& row : rows) {
+        BatchEntry e;
+        if (!extractKey(table, info, row.data.data(), (int)row.data.size(), e.key, payload)) continue;
+        e.rid = row.rid;
+        e.tail = tails.size();
+        tails.resize(tails.size() + tailLen);
+        char* t = tails.data() + e.tail;
+        storeInt32(t, row.rid.pageNum);
+        storeInt32(t + 4, row.rid.slotNum);
+        std::memcpy(t + 8, payload, info.payloadLen);
+        entries.push_back(e);
+    }
+    std::sort(entries.begin(), entries.end(), [](const BatchEntry& a, const BatchEntry& b) {
+        int c = a.key.compare(b.key);
+        return c != 0 ? c < 0 : ridOrdinal(a.rid) < ridOrdinal(b.rid);
+    });
+}
+
+RC IndexManager::insertBatch(TableId indexId, const IndexInfo &info, const std::vector<BatchEntry> &entries,
+                             const std::vector<char> &tails, std::vector<char> &applied) {
+    applied.assign(entries.size(), 0);
+    RC first = RC_OK;
+    auto note = [&](size_t i, RC rc) {
+        applied[i] = rc == RC_OK;
+        if (rc != RC_OK && first == RC_OK) first = rc;
+    };
+    size_t i = 0;
+    while (i < entries.size()) {
+        // 1. 为第i项乐观下降，同时取得叶子的上界；版本未变时升级为写锁
+        PageNum leafPage;
+        BufferFrame* leafFrame = nullptr;
+        uint64_t version;
+        KeyBytes fence;
+        RC rc = descend(indexId, info, &entries[i].key, false, leafPage, leafFrame, version, &fence);
+        if (rc != RC_OK) return rc;
+        if (!leafFrame->latch.tryUpgrade(version)) {
+            releasePage(indexId, leafPage);
+            continue;
+        }
+
+        // 2. 小于上界的后续项同样落在该叶子：持写锁就地插入，直到放不下或越过上界
+        LeafInsert result = LeafInsert::DONE;
+        do {
+            const BatchEntry& e = entries[i];
+            result = insertIntoLeaf(indexId, info, leafFrame, e.key, tails.data() + e.tail, e.rid, false, rc);
+            if (result != LeafInsert::DONE) break;
+            note(i++, rc);
+        } while (i < entries.size() && (fence.len == 0 || entries[i].key.compare(fence) < 0));
+        leafFrame->latch.unlock();
+        releasePage(indexId, leafPage);
+
+        // 3. 需要分裂或跨叶子处理的项交给结构修改，之后自根重新下降
+        if (result != LeafInsert::DONE) {
+            const BatchEntry& e = entries[i];
+            note(i++, insertInSmo(indexId, info, e.key, tails.data() + e.tail, e.rid));
+        }
+    }
+    return first;
+}
+
+RC IndexManager::deleteBatch(TableId indexId, const IndexInfo &info, const std::vector<BatchEntry> &entries,
+                             std::vector<char> &applied) {
+    applied.assign(entries.size(), 0);
+    IndexLatch& latch = latchFor(indexId);
+    RC first = RC_OK;
+    auto note = [&](RC rc) { if (rc != RC_OK && first == RC_OK) first = rc; };
+    size_t i = 0;
+    while (i < entries.size()) {
+        // 1. 为第i项乐观下降到可能含其键的最左叶子，版本未变时升级为写锁
+        PageNum leaf;
+        BufferFrame* frame = nullptr;
+        uint64_t version;
+        RC rc = descend(indexId, info, &entries[i].key, true, leaf, frame, version);
+        if (rc != RC_OK) return rc;
+        if (!frame->latch.tryUpgrade(version)) {
+            releasePage(indexId, leaf);
+            continue;
+        }
+
+        // 2. 键不超过叶子末键的后续项在该叶子中匹配(键, RID)删除；下降后的第一项超出末键时该键在右侧叶子中或不存在
+        //    删除可以低于下溢阈值（不删空叶子），离开叶子后再重平衡一次
+        auto* hdr = reinterpret_cast<IndexPageHeader*>(frame->data);
+        bool single = false;
+        for (bool fresh = true; i < entries.size(); fresh = false) {
+            const BatchEntry& e = entries[i];
+            NodeFormat fmt = leafFormat(frame->data, info);
+            int n = hdr->keyCount;
+            if (n == 0 || nodeCompareKey(frame->data, fmt, n - 1, e.key.data()) < 0) {
+                single = fresh;
+                break;
+            }
+            int pos = -1;
+            bool posting = false;
+            for (int j = nodeLowerBound(frame->data, fmt, e.key.data()); j < n; ++j) {
+                if (nodeCompareKey(frame->data, fmt, j, e.key.data()) != 0) break;
+                const char* t = nodeTail(frame->data, fmt, j);
+                if (loadInt32(t) == POSTING_RID_PAGE) { pos = j; posting = true; break; }
+                if (loadInt32(t) == e.rid.pageNum && loadInt32(t + 4) == e.rid.slotNum) { pos = j; break; }
+            }
+            if (posting) {
+                rc = removeFromPosting(indexId, frame, fmt, pos, e.rid);
+                applied[i++] = rc == RC_OK;
+                note(rc);
+                continue;
+            }
+            // 项不在该叶子（相同键跨叶子）或会删空叶子（叶子为根时不会）：交给逐项删除
+            if (pos < 0 || (leaf != latch.rootPage.load() && n == 1)) {
+                single = true;
+                break;
+            }
+            nodeRemove(frame->data, fmt, pos);
+            memManager_.markDirty(indexId, leaf);
+            applied[i++] = 1;
+        }
+        KeyBytes leafKey;
+        bool underflow = leaf != latch.rootPage.load() && hdr->keyCount < minKeysForNode(hdr->maxKeys);
+        if (underflow) {
+            nodeGetKey(frame->data, leafFormat(frame->data, info), 0, leafKey.bytes);
+            leafKey.len = info.keyLen;
+        }
+        frame->latch.unlock();
+        releasePage(indexId, leaf);
+
+        if (underflow) note(rebalanceLeaf(indexId, info, leaf, leafKey));
+        if (single) {
+            rc = deleteKey(indexId, info, entries[i].key, entries[i].rid);
+            applied[i++] = rc == RC_OK;
+            note(rc);
+        }
+    }
+    return first;
+}
+
+RC IndexManager::rebalanceLeaf(TableId indexId, const IndexInfo &info, PageNum leafPage, const KeyBytes &key) {
+    std::lock_guard<std::mutex> smo(latchFor(indexId).smo);
+    PageNum found;
+    std::vector<PageNum> path;
+    RC rc = descendForSmo(indexId, info, key, false, found, path);
+    if (rc != RC_OK || found != leafPage) return rc;
+    SmoLatches latches(memManager_, indexId);
+    return rebalanceAfterDelete(indexId, info, leafPage, path);
+}
+
+RC IndexManager::onRecordsInserted(const TableInfo &table, const std::vector<RowChange> &rows) {
+    std::vector<IndexRef> idxs; dataDict_.listIndexRefsForTable(table.tableId, idxs);
+    std::vector<BatchEntry> entries;
+    std::vector<char> tails;
+    std::vector<char> applied;
+    RC first = RC_OK;
+    auto note = [&](RC rc) { if (rc != RC_OK && first == RC_OK) first = rc; };
+    for (auto& ref : idxs) {
+        const IndexInfo& idx = ref->info;
+        collectBatch(table, idx, rows, entries, tails);
+        if (idx.method == IndexMethod::HASH) {
+            for (const BatchEntry& e : entries) note(hashInsert(idx, e.key, e.rid, tails.data() + e.tail + 8));
+            continue;
+        }
+        note(insertBatch(idx.indexId, idx, entries, tails, applied));
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (applied[i]) cacheApply(idx, entries[i].key, entries[i].rid, tails.data() + entries[i].tail + 8, true);
+        }
+    }
+    return first;
+}
+
+RC IndexManager::onRecordsDeleted(const TableInfo &table, const std::vector<RowChange> &rows) {
+    std::vector<IndexRef> idxs; dataDict_.listIndexRefsForTable(table.tableId, idxs);
+    std::vector<BatchEntry> entries;
+    std::vector<char> tails;
+    std::vector<char> applied;
+    RC first = RC_OK;
+    auto note = [&](RC rc) { if (rc != RC_OK && first == RC_OK) first = rc; };
+    for (auto& ref : idxs) {
+        const IndexInfo& idx = ref->info;
+        collectBatch(table, idx, rows, entries, tails);
+        if (idx.method == IndexMethod::HASH) {
+            for (const BatchEntry& e : entries) note(hashDelete(idx, e.key, e.rid));
+            continue;
+        }
+        note(deleteBatch(idx.indexId, idx, entries, applied));
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (applied[i]) cacheApply(idx, entries[i].key, entries[i].rid, tails.data() + entries[i].tail + 8, false);
+        }
+    }
+    return first;
+}
+
 RC IndexManager::showIndex(const char *indexName) {
     IndexInfo idx; RC rc = dataDict_.findIndex(indexName, idx);
     if (rc != RC_OK) { std::cout << "Index not found: " << indexName << std::endl; return rc; }
@@ -947,18 +2553,66 @@ RC IndexManager::showIndex(const char *indexName) {
 
     TableFileHeader hdr; rc = diskManager_.readTableFileHeader(idx.indexId, hdr);
     if (rc != RC_OK) return rc;
-
+    TableRef tableRef; rc = dataDict_.getTable(idx.tableName, tableRef);
+    if (rc != RC_OK) return rc;
+    const TableInfo& table = tableRef->info;
+
+    std::string columns;
+    for (int i = 0; i < idx.keyColumnCount; ++i) { if (i) columns += ", "; columns += columnRefText(table.attrs, indexKeyRef(idx, i)); }
+    if (idx.includeCount > 0) {
+        columns += " INCLUDE (";
+        for (int i = 0; i < idx.includeCount; ++i) { if (i) columns += ", "; columns += table.attrs[idx.includeColumns[i]].name; }
+        columns += ")";
+    }
     std::cout << "Index: " << idx.indexName << ", Table: " << idx.tableName
-              << ", Column: " << idx.columnName << ", Root: " << idx.rootPage
+              << ", Columns: " << columns << (idx.method == IndexMethod::HASH ? ", Method: HASH" : "") << ", Root: " << idx.rootPage
               << ", Height: " << idx.height << ", UsedBlocks: " << hdr.usedBlocks << std::endl;
+    if (idx.predicateCount > 0) {
+        std::cout << "  Where: ";
+        for (int i = 0; i < idx.predicateCount; ++i) {
+            const IndexPredicate& pred = idx.predicates[i];
+            const AttrInfo& attr = table.attrs[pred.column];
+            Value v; decodeIndexKey(attr.type, pred.key, indexKeyLength(attr.type, attr.length), v);
+            std::cout << (i ? " AND " : "") << attr.name << " " << pred.op << " '" << valueToString(v) << "'";
+        }
+        std::cout << std::endl;
+    }
+    if (idx.cached) {
+        std::shared_ptr<IndexCache> cache = cacheFor(idx, false);
+        if (cache) {
+            std::shared_lock<std::shared_mutex> guard(cache->mutex);
+            std::cout << "  ART cache: keys=" << cache->art.keyCount() << " entries=" << cache->art.entryCount()
+                      << " bytes=" << cache->art.memoryBytes() << std::endl;
+        } else {
+            std::cout << "  ART cache: enabled, built on first lookup" << std::endl;
+        }
+    }
+
+    // 键展示为各键列值（复合键以逗号分隔），叶子项另附INCLUDE列
+    auto keyString = [&](const char* key, const char* payload) {
+        std::string out;
+        for (int i = 0; i < idx.keyColumnCount; ++i) {
+            Value v; decodeIndexKeyPart(table, idx, key, payload, i, v);
+            if (i) out += ",";
+            out += valueToString(v);
+        }
+        for (int i = 0; payload && i < idx.includeCount; ++i) {
+            Value v; decodeIndexColumn(table, idx, key, payload, idx.includeColumns[i], v);
+            out += i ? "," : " | ";
+            out += valueToString(v);
+        }
+        return out;
+    };
 
     if (idx.rootPage < 0) return RC_OK;
+    if (idx.method == IndexMethod::HASH) return showHashIndex(idx, keyString);
 
     // 从根开始，先打印自顶向下的层级，然后打印叶子链
     // 层序遍历（最多简单打印少量示例键）
     std::vector<PageNum> q{idx.rootPage};
     std::vector<PageNum> leaves;
     int keyLen = idx.keyLen;
+    char key[MAX_INDEX_KEY_LEN];
 
     while (!q.empty()) {
         std::vector<PageNum> nq;
@@ -967,30 +2621,34 @@ RC IndexManager::showIndex(const char *indexName) {
             if (p < 0) continue;
             if (diskManager_.readBlock(idx.indexId, p, buf) != RC_OK) continue;
             auto* ph = reinterpret_cast<IndexPageHeader*>(buf);
-            std::cout << "  Page #" << p << " type=" << ((ph->nodeType==(uint8_t)IndexNodeType::LEAF)?"LEAF":"INTERNAL")
+            bool isLeaf = ph->nodeType == (uint8_t)IndexNodeType::LEAF;
+            NodeFormat fmt = isLeaf ? leafFormat(buf, idx) : internalFormat(buf, keyLen);
+            std::cout << "  Page #" << p << " type=" << (isLeaf?"LEAF":"INTERNAL")
                       << " prev=" << ph->prevPage << " next=" << ph->nextPage
-                      << " keys=" << ph->keyCount << "/" << ph->maxKeys << std::endl;
+                      << " keys=" << ph->keyCount << "/" << fmt.capacity()
+                      << " prefix=" << fmt.prefixLen << " stored=" << fmt.storedLen() << "/" << keyLen << std::endl;
             int show = std::min<int>(ph->keyCount, 6);
             for (int i = 0; i < show; ++i) {
-                if (ph->nodeType == (uint8_t)IndexNodeType::LEAF) {
-                    char* pentry = leafEntryPtr(buf, keyLen, (i<3?i:(ph->keyCount - (show - i))));
-                    int32_t page = *reinterpret_cast<int32_t*>(pentry + keyLen);
-                    int32_t slot = *reinterpret_cast<int32_t*>(pentry + keyLen + 4);
-                    int32_t keyPreview = 0; std::memcpy(&keyPreview, pentry, std::min(4, keyLen));
-                    std::cout << "    [" << i << "] key~=" << keyPreview << " -> (" << page << "," << slot << ")" << std::endl;
+                int pos = i < 3 ? i : ph->keyCount - (show - i);
+                nodeGetKey(buf, fmt, pos, key);
+                const char* t = nodeTail(buf, fmt, pos);
+                if (isLeaf && loadInt32(t) == POSTING_RID_PAGE) {
+                    char post[BLOCK_SIZE];
+                    int rows = diskManager_.readBlock(idx.indexId, loadInt32(t + 4), post) == RC_OK
+                               ? reinterpret_cast<PostingPageHeader*>(post)->totalCount : -1;
+                    std::cout << "    [" << i << "] key=" << keyString(key, t + 8) << " -> posting #" << loadInt32(t + 4)
+                              << " (" << rows << " rows)" << std::endl;
+                } else if (isLeaf) {
+                    std::cout << "    [" << i << "] key=" << keyString(key, t + 8) << " -> (" << loadInt32(t) << "," << loadInt32(t + 4) << ")" << std::endl;
                 } else {
-                    char* e = internalEntryPtr(buf, keyLen, (i<3?i:(ph->keyCount - (show - i))));
-                    int32_t child = *reinterpret_cast<int32_t*>(e + keyLen);
-                    int32_t keyPreview = 0; std::memcpy(&keyPreview, e, std::min(4, keyLen));
-                    std::cout << "    [" << i << "] key~=" << keyPreview << " -> child=" << child << std::endl;
+                    std::cout << "    [" << i << "] key=" << keyString(key, nullptr) << " -> child=" << loadInt32(t) << std::endl;
                 }
             }
 
             if (ph->nodeType == (uint8_t)IndexNodeType::INTERNAL) {
                 if (ph->leftMostChild >= 0) nq.push_back(ph->leftMostChild);
                 for (int i = 0; i < ph->keyCount; ++i) {
-                    char* e = internalEntryPtr(buf, keyLen, i);
-                    int32_t child = *reinterpret_cast<int32_t*>(e + keyLen);
+                    int32_t child = loadInt32(nodeTail(buf, fmt, i));
                     if (child >= 0) nq.push_back(child);
                 }
             } else {
@@ -0,0 +1,503 @@
+#include "../include/index_node.h"
+#include <algorithm>
+#include <atomic>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define NODE_SEARCH_X86 1
+#endif
+
+static inline uint32_t loadBigEndian32(const char* in) {
+    const auto* p = reinterpret_cast<const unsigned char*>(in);
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static inline uint64_t loadBigEndian64(const char* in) {
+    return ((uint64_t)loadBigEndian32(in) << 32) | loadBigEndian32(in + 4);
+}
+
+static inline int commonPrefix(const char* a, const char* b, int len) {
+    int i = 0;
+    while (i < len && a[i] == b[i]) ++i;
+    return i;
+}
+
+static inline bool allZero(const char* p, int len) {
+    for (int i = 0; i < len; ++i) {
+        if (p[i] != 0) return false;
+    }
+    return true;
+}
+
+// [from, to)内最长的0段（等长时取靠后的一段，位于键尾的0段比较时只需一次memcmp）
+template <typename ByteAt>
+static void longestZeroRun(int from, int to, const ByteAt& byteAt, int& start, int& len) {
+    start = to;
+    len = 0;
+    int runStart = from;
+    for (int i = from; i <= to; ++i) {
+        if (i < to && byteAt(i) == 0) continue;
+        if (i - runStart >= len && i > runStart) {
+            start = runStart;
+            len = i - runStart;
+        }
+        runStart = i + 1;
+    }
+}
+
+NodeFormat::NodeFormat(const char* page, int keyLen, int tailLen) : keyLen(keyLen), tailLen(tailLen) {
+    auto* hdr = reinterpret_cast<const IndexPageHeader*>(page);
+    prefixLen = hdr->prefixLen;
+    gapStart = hdr->gapLen > 0 ? hdr->gapStart : keyLen;
+    gapLen = hdr->gapLen;
+}
+
+int NodeFormat::capacity() const {
+    return (int)((BLOCK_SIZE - sizeof(IndexPageHeader) - prefixLen) / stride());
+}
+
+int NodeFormat::tailOffset() const {
+    return (int)sizeof(IndexPageHeader) + prefixLen + capacity() * storedLen();
+}
+
+bool NodeFormat::consistent(const char* page) const {
+    int count = reinterpret_cast<const IndexPageHeader*>(page)->keyCount;
+    if (prefixLen < 0 || gapLen < 0 || prefixLen > gapStart || gapStart + gapLen > keyLen) return false;
+    return count >= 0 && count <= capacity();
+}
+
+bool NodeFormat::accepts(const char* page, const char* key) const {
+    return std::memcmp(page + sizeof(IndexPageHeader), key, prefixLen) == 0 && allZero(key + gapStart, gapLen);
+}
+
+void nodeGetKey(const char* page, const NodeFormat& fmt, int pos, char* out) {
+    const char* e = nodeEntry(page, fmt, pos);
+    std::memcpy(out, page + sizeof(IndexPageHeader), fmt.prefixLen);
+    std::memcpy(out + fmt.prefixLen, e, fmt.headLen());
+    std::memset(out + fmt.gapStart, 0, fmt.gapLen);
+    std::memcpy(out + fmt.gapStart + fmt.gapLen, e + fmt.headLen(), fmt.storedLen() - fmt.headLen());
+}
+
+int nodeCompareKey(const char* page, const NodeFormat& fmt, int pos, const char* key) {
+    int c = std::memcmp(page + sizeof(IndexPageHeader), key, fmt.prefixLen);
+    if (c != 0) return c;
+    const char* e = nodeEntry(page, fmt, pos);
+    c = std::memcmp(e, key + fmt.prefixLen, fmt.headLen());
+    if (c != 0) return c;
+    if (!allZero(key + fmt.gapStart, fmt.gapLen)) return -1;
+    return std::memcmp(e + fmt.headLen(), key + fmt.gapStart + fmt.gapLen, fmt.storedLen() - fmt.headLen());
+}
+
+// 项内键比较器（直接比较页内的压缩字节与同样去掉前缀和0区段的查找键）：
+//   存放4字节（如INT/FLOAT键）时按大端无符号整数比较，一次加载完成；其余按memcmp比较
+struct FixedKeyCompare {
+    int operator()(const char* a, const char* b) const {
+        uint32_t x = loadBigEndian32(a), y = loadBigEndian32(b);
+        return x < y ? -1 : (x > y ? 1 : 0);
+    }
+};
+
+struct BytesKeyCompare {
+    int len;
+    int operator()(const char* a, const char* b) const { return std::memcmp(a, b, len); }
+};
+
+// 查找键在0区段上非0：区段前相同的项都小于查找键
+struct GapKeyCompare {
+    int headLen;
+    int operator()(const char* a, const char* b) const {
+        int c = std::memcmp(a, b, headLen);
+        return c != 0 ? c : -1;
+    }
+};
+
+// 在连续的定长键数组的[lo, hi)上二分查找，区间不超过limit项时停止（limit为0时查到底，lo即结果）
+//   upper=true：找第一个键大于key的位置；upper=false：找第一个键不小于key的位置
+template <typename Cmp>
+static void searchEntries(const char* keys, int width, const char* key, bool upper, const Cmp& cmp, int& lo, int& hi, int limit) {
+    while (hi - lo > limit) {
+        int mid = (lo + hi) >> 1;
+        int c = cmp(keys + mid * width, key);
+        if (c < 0 || (upper && c == 0)) lo = mid + 1;
+        else hi = mid;
+    }
+}
+
+// ===== SIMD区间计数：n个连续的大端键中小于（upper时不大于）target的个数，即有序区间内的查找结果 =====
+// 大端键经字节重排转为本机序，再翻转符号位以有符号比较代替无符号比较
+
+static int countBelowScalar32(const char* keys, int n, uint64_t target, bool upper) {
+    int count = 0;
+    for (int i = 0; i < n; ++i) {
+        uint32_t k = loadBigEndian32(keys + i * 4);
+        count += upper ? k <= target : k < target;
+    }
+    return count;
+}
+
+static int countBelowScalar64(const char* keys, int n, uint64_t target, bool upper) {
+    int count = 0;
+    for (int i = 0; i < n; ++i) {
+        uint64_t k = loadBigEndian64(keys + i * 8);
+        count += upper ? k <= target : k < target;
+    }
+    return count;
+}
+
+#ifdef NODE_SEARCH_X86
+__attribute__((target("avx2")))
+static int countBelowAvx2_32(const char* keys, int n, uint64_t target, bool upper) {
+    const __m256i swap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                          3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    const __m256i sign = _mm256_set1_epi32(INT32_MIN);
+    const __m256i t = _mm256_set1_epi32((int32_t)((uint32_t)target ^ 0x80000000u));
+    int count = 0, i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i * 4));
+        k = _mm256_xor_si256(_mm256_shuffle_epi8(k, swap), sign);
+        // upper：数出键大于target的，其余即不大于
+        __m256i m = upper ? _mm256_cmpgt_epi32(k, t) : _mm256_cmpgt_epi32(t, k);
+        int hits = __builtin_popcount((unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(m)));
+        count += upper ? 8 - hits : hits;
+    }
+    return count + countBelowScalar32(keys + i * 4, n - i, target, upper);
+}
+
+__attribute__((target("avx2")))
+static int countBelowAvx2_64(const char* keys, int n, uint64_t target, bool upper) {
+    const __m256i swap = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+                                          7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+    const __m256i t = _mm256_set1_epi64x((int64_t)(target ^ 0x8000000000000000ull));
+    int count = 0, i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i * 8));
+        k = _mm256_xor_si256(_mm256_shuffle_epi8(k, swap), sign);
+        __m256i m = upper ? _mm256_cmpgt_epi64(k, t) : _mm256_cmpgt_epi64(t, k);
+        int hits = __builtin_popcount((unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(m)));
+        count += upper ? 4 - hits : hits;
+    }
+    return count + countBelowScalar64(keys + i * 8, n - i, target, upper);
+}
+
+__attribute__((target("sse4.2")))
+static int countBelowSse42_32(const char* keys, int n, uint64_t target, bool upper) {
+    const __m128i swap = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    const __m128i sign = _mm_set1_epi32(INT32_MIN);
+    const __m128i t = _mm_set1_epi32((int32_t)((uint32_t)target ^ 0x80000000u));
+    int count = 0, i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i * 4));
+        k = _mm_xor_si128(_mm_shuffle_epi8(k, swap), sign);
+        __m128i m = upper ? _mm_cmpgt_epi32(k, t) : _mm_cmpgt_epi32(t, k);
+        int hits = __builtin_popcount((unsigned)_mm_movemask_ps(_mm_castsi128_ps(m)));
+        count += upper ? 4 - hits : hits;
+    }
+    return count + countBelowScalar32(keys + i * 4, n - i, target, upper);
+}
+
+__attribute__((target("sse4.2")))
+static int countBelowSse42_64(const char* keys, int n, uint64_t target, bool upper) {
+    const __m128i swap = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    const __m128i sign = _mm_set1_epi64x(INT64_MIN);
+    const __m128i t = _mm_set1_epi64x((int64_t)(target ^ 0x8000000000000000ull));
+    int count = 0, i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i * 8));
+        k = _mm_xor_si128(_mm_shuffle_epi8(k, swap), sign);
+        __m128i m = upper ? _mm_cmpgt_epi64(k, t) : _mm_cmpgt_epi64(t, k);
+        int hits = __builtin_popcount((unsigned)_mm_movemask_pd(_mm_castsi128_pd(m)));
+        count += upper ? 2 - hits : hits;
+    }
+    return count + countBelowScalar64(keys + i * 8, n - i, target, upper);
+}
+#endif
+
+static bool kernelSupported(NodeSearchKernel kernel) {
+    switch (kernel) {
+        case NodeSearchKernel::SCALAR: return true;
+#ifdef NODE_SEARCH_X86
+        case NodeSearchKernel::SSE42: return __builtin_cpu_supports("sse4.2");
+        case NodeSearchKernel::AVX2: return __builtin_cpu_supports("avx2");
+#endif
+        default: return false;
+    }
+}
+
+static NodeSearchKernel detectKernel() {
+    if (kernelSupported(NodeSearchKernel::AVX2)) return NodeSearchKernel::AVX2;
+    if (kernelSupported(NodeSearchKernel::SSE42)) return NodeSearchKernel::SSE42;
+    return NodeSearchKernel::SCALAR;
+}
+
+static std::atomic<NodeSearchKernel> activeKernel{detectKernel()};
+
+NodeSearchKernel nodeSearchKernel() {
+    return activeKernel.load(std::memory_order_relaxed);
+}
+
+bool setNodeSearchKernel(NodeSearchKernel kernel) {
+    if (!kernelSupported(kernel)) return false;
+    activeKernel.store(kernel, std::memory_order_relaxed);
+    return true;
+}
+
+// 4/8字节的键：二分到不超过NODE_SIMD_WINDOW项后按当前实现成组计数
+static int simdSearch(NodeSearchKernel kernel, const char* keys, int n, int width, const char* key, bool upper) {
+    int lo = 0, hi = n;
+    if (width == 4) searchEntries(keys, width, key, upper, FixedKeyCompare(), lo, hi, NODE_SIMD_WINDOW);
+    else searchEntries(keys, width, key, upper, BytesKeyCompare{width}, lo, hi, NODE_SIMD_WINDOW);
+    const char* window = keys + lo * width;
+    int len = hi - lo;
+    uint64_t target = width == 4 ? loadBigEndian32(key) : loadBigEndian64(key);
+    switch (kernel) {
+#ifdef NODE_SEARCH_X86
+        case NodeSearchKernel::AVX2:
+            return lo + (width == 4 ? countBelowAvx2_32(window, len, target, upper) : countBelowAvx2_64(window, len, target, upper));
+        case NodeSearchKernel::SSE42:
+            return lo + (width == 4 ? countBelowSse42_32(window, len, target, upper) : countBelowSse42_64(window, len, target, upper));
+#endif
+        default:
+            return lo + (width == 4 ? countBelowScalar32(window, len, target, upper) : countBelowScalar64(window, len, target, upper));
+    }
+}
+
+static int nodeSearch(const char* page, const NodeFormat& fmt, const char* key, bool upper) {
+    int n = reinterpret_cast<const IndexPageHeader*>(page)->keyCount;
+    // 先与页内前缀比较：不同时查找键整体位于所有项之前或之后
+    int c = std::memcmp(key, page + sizeof(IndexPageHeader), fmt.prefixLen);
+    if (c != 0) return c < 0 ? 0 : n;
+
+    char proj[MAX_INDEX_KEY_LEN];
+    int head = fmt.headLen();
+    int width = fmt.storedLen();
+    std::memcpy(proj, key + fmt.prefixLen, head);
+    std::memcpy(proj + head, key + fmt.gapStart + fmt.gapLen, width - head);
+
+    const char* keys = nodeEntry(page, fmt, 0);
+    int lo = 0, hi = n;
+    if (!allZero(key + fmt.gapStart, fmt.gapLen)) {
+        searchEntries(keys, width, proj, upper, GapKeyCompare{head}, lo, hi, 0);
+        return lo;
+    }
+    NodeSearchKernel kernel = nodeSearchKernel();
+    if (kernel != NodeSearchKernel::SCALAR && (width == 4 || width == 8)) return simdSearch(kernel, keys, n, width, proj, upper);
+    if (width == 4) searchEntries(keys, width, proj, upper, FixedKeyCompare(), lo, hi, 0);
+    else searchEntries(keys, width, proj, upper, BytesKeyCompare{width}, lo, hi, 0);
+    return lo;
+}
+
+int nodeUpperBound(const char* page, const NodeFormat& fmt, const char* key) {
+    return nodeSearch(page, fmt, key, true);
+}
+
+int nodeLowerBound(const char* page, const NodeFormat& fmt, const char* key) {
+    return nodeSearch(page, fmt, key, false);
+}
+
+bool nodeInsertInPlace(char* page, const NodeFormat& fmt, int pos, const char* key, const char* tail) {
+    auto* hdr = reinterpret_cast<IndexPageHeader*>(page);
+    if (hdr->keyCount >= fmt.capacity() || !fmt.accepts(page, key)) return false;
+    int width = fmt.storedLen();
+    int moved = hdr->keyCount - pos;
+    char* e = nodeEntry(page, fmt, pos);
+    char* t = nodeTail(page, fmt, pos);
+    std::memmove(e + width, e, (size_t)moved * width);
+    std::memmove(t + fmt.tailLen, t, (size_t)moved * fmt.tailLen);
+    int head = fmt.headLen();
+    std::memcpy(e, key + fmt.prefixLen, head);
+    std::memcpy(e + head, key + fmt.gapStart + fmt.gapLen, width - head);
+    std::memcpy(t, tail, fmt.tailLen);
+    hdr->keyCount++;
+    return true;
+}
+
+void nodeRemove(char* page, const NodeFormat& fmt, int pos) {
+    auto* hdr = reinterpret_cast<IndexPageHeader*>(page);
+    int width = fmt.storedLen();
+    int moved = hdr->keyCount - pos - 1;
+    char* e = nodeEntry(page, fmt, pos);
+    char* t = nodeTail(page, fmt, pos);
+    std::memmove(e, e + width, (size_t)moved * width);
+    std::memmove(t, t + fmt.tailLen, (size_t)moved * fmt.tailLen);
+    hdr->keyCount--;
+}
+
+bool nodeReplaceKey(char* page, int keyLen, int tailLen, int pos, const char* key) {
+    NodeFormat fmt(page, keyLen, tailLen);
+    if (fmt.accepts(page, key)) {
+        char* e = nodeEntry(page, fmt, pos);
+        int head = fmt.headLen();
+        std::memcpy(e, key + fmt.prefixLen, head);
+        std::memcpy(e + head, key + fmt.gapStart + fmt.gapLen, fmt.storedLen() - head);
+        return true;
+    }
+    NodeImage img(keyLen, tailLen);
+    img.load(page);
+    std::memcpy(img.key(pos), key, keyLen);
+    return img.store(page);
+}
+
+int makeSeparator(const char* left, const char* right, int keyLen, char* out) {
+    int i = commonPrefix(left, right, keyLen);
+    if (i == keyLen) {
+        std::memcpy(out, right, keyLen);
+        while (i > 0 && right[i - 1] == 0) --i;
+        return i;
+    }
+    std::memcpy(out, right, i + 1);
+    std::memset(out + i + 1, 0, keyLen - i - 1);
+    return i + 1;
+}
+
+void NodeImage::load(const char* page) {
+    std::memcpy(&hdr_, page, sizeof(hdr_));
+    NodeFormat fmt(page, keyLen_, tailLen_);
+    int n = hdr_.keyCount;
+    entries_.resize((size_t)n * entryLen());
+    for (int i = 0; i < n; ++i) {
+        nodeGetKey(page, fmt, i, key(i));
+        std::memcpy(tail(i), nodeTail(page, fmt, i), tailLen_);
+    }
+}
+
+NodeFormat NodeImage::bestFormat() const {
+    NodeFormat fmt;
+    fmt.keyLen = keyLen_;
+    fmt.tailLen = tailLen_;
+    fmt.gapStart = keyLen_;
+    int n = count();
+    if (n == 0) return fmt;
+    // 项按键有序：首尾两键的公共前缀即全部键的公共前缀
+    const char* first = entries_.data();
+    const char* last = entries_.data() + (size_t)(n - 1) * entryLen();
+    fmt.prefixLen = commonPrefix(first, last, keyLen_);
+
+    std::vector<uint8_t> orBytes(keyLen_, 0);
+    for (int i = 0; i < n; ++i) {
+        const char* k = entries_.data() + (size_t)i * entryLen();
+        for (int j = fmt.prefixLen; j < keyLen_; ++j) orBytes[j] |= (uint8_t)k[j];
+    }
+    longestZeroRun(fmt.prefixLen, keyLen_, [&](int j) { return orBytes[j]; }, fmt.gapStart, fmt.gapLen);
+    return fmt;
+}
+
+int NodeImage::packedSize() const {
+    NodeFormat fmt = bestFormat();
+    return (int)sizeof(IndexPageHeader) + fmt.prefixLen + count() * fmt.stride();
+}
+
+bool NodeImage::store(char* page) const {
+    NodeFormat fmt = bestFormat();
+    int n = count();
+    if ((int)sizeof(IndexPageHeader) + fmt.prefixLen + n * fmt.stride() > BLOCK_SIZE) return false;
+
+    IndexPageHeader hdr = hdr_;
+    hdr.keyCount = (int16_t)n;
+    hdr.prefixLen = (int16_t)fmt.prefixLen;
+    hdr.gapStart = (int16_t)fmt.gapStart;
+    hdr.gapLen = (int16_t)fmt.gapLen;
+    std::memset(page, 0, BLOCK_SIZE);
+    std::memcpy(page, &hdr, sizeof(hdr));
+    if (n > 0) std::memcpy(page + sizeof(IndexPageHeader), entries_.data(), fmt.prefixLen);
+    int head = fmt.headLen();
+    for (int i = 0; i < n; ++i) {
+        const char* k = entries_.data() + (size_t)i * entryLen();
+        char* e = nodeEntry(page, fmt, i);
+        std::memcpy(e, k + fmt.prefixLen, head);
+        std::memcpy(e + head, k + fmt.gapStart + fmt.gapLen, fmt.storedLen() - head);
+        std::memcpy(nodeTail(page, fmt, i), k + keyLen_, tailLen_);
+    }
+    return true;
+}
+
+void NodeImage::insert(int pos, const char* key, const char* tail) {
+    auto it = entries_.begin() + (size_t)pos * entryLen();
+    it = entries_.insert(it, key, key + keyLen_);
+    entries_.insert(it + keyLen_, tail, tail + tailLen_);
+}
+
+void NodeImage::erase(int from, int to) {
+    entries_.erase(entries_.begin() + (size_t)from * entryLen(), entries_.begin() + (size_t)to * entryLen());
+}
+
+void NodeImage::append(NodeImage& other, int from, int to) {
+    entries_.insert(entries_.end(), other.entries_.begin() + (size_t)from * entryLen(), other.entries_.begin() + (size_t)to * entryLen());
+}
+
+void NodeSizer::reset() {
+    count_ = 0;
+    prefixLen_ = keyLen_;
+    std::fill(orBytes_.begin(), orBytes_.end(), 0);
+}
+
+void NodeSizer::add(const char* key) {
+    if (count_ == 0) {
+        std::memcpy(first_.data(), key, keyLen_);
+        prefixLen_ = keyLen_;
+    } else {
+        prefixLen_ = std::min(prefixLen_, commonPrefix(first_.data(), key, keyLen_));
+    }
+    for (int j = 0; j < keyLen_; ++j) orBytes_[j] |= (uint8_t)key[j];
+    count_++;
+}
+
+int NodeSizer::sizeWith(const char* key) const {
+    int prefix = count_ == 0 ? keyLen_ : std::min(prefixLen_, commonPrefix(first_.data(), key, keyLen_));
+    int gapStart, gapLen;
+    longestZeroRun(prefix, keyLen_, [&](int j) { return orBytes_[j] | (uint8_t)key[j]; }, gapStart, gapLen);
+    return (int)sizeof(IndexPageHeader) + prefix + (count_ + 1) * (keyLen_ - prefix - gapLen + tailLen_);
+}
+
+// 变长整数：每字节低7位为数据，最高位表示后面还有字节
+static inline int putVarint(uint64_t v, char* out) {
+    int n = 0;
+    while (v >= 0x80) {
+        out[n++] = (char)(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = (char)v;
+    return n;
+}
+
+static inline uint64_t getVarint(const char*& in) {
+    uint64_t v = 0;
+    int shift = 0;
+    while (true) {
+        uint8_t b = (uint8_t)*in++;
+        v |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return v;
+        shift += 7;
+    }
+}
+
+int encodePostings(const uint64_t* rids, int n, char* out, int capacity, int& bytes) {
+    char tmp[10];
+    uint64_t prev = 0;
+    bytes = 0;
+    for (int i = 0; i < n; ++i) {
+        int len = putVarint(rids[i] - prev, tmp);
+        if (bytes + len > capacity) return i;
+        std::memcpy(out + bytes, tmp, len);
+        bytes += len;
+        prev = rids[i];
+    }
+    return n;
+}
+
+void decodePostings(const char* page, std::vector<uint64_t>& out) {
+    auto* hdr = reinterpret_cast<const PostingPageHeader*>(page);
+    const char* p = page + sizeof(PostingPageHeader);
+    uint64_t v = 0;
+    for (int i = 0; i < hdr->count; ++i) {
+        v += getVarint(p);
+        out.push_back(v);
+    }
+}
+
+uint64_t firstPosting(const char* page) {
+    auto* hdr = reinterpret_cast<const PostingPageHeader*>(page);
+    if (hdr->count == 0) return UINT64_MAX;
+    const char* p = page + sizeof(PostingPageHeader);
+    return getVarint(p);
+}
@@ -97,9 +97,12 @@ int LogManager::calculateLogLength(LogType type, int dataLen, int extraLen) {
             return baseLen + sizeof(InsertLog) - sizeof(LogHeader) + dataLen;
         case LOG_UPDATE:
             return baseLen + sizeof(UpdateLog) - sizeof(LogHeader) + dataLen + extraLen;
+        case LOG_OVERFLOW:
+            return baseLen + sizeof(OverflowLog) - sizeof(LogHeader) + dataLen;
         case LOG_CREATE_TABLE:
             return baseLen + sizeof(CreateTableLog) - sizeof(LogHeader) + extraLen;
         case LOG_DROP_TABLE:
+        case LOG_TRUNCATE_TABLE:
             return baseLen + sizeof(DropTableLog) - sizeof(LogHeader);
         case LOG_ALTER_TABLE:
             return baseLen + extraLen; // 预留
@@ -275,6 +278,61 @@ lsn_t LogManager::writeDeleteLog(TransactionId txId, TableId tableId, const RID
     return log->header.lsn;
 }
 
+// 写入溢出页日志
+lsn_t LogManager::writeOverflowLog(TransactionId txId, TableId tableId, PageNum pageNum, PageNum nextPage,
+                                   const char *data, int dataLen) {
+    // 每条最多携带一个日志块放得下的数据，超出部分按偏移拆成后续各条
+    const int maxPiece = BLOCK_SIZE - calculateLogLength(LOG_OVERFLOW, 0);
+    lsn_t lsn = RC_INVALID_LSN;
+    int offset = 0;
+    do {
+        int piece = std::min(maxPiece, dataLen - offset);
+        int logLen = calculateLogLength(LOG_OVERFLOW, piece);
+
+        RC rc = RC_OK;
+        if (currentLogBlock_ == -1 || (blockOffsets_[currentLogBlock_] + logLen > BLOCK_SIZE)) {
+            rc = allocLogBlock();
+        }
+        if (rc != RC_OK) {
+            return RC_INVALID_LSN;
+        }
+
+        // 获取当前日志块的缓冲帧
+        BufferFrame *frame = nullptr;
+        rc = getCurrentLogBlock(frame);
+        if (rc != RC_OK) {
+            return RC_INVALID_LSN;
+        }
+
+        // 构造日志记录
+        int blockOffset = blockOffsets_[currentLogBlock_];
+        OverflowLog *log = reinterpret_cast<OverflowLog *>(frame->data + blockOffset);
+        log->header.type = LOG_OVERFLOW;
+        log->header.txId = txId;
+        log->header.lsn = nextLSN();
+        log->header.prevLSN = getLastLSN(txId);
+        log->header.length = logLen;
+        log->tableId = tableId;
+        log->pageNum = pageNum;
+        log->nextPage = nextPage;
+        log->offset = offset;
+        log->dataLen = piece;
+        memcpy(log->data, data + offset, piece);
+        lsn = log->header.lsn;
+
+        // 更新事务日志链
+        txLastLSN_[txId] = lsn;
+        lsnBlockMap_[lsn] = {currentLogBlock_, blockOffset};
+
+        // 更新块偏移并标记脏页
+        blockOffsets_[currentLogBlock_] += logLen;
+        memManager_.markDirty(LOG_TABLE_ID, currentLogBlock_);
+        memManager_.releasePage(LOG_TABLE_ID, currentLogBlock_);
+        offset += piece;
+    } while (offset < dataLen);
+    return lsn;
+}
+
 // 写入更新操作日志
 lsn_t LogManager::writeUpdateLog(TransactionId txId, TableId tableId, const RID &rid,
                                  const char *oldData, int oldLen, const char *newData, int newLen) {
@@ -380,8 +438,16 @@ lsn_t LogManager::writeCreateTableLog(TransactionId txId, TableId tableId, const
 
 // 写入删除表日志
 lsn_t LogManager::writeDropTableLog(TransactionId txId, TableId tableId, const char *tableName) {
+    return writeTableDdlLog(LOG_DROP_TABLE, txId, tableId, tableName);
+}
+
+lsn_t LogManager::writeTruncateTableLog(TransactionId txId, TableId tableId, const char *tableName) {
+    return writeTableDdlLog(LOG_TRUNCATE_TABLE, txId, tableId, tableName);
+}
+
+lsn_t LogManager::writeTableDdlLog(LogType type, TransactionId txId, TableId tableId, const char *tableName) {
     // 计算日志长度
-    int logLen = calculateLogLength(LOG_DROP_TABLE);
+    int logLen = calculateLogLength(type);
     if (logLen > BLOCK_SIZE) {
         return RC_INVALID_LSN;
     }
@@ -404,7 +470,7 @@ lsn_t LogManager::writeDropTableLog(TransactionId txId, TableId tableId, const c
     // 构造日志记录
     int offset = blockOffsets_[currentLogBlock_];
     DropTableLog *log = reinterpret_cast<DropTableLog *>(frame->data + offset);
-    log->header.type = LOG_DROP_TABLE;
+    log->header.type = type;
     log->header.txId = txId;
     log->header.lsn = nextLSN();
     log->header.prevLSN = getLastLSN(txId);
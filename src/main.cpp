@@ -91,8 +91,8 @@ int main(int argc, char* argv[]) {
     CLI cli(tableManager, dataDict, test, indexManager);
     cli.run();
     
-    // 关闭数据库
-    memManager.flushAllPages();
+    // 关闭数据库（检查点：写回表统计并刷出所有脏页）
+    dataDict.checkpoint();
     std::cout << "Database closed!" << std::endl;
     
     return 0;
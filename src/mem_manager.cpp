@@ -1,5 +1,7 @@
 #include "../include/mem_manager.h"
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 
 MemManager::MemManager(size_t totalMemSize, DiskManager &diskManager) :
@@ -30,8 +32,9 @@ MemManager::~MemManager() {
 }
 
 RC MemManager::init() {
-    // 初始化缓冲帧
-    frames_.resize(totalFrames_);
+    // 初始化缓冲帧（帧内含页闩，不可拷贝，一次构造）
+    frames_ = std::vector<BufferFrame>(totalFrames_);
+    pageTable_.clear();
     for (int i = 0; i < totalFrames_; i++) {
         frames_[i].data = new char[BLOCK_SIZE];
         memset(frames_[i].data, 0, BLOCK_SIZE);
@@ -51,14 +54,19 @@ RC MemManager::init() {
 }
 
 RC MemManager::getPage(TableId tableId, PageNum pageNum, BufferFrame *&frame, MemSpaceType spaceType) {
-    // 1. 检查缓冲池中是否已有该页面
-    for (int i = 0; i < totalFrames_; i++) {
-        if (frames_[i].isValid && frames_[i].tableId == tableId && frames_[i].pageNum == pageNum) {
-            frames_[i].pinCount++;
-            frames_[i].refBit = true;
-            frame = &frames_[i];
-            return RC_OK;
-        }
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // 1. 检查缓冲池中是否已有该页面（帧正在置换时等待I/O结束后重新查找）
+    int hit = findFrame(tableId, pageNum);
+    while (hit != -1 && frames_[hit].ioPending) {
+        ioDone_.wait(lock);
+        hit = findFrame(tableId, pageNum);
+    }
+    if (hit != -1 && frames_[hit].isValid) {
+        frames_[hit].pinCount++;
+        frames_[hit].refBit = true;
+        frame = &frames_[hit];
+        return RC_OK;
     }
 
     // 2. 缓存未命中，查找空闲帧或置换
@@ -70,19 +78,40 @@ RC MemManager::getPage(TableId tableId, PageNum pageNum, BufferFrame *&frame, Me
         }
     }
 
-    // 3. 若置换的帧是脏页，先刷盘
+    // 占住该帧：固定并标记置换中，新页先登记到页表，
+    // 之后的磁盘读写不持有mutex_，访问新页或旧页的线程等待置换结束，不会重复读入
     BufferFrame &targetFrame = frames_[frameIdx];
+    targetFrame.pinCount = 1;
+    targetFrame.ioPending = true;
+    pageTable_[pageKey(tableId, pageNum)] = frameIdx;
+
+    // 3. 若置换的帧是脏页，先刷盘（帧未被其他线程固定，内容不会变化）
+    RC rc = RC_OK;
     if (targetFrame.isDirty) {
-        RC rc = diskManager_.writeBlock(targetFrame.tableId, targetFrame.pageNum, targetFrame.data);
-        if (rc != RC_OK) {
-            return rc;
+        lock.unlock();
+        rc = diskManager_.writeBlock(targetFrame.tableId, targetFrame.pageNum, targetFrame.data);
+        lock.lock();
+        if (rc == RC_OK) {
+            targetFrame.isDirty = false;
         }
-        targetFrame.isDirty = false;
     }
 
-    // 4. 从磁盘读取页面数据
-    RC rc = diskManager_.readBlock(tableId, pageNum, targetFrame.data);
+    // 4. 解除旧页的映射，再从磁盘读取页面数据（写回失败时帧保留旧页，读失败时该帧留作空闲帧）
+    if (rc == RC_OK && targetFrame.pageNum != -1) {
+        pageTable_.erase(pageKey(targetFrame.tableId, targetFrame.pageNum));
+        targetFrame.pageNum = -1;
+        targetFrame.tableId = -1;
+    }
+    if (rc == RC_OK) {
+        lock.unlock();
+        rc = diskManager_.readBlock(tableId, pageNum, targetFrame.data);
+        lock.lock();
+    }
+    targetFrame.ioPending = false;
+    ioDone_.notify_all();
     if (rc != RC_OK) {
+        pageTable_.erase(pageKey(tableId, pageNum));
+        targetFrame.pinCount = 0;
         if (rc == RC_BLOCK_NOT_FOUND) {
             return RC_PAGE_NOT_FOUND;
         } else {
@@ -94,7 +123,6 @@ RC MemManager::getPage(TableId tableId, PageNum pageNum, BufferFrame *&frame, Me
     targetFrame.tableId = tableId;
     targetFrame.pageNum = pageNum;
     targetFrame.spaceType = spaceType;
-    targetFrame.pinCount = 1;
     targetFrame.refBit = true;
     targetFrame.isValid = true;
 
@@ -103,6 +131,7 @@ RC MemManager::getPage(TableId tableId, PageNum pageNum, BufferFrame *&frame, Me
 }
 
 RC MemManager::releasePage(TableId tableId, PageNum pageNum) {
+    std::lock_guard<std::mutex> guard(mutex_);
     int idx = findFrame(tableId, pageNum);
     if (idx == -1) {
         return RC_PAGE_NOT_FOUND;
@@ -115,6 +144,7 @@ RC MemManager::releasePage(TableId tableId, PageNum pageNum) {
 }
 
 RC MemManager::markDirty(TableId tableId, PageNum pageNum) {
+    std::lock_guard<std::mutex> guard(mutex_);
     int idx = findFrame(tableId, pageNum);
     if (idx == -1) {
         return RC_PAGE_NOT_FOUND;
@@ -125,25 +155,56 @@ RC MemManager::markDirty(TableId tableId, PageNum pageNum) {
 }
 
 RC MemManager::flushPage(TableId tableId, PageNum pageNum) {
+    std::unique_lock<std::mutex> lock(mutex_);
     int frameIdx = findFrame(tableId, pageNum);
+    while (frameIdx != -1 && frames_[frameIdx].ioPending) {
+        ioDone_.wait(lock);
+        frameIdx = findFrame(tableId, pageNum);
+    }
     if (frameIdx == -1) {
         return RC_PAGE_NOT_FOUND;
     }
 
-    BufferFrame& frame = frames_[frameIdx];
-    if (!frame.isDirty) {
+    if (!frames_[frameIdx].isDirty) {
         return RC_OK; // 非脏页无需刷新
     }
+    return flushFrame(lock, frameIdx, tableId);
+}
 
-    // 将页面数据写入磁盘
-    BlockNum blockNum = pageNum; // 假设页号与块号一致
-    RC rc = diskManager_.writeBlock(frame.tableId, blockNum, frame.data);
+RC MemManager::writeBack(BufferFrame &frame) {
+    // 将页面数据写入磁盘（页号与块号一致）
+    RC rc = diskManager_.writeBlock(frame.tableId, frame.pageNum, frame.data);
     if (rc == RC_OK) {
         frame.isDirty = false; // 清除脏页标记
     }
     return rc;
 }
 
+RC MemManager::flushFrame(std::unique_lock<std::mutex> &lock, int idx, TableId tableId) {
+    BufferFrame &frame = frames_[idx];
+    PageNum pageNum = frame.pageNum;
+    // 固定帧使其不被置换；先清除脏页标记，写盘期间再被修改的页会重新标记为脏页
+    frame.pinCount++;
+    frame.isDirty = false;
+    lock.unlock();
+
+    // 页闩共享读：复制到版本号未变的一致内容后再写盘，写盘期间不阻塞页的读写
+    char copy[BLOCK_SIZE];
+    uint64_t version;
+    do {
+        version = frame.latch.readLock();
+        memcpy(copy, frame.data, BLOCK_SIZE);
+    } while (!frame.latch.validate(version));
+    RC rc = diskManager_.writeBlock(tableId, pageNum, copy);
+
+    lock.lock();
+    if (rc != RC_OK) {
+        frame.isDirty = true;
+    }
+    frame.pinCount--;
+    return rc;
+}
+
 RC MemManager::flushAllPages() {
     flushSpace(DICT_SPACE);
     flushSpace(DATA_SPACE);
@@ -152,47 +213,74 @@ RC MemManager::flushAllPages() {
 }
 
 RC MemManager::flushSpace(MemSpaceType spaceType) {
-    if (spaceType == LOG_SPACE) {
-        for (auto &frame: frames_) {
-            if (frame.isDirty && frame.spaceType == spaceType) {
-                RC rc = diskManager_.writeBlock(LOG_TABLE_ID, frame.pageNum, frame.data);
-                if (rc != RC_OK) {
-                    return rc;
-                }
-                frame.isDirty = false;
-            }
-        }
-    }
-    else if (spaceType == PLAN_SPACE) {
+    if (spaceType == PLAN_SPACE) {
         return RC_OK;
     }
-    else if (spaceType == DICT_SPACE) {
-        for (auto &frame: frames_) {
-            if (frame.isDirty && frame.spaceType == spaceType) {
-                // 修复：将字典类页面写回其所属的表（可能是DICT_TABLE_ID或INDEX_META_TABLE_ID）
-                RC rc = diskManager_.writeBlock(frame.tableId, frame.pageNum, frame.data);
-                if (rc != RC_OK) {
-                    return rc;
-                }
-                frame.isDirty = false;
-            }
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (int i = 0; i < totalFrames_; ++i) {
+        BufferFrame &frame = frames_[i];
+        // 正在置换的帧由置换线程负责写回
+        if (!frame.isDirty || frame.spaceType != spaceType || frame.ioPending) {
+            continue;
+        }
+        // 日志页写回日志文件；字典类页面写回其所属的表（可能是DICT_TABLE_ID或INDEX_META_TABLE_ID）
+        TableId target = spaceType == LOG_SPACE ? LOG_TABLE_ID : frame.tableId;
+        RC rc = flushFrame(lock, i, target);
+        if (rc != RC_OK) {
+            return rc;
         }
     }
-    else {
-        for (auto &frame: frames_) {
-            if (frame.isDirty && frame.spaceType == spaceType) {
-                RC rc = diskManager_.writeBlock(frame.tableId, frame.pageNum, frame.data);
-                if (rc != RC_OK) {
-                    return rc;
-                }
-                frame.isDirty = false;
-            }
+    return RC_OK;
+}
+
+RC MemManager::discardPages(const std::vector<TableId> &tableIds) {
+    auto owned = [&tableIds](const BufferFrame &frame) {
+        return frame.pageNum != -1 &&
+               std::find(tableIds.begin(), tableIds.end(), frame.tableId) != tableIds.end();
+    };
+
+    std::lock_guard<std::mutex> guard(mutex_);
+
+    // 先确认没有被固定的帧，避免丢弃到一半
+    for (const auto &frame: frames_) {
+        if (owned(frame) && frame.pinCount > 0) {
+            return RC_INVALID_OP;
+        }
+    }
+
+    for (auto &frame: frames_) {
+        if (owned(frame)) {
+            pageTable_.erase(pageKey(frame.tableId, frame.pageNum));
+            frame.pageNum = -1;
+            frame.tableId = -1;
+            frame.isDirty = false;
+            frame.refBit = false;
         }
     }
     return RC_OK;
 }
 
+RC MemManager::discardPage(TableId tableId, PageNum pageNum) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = pageTable_.find(pageKey(tableId, pageNum));
+    if (it == pageTable_.end()) {
+        return RC_OK;
+    }
+    BufferFrame &frame = frames_[it->second];
+    if (frame.pinCount > 0) {
+        return RC_INVALID_OP;
+    }
+    pageTable_.erase(it);
+    frame.pageNum = -1;
+    frame.tableId = -1;
+    frame.isDirty = false;
+    frame.refBit = false;
+    return RC_OK;
+}
+
 RC MemManager::getFreeFrame(BufferFrame *&frame, PageNum &pageId, MemSpaceType spaceType) {
+    std::lock_guard<std::mutex> guard(mutex_);
+
     // 先查找未使用的帧
     for (int i = 0; i < totalFrames_; i++) {
         if (frames_[i].pageNum == -1 && frames_[i].spaceType == spaceType && frames_[i].pinCount == 0) {
@@ -210,7 +298,7 @@ RC MemManager::getFreeFrame(BufferFrame *&frame, PageNum &pageId, MemSpaceType s
 
     // 刷新脏页
     if (frames_[replaceIdx].isDirty) {
-        flushPage(frames_[replaceIdx].tableId, frames_[replaceIdx].pageNum);
+        writeBack(frames_[replaceIdx]);
     }
 
     frame = &frames_[replaceIdx];
@@ -220,6 +308,7 @@ RC MemManager::getFreeFrame(BufferFrame *&frame, PageNum &pageId, MemSpaceType s
 
 int MemManager::clockReplace(MemSpaceType spaceType) {
     int start = clockHand_;
+    int rounds = 0;  // 第一圈可能只清除了引用位，需再转一圈
 
     while (true) {
         // 检查当前帧是否符合置换条件
@@ -238,20 +327,16 @@ int MemManager::clockReplace(MemSpaceType spaceType) {
         // 移动指针
         clockHand_ = (clockHand_ + 1) % totalFrames_;
 
-        // 如果回到起点，说明没有可置换的帧
-        if (clockHand_ == start) {
+        // 转满两圈仍未找到，说明没有可置换的帧
+        if (clockHand_ == start && ++rounds == 2) {
             return -1;
         }
     }
 }
 
 int MemManager::findFrame(TableId tableId, PageNum pageNum) {
-    for (int i = 0; i < totalFrames_; i++) {
-        if (frames_[i].tableId == tableId && frames_[i].pageNum == pageNum) {
-            return i;
-        }
-    }
-    return -1;
+    auto it = pageTable_.find(pageKey(tableId, pageNum));
+    return it == pageTable_.end() ? -1 : it->second;
 }
 
 int MemManager::findFreeFrame(MemSpaceType spaceType) {
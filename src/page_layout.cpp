@@ -0,0 +1,252 @@
+#include "../include/page_layout.h"
+#include <algorithm>
+#include <cstring>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static inline int countTrailingZeros(uint64_t x) {
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward64(&idx, x);
+    return (int)idx;
+#else
+    return __builtin_ctzll(x);
+#endif
+}
+
+static inline int align8(int n) {
+    return (n + 7) & ~7;
+}
+
+int bitmapFindZero(const char *bitmap, int nbits) {
+    int words = (nbits + 63) / 64;
+    for (int w = 0; w < words; ++w) {
+        uint64_t x;
+        std::memcpy(&x, bitmap + w * 8, sizeof(x));
+        if (~x != 0) {
+            int bit = w * 64 + countTrailingZeros(~x);
+            return bit < nbits ? bit : -1;
+        }
+    }
+    return -1;
+}
+
+RC PaxLayout::init(const RowLayout &layout) {
+    // 每行占用：各列值宽度 + 1个占用位 + 每列1个空值位
+    int rowBytes = 0;
+    for (int i = 0; i < layout.attrCount; ++i) {
+        rowBytes += 4 + (layout.types[i] == STRING ? layout.lengths[i] : 0);
+    }
+    auto pageBytes = [&](int cap) {
+        int size = (int)sizeof(BitmapPageHeader) + bitmapBytes(cap);
+        for (int i = 0; i < layout.attrCount; ++i) {
+            size += bitmapBytes(cap) + align8(cap * 4);
+            if (layout.types[i] == STRING) size += align8(cap * layout.lengths[i]);
+        }
+        return size;
+    };
+
+    int cap = (BLOCK_SIZE - (int)sizeof(BitmapPageHeader)) * 8 / (rowBytes * 8 + layout.attrCount + 1);
+    while (cap > 0 && pageBytes(cap) > BLOCK_SIZE) {
+        cap--;
+    }
+    if (cap < PAX_MIN_ROWS) {
+        return RC_RECORD_TOO_LONG;
+    }
+
+    capacity = cap;
+    bitmapOffset = (int)sizeof(BitmapPageHeader);
+    int offset = bitmapOffset + bitmapBytes(cap);
+    for (int i = 0; i < layout.attrCount; ++i) {
+        nullOffset[i] = offset;
+        offset += bitmapBytes(cap);
+        valueOffset[i] = offset;
+        offset += align8(cap * 4);
+        charOffset[i] = -1;
+        if (layout.types[i] == STRING) {
+            charOffset[i] = offset;
+            offset += align8(cap * layout.lengths[i]);
+        }
+    }
+    return RC_OK;
+}
+
+void PaxPage::init(PageNum pageNum) {
+    std::memset(data_, 0, BLOCK_SIZE);
+    BitmapPageHeader *h = header();
+    h->pageNum = pageNum;
+    h->capacity = pax_.capacity;
+    h->liveCount = 0;
+}
+
+void PaxPage::writeRow(int slot, const char *rowData, int rowLen) {
+    RowView row(row_, rowData, rowLen);
+    for (int i = 0; i < row_.attrCount; ++i) {
+        char *nulls = data_ + pax_.nullOffset[i];
+        if (row.isNull(i)) {
+            bitmapSet(nulls, slot);
+        } else {
+            bitmapClear(nulls, slot);
+        }
+        if (row_.types[i] != STRING) {
+            std::memcpy(data_ + pax_.valueOffset[i] + slot * 4, rowData + row_.fixedOffset[i], 4);
+            continue;
+        }
+        int32_t len = 0;
+        const char *s = row.getString(i, len);
+        std::memcpy(data_ + pax_.valueOffset[i] + slot * 4, &len, sizeof(len));
+        std::memcpy(data_ + pax_.charOffset[i] + slot * row_.lengths[i], s, len);
+    }
+    bitmapSet(data_ + pax_.bitmapOffset, slot);
+    header()->liveCount++;
+}
+
+void PaxPage::readRow(int slot, std::string &out) const {
+    // 先计算变长数据总长，再一次性按row_codec格式拼装
+    int total = row_.varDataOffset;
+    for (int i = 0; i < row_.attrCount; ++i) {
+        if (row_.types[i] != STRING) continue;
+        int32_t len;
+        std::memcpy(&len, data_ + pax_.valueOffset[i] + slot * 4, sizeof(len));
+        total += len;
+    }
+
+    out.assign(total, '\0');
+    char *row = &out[0];
+    int32_t varEnd = row_.varDataOffset;
+    for (int i = 0; i < row_.attrCount; ++i) {
+        if (bitmapTest(data_ + pax_.nullOffset[i], slot)) {
+            row[i >> 3] |= (char)(1 << (i & 7));
+        }
+        if (row_.types[i] != STRING) {
+            std::memcpy(row + row_.fixedOffset[i], data_ + pax_.valueOffset[i] + slot * 4, 4);
+            continue;
+        }
+        int32_t len;
+        std::memcpy(&len, data_ + pax_.valueOffset[i] + slot * 4, sizeof(len));
+        std::memcpy(row + varEnd, data_ + pax_.charOffset[i] + slot * row_.lengths[i], len);
+        varEnd += len;
+        std::memcpy(row + row_.varTableOffset + row_.varIndex[i] * 4, &varEnd, sizeof(varEnd));
+    }
+}
+
+void PaxPage::getValue(int slot, int col, Value &value) const {
+    value = Value();
+    value.type = row_.types[col];
+    value.isNull = bitmapTest(data_ + pax_.nullOffset[col], slot);
+    if (value.isNull) return;
+    const char *v = data_ + pax_.valueOffset[col] + slot * 4;
+    switch (value.type) {
+        case INT:
+            std::memcpy(&value.intVal, v, sizeof(int32_t));
+            break;
+        case FLOAT:
+            std::memcpy(&value.floatVal, v, sizeof(float));
+            break;
+        case STRING: {
+            int32_t len;
+            std::memcpy(&len, v, sizeof(len));
+            value.strVal.assign(data_ + pax_.charOffset[col] + slot * row_.lengths[col], len);
+            break;
+        }
+    }
+}
+
+void PaxPage::matchEquals(int col, const Value &value, std::vector<int> &slots) const {
+    const char *vals = data_ + pax_.valueOffset[col];
+    int words = (pax_.capacity + 63) / 64;
+    for (int w = 0; w < words; ++w) {
+        uint64_t live, nulls;
+        std::memcpy(&live, data_ + pax_.bitmapOffset + w * 8, sizeof(live));
+        std::memcpy(&nulls, data_ + pax_.nullOffset[col] + w * 8, sizeof(nulls));
+        uint64_t candidates = live & ~nulls;
+        if (candidates == 0) continue;
+
+        // 定长列无分支比较，便于编译器向量化
+        int base = w * 64;
+        int n = std::min(64, pax_.capacity - base);
+        uint64_t match = 0;
+        switch (row_.types[col]) {
+            case INT: {
+                int32_t target = value.intVal;
+                for (int j = 0; j < n; ++j) {
+                    int32_t v;
+                    std::memcpy(&v, vals + (base + j) * 4, sizeof(v));
+                    match |= (uint64_t)(v == target) << j;
+                }
+                break;
+            }
+            case FLOAT: {
+                float target = value.floatVal;
+                for (int j = 0; j < n; ++j) {
+                    float v;
+                    std::memcpy(&v, vals + (base + j) * 4, sizeof(v));
+                    match |= (uint64_t)(v == target) << j;
+                }
+                break;
+            }
+            case STRING: {
+                int32_t target = (int32_t)value.strVal.size();
+                const char *chars = data_ + pax_.charOffset[col];
+                for (int j = 0; j < n; ++j) {
+                    if (!((candidates >> j) & 1)) continue;
+                    int32_t len;
+                    std::memcpy(&len, vals + (base + j) * 4, sizeof(len));
+                    if (len == target &&
+                        std::memcmp(chars + (base + j) * row_.lengths[col], value.strVal.data(), len) == 0) {
+                        match |= (uint64_t)1 << j;
+                    }
+                }
+                break;
+            }
+        }
+
+        match &= candidates;
+        while (match != 0) {
+            slots.push_back(base + countTrailingZeros(match));
+            match &= match - 1;
+        }
+    }
+}
+
+RC FixedLayout::init(const RowLayout &layout) {
+    width = layout.maxRowLen();
+    int cap = (BLOCK_SIZE - (int)sizeof(BitmapPageHeader)) * 8 / (width * 8 + 1);
+    while (cap > 0 && (int)sizeof(BitmapPageHeader) + bitmapBytes(cap) + cap * width > BLOCK_SIZE) {
+        cap--;
+    }
+    if (cap < FIXED_MIN_ROWS) {
+        return RC_RECORD_TOO_LONG;
+    }
+
+    capacity = cap;
+    bitmapOffset = (int)sizeof(BitmapPageHeader);
+    rowOffset = bitmapOffset + bitmapBytes(cap);
+    return RC_OK;
+}
+
+void FixedPage::init(PageNum pageNum) {
+    std::memset(data_, 0, BLOCK_SIZE);
+    BitmapPageHeader *h = header();
+    h->pageNum = pageNum;
+    h->capacity = fixed_.capacity;
+    h->liveCount = 0;
+}
+
+int FixedPage::rowLength(int slot) const {
+    if (row_.varCount == 0) {
+        return row_.varDataOffset;
+    }
+    int32_t end;
+    std::memcpy(&end, row(slot) + row_.varTableOffset + (row_.varCount - 1) * 4, sizeof(end));
+    return end;
+}
+
+void FixedPage::writeRow(int slot, const char *rowData, int rowLen) {
+    char *dst = data_ + fixed_.rowOffset + slot * fixed_.width;
+    std::memcpy(dst, rowData, rowLen);
+    std::memset(dst + rowLen, 0, fixed_.width - rowLen);
+    bitmapSet(data_ + fixed_.bitmapOffset, slot);
+    header()->liveCount++;
+}
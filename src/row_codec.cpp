@@ -0,0 +1,265 @@
+#include "../include/row_codec.h"
+#include <cstring>
+#include <sstream>
+#include <algorithm>
+#include <cctype>
+
+RC RowLayout::init(int count, const AttrInfo *attrs) {
+    if (count <= 0 || count > MAX_ATTRS_PER_TABLE || attrs == nullptr) {
+        return RC_INVALID_ARG;
+    }
+
+    attrCount = count;
+    nullBitmapLen = (count + 7) / 8;
+    varCount = 0;
+
+    // 定长列紧跟空值位图
+    int offset = nullBitmapLen;
+    for (int i = 0; i < count; ++i) {
+        types[i] = attrs[i].type;
+        lengths[i] = attrs[i].length;
+        if (attrs[i].type == STRING) {
+            fixedOffset[i] = -1;
+            varIndex[i] = varCount++;
+        } else {
+            fixedOffset[i] = offset;
+            varIndex[i] = -1;
+            offset += 4;
+        }
+    }
+
+    // 变长偏移表与数据区
+    varTableOffset = offset;
+    varDataOffset = offset + varCount * (int)sizeof(int32_t);
+    return RC_OK;
+}
+
+int RowLayout::maxRowLen() const {
+    int len = varDataOffset;
+    for (int i = 0; i < attrCount; ++i) {
+        if (types[i] == STRING) len += lengths[i];
+    }
+    return len;
+}
+
+void RowView::columnRange(int col, int &offset, int &len) const {
+    if (layout_.types[col] != STRING) {
+        offset = layout_.fixedOffset[col];
+        len = 4;
+        return;
+    }
+    int start, end;
+    varBounds(layout_.varIndex[col], start, end);
+    offset = start;
+    len = end - start;
+}
+
+void RowView::getValue(int col, Value &value) const {
+    value.type = layout_.types[col];
+    value.isNull = isNull(col);
+    if (value.isNull) return;
+    switch (value.type) {
+        case INT:
+            value.intVal = getInt(col);
+            break;
+        case FLOAT:
+            value.floatVal = getFloat(col);
+            break;
+        case STRING: {
+            int len = 0;
+            const char *s = getString(col, len);
+            value.strVal.assign(s, len);
+            break;
+        }
+    }
+}
+
+bool RowView::validate() const {
+    if (data_ == nullptr || len_ < layout_.varDataOffset) return false;
+    int prevEnd = layout_.varDataOffset;
+    for (int v = 0; v < layout_.varCount; ++v) {
+        int32_t end;
+        std::memcpy(&end, data_ + layout_.varTableOffset + v * 4, sizeof(int32_t));
+        if (end < prevEnd || end > len_) return false;
+        prevEnd = end;
+    }
+    return prevEnd == len_;
+}
+
+RC encodeRow(const RowLayout &layout, const std::vector<Value> &values, std::string &out) {
+    if ((int)values.size() != layout.attrCount) {
+        return RC_INVALID_ARG;
+    }
+
+    int total = layout.varDataOffset;
+    for (int i = 0; i < layout.attrCount; ++i) {
+        if (layout.types[i] != STRING || values[i].isNull) continue;
+        if ((int)values[i].strVal.size() > layout.lengths[i]) return RC_RECORD_TOO_LONG;
+        total += (int)values[i].strVal.size();
+    }
+    if (total > MAX_TUPLE_LEN) {
+        return RC_RECORD_TOO_LONG;
+    }
+
+    out.assign(total, '\0');
+    char *row = &out[0];
+    int varEnd = layout.varDataOffset;
+    for (int i = 0; i < layout.attrCount; ++i) {
+        const Value &v = values[i];
+        if (v.isNull) {
+            row[i >> 3] |= (char)(1 << (i & 7));
+        }
+        switch (layout.types[i]) {
+            case INT: {
+                int32_t x = v.isNull ? 0 : v.intVal;
+                std::memcpy(row + layout.fixedOffset[i], &x, sizeof(x));
+                break;
+            }
+            case FLOAT: {
+                float f = v.isNull ? 0.0f : v.floatVal;
+                std::memcpy(row + layout.fixedOffset[i], &f, sizeof(f));
+                break;
+            }
+            case STRING: {
+                if (!v.isNull) {
+                    std::memcpy(row + varEnd, v.strVal.data(), v.strVal.size());
+                    varEnd += (int)v.strVal.size();
+                }
+                int32_t end = varEnd;
+                std::memcpy(row + layout.varTableOffset + layout.varIndex[i] * 4, &end, sizeof(end));
+                break;
+            }
+        }
+    }
+    return RC_OK;
+}
+
+RC parseValue(const AttrInfo &attr, const std::string &literal, Value &value) {
+    value = Value();
+    value.type = attr.type;
+    if (literal == "null" || literal == "NULL") {
+        value.isNull = true;
+        return RC_OK;
+    }
+    try {
+        size_t used = 0;
+        switch (attr.type) {
+            case INT:
+                value.intVal = std::stoi(literal, &used);
+                break;
+            case FLOAT:
+                value.floatVal = std::stof(literal, &used);
+                break;
+            case STRING:
+                if ((int)literal.size() > attr.length) return RC_RECORD_TOO_LONG;
+                value.strVal = literal;
+                used = literal.size();
+                break;
+        }
+        if (used != literal.size()) return RC_INVALID_ARG;
+    } catch (...) {
+        return RC_INVALID_ARG;
+    }
+    return RC_OK;
+}
+
+int findAttrIndex(int attrCount, const AttrInfo *attrs, const char *name) {
+    if (name == nullptr) return -1;
+    for (int i = 0; i < attrCount; ++i) {
+        if (strcmp(attrs[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+RC parseColumnRef(int attrCount, const AttrInfo *attrs, const std::string &text, ColumnRef &ref) {
+    // 去掉空白后按 函数名(参数, ...) 拆分
+    std::string t;
+    for (char c : text) {
+        if (!std::isspace((unsigned char)c)) t += c;
+    }
+    ref = ColumnRef();
+    size_t lpar = t.find('(');
+    if (lpar == std::string::npos) {
+        ref.column = findAttrIndex(attrCount, attrs, t.c_str());
+        return ref.column < 0 ? RC_ATTR_NOT_FOUND : RC_OK;
+    }
+    if (t.back() != ')') return RC_INVALID_ARG;
+    std::string func = t.substr(0, lpar);
+    std::transform(func.begin(), func.end(), func.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    std::vector<std::string> args;
+    size_t start = lpar + 1;
+    while (start < t.size()) {
+        size_t comma = t.find(',', start);
+        if (comma == std::string::npos) comma = t.size() - 1;
+        args.push_back(t.substr(start, comma - start));
+        start = comma + 1;
+    }
+    if (args.empty()) return RC_INVALID_ARG;
+    ref.column = findAttrIndex(attrCount, attrs, args[0].c_str());
+    if (ref.column < 0) return RC_ATTR_NOT_FOUND;
+    if (attrs[ref.column].type != STRING) return RC_INVALID_ARG;
+
+    if (func == "lower" && args.size() == 1) {
+        ref.expr = ColumnExpr::LOWER;
+        return RC_OK;
+    }
+    if (func == "substr" && args.size() == 3 && args[1] == "1") {
+        try {
+            size_t used = 0;
+            ref.arg = std::stoi(args[2], &used);
+            if (used != args[2].size()) return RC_INVALID_ARG;
+        } catch (...) {
+            return RC_INVALID_ARG;
+        }
+        if (ref.arg < 1 || ref.arg > attrs[ref.column].length) return RC_INVALID_ARG;
+        ref.expr = ColumnExpr::PREFIX;
+        return RC_OK;
+    }
+    return RC_INVALID_ARG;
+}
+
+std::string columnRefText(const AttrInfo *attrs, const ColumnRef &ref) {
+    std::string name = attrs[ref.column].name;
+    switch (ref.expr) {
+        case ColumnExpr::LOWER: return "lower(" + name + ")";
+        case ColumnExpr::PREFIX: return "substr(" + name + ", 1, " + std::to_string(ref.arg) + ")";
+        default: return name;
+    }
+}
+
+void applyColumnExpr(ColumnExpr expr, int arg, Value &value) {
+    if (value.isNull || value.type != STRING) return;
+    int len = applyColumnExpr(expr, arg, value.strVal.data(), (int)value.strVal.size(), &value.strVal[0]);
+    value.strVal.resize(len);
+}
+
+int applyColumnExpr(ColumnExpr expr, int arg, const char *data, int len, char *out) {
+    if (expr == ColumnExpr::PREFIX) {
+        len = std::min(len, arg);
+    }
+    for (int i = 0; i < len; ++i) {
+        char c = data[i];
+        out[i] = expr == ColumnExpr::LOWER && c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c;
+    }
+    return len;
+}
+
+std::string valueToString(const Value &value) {
+    if (value.isNull) return "null";
+    std::ostringstream out;
+    switch (value.type) {
+        case INT: out << value.intVal; break;
+        case FLOAT: out << value.floatVal; break;
+        case STRING: out << value.strVal; break;
+    }
+    return out.str();
+}
+
+int compareValue(const Value &a, const Value &b) {
+    if (a.type == STRING) {
+        return a.strVal.compare(b.strVal);
+    }
+    double x = a.type == INT ? a.intVal : a.floatVal;
+    double y = b.type == INT ? b.intVal : b.floatVal;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
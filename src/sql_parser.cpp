@@ -45,17 +45,41 @@ ParseResult parseSelectSql(const std::string& sql) {
         if (t->getType()==SQLiteLexer::FROM_) { afterFrom=true; continue; }
         if (afterFrom && t->getType()==SQLiteLexer::IDENTIFIER){ sel.table = t->getText(); break; }
     }
-    bool inWhere=false; std::string col; std::string lit; for (size_t i=0;i<tokens.getTokens().size();++i){ auto t=tokens.getTokens()[i];
+    // WHERE <column> <op> <literal> [AND ...], op: = == < <= > >=
+    auto compareOp = [](size_t type) -> const char* {
+        switch (type) {
+            case SQLiteLexer::ASSIGN: case SQLiteLexer::EQ: return "=";
+            case SQLiteLexer::LT: return "<";
+            case SQLiteLexer::LT_EQ: return "<=";
+            case SQLiteLexer::GT: return ">";
+            case SQLiteLexer::GT_EQ: return ">=";
+            default: return nullptr;
+        }
+    };
+    // The column may be wrapped in a function (lower(col), substr(col, 1, n)); it is kept as text
+    // "func(arg, ...)" and resolved against the table later
+    bool inWhere=false; std::string col; std::string op; for (size_t i=0;i<tokens.getTokens().size();++i){ auto t=tokens.getTokens()[i];
         if (t->getType()==SQLiteLexer::WHERE_) { inWhere=true; continue; }
-        if (inWhere && t->getType()==SQLiteLexer::IDENTIFIER) { col=t->getText(); }
-        if (inWhere && t->getType()==SQLiteLexer::ASSIGN) {
-            for (size_t j=i+1; j<tokens.getTokens().size(); ++j){ auto tt=tokens.getTokens()[j];
-                if (tt->getType()==SQLiteLexer::NUMERIC_LITERAL || tt->getType()==SQLiteLexer::STRING_LITERAL) { lit = stripQuotes(tt->getText()); break; }
+        if (!inWhere) continue;
+        if (t->getType()==SQLiteLexer::IDENTIFIER && op.empty()) {
+            col=t->getText();
+            const auto& all = tokens.getTokens();
+            if (i+1 < all.size() && all[i+1]->getType()==SQLiteLexer::OPEN_PAR) {
+                col += "(";
+                size_t j=i+2;
+                for (; j<all.size() && all[j]->getType()!=SQLiteLexer::CLOSE_PAR; ++j) {
+                    col += all[j]->getType()==SQLiteLexer::COMMA ? ", " : all[j]->getText();
+                }
+                col += ")";
+                i=j;
             }
-            break;
+        }
+        else if (compareOp(t->getType()) && !col.empty()) { op = compareOp(t->getType()); }
+        else if (!op.empty() && (t->getType()==SQLiteLexer::NUMERIC_LITERAL || t->getType()==SQLiteLexer::STRING_LITERAL)) {
+            sel.where.push_back(SqlExpr{col, op, stripQuotes(t->getText())});
+            col.clear(); op.clear();
         }
     }
-    if (!col.empty() && !lit.empty()) { sel.where = SqlExpr{col, "=", lit}; }
     if (sel.table.empty()) { res.ok=false; res.error = "缺少表名"; return res; }
     res.select = std::move(sel); return res;
 }
@@ -1,8 +1,189 @@
 #include "../include/sql_physical.h"
 #include <sstream>
+#include <algorithm>
 
 static std::string join(const std::vector<std::string>& v){ std::ostringstream o; for(size_t i=0;i<v.size();++i){ if(i) o<<", "; o<<v[i]; } return o.str(); }
 
+struct PlanCost { double rows; double indexCost; double scanCost; };
+
+// How an index serves the AND-ed conditions: equalities on a prefix of its key columns,
+// then at most one lower and one upper bound on the next key column. A hash index only
+// serves equalities on all of its key columns.
+struct IndexMatch {
+    std::vector<int> eq;          // condition positions, one per leading key column
+    int lower = -1, upper = -1;   // range condition positions on the key column after the equalities
+    bool usable() const { return !eq.empty() || lower >= 0 || upper >= 0; }
+    std::vector<int> used() const {
+        std::vector<int> u = eq;
+        if (lower >= 0) u.push_back(lower);
+        if (upper >= 0) u.push_back(upper);
+        return u;
+    }
+};
+
+// How a condition on "ref op literal" can bound key column key: EXACT when it names the same column
+// or expression, IMPLIED when it is on the plain column and the key holds an expression of it
+// (col = v implies lower(col) = lower(v); a prefix is monotone, so col > v also implies
+// prefix(col) >= prefix(v), and likewise for upper bounds)
+enum class KeyUse { NONE, EXACT, IMPLIED };
+
+static KeyUse keyUse(const ColumnRef& key, const ColumnRef& cond, const std::string& op) {
+    if (cond.column < 0 || cond.column != key.column) return KeyUse::NONE;
+    if (cond.expr == key.expr && cond.arg == key.arg) return KeyUse::EXACT;
+    if (cond.expr != ColumnExpr::NONE) return KeyUse::NONE;
+    if (op == "=" || key.expr == ColumnExpr::PREFIX) return KeyUse::IMPLIED;
+    return KeyUse::NONE;
+}
+
+// Position of a condition implying the partial index predicate "column op value", -1 if none
+static int implyingCondition(const TableInfo& ti, const std::vector<SqlExpr>& preds, const IndexPredicate& ip) {
+    const AttrInfo& attr = ti.attrs[ip.column];
+    Value p;
+    decodeIndexKey(attr.type, ip.key, indexKeyLength(attr.type, attr.length), p);
+    const std::string pop = ip.op;
+    for (size_t i = 0; i < preds.size(); ++i) {
+        const SqlExpr& q = preds[i];
+        Value v;
+        if (q.column != attr.name || parseValue(attr, q.literal, v) != RC_OK || v.isNull) continue;
+        int cmp = compareValue(v, p);
+        const std::string& op = q.op;
+        bool lt = op == "<", le = op == "<=", gt = op == ">", ge = op == ">=", eq = op == "=";
+        bool implied;
+        if (pop == "=") implied = eq && cmp == 0;
+        else if (pop == "!=") implied = (eq && cmp != 0) || (lt && cmp <= 0) || (le && cmp < 0) || (gt && cmp >= 0) || (ge && cmp > 0);
+        else if (pop == "<") implied = (lt && cmp <= 0) || ((le || eq) && cmp < 0);
+        else if (pop == "<=") implied = (lt || le || eq) && cmp <= 0;
+        else if (pop == ">") implied = (gt && cmp >= 0) || ((ge || eq) && cmp > 0);
+        else implied = (gt || ge || eq) && cmp >= 0;
+        if (implied) return (int)i;
+    }
+    return -1;
+}
+
+static IndexMatch matchIndex(const TableInfo& ti, const IndexInfo& ii, const std::vector<SqlExpr>& preds) {
+    // A partial index only holds the rows satisfying its predicates: usable when the query implies them all
+    for (int i = 0; i < ii.predicateCount; ++i) {
+        if (implyingCondition(ti, preds, ii.predicates[i]) < 0) return IndexMatch();
+    }
+    std::vector<ColumnRef> refs(preds.size());
+    for (size_t i = 0; i < preds.size(); ++i) {
+        if (parseColumnRef(ti.attrCount, ti.attrs, preds[i].column, refs[i]) != RC_OK) refs[i].column = -1;
+    }
+    IndexMatch m;
+    for (int k = 0; k < ii.keyColumnCount; ++k) {
+        ColumnRef key = indexKeyRef(ii, k);
+        int eq = -1;
+        m.lower = m.upper = -1;
+        for (size_t i = 0; i < preds.size(); ++i) {
+            const std::string& op = preds[i].op;
+            if (keyUse(key, refs[i], op) == KeyUse::NONE) continue;
+            if (op == "=" && eq < 0) eq = (int)i;
+            else if ((op == ">" || op == ">=") && m.lower < 0) m.lower = (int)i;
+            else if ((op == "<" || op == "<=") && m.upper < 0) m.upper = (int)i;
+        }
+        if (eq < 0) break;
+        m.eq.push_back(eq);
+        m.lower = m.upper = -1;
+    }
+    if (ii.method == IndexMethod::HASH && (int)m.eq.size() < ii.keyColumnCount) return IndexMatch();
+    return m;
+}
+
+// Fraction of rows satisfying "column op value" according to the column statistics
+static double predicateSelectivity(const ColumnStats& cs, const std::string& op, const Value& v) {
+    double nonNull = 1.0 - cs.nullFraction();
+    if (op == "=") return cs.equalSelectivity(v);
+    if (op == "<") return cs.lessSelectivity(v, false);
+    if (op == "<=") return cs.lessSelectivity(v, true);
+    if (op == ">") return std::max(0.0, nonNull - cs.lessSelectivity(v, true));
+    return std::max(0.0, nonNull - cs.lessSelectivity(v, false));
+}
+
+// Selectivity of the conditions on one column (an equality, or a lower and/or upper bound).
+// Uses ANALYZE statistics when present, otherwise DEFAULT_EQ_SELECTIVITY / DEFAULT_RANGE_SELECTIVITY.
+static double columnSelectivity(const TableInfo& ti, const TableStats* stats, const std::vector<SqlExpr>& preds, int first, int second) {
+    const SqlExpr& p = preds[first];
+    double fallback = p.op == "=" ? DEFAULT_EQ_SELECTIVITY : DEFAULT_RANGE_SELECTIVITY;
+    int col = findAttrIndex(ti.attrCount, ti.attrs, p.column.c_str());
+    if (col < 0 || !stats || col >= (int)stats->columns.size()) return fallback;
+    const ColumnStats& cs = stats->columns[col];
+    Value v;
+    if (parseValue(ti.attrs[col], p.literal, v) != RC_OK) return fallback;
+    double sel = predicateSelectivity(cs, p.op, v);
+    if (second >= 0 && parseValue(ti.attrs[col], preds[second].literal, v) == RC_OK) {
+        // lower and upper bound: both fractions overlap on the rows in between
+        sel = std::max(0.0, sel + predicateSelectivity(cs, preds[second].op, v) - (1.0 - cs.nullFraction()));
+    }
+    return sel;
+}
+
+// Estimate matching rows of the conditions an index serves and the cost of both access paths.
+// Conditions on different columns are assumed independent. The index path descends once, reads the
+// matching leaves in order, and unless it is index-only pays a random heap fetch per matching row
+// (unclustered), bounded by the table's page count. A hash index probes a single bucket instead
+// of descending (directory pages are assumed cached).
+static PlanCost estimateIndexCost(DataDict& dict, const TableInfo& ti, const IndexInfo& ii,
+                                  const std::vector<SqlExpr>& preds, const IndexMatch& m, bool indexOnly) {
+    double rows = std::max(ti.recordCount, 0);
+    double pages = ti.firstPage == -1 ? 0 : ti.lastPage - ti.firstPage + 1;
+    const TableStats* stats = nullptr;
+    if (dict.getTableStats(ti.tableId, stats) != RC_OK) stats = nullptr;
+
+    double selectivity = 1.0;
+    for (int e : m.eq) selectivity *= columnSelectivity(ti, stats, preds, e, -1);
+    if (m.lower >= 0 || m.upper >= 0) {
+        selectivity *= columnSelectivity(ti, stats, preds, m.lower >= 0 ? m.lower : m.upper, m.lower >= 0 ? m.upper : -1);
+    }
+    // A partial index holds only the rows of its predicates: the conditions implying them narrow the scan too
+    std::vector<int> used = m.used();
+    for (int i = 0; i < ii.predicateCount; ++i) {
+        int q = implyingCondition(ti, preds, ii.predicates[i]);
+        if (q < 0 || std::find(used.begin(), used.end(), q) != used.end()) continue;
+        used.push_back(q);
+        selectivity *= columnSelectivity(ti, stats, preds, q, -1);
+    }
+    double matches = selectivity * rows;
+    if (ii.unique && (int)m.eq.size() == ii.keyColumnCount) matches = std::min(matches, 1.0);
+
+    double keysPerLeaf = std::max(1.0, (double)BLOCK_SIZE / indexLeafEntryLen(ii));
+    PlanCost c;
+    c.rows = matches;
+    c.scanCost = pages * SEQ_PAGE_COST + rows * CPU_TUPLE_COST;
+    // Full-key equality on a B+tree with an in-memory ART mirror is answered without reading index pages.
+    bool mirrored = ii.method == IndexMethod::BTREE && ii.cached && (int)m.eq.size() == ii.keyColumnCount;
+    int probePages = ii.method == IndexMethod::HASH ? 1 : (mirrored ? 0 : std::max(1, ii.height));
+    double leafPages = mirrored ? 0 : matches / keysPerLeaf;
+    c.indexCost = probePages * RANDOM_PAGE_COST + leafPages * SEQ_PAGE_COST + matches * CPU_TUPLE_COST;
+    if (!indexOnly) c.indexCost += std::min(matches, pages) * RANDOM_PAGE_COST;
+    return c;
+}
+
+static std::string describeConditions(const std::vector<SqlExpr>& preds) {
+    std::ostringstream o;
+    for (size_t i = 0; i < preds.size(); ++i) {
+        if (i) o << " AND ";
+        o << preds[i].column << " " << preds[i].op << " '" << preds[i].literal << "'";
+    }
+    return o.str();
+}
+
+// Comparison semantics of WHERE: NULL matches nothing
+static bool matchesPredicate(const Value& v, const std::string& op, const Value& literal) {
+    if (v.isNull || literal.isNull) return false;
+    int cmp = compareValue(v, literal);
+    if (op == "=") return cmp == 0;
+    if (op == "<") return cmp < 0;
+    if (op == "<=") return cmp <= 0;
+    if (op == ">") return cmp > 0;
+    if (op == ">=") return cmp >= 0;
+    if (op == "!=" || op == "<>") return cmp != 0;
+    return false; // unknown operators are rejected when the conditions are resolved
+}
+
+static bool isCompareOp(const std::string& op) {
+    return op == "=" || op == "<" || op == "<=" || op == ">" || op == ">=" || op == "!=" || op == "<>";
+}
+
 PhysicalPlan buildPhysicalPlan(const LogicalPlan& optPlan, DataDict& dict, IndexManager& idxMgr) {
     PhysicalPlan pp;
     // Expect Project -> (Select) -> Scan
@@ -15,31 +196,84 @@ PhysicalPlan buildPhysicalPlan(const LogicalPlan& optPlan, DataDict& dict, Index
     }
     if (!scan) { pp.steps.push_back({PhysOpType::TableScan, "Invalid plan structure"}); return pp; }
 
-    bool useIndex = false; std::string indexName;
-    if (sel && sel->predicate.has_value()) {
-        // check if there's an index on the predicate column via public APIs
-        TableInfo ti; RC rcT = dict.findTable(scan->table.c_str(), ti);
+    std::vector<SqlExpr> preds;
+    if (sel) preds = sel->predicates;
+    bool useIndex = false; std::string indexName; std::string costNote; IndexMatch best; bool bestIndexOnly = false; bool bestHash = false;
+    bool bestPartial = false;
+    if (!preds.empty()) {
+        // Every index whose leading key column carries a condition is a candidate; keep the cheapest
+        TableRef table; RC rcT = dict.getTable(scan->table.c_str(), table);
         if (rcT == RC_OK) {
-            std::vector<IndexInfo> idxs; RC rcL = dict.listIndexesForTable(ti.tableId, idxs);
-            if (rcL == RC_OK) {
-                for (const auto& ii : idxs) {
-                    if (ii.columnName == sel->predicate->column) { useIndex = true; indexName = ii.indexName; break; }
-                }
+            const TableInfo& ti = table->info;
+            // Columns the query reads: output columns and condition columns
+            std::vector<int> referenced;
+            bool all = proj.columns.size() == 1 && proj.columns[0] == "*";
+            for (int i = 0; i < ti.attrCount && all; ++i) referenced.push_back(i);
+            for (const auto& name : proj.columns) if (!all) referenced.push_back(findAttrIndex(ti.attrCount, ti.attrs, name.c_str()));
+            for (const auto& p : preds) {
+                ColumnRef ref;
+                referenced.push_back(parseColumnRef(ti.attrCount, ti.attrs, p.column, ref) == RC_OK ? ref.column : -1);
+            }
+
+            std::vector<IndexRef> idxs; dict.listIndexRefsForTable(ti.tableId, idxs);
+            double bestCost = 0;
+            for (const auto& ref : idxs) {
+                const IndexInfo& ii = ref->info;
+                IndexMatch m = matchIndex(ti, ii, preds);
+                if (!m.usable()) continue;
+                bool indexOnly = std::all_of(referenced.begin(), referenced.end(), [&](int col) { return col >= 0 && indexCoversColumn(ii, col); });
+                PlanCost c = estimateIndexCost(dict, ti, ii, preds, m, indexOnly);
+                if (!indexName.empty() && c.indexCost >= bestCost) continue;
+                bestCost = c.indexCost;
+                useIndex = c.indexCost < c.scanCost;
+                indexName = ii.indexName; best = m; bestIndexOnly = indexOnly; bestHash = ii.method == IndexMethod::HASH;
+                bestPartial = ii.predicateCount > 0;
+                std::ostringstream note;
+                note.setf(std::ios::fixed); note.precision(1);
+                note << " (est. rows=" << c.rows << ", index cost=" << c.indexCost << ", scan cost=" << c.scanCost << ")";
+                costNote = note.str();
             }
         }
     }
 
+    std::vector<SqlExpr> rest = preds;
     if (useIndex) {
-        pp.steps.push_back({PhysOpType::IndexScan, std::string("IndexScan on ") + scan->table + " using index " + indexName + (sel? (std::string(", key='") + sel->predicate->literal + "'") : "")});
+        std::vector<int> used = best.used();
+        std::vector<SqlExpr> bounds;
+        for (int i : used) bounds.push_back(preds[i]);
+        rest.clear();
+        for (size_t i = 0; i < preds.size(); ++i) if (std::find(used.begin(), used.end(), (int)i) == used.end()) rest.push_back(preds[i]);
+        PhysOp op{PhysOpType::IndexScan, std::string("IndexScan on ") + scan->table + (bestHash ? " using hash index " : " using index ") + indexName + ", key " +
+                  describeConditions(bounds) + (bestPartial ? ", partial" : "") + (bestIndexOnly ? ", index-only" : "") + costNote};
+        op.table = scan->table; op.index = indexName; op.predicates = bounds; op.indexOnly = bestIndexOnly;
+        pp.steps.push_back(op);
     } else {
-        pp.steps.push_back({PhysOpType::TableScan, std::string("TableScan on ") + scan->table});
-        if (sel && sel->predicate.has_value()) {
-            pp.steps.push_back({PhysOpType::Filter, std::string("Filter where ") + sel->predicate->column + " " + sel->predicate->op + " '" + sel->predicate->literal + "'"});
+        // Equality conditions on columns with Bloom filters skip page segments during the scan
+        std::vector<std::string> bloomCols;
+        TableRef table;
+        if (dict.getTable(scan->table.c_str(), table) == RC_OK) {
+            const TableInfo& ti = table->info;
+            for (const auto& p : preds) {
+                int col = findAttrIndex(ti.attrCount, ti.attrs, p.column.c_str());
+                if (p.op == "=" && col >= 0 && (ti.bloomColumns & (1u << col)) &&
+                    std::find(bloomCols.begin(), bloomCols.end(), p.column) == bloomCols.end()) bloomCols.push_back(p.column);
+            }
         }
+        PhysOp op{PhysOpType::TableScan, std::string("TableScan on ") + scan->table +
+                  (bloomCols.empty() ? "" : ", bloom filter on " + join(bloomCols)) + costNote};
+        op.table = scan->table;
+        pp.steps.push_back(op);
+    }
+    if (!rest.empty()) {
+        PhysOp filter{PhysOpType::Filter, std::string("Filter where ") + describeConditions(rest)};
+        filter.predicates = rest;
+        pp.steps.push_back(filter);
     }
 
     // Projection
-    pp.steps.push_back({PhysOpType::Project, std::string("Project columns ") + join(proj.columns)});
+    PhysOp project{PhysOpType::Project, std::string("Project columns ") + join(proj.columns)};
+    project.columns = proj.columns;
+    pp.steps.push_back(project);
     return pp;
 }
 
@@ -48,3 +282,167 @@ std::string printPhysicalPlan(const PhysicalPlan& plan){
     for(size_t i=0;i<plan.steps.size();++i){ out << (i+1) << ". " << plan.steps[i].detail << "\n"; }
     return out.str();
 }
+
+RC executePhysicalPlan(const PhysicalPlan& plan, DataDict& dict, TableManager& tableMgr, IndexManager& idxMgr, const RowSink& sink) {
+    const PhysOp* access = nullptr; const PhysOp* filter = nullptr; const PhysOp* project = nullptr;
+    for (const auto& step : plan.steps) {
+        switch (step.type) {
+            case PhysOpType::TableScan: case PhysOpType::IndexScan: access = &step; break;
+            case PhysOpType::Filter: filter = &step; break;
+            case PhysOpType::Project: project = &step; break;
+        }
+    }
+    if (!access || access->table.empty()) return RC_INVALID_ARG;
+
+    TableRef table; RC rc = dict.getTable(access->table.c_str(), table);
+    if (rc != RC_OK) return rc;
+    const TableInfo& ti = table->info;
+    const RowLayout* layout = nullptr;
+    rc = dict.getRowLayout(ti.tableId, layout);
+    if (rc != RC_OK) return rc;
+
+    // Output columns ("*" or no projection: all columns)
+    std::vector<int> outCols;
+    if (project && !(project->columns.size() == 1 && project->columns[0] == "*")) {
+        for (const auto& name : project->columns) {
+            int col = findAttrIndex(ti.attrCount, ti.attrs, name.c_str());
+            if (col < 0) return RC_ATTR_NOT_FOUND;
+            outCols.push_back(col);
+        }
+    } else {
+        for (int i = 0; i < ti.attrCount; ++i) outCols.push_back(i);
+    }
+
+    // Resolve condition columns (or expressions on them) and literals once; a NULL literal matches nothing.
+    // A string literal longer than the column equals no stored value: "=" matches nothing and "!=" keeps
+    // the whole literal. Every value orders against it as against its cut to the column length, except
+    // that a value equal to the cut sorts below the literal, so a range uses the cut with < and >= turned
+    // into <= and > (index bounds are then taken from the cut as well)
+    struct Condition { ColumnRef ref; std::string op; Value literal; };
+    std::vector<Condition> conds;
+    for (const PhysOp* step : {access, filter}) {
+        if (!step) continue;
+        for (const auto& p : step->predicates) {
+            if (!isCompareOp(p.op)) return RC_INVALID_ARG;
+            Condition c{ColumnRef(), p.op, Value()};
+            rc = parseColumnRef(ti.attrCount, ti.attrs, p.column, c.ref);
+            if (rc != RC_OK) return rc;
+            rc = parseValue(ti.attrs[c.ref.column], p.literal, c.literal);
+            if (rc == RC_RECORD_TOO_LONG) {
+                if (p.op == "=") return RC_OK;
+                c.literal.strVal = p.literal;
+                if (p.op != "!=" && p.op != "<>") {
+                    c.literal.strVal.resize(ti.attrs[c.ref.column].length);
+                    if (c.op == "<") c.op = "<=";
+                    else if (c.op == ">=") c.op = ">";
+                }
+                rc = RC_OK;
+            }
+            if (rc != RC_OK) return rc;
+            if (c.literal.isNull) return RC_OK;
+            conds.push_back(c);
+        }
+    }
+
+    // Conditions are re-checked on every row: index bounds only narrow the range (a NULL in a
+    // non-leading key column is stored as zero bytes and may fall inside it)
+    std::vector<Value> out(outCols.size());
+    auto emit = [&](const RID& rid, auto&& getValue) {
+        Value v;
+        for (const auto& c : conds) {
+            getValue(c.ref.column, v);
+            applyColumnExpr(c.ref.expr, c.ref.arg, v);
+            if (!matchesPredicate(v, c.op, c.literal)) return true;
+        }
+        for (size_t i = 0; i < outCols.size(); ++i) getValue(outCols[i], out[i]);
+        return sink(rid, out);
+    };
+
+    if (access->type == PhysOpType::IndexScan) {
+        if (access->predicates.empty()) return RC_INVALID_ARG;
+        IndexRef index; rc = dict.getIndex(access->index.c_str(), index);
+        if (rc != RC_OK) return rc;
+        const IndexInfo& ii = index->info;
+
+        // Equalities on leading key columns form a common key prefix; a lower/upper bound on the
+        // next key column extends it into the low/high bound. The leaf chain yields RIDs in key order;
+        // for a hash index the prefix is the full key and both bounds are that key. A condition on a
+        // column whose key holds an expression of it bounds the key by the expression of its literal
+        // (non-strictly for a prefix, which also truncates literals longer than the prefix).
+        struct Bound { Value literal; bool inclusive; };
+        auto keyBound = [&](const ColumnRef& key, const Condition& c) {
+            Bound b{c.literal, c.op != ">" && c.op != "<"};
+            if (keyUse(key, c.ref, c.op) == KeyUse::IMPLIED || key.expr == ColumnExpr::PREFIX) {
+                applyColumnExpr(key.expr, key.arg, b.literal);
+                b.inclusive = true;
+            }
+            return b;
+        };
+        KeyBytes prefix; prefix.len = 0;
+        int boundWidth = 0;
+        std::optional<Bound> lower, upper;
+        for (int k = 0; k < ii.keyColumnCount; ++k) {
+            ColumnRef key = indexKeyRef(ii, k);
+            const Condition* eq = nullptr;
+            for (size_t i = 0; i < access->predicates.size(); ++i) {
+                const Condition& c = conds[i];
+                if (keyUse(key, c.ref, c.op) == KeyUse::NONE) continue;
+                if (c.op == "=") { if (!eq) eq = &c; }
+                else if (c.op == ">" || c.op == ">=") { if (!lower) lower = keyBound(key, c); }
+                else if (!upper) upper = keyBound(key, c);
+            }
+            if (!eq) {
+                if (lower || upper) boundWidth = indexKeyPartLength(ti, ii, k);
+                break;
+            }
+            KeyBytes part;
+            encodeValueKey(keyBound(key, *eq).literal, indexKeyPartLength(ti, ii, k), part);
+            std::memcpy(prefix.bytes + prefix.len, part.bytes, part.len);
+            prefix.len += part.len;
+            lower.reset(); upper.reset();
+        }
+        auto extend = [&](const std::optional<Bound>& b, KeyBytes& key) {
+            key = prefix;
+            if (!b) return;
+            KeyBytes part;
+            encodeValueKey(b->literal, boundWidth, part);
+            std::memcpy(key.bytes + key.len, part.bytes, part.len);
+            key.len += part.len;
+        };
+        KeyBytes lowKey, highKey;
+        extend(lower, lowKey);
+        extend(upper, highKey);
+        IndexScan it;
+        rc = idxMgr.openScan(access->index.c_str(), lowKey.len > 0 ? &lowKey : nullptr, !lower || lower->inclusive,
+                             highKey.len > 0 ? &highKey : nullptr, !upper || upper->inclusive, ScanDirection::FORWARD, it, true);
+        if (rc != RC_OK) return rc;
+
+        RID rid;
+        while (it.next(rid)) {
+            bool more;
+            if (access->indexOnly) {
+                more = emit(rid, [&](int col, Value& v) { decodeIndexColumn(ti, ii, it.key(), it.payload(), col, v); });
+            } else {
+                char* data = nullptr; int len = 0;
+                rc = tableMgr.readRecord(ti.tableName, rid, data, len);
+                if (rc != RC_OK) return rc;
+                RowView row(*layout, data, len);
+                more = emit(rid, [&](int col, Value& v) { row.getValue(col, v); });
+                delete[] data;
+            }
+            if (!more) break;
+        }
+        return it.status();
+    }
+
+    // Equality conditions let the scan skip page segments whose Bloom filters rule the value out
+    ColumnEqualities equalities;
+    for (const auto& c : conds) if (c.op == "=" && c.ref.expr == ColumnExpr::NONE) equalities.emplace_back(c.ref.column, c.literal);
+    // Only the output and condition columns are read, so out-of-line data past them is not fetched
+    std::vector<int> scanCols = outCols;
+    for (const auto& c : conds) scanCols.push_back(c.ref.column);
+    return tableMgr.scanTable(ti.tableName, [&](const RID& rid, const char* data, int len) {
+        RowView row(*layout, data, len);
+        return emit(rid, [&](int col, Value& v) { row.getValue(col, v); });
+    }, equalities, &scanCols);
+}
@@ -3,15 +3,15 @@
 
 LogicalPlanResult buildLogicalPlan(const SqlSelect& select) {
     LogicalPlanResult res; res.ok = false;
-    LogicalNode scan{LogicalOpType::Scan, select.table, {}, std::nullopt, {}};
+    LogicalNode scan{LogicalOpType::Scan, select.table, {}, {}, {}};
     LogicalNode root = scan;
     // WHERE becomes Select above Scan
-    if (select.where.has_value()) {
+    if (!select.where.empty()) {
         LogicalNode sel{LogicalOpType::Select, "", {}, select.where, {root}};
         root = sel;
     }
     // Projection on top
-    LogicalNode proj{LogicalOpType::Project, "", select.columns, std::nullopt, {root}};
+    LogicalNode proj{LogicalOpType::Project, "", select.columns, {}, {root}};
     res.plan = LogicalPlan{proj};
     res.ok = true; return res;
 }
@@ -54,8 +54,10 @@ static void printNode(const LogicalNode& n, int depth, std::ostringstream& out){
     if (n.type == LogicalOpType::Scan) {
         out << "(table=" << n.table << ")";
     }
-    if (n.type == LogicalOpType::Select && n.predicate.has_value()) {
-        out << "(pred=" << n.predicate->column << " " << n.predicate->op << " '" << n.predicate->literal << "')";
+    if (n.type == LogicalOpType::Select && !n.predicates.empty()) {
+        out << "(pred=";
+        for(size_t i=0;i<n.predicates.size();++i){ if(i) out << " AND "; out << n.predicates[i].column << " " << n.predicates[i].op << " '" << n.predicates[i].literal << "'"; }
+        out << ")";
     }
     if (n.type == LogicalOpType::Project) {
         out << "(cols=";
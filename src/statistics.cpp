@@ -0,0 +1,339 @@
+#include "../include/statistics.h"
+#include <algorithm>
+#include <cmath>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static inline int countLeadingZeros(uint64_t x) {
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanReverse64(&idx, x);
+    return 63 - (int)idx;
+#else
+    return __builtin_clzll(x);
+#endif
+}
+
+// 64位混合函数（MurmurHash3 fmix64），使低熵输入的各位均匀分布
+static inline uint64_t mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+uint64_t hashValue(const Value &value) {
+    switch (value.type) {
+        case INT:
+            return mix64((uint64_t)(uint32_t)value.intVal);
+        case FLOAT: {
+            float f = value.floatVal == 0.0f ? 0.0f : value.floatVal; // -0与+0视为同一值
+            uint32_t bits;
+            std::memcpy(&bits, &f, sizeof(bits));
+            return mix64((uint64_t)bits | (1ULL << 32));
+        }
+        case STRING: {
+            uint64_t h = 1469598103934665603ULL; // FNV-1a
+            for (unsigned char c : value.strVal) {
+                h ^= c;
+                h *= 1099511628211ULL;
+            }
+            return mix64(h);
+        }
+    }
+    return 0;
+}
+
+double statsSortKey(const Value &value) {
+    switch (value.type) {
+        case INT:
+            return (double)value.intVal;
+        case FLOAT:
+            return (double)value.floatVal;
+        case STRING: {
+            uint64_t key = 0;
+            for (int i = 0; i < 8; ++i) {
+                unsigned char c = i < (int)value.strVal.size() ? (unsigned char)value.strVal[i] : 0;
+                key = (key << 8) | c;
+            }
+            return (double)key;
+        }
+    }
+    return 0.0;
+}
+
+void HyperLogLog::add(uint64_t hash) {
+    // 高HLL_PRECISION位选寄存器，其余位的前导零个数+1为秩
+    int idx = (int)(hash >> (64 - HLL_PRECISION));
+    uint64_t rest = hash << HLL_PRECISION;
+    uint8_t rank = rest == 0 ? (uint8_t)(64 - HLL_PRECISION + 1) : (uint8_t)(countLeadingZeros(rest) + 1);
+    if (rank > registers_[idx]) {
+        registers_[idx] = rank;
+    }
+}
+
+double HyperLogLog::estimate() const {
+    const double m = HLL_REGISTERS;
+    double sum = 0.0;
+    int zeros = 0;
+    for (uint8_t r : registers_) {
+        sum += std::ldexp(1.0, -(int)r);
+        if (r == 0) zeros++;
+    }
+    double alpha = 0.7213 / (1.0 + 1.079 / m);
+    double e = alpha * m * m / sum;
+    if (e <= 2.5 * m && zeros > 0) {
+        e = m * std::log(m / zeros);
+    }
+    return e;
+}
+
+void HyperLogLog::clear() {
+    std::fill(registers_.begin(), registers_.end(), 0);
+}
+
+// 双重散列：第i个位置为 h1 + i * h2（h2取奇数，位数为2的幂时各位置互不相同）
+void BloomFilter::add(uint64_t hash) {
+    uint64_t h2 = (hash >> 32 | hash << 32) | 1;
+    uint64_t mask = bits() - 1;
+    for (int i = 0; i < BLOOM_HASHES; ++i) {
+        uint64_t bit = (hash + i * h2) & mask;
+        words_[bit >> 6] |= 1ULL << (bit & 63);
+    }
+}
+
+bool BloomFilter::mayContain(uint64_t hash) const {
+    uint64_t h2 = (hash >> 32 | hash << 32) | 1;
+    uint64_t mask = bits() - 1;
+    for (int i = 0; i < BLOOM_HASHES; ++i) {
+        uint64_t bit = (hash + i * h2) & mask;
+        if (!(words_[bit >> 6] & (1ULL << (bit & 63)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TableBlooms::TableBlooms(std::vector<int> columns, int rowsPerPage)
+    : columns_(std::move(columns)), bits_(BLOOM_MIN_BITS), segments_(columns_.size()) {
+    // 按页段的行数定位数：表增长时各页段的行数不变，误判率也不变
+    size_t want = (size_t)std::max(rowsPerPage, 1) * BLOOM_SEGMENT_PAGES * BLOOM_BITS_PER_ROW;
+    while (bits_ < want) {
+        bits_ <<= 1;
+    }
+}
+
+bool TableBlooms::covers(int column) const {
+    return std::find(columns_.begin(), columns_.end(), column) != columns_.end();
+}
+
+void TableBlooms::addRow(const RowLayout &layout, PageNum page, const char *data, int len) {
+    if (page < 0) {
+        return;
+    }
+    size_t seg = (size_t)page / BLOOM_SEGMENT_PAGES;
+    RowView row(layout, data, len);
+    Value v;
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        std::vector<BloomFilter> &filters = segments_[i];
+        while (filters.size() <= seg) {
+            filters.emplace_back(bits_);
+        }
+        row.getValue(columns_[i], v);
+        if (!v.isNull) {
+            filters[seg].add(hashValue(v));
+        }
+    }
+}
+
+bool TableBlooms::mayContain(int column, PageNum page, uint64_t hash) const {
+    auto it = std::find(columns_.begin(), columns_.end(), column);
+    if (it == columns_.end()) {
+        return true;
+    }
+    const std::vector<BloomFilter> &filters = segments_[it - columns_.begin()];
+    size_t seg = (size_t)page / BLOOM_SEGMENT_PAGES;
+    return page >= 0 && seg < filters.size() && filters[seg].mayContain(hash);
+}
+
+size_t TableBlooms::memoryBytes() const {
+    size_t n = 0;
+    for (const auto &filters : segments_) {
+        n += filters.size() * bits_ / 8;
+    }
+    return n;
+}
+
+double ColumnStats::nullFraction() const {
+    return rowCount > 0 ? (double)nullCount / (double)rowCount : 0.0;
+}
+
+double ColumnStats::distinct() const {
+    double nonNull = (double)(rowCount - nullCount);
+    if (nonNull <= 0) return 0.0;
+    return std::max(1.0, std::min(nonNull, ndv.estimate() * ndvScale));
+}
+
+double ColumnStats::equalSelectivity(const Value &value) const {
+    if (rowCount <= 0) {
+        return 0.0;
+    }
+    if (value.isNull) {
+        return nullFraction();
+    }
+    if (hasMinMax && (compareValue(value, minValue) < 0 || compareValue(value, maxValue) > 0)) {
+        return 0.0;
+    }
+
+    // 均匀假设：非空行平均分给各不同值
+    double nonNull = 1.0 - nullFraction();
+    double sel = nonNull / std::max(1.0, distinct());
+
+    if (bounds.size() > 1) {
+        double key = statsSortKey(value);
+
+        // 超出ANALYZE时的值域：只可能来自其后插入的行
+        if (key < bounds.front() || key > bounds.back()) {
+            return std::min(sel, (double)addedRows / (double)rowCount);
+        }
+
+        // 高频值：在等深直方图中占据多个桶边界，按其覆盖的桶数估计
+        auto range = std::equal_range(bounds.begin(), bounds.end(), key);
+        int hits = (int)(range.second - range.first);
+        if (hits > 1) {
+            sel = std::max(sel, nonNull * (hits - 1) / (double)(bounds.size() - 1));
+        }
+    }
+    return std::min(sel, 1.0);
+}
+
+double ColumnStats::lessSelectivity(const Value &value, bool inclusive) const {
+    if (rowCount <= 0 || value.isNull) {
+        return 0.0;
+    }
+    double nonNull = 1.0 - nullFraction();
+    if (hasMinMax) {
+        if (compareValue(value, minValue) < 0) return 0.0;
+        if (compareValue(value, maxValue) > 0) return nonNull;
+    }
+    double eq = inclusive ? equalSelectivity(value) : 0.0;
+    if (bounds.size() < 2) {
+        return std::min(nonNull, nonNull * DEFAULT_RANGE_SELECTIVITY + eq);
+    }
+
+    // 等深直方图每桶行数相同：落在第i桶内时，小于value的比例为 (i + 桶内位置) / 桶数
+    double key = statsSortKey(value);
+    double buckets = (double)(bounds.size() - 1);
+    double frac;
+    if (key <= bounds.front()) {
+        frac = 0.0;
+    } else if (key > bounds.back()) {
+        frac = 1.0;
+    } else {
+        size_t i = std::lower_bound(bounds.begin(), bounds.end(), key) - bounds.begin();
+        double lo = bounds[i - 1], hi = bounds[i];
+        double within = hi > lo ? (key - lo) / (hi - lo) : 0.0;
+        frac = ((double)(i - 1) + within) / buckets;
+    }
+    return std::min(nonNull, nonNull * frac + eq);
+}
+
+void ColumnStats::addValue(const Value &value) {
+    rowCount++;
+    addedRows++;
+    if (value.isNull) {
+        nullCount++;
+        return;
+    }
+    ndv.add(hashValue(value));
+    if (!hasMinMax) {
+        minValue = value;
+        maxValue = value;
+        hasMinMax = true;
+        return;
+    }
+    if (compareValue(value, minValue) < 0) minValue = value;
+    if (compareValue(value, maxValue) > 0) maxValue = value;
+}
+
+void ColumnStats::removeValue(const Value &value) {
+    if (rowCount > 0) rowCount--;
+    if (value.isNull && nullCount > 0) nullCount--;
+}
+
+void TableStats::addRow(const RowLayout &layout, const char *data, int len) {
+    RowView row(layout, data, len);
+    Value v;
+    for (int i = 0; i < layout.attrCount && i < (int)columns.size(); ++i) {
+        row.getValue(i, v);
+        columns[i].addValue(v);
+    }
+    modifiedRows++;
+}
+
+void TableStats::removeRow(const RowLayout &layout, const char *data, int len) {
+    RowView row(layout, data, len);
+    for (int i = 0; i < layout.attrCount && i < (int)columns.size(); ++i) {
+        Value v;
+        v.isNull = row.isNull(i);
+        columns[i].removeValue(v);
+    }
+    modifiedRows++;
+}
+
+StatsBuilder::StatsBuilder(const RowLayout &layout) : layout_(layout), columns_(layout.attrCount), keys_(layout.attrCount) {
+    for (int i = 0; i < layout.attrCount; ++i) {
+        columns_[i].type = layout.types[i];
+    }
+}
+
+void StatsBuilder::addRow(const char *data, int len) {
+    RowView row(layout_, data, len);
+    Value v;
+    for (int i = 0; i < layout_.attrCount; ++i) {
+        row.getValue(i, v);
+        columns_[i].addValue(v);
+        if (!v.isNull) keys_[i].push_back(statsSortKey(v));
+    }
+    rows_++;
+}
+
+void StatsBuilder::finish(int64_t totalRows, int sampledPages, TableStats &stats) {
+    int64_t total = std::max(totalRows, rows_);
+    double scale = rows_ > 0 ? (double)total / (double)rows_ : 1.0;
+
+    for (int i = 0; i < layout_.attrCount; ++i) {
+        ColumnStats &col = columns_[i];
+        std::vector<double> &keys = keys_[i];
+
+        // 等深直方图：排序后按等间隔取分位点作为桶边界
+        std::sort(keys.begin(), keys.end());
+        col.bounds.clear();
+        if (!keys.empty()) {
+            size_t n = keys.size();
+            for (int b = 0; b <= STATS_HISTOGRAM_BUCKETS; ++b) {
+                size_t idx = std::min(n - 1, (size_t)((double)b * n / STATS_HISTOGRAM_BUCKETS));
+                col.bounds.push_back(keys[idx]);
+            }
+        }
+
+        // 抽样时：行数与空值数按比例放大；样本中几乎全是不同值时，视为不同值随行数线性增长
+        int64_t sampledNonNull = col.rowCount - col.nullCount;
+        col.rowCount = total;
+        col.nullCount = (int64_t)std::llround(col.nullCount * scale);
+        col.ndvScale = 1.0;
+        col.addedRows = 0;
+        if (scale > 1.0 && sampledNonNull > 0 && col.ndv.estimate() >= 0.9 * sampledNonNull) {
+            col.ndvScale = scale;
+        }
+        std::vector<double>().swap(keys);
+    }
+
+    stats.sampledRows = rows_;
+    stats.sampledPages = sampledPages;
+    stats.modifiedRows = 0;
+    stats.columns = std::move(columns_);
+}
@@ -2,25 +2,48 @@
 #include "../include/index_manager.h"
 #include <cstring>
 #include <iostream>
+#include <algorithm>
+#include <vector>
+#include <memory>
 
 TableManager::TableManager(DataDict &dataDict, DiskManager &diskManager, MemManager &memManager, LogManager &logManager, IndexManager &indexManager)
         : dataDict_(dataDict), memManager_(memManager), diskManager_(diskManager), logManager_(logManager), indexManager_(indexManager) {}
 
-RC TableManager::createTable(TransactionId txId, const char *tableName, int attrCount, const AttrInfo *attrs) {
+RC TableManager::createTable(TransactionId txId, const char *tableName, int attrCount, const AttrInfo *attrs,
+                             PageFormat pageFormat) {
     if (tableName == nullptr || attrCount <= 0 || attrCount > MAX_ATTRS_PER_TABLE || attrs == nullptr) {
         return RC_INVALID_ARG;
     }
 
     // 检查属性是否有效
     for (int i = 0; i < attrCount; i++) {
-        if (attrs[i].type == STRING && (attrs[i].length <= 0 || attrs[i].length > MAX_RECORD_LEN)) {
+        if (attrs[i].type == STRING && (attrs[i].length <= 0 || attrs[i].length > MAX_TUPLE_LEN)) {
             return RC_INVALID_ARG;
         }
     }
 
+    // 检查编码后的最大行长
+    RowLayout layout;
+    if (layout.init(attrCount, attrs) != RC_OK || layout.maxRowLen() > MAX_TUPLE_LEN) {
+        return RC_INVALID_ARG;
+    }
+
+    // PAX页与定长页中字符串按最大长度定长存放，要求每页至少容纳若干行
+    if (pageFormat == PAGE_FORMAT_PAX) {
+        PaxLayout pax;
+        if (pax.init(layout) != RC_OK) {
+            return RC_RECORD_TOO_LONG;
+        }
+    } else if (pageFormat == PAGE_FORMAT_FIXED) {
+        FixedLayout fixed;
+        if (fixed.init(layout) != RC_OK) {
+            return RC_RECORD_TOO_LONG;
+        }
+    }
+
     // 创建表并添加到数据字典
     TableId tableId;
-    RC rc = dataDict_.createTable(txId, tableName, attrCount, attrs, tableId);
+    RC rc = dataDict_.createTable(txId, tableName, attrCount, attrs, tableId, pageFormat);
     if (rc != RC_OK) {
         return rc;
     }
@@ -28,53 +51,238 @@ RC TableManager::createTable(TransactionId txId, const char *tableName, int attr
     return RC_OK;
 }
 
-RC TableManager::dropTable(const char *tableName) {
+RC TableManager::dropTable(TransactionId txId, const char *tableName) {
     if (tableName == nullptr) {
         return RC_INVALID_ARG;
     }
 
     // 获取表信息
-    TableInfo tableInfo;
-    RC rc = dataDict_.findTable(tableName, tableInfo);
+    TableRef table;
+    RC rc = dataDict_.getTable(tableName, table);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    const TableInfo &tableInfo = table->info;
+    std::vector<IndexInfo> indexes;
+    dataDict_.listIndexesForTable(tableInfo.tableId, indexes);
+
+    // 一次遍历丢弃表、溢出文件及索引的所有缓冲帧（脏页无需写回）
+    std::vector<TableId> files = {tableInfo.tableId, toastFileId(tableInfo.tableId)};
+    for (const auto &idx : indexes) {
+        files.push_back(idx.indexId);
+    }
+    rc = memManager_.discardPages(files);
+    if (rc != RC_OK) {
+        return rc;
+    }
+
+    // 从数据字典中删除表及其索引元数据
+    rc = dataDict_.dropTable(txId, tableName);
     if (rc != RC_OK) {
         return rc;
     }
 
-    // 释放表的所有数据块（简化实现）
-    // 实际实现中应该遍历所有页面并释放
+    for (const auto &idx : indexes) {
+        indexManager_.dropCache(idx.indexId);
+    }
 
-    // 从数据字典中删除表
-    return dataDict_.dropTable(0, tableName);
+    // 删除文件，存储立即释放
+    for (TableId file : files) {
+        diskManager_.removeTableFile(file);
+    }
+    return RC_OK;
+}
+
+RC TableManager::truncateTable(TransactionId txId, const char *tableName) {
+    if (tableName == nullptr) {
+        return RC_INVALID_ARG;
+    }
+
+    TableRef table;
+    RC rc = dataDict_.getTable(tableName, table);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    const TableInfo &tableInfo = table->info;
+    std::vector<IndexInfo> indexes;
+    dataDict_.listIndexesForTable(tableInfo.tableId, indexes);
+
+    std::vector<TableId> files = {tableInfo.tableId, toastFileId(tableInfo.tableId)};
+    for (const auto &idx : indexes) {
+        files.push_back(idx.indexId);
+    }
+    rc = memManager_.discardPages(files);
+    if (rc != RC_OK) {
+        return rc;
+    }
+
+    // 表文件与索引文件重建为空文件，溢出文件在下次写入溢出记录时再创建
+    rc = diskManager_.truncateTableFile(tableInfo.tableId);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    diskManager_.removeTableFile(toastFileId(tableInfo.tableId));
+    for (const auto &idx : indexes) {
+        rc = diskManager_.truncateTableFile(idx.indexId);
+        if (rc != RC_OK) {
+            return rc;
+        }
+    }
+
+    rc = dataDict_.truncateTable(txId, tableInfo.tableId);
+    if (rc != RC_OK) {
+        return rc;
+    }
+
+    // 各索引重新分配空的根叶子
+    for (auto &idx : indexes) {
+        rc = indexManager_.resetIndex(idx);
+        if (rc != RC_OK) {
+            return rc;
+        }
+    }
+    return RC_OK;
 }
 
 RC TableManager::insertRecord(TransactionId txId, const char *tableName, const char *data, int length, RID &rid) {
-    if (tableName == nullptr || data == nullptr || length <= 0 || length > MAX_RECORD_LEN) {
+    return insertRecord(txId, tableName, data, length, rid, nullptr);
+}
+
+RC TableManager::insertRecords(TransactionId txId, const char *tableName, const std::vector<std::string> &rows,
+                               std::vector<RID> &rids) {
+    rids.clear();
+    if (tableName == nullptr) {
+        return RC_INVALID_ARG;
+    }
+    TableRef table;
+    RC rc = dataDict_.getTable(tableName, table);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    const TableInfo &tableInfo = table->info;
+
+    // 各行先校验长度与行编码：无效行在写任何数据页之前拒绝整批
+    const RowLayout *layout = nullptr;
+    rc = dataDict_.getRowLayout(tableInfo.tableId, layout);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    for (const std::string &row : rows) {
+        if (row.empty() || row.size() > MAX_TUPLE_LEN || !RowView(*layout, row.data(), (int)row.size()).validate()) {
+            return RC_INVALID_ARG;
+        }
+    }
+
+    // 唯一索引：整批检查（含批内相同键），写任何数据页之前拒绝
+    std::vector<RowChange> batch(rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        batch[i].data = rows[i];
+    }
+    rc = indexManager_.checkUnique(tableInfo, batch);
+    if (rc != RC_OK) {
+        return rc;
+    }
+
+    // 逐行写数据页，索引留到最后按键排序一次维护
+    batch.clear();
+    for (const std::string &row : rows) {
+        RID rid;
+        rc = insertRecord(txId, tableName, row.data(), (int)row.size(), rid, &batch);
+        if (rc != RC_OK) {
+            break;
+        }
+        rids.push_back(rid);
+    }
+    if (rc == RC_OK) {
+        rc = indexManager_.onRecordsInserted(tableInfo, batch);
+        if (rc == RC_OK) {
+            return RC_OK;
+        }
+        // 索引维护失败：先删去已插入的索引项（尽力而为，未插入的项删除失败不影响）
+        indexManager_.onRecordsDeleted(tableInfo, batch);
+    }
+
+    // 中途失败：逆序删去已写入的行（索引项已撤销或尚未插入，不再维护索引），整批不插入
+    std::vector<RowChange> undone;
+    for (auto it = rids.rbegin(); it != rids.rend(); ++it) {
+        deleteRecord(txId, tableName, *it, &undone);
+    }
+    rids.clear();
+    return rc;
+}
+
+RC TableManager::insertRecord(TransactionId txId, const char *tableName, const char *data, int length, RID &rid,
+                              std::vector<RowChange> *deferred) {
+    if (tableName == nullptr || data == nullptr || length <= 0 || length > MAX_TUPLE_LEN) {
         return RC_INVALID_ARG;
     }
 
     // 获取表信息
-    TableInfo tableInfo;
-    RC rc = dataDict_.findTable(tableName, tableInfo);
+    TableRef table;
+    RC rc = dataDict_.getTable(tableName, table);
     if (rc != RC_OK) {
         return rc;
     }
+    const TableInfo &tableInfo = table->info;
+
+    // 校验行编码与表结构一致
+    const RowLayout *layout = nullptr;
+    rc = dataDict_.getRowLayout(tableInfo.tableId, layout);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    if (!RowView(*layout, data, length).validate()) {
+        return RC_INVALID_ARG;
+    }
+
+    // 唯一索引中键已存在时拒绝插入（在写数据页之前检查；批量插入已对整批检查）
+    if (deferred == nullptr) {
+        rc = indexManager_.checkUnique(tableInfo, data, length);
+        if (rc != RC_OK) {
+            return rc;
+        }
+    }
+
+    // 位图页（PAX/定长）表：按行序号定址写入
+    if (tableInfo.pageFormat != PAGE_FORMAT_SLOTTED) {
+        return insertBitmapRecord(txId, tableInfo, *layout, data, length, rid, deferred);
+    }
+
+    // 超长记录：尾部写入溢出链，行内仅保留前缀和溢出指针
+    const char *rowData = data;
+    int rowLen = length;
+    bool isOverflow = length > TOAST_THRESHOLD;
+    char stub[TOAST_INLINE_LEN + sizeof(ToastPointer)];
+    ToastPointer toast{-1, length};
+    if (isOverflow) {
+        rc = writeOverflowChain(tableInfo.tableId, data + TOAST_INLINE_LEN, length - TOAST_INLINE_LEN, toast.firstPage);
+        if (rc != RC_OK) {
+            return rc;
+        }
+        std::memcpy(stub, data, TOAST_INLINE_LEN);
+        std::memcpy(stub + TOAST_INLINE_LEN, &toast, sizeof(ToastPointer));
+        rowData = stub;
+        rowLen = (int)sizeof(stub);
+    }
 
     // 计算记录所需空间（数据 + 槽元信息，若需新槽）
-    int requiredData = length;
+    int requiredData = rowLen;
 
     // 查找适合插入的页面
     PageNum pageNum;
     BufferFrame *frame = nullptr;
     rc = findPageForInsert(tableInfo, requiredData, pageNum, frame);
     if (rc != RC_OK) {
+        if (isOverflow) freeOverflowChain(tableInfo.tableId, toast.firstPage);
         return rc;
     }
 
     // 在页面中查找空闲槽位
     SlotNum slotNum;
-    rc = findFreeSlot(frame->data, length, slotNum);
+    rc = findFreeSlot(frame->data, rowLen, slotNum);
     if (rc != RC_OK) {
         memManager_.releasePage(tableInfo.tableId, pageNum);
+        if (isOverflow) freeOverflowChain(tableInfo.tableId, toast.firstPage);
         return rc;
     }
 
@@ -90,9 +298,10 @@ RC TableManager::insertRecord(TransactionId txId, const char *tableName, const c
         int grow = (int)sizeof(RecordSlot);
 
         // 检查空间是否足够放下新槽位和数据
-        if (BLOCK_SIZE - header->freeOffset < grow + length) {
+        if (BLOCK_SIZE - header->freeOffset < grow + rowLen) {
             // 空间不足，释放页面并返回
             memManager_.releasePage(tableInfo.tableId, pageNum);
+            if (isOverflow) freeOverflowChain(tableInfo.tableId, toast.firstPage);
             return RC_BUFFER_FULL;
         }
 
@@ -100,12 +309,11 @@ RC TableManager::insertRecord(TransactionId txId, const char *tableName, const c
         if (dataBytes > 0) {
             std::memmove(frame->data + oldStartOfData + grow, frame->data + oldStartOfData, dataBytes);
         }
-        // 更新所有已存在槽的offset
+        // 更新所有已存在槽的offset：已删除的槽也要更新，其数据随数据区一起后移，
+        // 删除的溢出记录在vacuum或槽复用时还要从中读取ToastPointer
         for (int i = 0; i < totalSlotsBefore; ++i) {
             RecordSlot *s = reinterpret_cast<RecordSlot *>(frame->data + sizeof(VarPageHeader) + i * sizeof(RecordSlot));
-            if (!s->isDeleted) {
-                s->offset += grow;
-            }
+            s->offset += grow;
         }
         // 扩展freeOffset以包含槽目录增长
         header->freeOffset += grow;
@@ -117,54 +325,127 @@ RC TableManager::insertRecord(TransactionId txId, const char *tableName, const c
 
     // 检查剩余空间是否足够写入记录数据
     int remainingSpace = BLOCK_SIZE - header->freeOffset;
-    if (remainingSpace < length) {
+    if (remainingSpace < rowLen) {
         memManager_.releasePage(tableInfo.tableId, pageNum);
+        if (isOverflow) freeOverflowChain(tableInfo.tableId, toast.firstPage);
         return RC_BUFFER_FULL;
     }
 
+    // 复用的槽位若仍指向旧的溢出链（删除后尚未清理），此时释放
+    if (!isNewSlot && slot->isOverflow) {
+        ToastPointer old;
+        std::memcpy(&old, frame->data + slot->offset + TOAST_INLINE_LEN, sizeof(ToastPointer));
+        freeOverflowChain(tableInfo.tableId, old.firstPage);
+    }
+
     // 写入记录数据
     slot->offset = header->freeOffset;
-    slot->length = length;
+    slot->length = rowLen;
     slot->isDeleted = false;
-    std::memcpy(frame->data + header->freeOffset, data, length);
+    slot->isOverflow = isOverflow;
+    std::memcpy(frame->data + header->freeOffset, rowData, rowLen);
 
-    // 更新页面头与表统计
-    header->freeOffset += length;
+    // 更新页面头与表统计（复用已删除槽位时槽目录总数不变）
+    header->freeOffset += rowLen;
     header->recordCount++;
-    tableInfo.recordCount++;
+    if (!isNewSlot) {
+        header->deletedCount--;
+    }
 
-    // 更新表信息
-    dataDict_.updateTableInfo(tableInfo.tableId, pageNum, tableInfo.recordCount);
+    // 更新表信息（新页已在分配时登记为最后一页，此处只累加记录数，不用可能已过时的句柄快照覆盖）
+    dataDict_.adjustRecordCount(tableInfo.tableId, 1);
 
     // 标记页面为脏页
     memManager_.markDirty(tableInfo.tableId, pageNum);
 
-    // 记录插入日志
-    logManager_.writeInsertLog(txId, LOG_TABLE_ID, RID(pageNum, slotNum), data, length);
+    // 记录插入日志（行内部分一条日志，溢出链按页另行记录，每条日志不超过一个块）
+    if (isOverflow) {
+        logOverflowChain(txId, tableInfo.tableId, toast.firstPage);
+    }
+    logManager_.writeInsertLog(txId, LOG_TABLE_ID, RID(pageNum, slotNum), rowData, rowLen);
 
     // 设置返回的RID
     rid = RID(pageNum, slotNum);
 
-    // 索引维护：插入
-    indexManager_.onRecordInserted(tableInfo, data, length, rid);
+    // 索引与统计维护：插入
+    if (deferred) {
+        deferred->push_back(RowChange{std::string(data, length), rid});
+    } else {
+        rc = indexManager_.onRecordInserted(tableInfo, data, length, rid);
+    }
+    dataDict_.onRowInserted(tableInfo.tableId, rid.pageNum, data, length);
 
     // 释放页面
     memManager_.releasePage(tableInfo.tableId, pageNum);
 
+    // 索引拒绝（如并发插入了相同的唯一键）：撤销该行
+    if (rc != RC_OK) {
+        return undoInsert(txId, tableInfo, data, length, rid, rc);
+    }
     return RC_OK;
 }
 
 RC TableManager::deleteRecord(TransactionId txId, const char *tableName, const RID &rid) {
+    return deleteRecord(txId, tableName, rid, nullptr);
+}
+
+RC TableManager::deleteRecords(TransactionId txId, const char *tableName, const std::vector<RID> &rids, int &deleted) {
+    deleted = 0;
+    if (tableName == nullptr) {
+        return RC_INVALID_ARG;
+    }
+    TableRef table;
+    RC rc = dataDict_.getTable(tableName, table);
+    if (rc != RC_OK) {
+        return rc;
+    }
+
+    // 先确认各行都存在（重复的RID只删除一次），之后的失败只可能来自I/O
+    std::vector<RID> targets(rids);
+    std::sort(targets.begin(), targets.end(), [](const RID &a, const RID &b) {
+        return a.pageNum != b.pageNum ? a.pageNum < b.pageNum : a.slotNum < b.slotNum;
+    });
+    targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+    for (const RID &rid : targets) {
+        char *data = nullptr;
+        int length = 0;
+        rc = readRecord(tableName, rid, data, length);
+        if (rc != RC_OK) {
+            return rc;
+        }
+        delete[] data;
+    }
+
+    // 逐行删除，已删除的各行最后按键排序一次维护索引
+    std::vector<RowChange> batch;
+    batch.reserve(targets.size());
+    for (const RID &rid : targets) {
+        rc = deleteRecord(txId, tableName, rid, &batch);
+        if (rc != RC_OK) {
+            break;
+        }
+    }
+    deleted = (int)batch.size();
+    RC irc = indexManager_.onRecordsDeleted(table->info, batch);
+    return rc != RC_OK ? rc : irc;
+}
+
+RC TableManager::deleteRecord(TransactionId txId, const char *tableName, const RID &rid, std::vector<RowChange> *deferred) {
     if (tableName == nullptr || rid.pageNum < 0 || rid.slotNum < 0) {
         return RC_INVALID_ARG;
     }
 
     // 获取表信息
-    TableInfo tableInfo;
-    RC rc = dataDict_.findTable(tableName, tableInfo);
+    TableRef table;
+    RC rc = dataDict_.getTable(tableName, table);
     if (rc != RC_OK) {
         return rc;
     }
+    const TableInfo &tableInfo = table->info;
+
+    if (tableInfo.pageFormat != PAGE_FORMAT_SLOTTED) {
+        return deleteBitmapRecord(txId, tableInfo, rid, deferred);
+    }
 
     // 获取页面
     BufferFrame *frame = nullptr;
@@ -194,8 +475,28 @@ RC TableManager::deleteRecord(TransactionId txId, const char *tableName, const R
     // 记录删除日志
     logManager_.writeDeleteLog(txId, tableInfo.tableId, rid, data, dataLen);
 
-    // 标记记录为删除
+    // 溢出记录：索引维护需要完整记录；溢出链保留到槽位被清理或复用时再释放，
+    // 删除之前的溢出页镜像写入日志，保证撤销时可以恢复完整行
+    std::vector<char> fullRecord;
+    if (slot->isOverflow) {
+        ToastPointer toast;
+        std::memcpy(&toast, data + TOAST_INLINE_LEN, sizeof(ToastPointer));
+        fullRecord.resize(toast.totalLength);
+        std::memcpy(fullRecord.data(), data, TOAST_INLINE_LEN);
+        rc = readOverflowChain(memManager_, tableInfo.tableId, toast.firstPage, 0,
+                               toast.totalLength - TOAST_INLINE_LEN, fullRecord.data() + TOAST_INLINE_LEN);
+        if (rc != RC_OK) {
+            memManager_.releasePage(tableInfo.tableId, rid.pageNum);
+            return rc;
+        }
+        logOverflowChain(txId, tableInfo.tableId, toast.firstPage);
+        data = fullRecord.data();
+        dataLen = toast.totalLength;
+    }
+
+    // 标记记录为删除（槽目录总数 = recordCount + deletedCount 保持不变）
     slot->isDeleted = true;
+    header->recordCount--;
     header->deletedCount++;
 
     // 将空闲空间添加到空闲列表（优化插入）
@@ -205,9 +506,15 @@ RC TableManager::deleteRecord(TransactionId txId, const char *tableName, const R
 
     // 标记页面为脏页
     memManager_.markDirty(tableInfo.tableId, rid.pageNum);
+    dataDict_.adjustRecordCount(tableInfo.tableId, -1);
 
-    // 索引维护：删除
-    indexManager_.onRecordDeleted(tableInfo, data, dataLen, rid);
+    // 索引与统计维护：删除
+    if (deferred) {
+        deferred->push_back(RowChange{std::string(data, dataLen), rid});
+    } else {
+        indexManager_.onRecordDeleted(tableInfo, data, dataLen, rid);
+    }
+    dataDict_.onRowDeleted(tableInfo.tableId, data, dataLen);
 
     // 释放页面
     memManager_.releasePage(tableInfo.tableId, rid.pageNum);
@@ -217,12 +524,21 @@ RC TableManager::deleteRecord(TransactionId txId, const char *tableName, const R
 
 RC TableManager::updateRecord(TransactionId txId, const char *tableName, const RID &rid, const char *newData,
                               int newLength) {
-    if (tableName == nullptr || newData == nullptr || newLength <= 0 || newLength > MAX_RECORD_LEN) {
+    if (tableName == nullptr || newData == nullptr || newLength <= 0 || newLength > MAX_TUPLE_LEN) {
         return RC_INVALID_ARG;
     }
 
+    // 保留旧记录：新记录违反唯一索引时恢复
+    char *oldData = nullptr;
+    int oldLength = 0;
+    RC rc = readRecord(tableName, rid, oldData, oldLength);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    std::unique_ptr<char[]> oldRow(oldData);
+
     // 先删除旧记录
-    RC rc = deleteRecord(0, tableName, rid);
+    rc = deleteRecord(0, tableName, rid);
     if (rc != RC_OK) {
         return rc;
     }
@@ -230,6 +546,10 @@ RC TableManager::updateRecord(TransactionId txId, const char *tableName, const R
     // 插入新记录（简化实现，实际可能需要更高效的方式）
     RID newRid;
     rc = insertRecord(0, tableName, newData, newLength, newRid);
+    if (rc == RC_DUPLICATE_KEY) {
+        RID restored;
+        insertRecord(0, tableName, oldRow.get(), oldLength, restored);
+    }
     return rc;
 }
 
@@ -239,11 +559,24 @@ RC TableManager::readRecord(const char *tableName, const RID &rid, char *&data,
     }
 
     // 获取表信息
-    TableInfo tableInfo;
-    RC rc = dataDict_.findTable(tableName, tableInfo);
+    TableRef table;
+    RC rc = dataDict_.getTable(tableName, table);
     if (rc != RC_OK) {
         return rc;
     }
+    const TableInfo &tableInfo = table->info;
+
+    if (tableInfo.pageFormat != PAGE_FORMAT_SLOTTED) {
+        std::string row;
+        rc = readBitmapRecord(tableInfo, rid, row);
+        if (rc != RC_OK) {
+            return rc;
+        }
+        length = (int)row.size();
+        data = new char[length];
+        memcpy(data, row.data(), length);
+        return RC_OK;
+    }
 
     // 获取页面
     BufferFrame *frame = nullptr;
@@ -267,13 +600,322 @@ RC TableManager::readRecord(const char *tableName, const RID &rid, char *&data,
         return RC_SLOT_NOT_FOUND;
     }
 
-    length = slot->length;
+    if (!slot->isOverflow) {
+        length = slot->length;
+        data = new char[length];
+        memcpy(data, frame->data + slot->offset, length);
+        memManager_.releasePage(tableInfo.tableId, rid.pageNum);
+        return RC_OK;
+    }
+
+    // 溢出记录：拼接行内前缀与溢出链
+    ToastPointer toast;
+    memcpy(&toast, frame->data + slot->offset + TOAST_INLINE_LEN, sizeof(ToastPointer));
+    length = toast.totalLength;
     data = new char[length];
-    memcpy(data, frame->data + slot->offset, length);
+    memcpy(data, frame->data + slot->offset, TOAST_INLINE_LEN);
+    memManager_.releasePage(tableInfo.tableId, rid.pageNum);
 
-    // 释放页面
+    rc = readOverflowChain(memManager_, tableInfo.tableId, toast.firstPage, 0,
+                           length - TOAST_INLINE_LEN, data + TOAST_INLINE_LEN);
+    if (rc != RC_OK) {
+        delete[] data;
+        data = nullptr;
+        length = 0;
+    }
+    return rc;
+}
+
+RC TableManager::readRecordRange(const char *tableName, const RID &rid, int offset, int len, char *out, int &outLen) {
+    if (tableName == nullptr || out == nullptr || offset < 0 || len < 0 || rid.pageNum < 0 || rid.slotNum < 0) {
+        return RC_INVALID_ARG;
+    }
+
+    TableRef table;
+    RC rc = dataDict_.getTable(tableName, table);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    const TableInfo &tableInfo = table->info;
+
+    // 位图页行宽受限，读取整行后截取区间
+    if (tableInfo.pageFormat != PAGE_FORMAT_SLOTTED) {
+        std::string row;
+        rc = readBitmapRecord(tableInfo, rid, row);
+        if (rc != RC_OK) {
+            return rc;
+        }
+        outLen = std::max(0, std::min(len, (int)row.size() - offset));
+        if (outLen > 0) {
+            memcpy(out, row.data() + offset, outLen);
+        }
+        return RC_OK;
+    }
+
+    BufferFrame *frame = nullptr;
+    rc = memManager_.getPage(tableInfo.tableId, rid.pageNum, frame, DATA_SPACE);
+    if (rc != RC_OK) {
+        return rc;
+    }
+
+    VarPageHeader *header = reinterpret_cast<VarPageHeader *>(frame->data);
+    if (rid.slotNum >= header->recordCount + header->deletedCount) {
+        memManager_.releasePage(tableInfo.tableId, rid.pageNum);
+        return RC_SLOT_NOT_FOUND;
+    }
+    RecordSlot *slot = reinterpret_cast<RecordSlot *>(frame->data + sizeof(VarPageHeader) +
+                                                      rid.slotNum * sizeof(RecordSlot));
+    if (slot->isDeleted) {
+        memManager_.releasePage(tableInfo.tableId, rid.pageNum);
+        return RC_SLOT_NOT_FOUND;
+    }
+
+    const char *rec = frame->data + slot->offset;
+    bool isOverflow = slot->isOverflow;
+    int totalLen = slot->length;
+    int inlineLen = slot->length;
+    ToastPointer toast{-1, 0};
+    if (isOverflow) {
+        memcpy(&toast, rec + TOAST_INLINE_LEN, sizeof(ToastPointer));
+        totalLen = toast.totalLength;
+        inlineLen = TOAST_INLINE_LEN;
+    }
+
+    int end = std::min(offset + len, totalLen);
+    outLen = std::max(0, end - offset);
+
+    // 行内部分
+    int inlineEnd = std::min(end, inlineLen);
+    if (offset < inlineEnd) {
+        memcpy(out, rec + offset, inlineEnd - offset);
+    }
     memManager_.releasePage(tableInfo.tableId, rid.pageNum);
 
+    // 仅当区间超出行内前缀时才读取溢出链
+    if (isOverflow && end > inlineLen) {
+        int from = std::max(offset, inlineLen);
+        return readOverflowChain(memManager_, tableInfo.tableId, toast.firstPage, from - inlineLen,
+                                 end - from, out + (from - offset));
+    }
+    return RC_OK;
+}
+
+RC TableManager::readColumn(const char *tableName, const RID &rid, int column, Value &value) {
+    TableRef table;
+    RC rc = dataDict_.getTable(tableName, table);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    const TableInfo &tableInfo = table->info;
+    const RowLayout *layout = nullptr;
+    rc = dataDict_.getRowLayout(tableInfo.tableId, layout);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    if (column < 0 || column >= layout->attrCount) {
+        return RC_ATTR_NOT_FOUND;
+    }
+
+    // PAX表：直接读取该列的minipage
+    if (tableInfo.pageFormat == PAGE_FORMAT_PAX) {
+        const PaxLayout *pax = nullptr;
+        rc = dataDict_.getPaxLayout(tableInfo.tableId, pax);
+        if (rc != RC_OK) {
+            return rc;
+        }
+        BufferFrame *frame = nullptr;
+        rc = memManager_.getPage(tableInfo.tableId, rid.pageNum, frame, DATA_SPACE);
+        if (rc != RC_OK) {
+            return rc;
+        }
+        PaxPage page(frame->data, *pax, *layout);
+        if (rid.slotNum >= pax->capacity || !page.isLive(rid.slotNum)) {
+            memManager_.releasePage(tableInfo.tableId, rid.pageNum);
+            return RC_SLOT_NOT_FOUND;
+        }
+        page.getValue(rid.slotNum, column, value);
+        memManager_.releasePage(tableInfo.tableId, rid.pageNum);
+        return RC_OK;
+    }
+
+    // 定长表：行位置由槽号直接算出，在页内原地读取该列
+    if (tableInfo.pageFormat == PAGE_FORMAT_FIXED) {
+        const FixedLayout *fixed = nullptr;
+        rc = dataDict_.getFixedLayout(tableInfo.tableId, fixed);
+        if (rc != RC_OK) {
+            return rc;
+        }
+        BufferFrame *frame = nullptr;
+        rc = memManager_.getPage(tableInfo.tableId, rid.pageNum, frame, DATA_SPACE);
+        if (rc != RC_OK) {
+            return rc;
+        }
+        FixedPage page(frame->data, *fixed, *layout);
+        if (rid.slotNum >= fixed->capacity || !page.isLive(rid.slotNum)) {
+            memManager_.releasePage(tableInfo.tableId, rid.pageNum);
+            return RC_SLOT_NOT_FOUND;
+        }
+        RowView(*layout, page.row(rid.slotNum), page.rowLength(rid.slotNum)).getValue(column, value);
+        memManager_.releasePage(tableInfo.tableId, rid.pageNum);
+        return RC_OK;
+    }
+
+    // 行头（空值位图、定长列、偏移表）总在行内前缀中
+    std::vector<char> row(layout->varDataOffset);
+    int got = 0;
+    rc = readRecordRange(tableName, rid, 0, layout->varDataOffset, row.data(), got);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    if (got < layout->varDataOffset) {
+        return RC_INVALID_OP;
+    }
+
+    RowView header(*layout, row.data(), got);
+    value = Value();
+    value.type = layout->types[column];
+    value.isNull = header.isNull(column);
+    if (value.isNull || value.type != STRING) {
+        header.getValue(column, value);
+        return RC_OK;
+    }
+
+    // 变长列：按偏移表读取该列字节
+    int offset = 0, len = 0;
+    header.columnRange(column, offset, len);
+    value.strVal.resize(len);
+    if (len == 0) {
+        return RC_OK;
+    }
+    return readRecordRange(tableName, rid, offset, len, &value.strVal[0], got);
+}
+
+RC TableManager::writeOverflowChain(TableId tableId, const char *data, int length, PageNum &firstPage) {
+    TableId toastId = toastFileId(tableId);
+    RC rc = diskManager_.createTableFile(toastId);
+    if (rc != RC_OK && rc != RC_FILE_EXISTS) {
+        return rc;
+    }
+
+    const int chunkCapacity = BLOCK_SIZE - (int)sizeof(OverflowPageHeader);
+    firstPage = -1;
+    PageNum prevPage = -1;
+    int written = 0;
+    while (written < length) {
+        BlockNum block;
+        rc = diskManager_.allocBlock(toastId, block);
+        if (rc == RC_OK) {
+            BufferFrame *frame = nullptr;
+            rc = memManager_.getPage(toastId, block, frame, DATA_SPACE);
+            if (rc != RC_OK) {
+                // 新分配的块尚未链入溢出链，单独归还
+                diskManager_.freeBlock(toastId, block);
+            } else {
+                auto *oh = reinterpret_cast<OverflowPageHeader *>(frame->data);
+                int chunk = std::min(chunkCapacity, length - written);
+                oh->pageNum = block;
+                oh->nextPage = -1;
+                oh->dataLen = chunk;
+                memcpy(frame->data + sizeof(OverflowPageHeader), data + written, chunk);
+                memManager_.markDirty(toastId, block);
+                memManager_.releasePage(toastId, block);
+                written += chunk;
+            }
+        }
+        if (rc != RC_OK) {
+            if (firstPage != -1) freeOverflowChain(tableId, firstPage);
+            return rc;
+        }
+
+        // 链接前驱页
+        if (prevPage == -1) {
+            firstPage = block;
+        } else {
+            BufferFrame *prev = nullptr;
+            rc = memManager_.getPage(toastId, prevPage, prev, DATA_SPACE);
+            if (rc != RC_OK) {
+                freeOverflowChain(tableId, firstPage);
+                return rc;
+            }
+            reinterpret_cast<OverflowPageHeader *>(prev->data)->nextPage = block;
+            memManager_.markDirty(toastId, prevPage);
+            memManager_.releasePage(toastId, prevPage);
+        }
+        prevPage = block;
+    }
+    return RC_OK;
+}
+
+RC TableManager::readOverflowChain(MemManager &memManager, TableId tableId, PageNum firstPage,
+                                   int offset, int len, char *out) {
+    TableId toastId = toastFileId(tableId);
+    PageNum cur = firstPage;
+    int pageStart = 0;  // 当前页数据在溢出数据中的起始偏移
+    int copied = 0;
+    while (cur != -1 && copied < len) {
+        BufferFrame *frame = nullptr;
+        RC rc = memManager.getPage(toastId, cur, frame, DATA_SPACE);
+        if (rc != RC_OK) {
+            return rc;
+        }
+        auto *oh = reinterpret_cast<OverflowPageHeader *>(frame->data);
+        // 链上的页都存有数据：空页说明链已损坏（如页被误释放后清零），按链不完整返回，避免沿nextPage原地循环
+        if (oh->dataLen <= 0) {
+            memManager.releasePage(toastId, cur);
+            return RC_PAGE_NOT_FOUND;
+        }
+        int pageEnd = pageStart + oh->dataLen;
+        int from = std::max(offset + copied, pageStart);
+        int to = std::min(offset + len, pageEnd);
+        if (from < to) {
+            memcpy(out + (from - offset), frame->data + sizeof(OverflowPageHeader) + (from - pageStart), to - from);
+            copied += to - from;
+        }
+        PageNum next = oh->nextPage;
+        memManager.releasePage(toastId, cur);
+        pageStart = pageEnd;
+        cur = next;
+    }
+    return copied == len ? RC_OK : RC_PAGE_NOT_FOUND;
+}
+
+RC TableManager::freeOverflowChain(TableId tableId, PageNum firstPage) {
+    TableId toastId = toastFileId(tableId);
+    PageNum cur = firstPage;
+    while (cur != -1) {
+        BufferFrame *frame = nullptr;
+        RC rc = memManager_.getPage(toastId, cur, frame, DATA_SPACE);
+        if (rc != RC_OK) {
+            return rc;
+        }
+        PageNum next = reinterpret_cast<OverflowPageHeader *>(frame->data)->nextPage;
+        memManager_.releasePage(toastId, cur);
+        // 先丢弃缓冲池中的帧，避免块被重新分配后旧脏页被写回覆盖新数据
+        rc = memManager_.discardPage(toastId, cur);
+        if (rc != RC_OK) {
+            return rc;
+        }
+        diskManager_.freeBlock(toastId, cur);
+        cur = next;
+    }
+    return RC_OK;
+}
+
+RC TableManager::logOverflowChain(TransactionId txId, TableId tableId, PageNum firstPage) {
+    TableId toastId = toastFileId(tableId);
+    PageNum cur = firstPage;
+    while (cur != -1) {
+        BufferFrame *frame = nullptr;
+        RC rc = memManager_.getPage(toastId, cur, frame, DATA_SPACE);
+        if (rc != RC_OK) {
+            return rc;
+        }
+        auto *oh = reinterpret_cast<OverflowPageHeader *>(frame->data);
+        PageNum next = oh->nextPage;
+        logManager_.writeOverflowLog(txId, toastId, cur, next, frame->data + sizeof(OverflowPageHeader), oh->dataLen);
+        memManager_.releasePage(toastId, cur);
+        cur = next;
+    }
     return RC_OK;
 }
 
@@ -283,19 +925,24 @@ RC TableManager::vacuum(const char *tableName) {
     }
 
     // 获取表信息
-    TableInfo tableInfo;
-    RC rc = dataDict_.findTable(tableName, tableInfo);
+    TableRef table;
+    RC rc = dataDict_.getTable(tableName, table);
     if (rc != RC_OK) {
         return rc;
     }
+    const TableInfo &tableInfo = table->info;
 
     if (tableInfo.firstPage == -1) {
-        return RC_OK;  // 空表无需清理
+        return buildBlooms(tableInfo);  // 空表无需清理
+    }
+
+    // 位图页按行序号定址，删除只清除占用位，无碎片需要整理
+    if (tableInfo.pageFormat != PAGE_FORMAT_SLOTTED) {
+        return buildBlooms(tableInfo);
     }
 
-    // 遍历所有页面执行垃圾回收（简化实现）
-    PageNum currentPage = tableInfo.firstPage;
-    while (currentPage != -1) {
+    // 遍历所有页面执行垃圾回收（假设页面连续）
+    for (PageNum currentPage = tableInfo.firstPage; currentPage <= tableInfo.lastPage; ++currentPage) {
         // 获取页面
         BufferFrame *frame = nullptr;
         rc = memManager_.getPage(tableInfo.tableId, currentPage, frame, DATA_SPACE);
@@ -308,52 +955,534 @@ RC TableManager::vacuum(const char *tableName) {
         // 如果没有删除的记录，跳过此页
         if (header->deletedCount == 0) {
             memManager_.releasePage(tableInfo.tableId, currentPage);
-            currentPage++;  // 简化：假设页面连续
             continue;
         }
 
-        // 整理页面：移动有效记录，更新槽信息
-        int newFreeOffset = sizeof(VarPageHeader) + (header->recordCount) * sizeof(RecordSlot);
-        int validCount = 0;
-
-        // 重新组织记录
-        for (int i = 0; i < header->recordCount + header->deletedCount; i++) {
+        // 整理数据区：槽目录保持不变（RID与索引项仍然有效），有效记录按原偏移顺序前移，
+        // 目标位置总不超过源位置，可以安全地原地移动
+        int totalSlots = header->recordCount + header->deletedCount;
+        std::vector<RecordSlot *> live;
+        header->freeListCount = 0;
+        memset(header->freeList, -1, sizeof(header->freeList));
+        for (int i = 0; i < totalSlots; i++) {
             RecordSlot *slot = reinterpret_cast<RecordSlot *>(frame->data + sizeof(VarPageHeader) +
                                                               i * sizeof(RecordSlot));
-
             if (!slot->isDeleted) {
-                // 移动有效记录到新位置
-                memmove(frame->data + newFreeOffset, frame->data + slot->offset, slot->length);
-
-                // 更新槽信息
-                slot->offset = newFreeOffset;
-                newFreeOffset += slot->length;
-                validCount++;
+                live.push_back(slot);
+                continue;
+            }
+            // 已删除的溢出记录在数据区被覆盖前释放其溢出链
+            if (slot->isOverflow) {
+                ToastPointer toast;
+                std::memcpy(&toast, frame->data + slot->offset + TOAST_INLINE_LEN, sizeof(ToastPointer));
+                freeOverflowChain(tableInfo.tableId, toast.firstPage);
+                slot->isOverflow = false;
+            }
+            if (header->freeListCount < 16) {
+                header->freeList[header->freeListCount++] = i;
             }
         }
-
-        // 更新页面头
+        std::sort(live.begin(), live.end(),
+                  [](const RecordSlot *a, const RecordSlot *b) { return a->offset < b->offset; });
+
+        int newFreeOffset = sizeof(VarPageHeader) + totalSlots * sizeof(RecordSlot);
+        for (RecordSlot *slot : live) {
+            memmove(frame->data + newFreeOffset, frame->data + slot->offset, slot->length);
+            slot->offset = newFreeOffset;
+            newFreeOffset += slot->length;
+        }
         header->freeOffset = newFreeOffset;
-        header->recordCount = validCount;
-        header->deletedCount = 0;
-        header->freeListCount = 0;
-        memset(header->freeList, 0, sizeof(header->freeList));
 
         // 标记页面为脏页
         memManager_.markDirty(tableInfo.tableId, currentPage);
 
         // 释放页面
         memManager_.releasePage(tableInfo.tableId, currentPage);
+    }
+
+    return buildBlooms(tableInfo);
+}
+
+RC TableManager::insertBitmapRecord(TransactionId txId, const TableInfo &tableInfo, const RowLayout &layout,
+                                    const char *data, int length, RID &rid, std::vector<RowChange> *deferred) {
+    const PaxLayout *pax = nullptr;
+    const FixedLayout *fixed = nullptr;
+    RC rc = tableInfo.pageFormat == PAGE_FORMAT_PAX ? dataDict_.getPaxLayout(tableInfo.tableId, pax)
+                                                    : dataDict_.getFixedLayout(tableInfo.tableId, fixed);
+    if (rc != RC_OK) {
+        return rc;
+    }
+
+    PageNum pageNum;
+    BufferFrame *frame = nullptr;
+    rc = findPageForInsert(tableInfo, length, pageNum, frame);
+    if (rc != RC_OK) {
+        return rc;
+    }
+
+    int slot;
+    if (pax != nullptr) {
+        PaxPage page(frame->data, *pax, layout);
+        slot = page.findFreeSlot();
+        if (slot >= 0) page.writeRow(slot, data, length);
+    } else {
+        FixedPage page(frame->data, *fixed, layout);
+        slot = page.findFreeSlot();
+        if (slot >= 0) page.writeRow(slot, data, length);
+    }
+    if (slot < 0) {
+        memManager_.releasePage(tableInfo.tableId, pageNum);
+        return RC_BUFFER_FULL;
+    }
+
+    dataDict_.adjustRecordCount(tableInfo.tableId, 1);
+    memManager_.markDirty(tableInfo.tableId, pageNum);
+
+    rid = RID(pageNum, (SlotNum)slot);
+    logManager_.writeInsertLog(txId, LOG_TABLE_ID, rid, data, length);
+    if (deferred) {
+        deferred->push_back(RowChange{std::string(data, length), rid});
+    } else {
+        rc = indexManager_.onRecordInserted(tableInfo, data, length, rid);
+    }
+    dataDict_.onRowInserted(tableInfo.tableId, rid.pageNum, data, length);
+
+    memManager_.releasePage(tableInfo.tableId, pageNum);
+    if (rc != RC_OK) {
+        return undoInsert(txId, tableInfo, data, length, rid, rc);
+    }
+    return RC_OK;
+}
+
+RC TableManager::undoInsert(TransactionId txId, const TableInfo &tableInfo, const char *data, int length, const RID &rid,
+                            RC cause) {
+    // 先删去已插入的索引项（只匹配该行的RID，不影响其他行），再删除数据行（不再维护索引）
+    indexManager_.onRecordDeleted(tableInfo, data, length, rid);
+    std::vector<RowChange> undone;
+    RC rc = deleteRecord(txId, tableInfo.tableName, rid, &undone);
+    return rc != RC_OK ? rc : cause;
+}
+
+RC TableManager::deleteBitmapRecord(TransactionId txId, const TableInfo &tableInfo, const RID &rid,
+                                    std::vector<RowChange> *deferred) {
+    BufferFrame *frame = nullptr;
+    std::string row;
+    RC rc = pinBitmapRecord(tableInfo, rid, frame, row);
+    if (rc != RC_OK) {
+        return rc;
+    }
+
+    // 日志与索引维护使用完整行
+    logManager_.writeDeleteLog(txId, tableInfo.tableId, rid, row.data(), (int)row.size());
+
+    auto *header = reinterpret_cast<BitmapPageHeader *>(frame->data);
+    const RowLayout *layout = nullptr;
+    dataDict_.getRowLayout(tableInfo.tableId, layout);
+    if (tableInfo.pageFormat == PAGE_FORMAT_PAX) {
+        const PaxLayout *pax = nullptr;
+        dataDict_.getPaxLayout(tableInfo.tableId, pax);
+        PaxPage(frame->data, *pax, *layout).clearLive(rid.slotNum);
+    } else {
+        const FixedLayout *fixed = nullptr;
+        dataDict_.getFixedLayout(tableInfo.tableId, fixed);
+        FixedPage(frame->data, *fixed, *layout).clearLive(rid.slotNum);
+    }
+    header->liveCount--;
+    memManager_.markDirty(tableInfo.tableId, rid.pageNum);
+    dataDict_.adjustRecordCount(tableInfo.tableId, -1);
+
+    if (deferred) {
+        deferred->push_back(RowChange{row, rid});
+    } else {
+        indexManager_.onRecordDeleted(tableInfo, row.data(), (int)row.size(), rid);
+    }
+    dataDict_.onRowDeleted(tableInfo.tableId, row.data(), (int)row.size());
+
+    memManager_.releasePage(tableInfo.tableId, rid.pageNum);
+    return RC_OK;
+}
+
+RC TableManager::readBitmapRecord(const TableInfo &tableInfo, const RID &rid, std::string &row) {
+    BufferFrame *frame = nullptr;
+    RC rc = pinBitmapRecord(tableInfo, rid, frame, row);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    memManager_.releasePage(tableInfo.tableId, rid.pageNum);
+    return RC_OK;
+}
+
+RC TableManager::pinBitmapRecord(const TableInfo &tableInfo, const RID &rid, BufferFrame *&frame, std::string &row) {
+    const RowLayout *layout = nullptr;
+    RC rc = dataDict_.getRowLayout(tableInfo.tableId, layout);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    if (rid.pageNum < tableInfo.firstPage || rid.pageNum > tableInfo.lastPage) {
+        return RC_SLOT_NOT_FOUND;
+    }
+
+    rc = memManager_.getPage(tableInfo.tableId, rid.pageNum, frame, DATA_SPACE);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    auto *header = reinterpret_cast<BitmapPageHeader *>(frame->data);
+    bool live = rid.slotNum < header->capacity;
+    if (tableInfo.pageFormat == PAGE_FORMAT_PAX) {
+        const PaxLayout *pax = nullptr;
+        rc = dataDict_.getPaxLayout(tableInfo.tableId, pax);
+        if (rc == RC_OK) {
+            PaxPage page(frame->data, *pax, *layout);
+            live = live && page.isLive(rid.slotNum);
+            if (live) page.readRow(rid.slotNum, row);
+        }
+    } else {
+        const FixedLayout *fixed = nullptr;
+        rc = dataDict_.getFixedLayout(tableInfo.tableId, fixed);
+        if (rc == RC_OK) {
+            FixedPage page(frame->data, *fixed, *layout);
+            live = live && page.isLive(rid.slotNum);
+            if (live) row.assign(page.row(rid.slotNum), page.rowLength(rid.slotNum));
+        }
+    }
+    if (rc == RC_OK && !live) rc = RC_SLOT_NOT_FOUND;
+    if (rc != RC_OK) {
+        memManager_.releasePage(tableInfo.tableId, rid.pageNum);
+    }
+    return rc;
+}
+
+// 行中给定各列的字节全部落入其中的最短前缀长度（行头总在行内前缀中，只有STRING列的数据可能在其后）
+static int columnsPrefixLen(const RowLayout &layout, const char *row, const std::vector<int> &columns) {
+    RowView view(layout, row, layout.varDataOffset);
+    int need = layout.varDataOffset;
+    for (int col : columns) {
+        if (layout.types[col] != STRING) continue;
+        int offset = 0, len = 0;
+        view.columnRange(col, offset, len);
+        need = std::max(need, offset + len);
+    }
+    return need;
+}
+
+RC TableManager::scanRecords(MemManager &memManager, DataDict &dataDict, const TableInfo &tableInfo,
+                             const RecordVisitor &visitor, int pageStride, const PageFilter &pageFilter,
+                             const std::vector<int> *columns) {
+    if (tableInfo.firstPage == -1) {
+        return RC_OK;
+    }
 
-        currentPage++;  // 简化：假设页面连续
+    const RowLayout *layout = nullptr;
+    const PaxLayout *pax = nullptr;
+    const FixedLayout *fixed = nullptr;
+    {
+        RC rc = dataDict.getRowLayout(tableInfo.tableId, layout);
+        if (rc == RC_OK && tableInfo.pageFormat != PAGE_FORMAT_SLOTTED) {
+            rc = tableInfo.pageFormat == PAGE_FORMAT_PAX ? dataDict.getPaxLayout(tableInfo.tableId, pax)
+                                                         : dataDict.getFixedLayout(tableInfo.tableId, fixed);
+        }
+        if (rc != RC_OK) {
+            return rc;
+        }
     }
 
-    // 更新表的记录计数
-    dataDict_.updateTableInfo(tableInfo.tableId, tableInfo.lastPage, tableInfo.recordCount - tableInfo.deletedCount);
+    std::string row;
+    std::vector<char> full;
+    int stride = std::max(1, pageStride);
+    for (PageNum p = tableInfo.firstPage; p <= tableInfo.lastPage; p += stride) {
+        if (pageFilter && !pageFilter(p)) {
+            continue;
+        }
+        BufferFrame *frame = nullptr;
+        RC rc = memManager.getPage(tableInfo.tableId, p, frame, DATA_SPACE);
+        if (rc != RC_OK) {
+            return rc;
+        }
 
+        bool more = true;
+        if (tableInfo.pageFormat == PAGE_FORMAT_PAX) {
+            PaxPage page(frame->data, *pax, *layout);
+            for (int s = 0; s < pax->capacity && more; ++s) {
+                if (!page.isLive(s)) continue;
+                page.readRow(s, row);
+                more = visitor(RID(p, (SlotNum)s), row.data(), (int)row.size());
+            }
+        } else if (tableInfo.pageFormat == PAGE_FORMAT_FIXED) {
+            // 定长页：行在页内原地访问，无需拷贝
+            FixedPage page(frame->data, *fixed, *layout);
+            for (int s = 0; s < fixed->capacity && more; ++s) {
+                if (!page.isLive(s)) continue;
+                more = visitor(RID(p, (SlotNum)s), page.row(s), page.rowLength(s));
+            }
+        } else {
+            VarPageHeader *header = reinterpret_cast<VarPageHeader *>(frame->data);
+            int totalSlots = header->recordCount + header->deletedCount;
+            for (int s = 0; s < totalSlots && more; ++s) {
+                RecordSlot *slot = reinterpret_cast<RecordSlot *>(frame->data + sizeof(VarPageHeader) +
+                                                                  s * sizeof(RecordSlot));
+                if (slot->isDeleted) continue;
+                const char *rec = frame->data + slot->offset;
+                int len = slot->length;
+                if (slot->isOverflow) {
+                    // 溢出记录：拼接行内前缀与溢出链，只需部分列时读到其中最靠后的字节为止
+                    ToastPointer toast;
+                    memcpy(&toast, rec + TOAST_INLINE_LEN, sizeof(ToastPointer));
+                    len = toast.totalLength;
+                    if (columns) {
+                        len = std::min(len, columnsPrefixLen(*layout, rec, *columns));
+                    }
+                    if (len > TOAST_INLINE_LEN) {
+                        full.resize(len);
+                        memcpy(full.data(), rec, TOAST_INLINE_LEN);
+                        rc = readOverflowChain(memManager, tableInfo.tableId, toast.firstPage, 0,
+                                               len - TOAST_INLINE_LEN, full.data() + TOAST_INLINE_LEN);
+                        if (rc != RC_OK) {
+                            memManager.releasePage(tableInfo.tableId, p);
+                            return rc;
+                        }
+                        rec = full.data();
+                    }
+                }
+                more = visitor(RID(p, (SlotNum)s), rec, len);
+            }
+        }
+        memManager.releasePage(tableInfo.tableId, p);
+        if (!more) break;
+    }
     return RC_OK;
 }
 
+RC TableManager::scanTable(const char *tableName, const RecordVisitor &visitor) {
+    TableRef table;
+    RC rc = dataDict_.getTable(tableName, table);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    return scanRecords(memManager_, dataDict_, table->info, visitor);
+}
+
+RC TableManager::scanTable(const char *tableName, const RecordVisitor &visitor, const ColumnEqualities &equalities,
+                           const std::vector<int> *columns) {
+    TableRef table;
+    RC rc = dataDict_.getTable(tableName, table);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    return scanRecords(memManager_, dataDict_, table->info, visitor, 1, bloomPageFilter(table->info, equalities),
+                       columns);
+}
+
+RC TableManager::analyzeTable(const char *tableName) {
+    TableRef table;
+    RC rc = dataDict_.getTable(tableName, table);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    const TableInfo &tableInfo = table->info;
+
+    const RowLayout *layout = nullptr;
+    rc = dataDict_.getRowLayout(tableInfo.tableId, layout);
+    if (rc != RC_OK) {
+        return rc;
+    }
+
+    // 页数超过抽样上限时按等间隔抽页，每个抽中页的所有行进入样本
+    int pages = tableInfo.firstPage == -1 ? 0 : tableInfo.lastPage - tableInfo.firstPage + 1;
+    int stride = std::max(1, (pages + ANALYZE_SAMPLE_PAGES - 1) / ANALYZE_SAMPLE_PAGES);
+    StatsBuilder builder(*layout);
+    rc = scanRecords(memManager_, dataDict_, tableInfo, [&](const RID &, const char *rec, int len) {
+        builder.addRow(rec, len);
+        return true;
+    }, stride);
+    if (rc != RC_OK) {
+        return rc;
+    }
+
+    TableStats stats;
+    builder.finish(tableInfo.recordCount, (pages + stride - 1) / stride, stats);
+    return dataDict_.setTableStats(tableInfo.tableId, std::move(stats));
+}
+
+RC TableManager::filterEquals(const char *tableName, int column, const Value &value, std::vector<RID> &rids) {
+    TableRef table;
+    RC rc = dataDict_.getTable(tableName, table);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    const TableInfo &tableInfo = table->info;
+    const RowLayout *layout = nullptr;
+    rc = dataDict_.getRowLayout(tableInfo.tableId, layout);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    if (column < 0 || column >= layout->attrCount) {
+        return RC_ATTR_NOT_FOUND;
+    }
+    if (value.type != layout->types[column]) {
+        return RC_INVALID_ARG;
+    }
+    if (value.isNull || tableInfo.firstPage == -1) {
+        return RC_OK;
+    }
+
+    // 该列有Bloom过滤器时跳过不含比较值的页段
+    PageFilter pageFilter = bloomPageFilter(tableInfo, {{column, value}});
+
+    // PAX表：逐页在该列的连续值数组上匹配，其余列不被读取
+    if (tableInfo.pageFormat == PAGE_FORMAT_PAX) {
+        const PaxLayout *pax = nullptr;
+        rc = dataDict_.getPaxLayout(tableInfo.tableId, pax);
+        if (rc != RC_OK) {
+            return rc;
+        }
+        std::vector<int> slots;
+        for (PageNum p = tableInfo.firstPage; p <= tableInfo.lastPage; ++p) {
+            if (pageFilter && !pageFilter(p)) {
+                continue;
+            }
+            BufferFrame *frame = nullptr;
+            rc = memManager_.getPage(tableInfo.tableId, p, frame, DATA_SPACE);
+            if (rc != RC_OK) {
+                return rc;
+            }
+            slots.clear();
+            PaxPage(frame->data, *pax, *layout).matchEquals(column, value, slots);
+            memManager_.releasePage(tableInfo.tableId, p);
+            for (int s : slots) {
+                rids.emplace_back(p, (SlotNum)s);
+            }
+        }
+        return RC_OK;
+    }
+
+    // 行式表：逐行按列访问（溢出记录只读到该列为止）
+    const std::vector<int> needed{column};
+    return scanRecords(memManager_, dataDict_, tableInfo, [&](const RID &rid, const char *data, int len) {
+        RowView row(*layout, data, len);
+        if (row.isNull(column)) return true;
+        bool match = false;
+        switch (value.type) {
+            case INT: match = row.getInt(column) == value.intVal; break;
+            case FLOAT: match = row.getFloat(column) == value.floatVal; break;
+            case STRING: {
+                int n = 0;
+                const char *s = row.getString(column, n);
+                match = n == (int)value.strVal.size() && memcmp(s, value.strVal.data(), n) == 0;
+                break;
+            }
+        }
+        if (match) rids.push_back(rid);
+        return true;
+    }, 1, pageFilter, &needed);
+}
+
+RC TableManager::setBloomFilter(const char *tableName, const char *column, bool enabled) {
+    if (tableName == nullptr || column == nullptr) {
+        return RC_INVALID_ARG;
+    }
+
+    TableRef table;
+    RC rc = dataDict_.getTable(tableName, table);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    const TableInfo &tableInfo = table->info;
+    int col = findAttrIndex(tableInfo.attrCount, tableInfo.attrs, column);
+    if (col < 0) {
+        return RC_ATTR_NOT_FOUND;
+    }
+
+    uint32_t columns = enabled ? tableInfo.bloomColumns | (1u << col) : tableInfo.bloomColumns & ~(1u << col);
+    if (columns != tableInfo.bloomColumns) {
+        rc = dataDict_.setBloomColumns(tableInfo.tableId, columns);
+        if (rc != RC_OK) {
+            return rc;
+        }
+        // 目录项写时复制，按新的句柄建立过滤器
+        rc = dataDict_.getTable(tableName, table);
+        if (rc != RC_OK) {
+            return rc;
+        }
+    }
+    return buildBlooms(table->info);
+}
+
+RC TableManager::buildBlooms(const TableInfo &tableInfo) {
+    if (tableInfo.bloomColumns == 0) {
+        return RC_OK;
+    }
+    const RowLayout *layout = nullptr;
+    RC rc = dataDict_.getRowLayout(tableInfo.tableId, layout);
+    if (rc != RC_OK) {
+        return rc;
+    }
+
+    std::vector<int> columns;
+    for (int i = 0; i < tableInfo.attrCount; ++i) {
+        if (tableInfo.bloomColumns & (1u << i)) {
+            columns.push_back(i);
+        }
+    }
+
+    // 每页行数：表中有行时取实际平均值，否则按页面格式估计每页可容纳的行数
+    int pages = tableInfo.firstPage == -1 ? 0 : tableInfo.lastPage - tableInfo.firstPage + 1;
+    int rowsPerPage = 0;
+    if (pages > 0 && tableInfo.recordCount > 0) {
+        rowsPerPage = (tableInfo.recordCount + pages - 1) / pages;
+    } else if (tableInfo.pageFormat == PAGE_FORMAT_PAX) {
+        const PaxLayout *pax = nullptr;
+        if (dataDict_.getPaxLayout(tableInfo.tableId, pax) == RC_OK) rowsPerPage = pax->capacity;
+    } else if (tableInfo.pageFormat == PAGE_FORMAT_FIXED) {
+        const FixedLayout *fixed = nullptr;
+        if (dataDict_.getFixedLayout(tableInfo.tableId, fixed) == RC_OK) rowsPerPage = fixed->capacity;
+    } else {
+        rowsPerPage = (BLOCK_SIZE - (int)sizeof(VarPageHeader)) / ((int)sizeof(RecordSlot) + layout->varDataOffset);
+    }
+
+    TableBlooms blooms(columns, rowsPerPage);
+    rc = scanRecords(memManager_, dataDict_, tableInfo, [&](const RID &rid, const char *data, int len) {
+        blooms.addRow(*layout, rid.pageNum, data, len);
+        return true;
+    }, 1, nullptr, &columns);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    return dataDict_.setTableBlooms(tableInfo.tableId, std::move(blooms));
+}
+
+PageFilter TableManager::bloomPageFilter(const TableInfo &tableInfo, const ColumnEqualities &equalities) {
+    std::vector<std::pair<int, uint64_t>> probes;
+    for (const auto &eq : equalities) {
+        int col = eq.first;
+        if (col >= 0 && col < tableInfo.attrCount && (tableInfo.bloomColumns & (1u << col)) && !eq.second.isNull) {
+            probes.emplace_back(col, hashValue(eq.second));
+        }
+    }
+    if (probes.empty()) {
+        return nullptr;
+    }
+
+    const TableBlooms *blooms = nullptr;
+    if (dataDict_.getTableBlooms(tableInfo.tableId, blooms) != RC_OK) {
+        if (buildBlooms(tableInfo) != RC_OK || dataDict_.getTableBlooms(tableInfo.tableId, blooms) != RC_OK) {
+            return nullptr;
+        }
+    }
+
+    // 同一页段的各页结论相同，只在进入新页段时查过滤器
+    PageNum segment = -1;
+    bool keep = true;
+    return [blooms, probes, segment, keep](PageNum page) mutable {
+        if (page / BLOOM_SEGMENT_PAGES != segment) {
+            segment = page / BLOOM_SEGMENT_PAGES;
+            keep = std::all_of(probes.begin(), probes.end(), [&](const std::pair<int, uint64_t> &probe) {
+                return blooms->mayContain(probe.first, page, probe.second);
+            });
+        }
+        return keep;
+    };
+}
+
 void TableManager::initNewPage(char *pageData, PageNum pageNum) {
     VarPageHeader *header = reinterpret_cast<VarPageHeader *>(pageData);
     header->pageNum = pageNum;
@@ -369,18 +1498,30 @@ RC TableManager::findPageForInsert(const TableInfo &tableInfo, int length, PageN
     if (tableInfo.lastPage != -1) {
         RC rc = memManager_.getPage(tableInfo.tableId, tableInfo.lastPage, frame, DATA_SPACE);
         if (rc == RC_OK) {
-            VarPageHeader *header = reinterpret_cast<VarPageHeader *>(frame->data);
-            int remainingSpace = BLOCK_SIZE - header->freeOffset;  // 计算页面剩余可用空间（数据区之后）
-
-            // 若无可复用槽位，则需要额外预留一个RecordSlot空间
-            int extraSlotBytes = (header->freeListCount > 0) ? 0 : (int)sizeof(RecordSlot);
-
-            if (remainingSpace >= length + extraSlotBytes) {
-                pageNum = tableInfo.lastPage;
-                return RC_OK;
+            // 位图页：占用位图未满即可插入
+            if (tableInfo.pageFormat != PAGE_FORMAT_SLOTTED) {
+                BitmapPageHeader *bh = reinterpret_cast<BitmapPageHeader *>(frame->data);
+                if (bh->liveCount < bh->capacity) {
+                    pageNum = tableInfo.lastPage;
+                    return RC_OK;
+                }
+                memManager_.releasePage(tableInfo.tableId, tableInfo.lastPage);
+                frame = nullptr;
+            } else {
+                VarPageHeader *header = reinterpret_cast<VarPageHeader *>(frame->data);
+                int remainingSpace = BLOCK_SIZE - header->freeOffset;  // 计算页面剩余可用空间（数据区之后）
+
+                // 若无可复用槽位，则需要额外预留一个RecordSlot空间
+                int extraSlotBytes = (header->freeListCount > 0) ? 0 : (int)sizeof(RecordSlot);
+
+                if (remainingSpace >= length + extraSlotBytes) {
+                    pageNum = tableInfo.lastPage;
+                    return RC_OK;
+                }
+
+                memManager_.releasePage(tableInfo.tableId, tableInfo.lastPage);
+                frame = nullptr;
             }
-
-            memManager_.releasePage(tableInfo.tableId, tableInfo.lastPage);
         }
     }
 
@@ -401,11 +1542,32 @@ RC TableManager::findPageForInsert(const TableInfo &tableInfo, int length, PageN
     }
 
     // 初始化新页面元数据
-    initNewPage(frame->data, pageNum);
-    frame->isDirty = true;
+    if (tableInfo.pageFormat != PAGE_FORMAT_SLOTTED) {
+        const RowLayout *row = nullptr;
+        const PaxLayout *pax = nullptr;
+        const FixedLayout *fixed = nullptr;
+        rc = dataDict_.getRowLayout(tableInfo.tableId, row);
+        if (rc == RC_OK) {
+            rc = tableInfo.pageFormat == PAGE_FORMAT_PAX ? dataDict_.getPaxLayout(tableInfo.tableId, pax)
+                                                         : dataDict_.getFixedLayout(tableInfo.tableId, fixed);
+        }
+        if (rc != RC_OK) {
+            memManager_.releasePage(tableInfo.tableId, pageNum);
+            diskManager_.freeBlock(tableInfo.tableId, newBlockNum);
+            return rc;
+        }
+        if (pax != nullptr) {
+            PaxPage(frame->data, *pax, *row).init(pageNum);
+        } else {
+            FixedPage(frame->data, *fixed, *row).init(pageNum);
+        }
+    } else {
+        initNewPage(frame->data, pageNum);
+    }
+    memManager_.markDirty(tableInfo.tableId, pageNum);
 
     // 更新表信息
-    dataDict_.updateTableInfo(tableInfo.tableId, pageNum, tableInfo.recordCount);
+    dataDict_.updateTableInfo(tableInfo.tableId, pageNum);
 
     return RC_OK;
 }
@@ -8,10 +8,22 @@
 #include "../include/sql_plan.h"
 #include "../include/sql_physical.h"
 #include "../include/npcbase.h"
+#include "../include/index_node.h"
+#include "../include/external_sort.h"
 #include <iostream>
 #include <unordered_map>
 #include <cstdlib>
 #include <ctime>
+#include <chrono>
+#include <random>
+#include <set>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <fstream>
+#include <tuple>
+#include <cstring>
+#include <cstdint>
 
 Test::Test(TableManager& tableManager, MemManager& memManager,
            DiskManager& diskManager, DataDict& dataDict, IndexManager& indexManager)
@@ -128,10 +140,16 @@ RC Test::runTask3() {
     // Step 2: Insert 1000 records (int 0..999)
     int toInsert = 1000;
     int before = tbl.recordCount;
+    const RowLayout* layout = nullptr;
+    rc = dataDict_.getRowLayout(tbl.tableId, layout);
+    if (rc != RC_OK) { std::cerr << "Failed to get row layout: " << rc << std::endl; return rc; }
+    std::vector<Value> vals(1);
+    std::string row;
     for (int i = 0; i < toInsert; ++i) {
-        int val = i;
+        vals[0].intVal = i;
+        encodeRow(*layout, vals, row);
         RID rid;
-        rc = tableManager_.insertRecord(1, tableName, reinterpret_cast<const char*>(&val), sizeof(int), rid);
+        rc = tableManager_.insertRecord(1, tableName, row.data(), (int)row.size(), rid);
         if (rc != RC_OK) { std::cerr << "Insert failed at #" << i << ": " << rc << std::endl; return rc; }
         if ((i + 1) % 200 == 0) std::cout << "  Inserted " << (i + 1) << " records" << std::endl;
     }
@@ -206,26 +224,16 @@ RC Test::runTask4() {
         std::cout << "[CREATE TABLE] Table '" << createRes.create.table << "' already exists" << std::endl;
     }
 
-    // Helper: pack row according to schema
+    // Helper: encode row according to schema
     auto packRow = [&](const TableInfo& tinfo, const std::vector<std::string>& vals, std::string& out)->bool{
         if ((int)vals.size() != tinfo.attrCount) { std::cerr << "Value count mismatch" << std::endl; return false; }
-        out.clear(); out.reserve(64);
+        const RowLayout* layout = nullptr;
+        if (dataDict_.getRowLayout(tinfo.tableId, layout) != RC_OK) return false;
+        std::vector<Value> values(tinfo.attrCount);
         for (int i=0;i<tinfo.attrCount;i++){
-            const AttrInfo& a = tinfo.attrs[i];
-            const std::string& v = vals[i];
-            if (a.type == INT) {
-                int x=0; try { x = std::stoi(v); } catch(...) { std::cerr << "Invalid INT literal: " << v << std::endl; return false; }
-                out.append(reinterpret_cast<const char*>(&x), sizeof(int));
-            } else if (a.type == FLOAT) {
-                float f=0.0f; try { f = std::stof(v); } catch(...) { std::cerr << "Invalid FLOAT literal: " << v << std::endl; return false; }
-                out.append(reinterpret_cast<const char*>(&f), sizeof(float));
-            } else if (a.type == STRING) {
-                std::string s=v; if ((int)s.size()>a.length) s.resize(a.length);
-                std::string padded = s; padded.resize(a.length, '\0');
-                out.append(padded.data(), a.length);
-            } else { return false; }
+            if (parseValue(tinfo.attrs[i], vals[i], values[i]) != RC_OK) { std::cerr << "Invalid literal: " << vals[i] << std::endl; return false; }
         }
-        return true;
+        return encodeRow(*layout, values, out) == RC_OK;
     };
 
     // INSERT via SQL: insert pairs (num, data) with data being a random 3-digit number
@@ -251,30 +259,12 @@ RC Test::runTask4() {
     // Helpers: decode and scan rows from stored pages
     auto decodeRow = [&](const TableInfo& tinfo, const char* buf, int len, int& numOut, int& dataOut){
         numOut = 0; dataOut = 0;
-        if (tinfo.attrCount >= 2 && len >= 8) {
-            numOut = *reinterpret_cast<const int*>(buf);
-            dataOut = *reinterpret_cast<const int*>(buf + sizeof(int));
-        }
-    };
-    auto scanSelectByNum = [&](const TableInfo& tinfo, int qNum){
-        for (PageNum p = tinfo.firstPage; p <= tinfo.lastPage; ++p){
-            BufferFrame* frame=nullptr; if (memManager_.getPage(tinfo.tableId, p, frame, DATA_SPACE) != RC_OK) continue;
-            auto* header = reinterpret_cast<VarPageHeader*>(frame->data);
-            int totalSlots = header->recordCount + header->deletedCount;
-            for (int s=0; s<totalSlots; ++s){
-                auto* slot = reinterpret_cast<RecordSlot*>(frame->data + sizeof(VarPageHeader) + s*sizeof(RecordSlot));
-                if (slot->isDeleted) continue;
-                int numVal=0, dataVal=0; decodeRow(tinfo, frame->data + slot->offset, slot->length, numVal, dataVal);
-                if (numVal == qNum){
-                    std::cout << "[SELECT Result] num=" << qNum << " -> data=" << dataVal
-                              << " (RID " << p << ":" << s << ")" << std::endl;
-                    memManager_.releasePage(tinfo.tableId, p);
-                    return;
-                }
-            }
-            memManager_.releasePage(tinfo.tableId, p);
+        const RowLayout* layout = nullptr;
+        if (tinfo.attrCount >= 2 && dataDict_.getRowLayout(tinfo.tableId, layout) == RC_OK) {
+            RowView row(*layout, buf, len);
+            if (!row.isNull(0)) numOut = row.getInt(0);
+            if (!row.isNull(1)) dataOut = row.getInt(1);
         }
-        std::cout << "[SELECT Result] num=" << qNum << " -> not found" << std::endl;
     };
     auto scanSelectAll = [&](const TableInfo& tinfo){
         std::cout << "[SELECT Result] table4 rows:" << std::endl;
@@ -293,23 +283,37 @@ RC Test::runTask4() {
         }
     };
 
-    // SELECT via SQL and print result by scanning pages
+    // SELECT via SQL: point and range predicates, executed through the physical plan
     int queryNum = 5;
-    std::string selectSql = std::string("SELECT data FROM table4 WHERE num = ") + std::to_string(queryNum);
-    std::cout << "[SQL] " << selectSql << std::endl;
-    auto parseRes = parseSelectSql(selectSql);
-    if (!parseRes.ok) { std::cerr << "Parse failed: " << parseRes.error << std::endl; return RC_INVALID_OP; }
-    auto lp = buildLogicalPlan(parseRes.select);
-    auto opt = optimizeLogicalPlan(lp.plan, dataDict_);
-    auto phys = buildPhysicalPlan(opt.optimized, dataDict_, indexManager_);
-    std::cout << "[Logical Plan]\n" << printLogicalPlan(lp.plan);
-    std::cout << "[Optimized Logical Plan]\n" << printLogicalPlan(opt.optimized);
-    std::cout << "[Physical Plan Steps]\n" << printPhysicalPlan(phys);
-    scanSelectByNum(tbl, queryNum);
+    std::vector<std::string> selectSqls = {
+        std::string("SELECT data FROM table4 WHERE num = ") + std::to_string(queryNum),
+        std::string("SELECT num, data FROM table4 WHERE num >= ") + std::to_string(queryNum + 2),
+    };
+    for (const auto& selectSql : selectSqls) {
+        std::cout << "[SQL] " << selectSql << std::endl;
+        auto parseRes = parseSelectSql(selectSql);
+        if (!parseRes.ok) { std::cerr << "Parse failed: " << parseRes.error << std::endl; return RC_INVALID_OP; }
+        auto lp = buildLogicalPlan(parseRes.select);
+        auto opt = optimizeLogicalPlan(lp.plan, dataDict_);
+        auto phys = buildPhysicalPlan(opt.optimized, dataDict_, indexManager_);
+        std::cout << "[Logical Plan]\n" << printLogicalPlan(lp.plan);
+        std::cout << "[Optimized Logical Plan]\n" << printLogicalPlan(opt.optimized);
+        std::cout << "[Physical Plan Steps]\n" << printPhysicalPlan(phys);
+        int found = 0;
+        rc = executePhysicalPlan(phys, dataDict_, tableManager_, indexManager_, [&](const RID& rid, const std::vector<Value>& values) {
+            std::cout << "[SELECT Result]";
+            for (size_t i = 0; i < values.size(); ++i) std::cout << " " << parseRes.select.columns[i] << "=" << valueToString(values[i]);
+            std::cout << " (RID " << rid.pageNum << ":" << rid.slotNum << ")" << std::endl;
+            found++;
+            return true;
+        });
+        if (rc != RC_OK) { std::cerr << "Execute failed: " << rc << std::endl; return rc; }
+        if (found == 0) std::cout << "[SELECT Result] not found" << std::endl;
+    }
 
     std::string selectAllSql = "SELECT * FROM table4";
     std::cout << "[SQL] " << selectAllSql << std::endl;
-    parseRes = parseSelectSql(selectAllSql);
+    auto parseRes = parseSelectSql(selectAllSql);
     auto lp2 = buildLogicalPlan(parseRes.select);
     auto opt2 = optimizeLogicalPlan(lp2.plan, dataDict_);
     auto phys2 = buildPhysicalPlan(opt2.optimized, dataDict_, indexManager_);
@@ -322,6 +326,763 @@ RC Test::runTask4() {
     return RC_OK;
 }
 
+RC Test::runTask5() {
+    std::cout << "\n===== Starting Task 5 Test: node search kernels =====" << std::endl;
+    const int pageCount = 64, lookups = 2000000;
+    const NodeSearchKernel kernels[] = {NodeSearchKernel::SCALAR, NodeSearchKernel::SSE42, NodeSearchKernel::AVX2};
+    const char* kernelNames[] = {"scalar binary search", "SSE4.2", "AVX2"};
+    NodeSearchKernel original = nodeSearchKernel();
+    std::mt19937 rng(5);
+
+    // 两种叶子：单列INT键（页内存4字节）与两列INT组合键（页内存8字节），项尾为RID
+    for (int cols = 1; cols <= 2; ++cols) {
+        int keyLen = 4 * cols;
+        std::vector<std::vector<char>> pages(pageCount, std::vector<char>(BLOCK_SIZE));
+        std::vector<std::vector<char>> probes(pageCount);
+        int entries = 0;
+        for (auto& page : pages) {
+            NodeImage image(keyLen, (int)sizeof(RID));
+            image.header().nodeType = (uint8_t)IndexNodeType::LEAF;
+            // 按无符号字节序排序，与页内键的比较一致
+            auto byteLess = [](const std::vector<char>& x, const std::vector<char>& y) {
+                return std::memcmp(x.data(), y.data(), x.size()) < 0;
+            };
+            std::set<std::vector<char>, decltype(byteLess)> keys(byteLess);
+            while (true) {
+                std::vector<char> key(keyLen);
+                for (int c = 0; c < cols; ++c) {
+                    int v = (int)rng();
+                    encodeIndexKey(INT, reinterpret_cast<const char*>(&v), 4, 4, key.data() + 4 * c);
+                }
+                keys.insert(key);
+                if ((int)sizeof(IndexPageHeader) + (int)keys.size() * (keyLen + (int)sizeof(RID)) > BLOCK_SIZE) {
+                    keys.erase(key);
+                    break;
+                }
+            }
+            RID rid(0, 0);
+            for (const auto& key : keys) image.insert(image.count(), key.data(), reinterpret_cast<const char*>(&rid));
+            image.store(page.data());
+            entries += image.count();
+        }
+        // 一半查页内已有的键，一半查随机键
+        const int probesPerPage = 256;
+        for (int p = 0; p < pageCount; ++p) {
+            NodeFormat fmt(pages[p].data(), keyLen, (int)sizeof(RID));
+            int n = reinterpret_cast<const IndexPageHeader*>(pages[p].data())->keyCount;
+            probes[p].resize((size_t)probesPerPage * keyLen);
+            for (int i = 0; i < probesPerPage; ++i) {
+                char* key = probes[p].data() + (size_t)i * keyLen;
+                if (i % 2 == 0) {
+                    nodeGetKey(pages[p].data(), fmt, (int)(rng() % n), key);
+                } else {
+                    for (int c = 0; c < cols; ++c) {
+                        int v = (int)rng();
+                        encodeIndexKey(INT, reinterpret_cast<const char*>(&v), 4, 4, key + 4 * c);
+                    }
+                }
+            }
+        }
+        std::cout << "[" << keyLen << "-byte keys] " << pageCount << " leaves, " << entries / pageCount
+                  << " entries per leaf" << std::endl;
+
+        std::vector<int> expected;
+        for (int k = 0; k < 3; ++k) {
+            if (!setNodeSearchKernel(kernels[k])) {
+                std::cout << "  " << kernelNames[k] << ": not supported by this CPU" << std::endl;
+                continue;
+            }
+            std::vector<int> results;
+            results.reserve((size_t)pageCount * probesPerPage * 2);
+            long long checksum = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < lookups; ++i) {
+                int p = i % pageCount;
+                const char* page = pages[p].data();
+                NodeFormat fmt(page, keyLen, (int)sizeof(RID));
+                const char* key = probes[p].data() + (size_t)((i / pageCount) % probesPerPage) * keyLen;
+                int lower = nodeLowerBound(page, fmt, key);
+                int upper = nodeUpperBound(page, fmt, key);
+                checksum += lower + upper;
+                if (i < pageCount * probesPerPage) {
+                    results.push_back(lower);
+                    results.push_back(upper);
+                }
+            }
+            auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "  " << kernelNames[k] << ": " << elapsed / lookups / 2 << " ns per search (checksum "
+                      << checksum << ")" << std::endl;
+            if (expected.empty()) {
+                expected = results;
+            } else if (results != expected) {
+                std::cerr << "  " << kernelNames[k] << " disagrees with scalar binary search" << std::endl;
+                setNodeSearchKernel(original);
+                return RC_INVALID_OP;
+            }
+        }
+    }
+    setNodeSearchKernel(original);
+    std::cout << "===== Task 5 Test Completed =====" << std::endl;
+    return RC_OK;
+}
+
+RC Test::runTask6() {
+    std::cout << "\n===== Starting Task 6 Test: concurrent index insert + lookup =====" << std::endl;
+    const int totalKeys = 200000;
+    const int threadCounts[] = {1, 2, 4, 8};
+    double baseline = 0;
+
+    for (int threads : threadCounts) {
+        std::string tableName = "table6_" + std::to_string(threads);
+        std::string indexName = "idx_" + tableName;
+
+        // Step 1: 建表与唯一索引（重复运行时先删除上次的表）
+        TableInfo tbl;
+        if (dataDict_.findTable(tableName.c_str(), tbl) == RC_OK) {
+            tableManager_.dropTable(1, tableName.c_str());
+        }
+        AttrInfo attrs[2] = {{"k", INT, 4}, {"v", INT, 4}};
+        RC rc = tableManager_.createTable(1, tableName.c_str(), 2, attrs);
+        if (rc != RC_OK) {
+            std::cerr << "Failed to create table '" << tableName << "': " << rc << std::endl;
+            return rc;
+        }
+        rc = indexManager_.createIndex(1, indexName.c_str(), tableName.c_str(), "k", true);
+        if (rc != RC_OK) {
+            std::cerr << "Failed to create index '" << indexName << "': " << rc << std::endl;
+            return rc;
+        }
+        dataDict_.findTable(tableName.c_str(), tbl);
+        IndexInfo info;
+        dataDict_.findIndex(indexName.c_str(), info);
+        const RowLayout* layout = nullptr;
+        dataDict_.getRowLayout(tbl.tableId, layout);
+
+        // Step 2: 各线程按键的置换顺序插入第t, t+threads, ...个键（RID由键合成，只并发维护索引），
+        // 每插入一项随即点查本线程已插入的一个键，必须恰好命中一次且RID一致
+        auto keyAt = [&](int i) { return (int)((long long)i * 7919 % totalKeys); };
+        std::atomic<int> failures{0};
+        auto worker = [&](int t) {
+            std::mt19937 rng(t + 1);
+            std::vector<Value> vals(2);
+            std::string row;
+            KeyBytes key;
+            Value probe;
+            for (int i = t; i < totalKeys && failures == 0; i += threads) {
+                int k = keyAt(i);
+                vals[0].intVal = k;
+                vals[1].intVal = -k;
+                encodeRow(*layout, vals, row);
+                RC irc = indexManager_.onRecordInserted(tbl, row.data(), (int)row.size(), RID(k / 1000, (SlotNum)(k % 1000)));
+                if (irc != RC_OK) {
+                    std::cerr << "  insert " << k << " failed: " << irc << std::endl;
+                    failures++;
+                    return;
+                }
+                probe.intVal = keyAt(t + (int)(rng() % ((i - t) / threads + 1)) * threads);
+                encodeValueKey(probe, info.keyLen, key);
+                IndexScan scan;
+                if (indexManager_.openScan(indexName.c_str(), &key, true, &key, true, ScanDirection::FORWARD, scan) != RC_OK) {
+                    failures++;
+                    return;
+                }
+                RID rid;
+                int hits = 0;
+                while (scan.next(rid)) {
+                    if (!(rid == RID(probe.intVal / 1000, (SlotNum)(probe.intVal % 1000)))) break;
+                    hits++;
+                }
+                if (hits != 1 || scan.status() != RC_OK) {
+                    std::cerr << "  lookup " << probe.intVal << " got " << hits << " hits" << std::endl;
+                    failures++;
+                    return;
+                }
+            }
+        };
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back(worker, t);
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (failures != 0) {
+            return RC_INVALID_OP;
+        }
+
+        // Step 3: 全索引扫描，键须恰为0..totalKeys-1且各自对应其RID
+        IndexScan scan;
+        rc = indexManager_.openScan(indexName.c_str(), nullptr, false, nullptr, false, ScanDirection::FORWARD, scan);
+        if (rc != RC_OK) {
+            return rc;
+        }
+        RID rid;
+        int expect = 0;
+        while (scan.next(rid)) {
+            Value k;
+            decodeIndexKey(INT, scan.key(), info.keyLen, k);
+            if (k.intVal != expect || !(rid == RID(expect / 1000, (SlotNum)(expect % 1000)))) {
+                std::cerr << "  entry #" << expect << " has key " << k.intVal << std::endl;
+                return RC_INVALID_OP;
+            }
+            expect++;
+        }
+        if (scan.status() != RC_OK || expect != totalKeys) {
+            std::cerr << "  full scan returned " << expect << " of " << totalKeys << " entries" << std::endl;
+            return RC_INVALID_OP;
+        }
+
+        double throughput = totalKeys / seconds;
+        if (threads == 1) {
+            baseline = throughput;
+        }
+        std::cout << "  " << threads << " thread(s): " << totalKeys << " inserts + lookups in " << seconds << " s, "
+                  << (long long)throughput << " ops/s, speedup " << throughput / baseline << "x" << std::endl;
+        tableManager_.dropTable(1, tableName.c_str());
+    }
+
+    std::cout << "===== Task 6 Test Completed =====" << std::endl;
+    return RC_OK;
+}
+
+RC Test::runTask7() {
+    std::cout << "\n===== Starting Task 7 Test: external sort + bulk index build =====" << std::endl;
+    const size_t sortMem = 16 * 1024;  // 远小于待排序数据，迫使写出多个有序段
+    const int totalRows = 20000;
+    const std::string tempPrefix = diskManager_.getDbName() + "_sort";
+    auto fileExists = [](const std::string& path) { return std::ifstream(path).good(); };
+
+    // Step 1: 直接使用ExternalSorter：乱序记录（含大量重复）须按memcmp顺序完整输出，临时文件在析构时删除
+    {
+        const std::string path = tempPrefix + "_task7.tmp";
+        const int recordLen = 12;
+        std::vector<std::string> expected;
+        int runs = 0;
+        {
+            ExternalSorter sorter(recordLen, sortMem, path);
+            std::mt19937 rng(7);
+            char record[recordLen];
+            for (int i = 0; i < totalRows; ++i) {
+                for (char& c : record) {
+                    c = (char)(rng() % 4);
+                }
+                expected.emplace_back(record, recordLen);
+                RC rc = sorter.add(record);
+                if (rc != RC_OK) {
+                    return rc;
+                }
+            }
+            RC rc = sorter.finish();
+            if (rc != RC_OK) {
+                return rc;
+            }
+            runs = sorter.runCount();
+            if (runs < 2 || !fileExists(path)) {
+                std::cerr << "  expected several runs in " << path << ", got " << runs << std::endl;
+                return RC_INVALID_OP;
+            }
+            std::sort(expected.begin(), expected.end());
+            const char* out;
+            size_t n = 0;
+            while (sorter.next(out)) {
+                if (n >= expected.size() || std::memcmp(out, expected[n].data(), recordLen) != 0) {
+                    std::cerr << "  sorter output #" << n << " out of order" << std::endl;
+                    return RC_INVALID_OP;
+                }
+                n++;
+            }
+            if (sorter.status() != RC_OK || n != expected.size()) {
+                std::cerr << "  sorter returned " << n << " of " << expected.size() << " records" << std::endl;
+                return RC_INVALID_OP;
+            }
+        }
+        if (fileExists(path)) {
+            std::cerr << "  temporary file " << path << " was not removed" << std::endl;
+            return RC_INVALID_OP;
+        }
+        std::cout << "  sorter: " << totalRows << " records spilled to " << runs << " runs, merged in order" << std::endl;
+    }
+
+    // Step 2: 同样的小缓冲区下为已有数据建非唯一索引（每个键4行），批量构建走外部归并
+    std::string tableName = "table7";
+    std::string indexName = "idx_table7";
+    TableInfo tbl;
+    if (dataDict_.findTable(tableName.c_str(), tbl) == RC_OK) {
+        tableManager_.dropTable(1, tableName.c_str());
+    }
+    AttrInfo attrs[2] = {{"k", INT, 4}, {"v", INT, 4}};
+    RC rc = tableManager_.createTable(1, tableName.c_str(), 2, attrs);
+    if (rc != RC_OK) {
+        std::cerr << "Failed to create table '" << tableName << "': " << rc << std::endl;
+        return rc;
+    }
+    dataDict_.findTable(tableName.c_str(), tbl);
+    const RowLayout* layout = nullptr;
+    dataDict_.getRowLayout(tbl.tableId, layout);
+    std::vector<Value> vals(2);
+    std::string row;
+    for (int i = 0; i < totalRows; ++i) {
+        vals[0].intVal = (int)((long long)i * 7919 % (totalRows / 4));
+        vals[1].intVal = i;
+        encodeRow(*layout, vals, row);
+        RID rid;
+        rc = tableManager_.insertRecord(1, tableName.c_str(), row.data(), (int)row.size(), rid);
+        if (rc != RC_OK) {
+            std::cerr << "Insert failed at record " << i << " (error: " << rc << ")" << std::endl;
+            return rc;
+        }
+    }
+    indexManager_.setBuildSortMemory(sortMem);
+    rc = indexManager_.createIndex(1, indexName.c_str(), tableName.c_str(), "k");
+    indexManager_.setBuildSortMemory(INDEX_BUILD_SORT_MEM);
+    if (rc != RC_OK) {
+        std::cerr << "Failed to create index '" << indexName << "': " << rc << std::endl;
+        return rc;
+    }
+    IndexInfo info;
+    dataDict_.findIndex(indexName.c_str(), info);
+    const std::string buildTemp = tempPrefix + std::to_string(info.indexId) + ".tmp";
+    if (fileExists(buildTemp)) {
+        std::cerr << "  temporary file " << buildTemp << " was not removed" << std::endl;
+        return RC_INVALID_OP;
+    }
+
+    // Step 3: 全索引扫描须按(键, RID)顺序恰好给出表扫描中的每一行
+    std::vector<std::tuple<int, PageNum, SlotNum>> fromTable, fromIndex;
+    rc = tableManager_.scanTable(tableName.c_str(), [&](const RID& rid, const char* data, int len) {
+        RowView view(*layout, data, len);
+        fromTable.emplace_back(view.getInt(0), rid.pageNum, rid.slotNum);
+        return true;
+    });
+    if (rc != RC_OK) {
+        return rc;
+    }
+    std::sort(fromTable.begin(), fromTable.end());
+    IndexScan scan;
+    rc = indexManager_.openScan(indexName.c_str(), nullptr, false, nullptr, false, ScanDirection::FORWARD, scan);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    RID rid;
+    while (scan.next(rid)) {
+        Value k;
+        decodeIndexKey(INT, scan.key(), info.keyLen, k);
+        fromIndex.emplace_back(k.intVal, rid.pageNum, rid.slotNum);
+    }
+    if (scan.status() != RC_OK || fromIndex != fromTable) {
+        std::cerr << "  index has " << fromIndex.size() << " entries, table scan " << fromTable.size()
+                  << " rows, or they differ" << std::endl;
+        return RC_INVALID_OP;
+    }
+    std::cout << "  bulk build: " << fromIndex.size() << " entries match the table scan, " << buildTemp
+              << " removed" << std::endl;
+    tableManager_.dropTable(1, tableName.c_str());
+
+    std::cout << "===== Task 7 Test Completed =====" << std::endl;
+    return RC_OK;
+}
+
+RC Test::runTask8() {
+    std::cout << "\n===== Starting Task 8 Test: row codec round trip =====" << std::endl;
+    const int rowsPerCase = 300;
+    const char* formatNames[3] = {"slotted", "pax", "fixed"};
+
+    // 各类型的列交错排列，10列使空值位图跨两个字节；长字符串列在行式页中会移出行外（溢出页）
+    auto makeAttrs = [](PageFormat format, std::vector<AttrInfo>& attrs) {
+        int longLen = format == PAGE_FORMAT_SLOTTED ? 3 * BLOCK_SIZE : 64;
+        attrs = {{"i", INT, 4}, {"s", STRING, 12}, {"f", FLOAT, 4}, {"body", STRING, longLen}, {"j", INT, 4},
+                 {"c", STRING, 1}, {"g", FLOAT, 4}, {"k", INT, 4}, {"t", STRING, 40}, {"m", INT, 4}};
+    };
+    // 第0行全为空值，第1行为各类型的边界值（空串、最大长度串、INT极值、-0.0），其余随机且约1/4为空值
+    auto makeRow = [](const std::vector<AttrInfo>& attrs, int n, std::mt19937& rng, std::vector<Value>& vals) {
+        vals.assign(attrs.size(), Value());
+        for (size_t c = 0; c < attrs.size(); ++c) {
+            Value& v = vals[c];
+            v.type = attrs[c].type;
+            v.isNull = n == 0 || (n > 1 && rng() % 4 == 0);
+            if (v.isNull) {
+                continue;
+            }
+            switch (v.type) {
+                case INT:
+                    v.intVal = n == 1 ? (c % 2 ? INT32_MIN : INT32_MAX) : (int32_t)rng();
+                    break;
+                case FLOAT:
+                    v.floatVal = n == 1 ? (c % 2 ? -0.0f : 3.4e38f) : (float)((int)(rng() % 200001) - 100000) / 7.0f;
+                    break;
+                case STRING: {
+                    int len = n == 1 ? (c % 2 ? attrs[c].length : 0) : (int)(rng() % (attrs[c].length + 1));
+                    v.strVal.resize(len);
+                    for (char& ch : v.strVal) {
+                        ch = (char)('a' + rng() % 26);
+                    }
+                    break;
+                }
+            }
+        }
+    };
+    auto sameValue = [](const Value& a, const Value& b) {
+        if (a.type != b.type || a.isNull != b.isNull) {
+            return false;
+        }
+        if (a.isNull) {
+            return true;
+        }
+        switch (a.type) {
+            case INT:
+                return a.intVal == b.intVal;
+            case FLOAT:
+                return std::memcmp(&a.floatVal, &b.floatVal, sizeof(float)) == 0;
+            case STRING:
+                return a.strVal == b.strVal;
+        }
+        return false;
+    };
+
+    // Step 1: 纯编解码：RowView逐列读出的值、字节区间与编码输入一致，解码值重新编码得到相同的字节
+    {
+        std::vector<AttrInfo> attrs;
+        makeAttrs(PAGE_FORMAT_SLOTTED, attrs);
+        RowLayout layout;
+        RC rc = layout.init((int)attrs.size(), attrs.data());
+        if (rc != RC_OK) {
+            return rc;
+        }
+        std::mt19937 rng(8);
+        std::vector<Value> vals, decoded(attrs.size());
+        std::string row, again;
+        for (int n = 0; n < rowsPerCase; ++n) {
+            makeRow(attrs, n, rng, vals);
+            rc = encodeRow(layout, vals, row);
+            if (rc != RC_OK) {
+                std::cerr << "  encode of row " << n << " failed: " << rc << std::endl;
+                return rc;
+            }
+            RowView view(layout, row.data(), (int)row.size());
+            if (!view.validate()) {
+                std::cerr << "  row " << n << " does not validate" << std::endl;
+                return RC_INVALID_OP;
+            }
+            for (int c = 0; c < layout.attrCount; ++c) {
+                view.getValue(c, decoded[c]);
+                int offset = 0, len = 0;
+                view.columnRange(c, offset, len);
+                int expectLen = attrs[c].type != STRING ? 4 : (vals[c].isNull ? 0 : (int)vals[c].strVal.size());
+                bool rangeOk = len == expectLen && offset >= 0 && offset + len <= (int)row.size();
+                if (rangeOk && attrs[c].type == STRING && len > 0) {
+                    rangeOk = std::memcmp(row.data() + offset, vals[c].strVal.data(), len) == 0;
+                }
+                if (view.isNull(c) != vals[c].isNull || !sameValue(decoded[c], vals[c]) || !rangeOk) {
+                    std::cerr << "  row " << n << " column " << c << " does not round-trip" << std::endl;
+                    return RC_INVALID_OP;
+                }
+            }
+            if (encodeRow(layout, decoded, again) != RC_OK || again != row) {
+                std::cerr << "  row " << n << " re-encodes differently" << std::endl;
+                return RC_INVALID_OP;
+            }
+        }
+        // 列数不符与超长字符串须被拒绝
+        vals.pop_back();
+        if (encodeRow(layout, vals, row) != RC_INVALID_ARG) {
+            std::cerr << "  encode accepted a row with a missing column" << std::endl;
+            return RC_INVALID_OP;
+        }
+        makeRow(attrs, 1, rng, vals);
+        vals[1].strVal.assign(attrs[1].length + 1, 'x');
+        if (encodeRow(layout, vals, row) != RC_RECORD_TOO_LONG) {
+            std::cerr << "  encode accepted an over-long string" << std::endl;
+            return RC_INVALID_OP;
+        }
+        std::cout << "  codec: " << rowsPerCase << " rows round-trip through RowView" << std::endl;
+    }
+
+    // Step 2: 经表存储往返（三种页面格式）：getRowLayout与表结构一致，readRecord取回相同的编码行，
+    // readColumn逐列读出相同的值（行式页的长字符串列经溢出页读取）
+    const PageFormat formats[3] = {PAGE_FORMAT_SLOTTED, PAGE_FORMAT_PAX, PAGE_FORMAT_FIXED};
+    for (int f = 0; f < 3; ++f) {
+        std::string tableName = std::string("table8_") + formatNames[f];
+        TableInfo tbl;
+        if (dataDict_.findTable(tableName.c_str(), tbl) == RC_OK) {
+            tableManager_.dropTable(1, tableName.c_str());
+        }
+        std::vector<AttrInfo> attrs;
+        makeAttrs(formats[f], attrs);
+        RC rc = tableManager_.createTable(1, tableName.c_str(), (int)attrs.size(), attrs.data(), formats[f]);
+        if (rc != RC_OK) {
+            std::cerr << "Failed to create table '" << tableName << "': " << rc << std::endl;
+            return rc;
+        }
+        dataDict_.findTable(tableName.c_str(), tbl);
+        const RowLayout* layout = nullptr;
+        const RowLayout* cached = nullptr;
+        RowLayout expected;
+        expected.init((int)attrs.size(), attrs.data());
+        if (dataDict_.getRowLayout(tbl.tableId, layout) != RC_OK || dataDict_.getRowLayout(tbl.tableId, cached) != RC_OK ||
+            cached != layout || layout->attrCount != expected.attrCount || layout->varDataOffset != expected.varDataOffset ||
+            layout->varTableOffset != expected.varTableOffset ||
+            !std::equal(expected.fixedOffset, expected.fixedOffset + expected.attrCount, layout->fixedOffset) ||
+            !std::equal(expected.varIndex, expected.varIndex + expected.attrCount, layout->varIndex)) {
+            std::cerr << "  getRowLayout does not match the schema of " << tableName << std::endl;
+            return RC_INVALID_OP;
+        }
+
+        std::mt19937 rng(80 + f);
+        std::vector<std::vector<Value>> rowValues(rowsPerCase);
+        std::vector<std::string> rows(rowsPerCase);
+        std::vector<RID> rids(rowsPerCase);
+        for (int n = 0; n < rowsPerCase; ++n) {
+            makeRow(attrs, n, rng, rowValues[n]);
+            encodeRow(*layout, rowValues[n], rows[n]);
+            rc = tableManager_.insertRecord(1, tableName.c_str(), rows[n].data(), (int)rows[n].size(), rids[n]);
+            if (rc != RC_OK) {
+                std::cerr << "Insert failed at record " << n << " (error: " << rc << ")" << std::endl;
+                return rc;
+            }
+        }
+        for (int n = 0; n < rowsPerCase; ++n) {
+            char* data = nullptr;
+            int length = 0;
+            rc = tableManager_.readRecord(tableName.c_str(), rids[n], data, length);
+            if (rc != RC_OK) {
+                return rc;
+            }
+            bool same = length == (int)rows[n].size() && std::memcmp(data, rows[n].data(), length) == 0;
+            delete[] data;
+            if (!same) {
+                std::cerr << "  " << tableName << " row " << n << " reads back different bytes" << std::endl;
+                return RC_INVALID_OP;
+            }
+            for (int c = 0; c < (int)attrs.size(); ++c) {
+                Value value;
+                rc = tableManager_.readColumn(tableName.c_str(), rids[n], c, value);
+                if (rc != RC_OK || !sameValue(value, rowValues[n][c])) {
+                    std::cerr << "  " << tableName << " row " << n << " column " << c << " reads back "
+                              << valueToString(value) << ", expected " << valueToString(rowValues[n][c]) << std::endl;
+                    return RC_INVALID_OP;
+                }
+            }
+        }
+        std::cout << "  " << formatNames[f] << " table: " << rowsPerCase << " rows and " << rowsPerCase * attrs.size()
+                  << " columns read back unchanged" << std::endl;
+        tableManager_.dropTable(1, tableName.c_str());
+    }
+
+    std::cout << "===== Task 8 Test Completed =====" << std::endl;
+    return RC_OK;
+}
+
+RC Test::runTask9() {
+    std::cout << "\n===== Starting Task 9 Test: overflow row delete, insert, vacuum and slot reuse =====" << std::endl;
+    const std::string tableName = "table9";
+    const int wideLen = 3 * BLOCK_SIZE;
+
+    // 第0轮删除后由vacuum释放溢出链，第1轮删除后由插入复用槽位时释放；
+    // 两轮中删除与清理之间都插入一行需要新槽的行内记录，使数据区整体后移
+    for (int round = 0; round < 2; ++round) {
+        TableInfo tbl;
+        if (dataDict_.findTable(tableName.c_str(), tbl) == RC_OK) {
+            tableManager_.dropTable(1, tableName.c_str());
+        }
+        AttrInfo attrs[2] = {{"id", INT, 4}, {"body", STRING, wideLen}};
+        RC rc = tableManager_.createTable(1, tableName.c_str(), 2, attrs);
+        if (rc != RC_OK) {
+            std::cerr << "Failed to create table '" << tableName << "': " << rc << std::endl;
+            return rc;
+        }
+        dataDict_.findTable(tableName.c_str(), tbl);
+        const RowLayout* layout = nullptr;
+        dataDict_.getRowLayout(tbl.tableId, layout);
+
+        // 行0（A）的正文全为0字节：数据区后移后若仍按旧偏移读取A的溢出指针，读到的首页号为0，即先插入的B的溢出链
+        std::vector<Value> vals(2);
+        std::string row;
+        auto fill = [](int id) { return id == 0 ? '\0' : (char)('a' + id % 26); };
+        auto insertRow = [&](int id, int len, RID& rid) {
+            vals[0].intVal = id;
+            vals[1].strVal.assign(len, fill(id));
+            encodeRow(*layout, vals, row);
+            return tableManager_.insertRecord(1, tableName.c_str(), row.data(), (int)row.size(), rid);
+        };
+        // 整行读回与按列读回都须与插入的内容一致
+        auto checkRow = [&](int id, int len, const RID& rid) {
+            vals[0].intVal = id;
+            vals[1].strVal.assign(len, fill(id));
+            encodeRow(*layout, vals, row);
+            char* data = nullptr;
+            int length = 0;
+            if (tableManager_.readRecord(tableName.c_str(), rid, data, length) != RC_OK) {
+                return false;
+            }
+            bool same = length == (int)row.size() && std::memcmp(data, row.data(), length) == 0;
+            delete[] data;
+            Value body;
+            return same && tableManager_.readColumn(tableName.c_str(), rid, 1, body) == RC_OK &&
+                   body.strVal == vals[1].strVal;
+        };
+
+        // Step 1: 同页的两个溢出行B、A；删除A后插入C，C比A的行内存根长，不能复用A的槽而占用新槽
+        RID a, b, c, d;
+        if ((rc = insertRow(1, 2 * BLOCK_SIZE + 100, b)) != RC_OK || (rc = insertRow(0, 2 * BLOCK_SIZE, a)) != RC_OK ||
+            (rc = tableManager_.deleteRecord(1, tableName.c_str(), a)) != RC_OK || (rc = insertRow(2, 700, c)) != RC_OK) {
+            std::cerr << "  setup failed: " << rc << std::endl;
+            return rc;
+        }
+        if (b.pageNum != a.pageNum || c.pageNum != a.pageNum || c.slotNum <= a.slotNum) {
+            std::cerr << "  rows did not share a page with a new slot for C" << std::endl;
+            return RC_INVALID_OP;
+        }
+
+        // Step 2: 释放A的溢出链（vacuum或复用A的槽），B与C不受影响
+        if (round == 0) {
+            rc = tableManager_.vacuum(tableName.c_str());
+        } else {
+            rc = insertRow(3, 100, d);
+            if (rc == RC_OK && !(d == a)) {
+                std::cerr << "  short row did not reuse the deleted slot" << std::endl;
+                return RC_INVALID_OP;
+            }
+        }
+        if (rc != RC_OK || !checkRow(1, 2 * BLOCK_SIZE + 100, b) || !checkRow(2, 700, c) ||
+            (round == 1 && !checkRow(3, 100, d))) {
+            std::cerr << "  round " << round << ": rows changed after the deleted overflow row was freed" << std::endl;
+            return RC_INVALID_OP;
+        }
+
+        // Step 3: 再删除B并清理，新插入的溢出行各自占用溢出页（溢出页未被重复释放）
+        std::vector<RID> more(4);
+        rc = tableManager_.deleteRecord(1, tableName.c_str(), b);
+        if (rc == RC_OK) {
+            rc = tableManager_.vacuum(tableName.c_str());
+        }
+        for (int i = 0; i < 4 && rc == RC_OK; ++i) {
+            rc = insertRow(10 + i, BLOCK_SIZE + 500 * i, more[i]);
+        }
+        if (rc != RC_OK) {
+            return rc;
+        }
+        for (int i = 0; i < 4; ++i) {
+            if (!checkRow(10 + i, BLOCK_SIZE + 500 * i, more[i])) {
+                std::cerr << "  round " << round << ": overflow row " << 10 + i << " reads back wrong" << std::endl;
+                return RC_INVALID_OP;
+            }
+        }
+        if (!checkRow(2, 700, c)) {
+            return RC_INVALID_OP;
+        }
+
+        // Step 4: 只读id列的扫描不访问溢出链，交给回调的只是行内前缀；读body列的扫描拿到完整正文
+        if (round == 1) {
+            tableManager_.deleteRecord(1, tableName.c_str(), d);
+        }
+        const std::vector<int> idOnly{0}, bodyOnly{1};
+        int seen = 0, whole = 0;
+        rc = tableManager_.scanTable(tableName.c_str(), [&](const RID&, const char* data, int len) {
+            RowView view(*layout, data, len);
+            int id = view.getInt(0);
+            seen++;
+            return id == 2 || (id >= 10 && id < 14 && len <= TOAST_INLINE_LEN);   // C在行内，其余为溢出行
+        }, {}, &idOnly);
+        if (rc == RC_OK) {
+            rc = tableManager_.scanTable(tableName.c_str(), [&](const RID&, const char* data, int len) {
+                RowView view(*layout, data, len);
+                int id = view.getInt(0), bodyLen = 0;
+                const char* body = view.getString(1, bodyLen);
+                int expect = id == 2 ? 700 : BLOCK_SIZE + 500 * (id - 10);
+                whole += bodyLen == expect && std::string(body, bodyLen) == std::string(expect, fill(id));
+                return true;
+            }, {}, &bodyOnly);
+        }
+        if (rc != RC_OK || seen != 5 || whole != 5) {
+            std::cerr << "  round " << round << ": projected scan saw " << seen << " rows, " << whole
+                      << " complete bodies" << std::endl;
+            return rc != RC_OK ? rc : RC_INVALID_OP;
+        }
+        std::cout << "  " << (round == 0 ? "vacuum" : "slot reuse") << ": live rows intact after freeing deleted overflow rows"
+                  << std::endl;
+    }
+    tableManager_.dropTable(1, tableName.c_str());
+
+    std::cout << "===== Task 9 Test Completed =====" << std::endl;
+    return RC_OK;
+}
+
+RC Test::runTask10() {
+    std::cout << "\n===== Starting Task 10 Test: WHERE string literals longer than the column =====" << std::endl;
+    const std::string tableName = "table10";
+    TableInfo tbl;
+    if (dataDict_.findTable(tableName.c_str(), tbl) == RC_OK) {
+        tableManager_.dropTable(1, tableName.c_str());
+    }
+    AttrInfo attrs[2] = {{"id", INT, 4}, {"tag", STRING, 4}};
+    RC rc = tableManager_.createTable(1, tableName.c_str(), 2, attrs);
+    if (rc != RC_OK) {
+        std::cerr << "Failed to create table '" << tableName << "': " << rc << std::endl;
+        return rc;
+    }
+    dataDict_.findTable(tableName.c_str(), tbl);
+    const RowLayout* layout = nullptr;
+    dataDict_.getRowLayout(tbl.tableId, layout);
+
+    // 字面量'abcde'截断到列宽为'abcd'：等于截断值的行排在字面量之前；另插入一批大于字面量的行，使查询走仅索引扫描
+    const int fillers = 2000;
+    std::vector<std::string> tags = {"ab", "abcd", "abce", "b"};
+    for (int i = 0; i < fillers; ++i) {
+        tags.push_back("c" + std::to_string(100 + i % 900));
+    }
+    std::vector<Value> vals(2);
+    std::string row;
+    for (size_t i = 0; i < tags.size(); ++i) {
+        vals[0].intVal = (int)i;
+        vals[1].strVal = tags[i];
+        encodeRow(*layout, vals, row);
+        RID rid;
+        rc = tableManager_.insertRecord(1, tableName.c_str(), row.data(), (int)row.size(), rid);
+        if (rc != RC_OK) {
+            return rc;
+        }
+    }
+
+    // 各运算符期望的行数；第1轮在tag上建索引后重复查询
+    const std::vector<std::pair<std::string, int>> cases = {
+        {"=", 0}, {"<", 2}, {"<=", 2}, {">", 2 + fillers}, {">=", 2 + fillers}, {"!=", 4 + fillers}};
+    for (int round = 0; round < 2; ++round) {
+        if (round == 1 && (rc = indexManager_.createIndex(1, "table10_tag", tableName.c_str(), "tag")) != RC_OK) {
+            std::cerr << "  failed to create index on tag: " << rc << std::endl;
+            return rc;
+        }
+        for (const auto& c : cases) {
+            std::string selectSql = "SELECT tag FROM table10 WHERE tag " + c.first + " 'abcde'";
+            auto parseRes = parseSelectSql(selectSql);
+            if (!parseRes.ok) {
+                std::cerr << "Parse failed: " << parseRes.error << std::endl;
+                return RC_INVALID_OP;
+            }
+            auto lp = buildLogicalPlan(parseRes.select);
+            auto opt = optimizeLogicalPlan(lp.plan, dataDict_);
+            auto phys = buildPhysicalPlan(opt.optimized, dataDict_, indexManager_);
+            int found = 0;
+            rc = executePhysicalPlan(phys, dataDict_, tableManager_, indexManager_, [&](const RID&, const std::vector<Value>&) {
+                found++;
+                return true;
+            });
+            if (rc != RC_OK || found != c.second) {
+                std::cerr << "  [" << selectSql << "] rc " << rc << ", " << found << " rows, expected " << c.second
+                          << "\n" << printPhysicalPlan(phys);
+                return rc != RC_OK ? rc : RC_INVALID_OP;
+            }
+        }
+        std::cout << "  " << (round == 0 ? "table scan" : "with index on tag") << ": all operators return the expected rows"
+                  << std::endl;
+    }
+    tableManager_.dropTable(1, tableName.c_str());
+
+    std::cout << "===== Task 10 Test Completed =====" << std::endl;
+    return RC_OK;
+}
+
 RC Test::createTestTables() {
     // 定义表结构：仅包含一个int类型的id字段
     AttrInfo attr = {"num", INT, sizeof(int)};
@@ -347,14 +1108,26 @@ RC Test::createTestTables() {
 }
 
 RC Test::insertTestData(const std::string& tableName, int count) {
+    TableInfo tableInfo;
+    RC rc = dataDict_.findTable(tableName.c_str(), tableInfo);
+    if (rc != RC_OK) {
+        return rc;
+    }
+    const RowLayout* layout = nullptr;
+    rc = dataDict_.getRowLayout(tableInfo.tableId, layout);
+    if (rc != RC_OK) {
+        return rc;
+    }
+
+    std::vector<Value> values(1);
+    std::string row;
     for (int i = 0; i < count; ++i) {
         // 简单数据：仅包含一个整数
-        int data = i;
+        values[0].intVal = i;
+        encodeRow(*layout, values, row);
         RID rid;
 
-        RC rc = tableManager_.insertRecord(1, tableName.c_str(),
-                                           reinterpret_cast<const char*>(&data),
-                                           sizeof(int), rid);
+        rc = tableManager_.insertRecord(1, tableName.c_str(), row.data(), (int)row.size(), rid);
         if (rc != RC_OK) {
             std::cerr << "Insert failed at record " << i << " (error: " << rc << ")" << std::endl;
             return rc;